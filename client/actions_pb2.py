@@ -14,13 +14,22 @@ _sym_db = _symbol_database.Default()
 
 
 
-DESCRIPTOR = _descriptor_pool.Default().AddSerializedFile(b'\n\ractions.proto\x12\x08poker.v1\"~\n\x06\x41\x63tion\x12%\n\x04\x66old\x18\x01 \x01(\x0b\x32\x15.poker.v1.Action.FoldH\x00\x12#\n\x03\x62\x65t\x18\x02 \x01(\x0b\x32\x14.poker.v1.Action.BetH\x00\x1a\x06\n\x04\x46old\x1a\x15\n\x03\x42\x65t\x12\x0e\n\x06\x61mount\x18\x02 \x01(\x04\x42\t\n\x07payloadb\x06proto3')
+DESCRIPTOR = _descriptor_pool.Default().AddSerializedFile(b'\n\ractions.proto\x12\x08poker.v1\"\xb4\x06\n\x06\x41\x63tion\x12%\n\x04\x66old\x18\x01 \x01(\x0b\x32\x15.poker.v1.Action.FoldH\x00\x12#\n\x03\x62\x65t\x18\x02 \x01(\x0b\x32\x14.poker.v1.Action.BetH\x00\x12%\n\x04join\x18\x04 \x01(\x0b\x32\x15.poker.v1.Action.JoinH\x00\x12\'\n\x05leave\x18\x05 \x01(\x0b\x32\x16.poker.v1.Action.LeaveH\x00\x12%\n\x04\x63hat\x18\x06 \x01(\x0b\x32\x15.poker.v1.Action.ChatH\x00\x12\'\n\x05watch\x18\x07 \x01(\x0b\x32\x16.poker.v1.Action.WatchH\x00\x12+\n\x07unwatch\x18\x08 \x01(\x0b\x32\x18.poker.v1.Action.UnwatchH\x00\x12\x33\n\x0bleaderboard\x18\t \x01(\x0b\x32\x1c.poker.v1.Action.LeaderboardH\x00\x12)\n\x06resume\x18\n \x01(\x0b\x32\x17.poker.v1.Action.ResumeH\x00\x12\'\n\x05stats\x18\x0b \x01(\x0b\x32\x16.poker.v1.Action.StatsH\x00\x12\x10\n\x08table_id\x18\x03 \x01(\x04\x12\x0f\n\x07hand_id\x18\x0c \x01(\x04\x1a\x06\n\x04\x46old\x1a\x15\n\x03\x42\x65t\x12\x0e\n\x06\x61mount\x18\x02 \x01(\x04\x1a\x19\n\x04Join\x12\x11\n\tfast_fold\x18\x01 \x01(\x08\x1a\x1a\n\x05Leave\x12\x11\n\tfast_fold\x18\x01 \x01(\x08\x1a\x14\n\x04\x43hat\x12\x0c\n\x04text\x18\x01 \x01(\t\x1a\x07\n\x05Watch\x1a\t\n\x07Unwatch\x1a\x97\x01\n\x0bLeaderboard\x12\x31\n\x05\x62oard\x18\x01 \x01(\x0e\x32\".poker.v1.Action.Leaderboard.Board\x12\x0c\n\x04page\x18\x02 \x01(\r\"G\n\x05\x42oard\x12\x15\n\x11\x42OARD_UNSPECIFIED\x10\x00\x12\x16\n\x12\x42OARD_NET_WINNINGS\x10\x01\x12\x0f\n\x0b\x42OARD_HANDS\x10\x02\x1a\'\n\x06Resume\x12\x0e\n\x06player\x18\x01 \x01(\x04\x12\r\n\x05token\x18\x02 \x01(\x06\x1a\x17\n\x05Stats\x12\x0e\n\x06player\x18\x01 \x01(\x04\x42\t\n\x07payloadb\x06proto3')
 
 
 
 _ACTION = DESCRIPTOR.message_types_by_name['Action']
 _ACTION_FOLD = _ACTION.nested_types_by_name['Fold']
 _ACTION_BET = _ACTION.nested_types_by_name['Bet']
+_ACTION_JOIN = _ACTION.nested_types_by_name['Join']
+_ACTION_LEAVE = _ACTION.nested_types_by_name['Leave']
+_ACTION_CHAT = _ACTION.nested_types_by_name['Chat']
+_ACTION_WATCH = _ACTION.nested_types_by_name['Watch']
+_ACTION_UNWATCH = _ACTION.nested_types_by_name['Unwatch']
+_ACTION_LEADERBOARD = _ACTION.nested_types_by_name['Leaderboard']
+_ACTION_LEADERBOARD_BOARD = _ACTION_LEADERBOARD.enum_types_by_name['Board']
+_ACTION_RESUME = _ACTION.nested_types_by_name['Resume']
+_ACTION_STATS = _ACTION.nested_types_by_name['Stats']
 Action = _reflection.GeneratedProtocolMessageType('Action', (_message.Message,), {
 
   'Fold' : _reflection.GeneratedProtocolMessageType('Fold', (_message.Message,), {
@@ -36,6 +45,62 @@ Action = _reflection.GeneratedProtocolMessageType('Action', (_message.Message,),
     # @@protoc_insertion_point(class_scope:poker.v1.Action.Bet)
     })
   ,
+
+  'Join' : _reflection.GeneratedProtocolMessageType('Join', (_message.Message,), {
+    'DESCRIPTOR' : _ACTION_JOIN,
+    '__module__' : 'actions_pb2'
+    # @@protoc_insertion_point(class_scope:poker.v1.Action.Join)
+    })
+  ,
+
+  'Leave' : _reflection.GeneratedProtocolMessageType('Leave', (_message.Message,), {
+    'DESCRIPTOR' : _ACTION_LEAVE,
+    '__module__' : 'actions_pb2'
+    # @@protoc_insertion_point(class_scope:poker.v1.Action.Leave)
+    })
+  ,
+
+  'Chat' : _reflection.GeneratedProtocolMessageType('Chat', (_message.Message,), {
+    'DESCRIPTOR' : _ACTION_CHAT,
+    '__module__' : 'actions_pb2'
+    # @@protoc_insertion_point(class_scope:poker.v1.Action.Chat)
+    })
+  ,
+
+  'Watch' : _reflection.GeneratedProtocolMessageType('Watch', (_message.Message,), {
+    'DESCRIPTOR' : _ACTION_WATCH,
+    '__module__' : 'actions_pb2'
+    # @@protoc_insertion_point(class_scope:poker.v1.Action.Watch)
+    })
+  ,
+
+  'Unwatch' : _reflection.GeneratedProtocolMessageType('Unwatch', (_message.Message,), {
+    'DESCRIPTOR' : _ACTION_UNWATCH,
+    '__module__' : 'actions_pb2'
+    # @@protoc_insertion_point(class_scope:poker.v1.Action.Unwatch)
+    })
+  ,
+
+  'Leaderboard' : _reflection.GeneratedProtocolMessageType('Leaderboard', (_message.Message,), {
+    'DESCRIPTOR' : _ACTION_LEADERBOARD,
+    '__module__' : 'actions_pb2'
+    # @@protoc_insertion_point(class_scope:poker.v1.Action.Leaderboard)
+    })
+  ,
+
+  'Resume' : _reflection.GeneratedProtocolMessageType('Resume', (_message.Message,), {
+    'DESCRIPTOR' : _ACTION_RESUME,
+    '__module__' : 'actions_pb2'
+    # @@protoc_insertion_point(class_scope:poker.v1.Action.Resume)
+    })
+  ,
+
+  'Stats' : _reflection.GeneratedProtocolMessageType('Stats', (_message.Message,), {
+    'DESCRIPTOR' : _ACTION_STATS,
+    '__module__' : 'actions_pb2'
+    # @@protoc_insertion_point(class_scope:poker.v1.Action.Stats)
+    })
+  ,
   'DESCRIPTOR' : _ACTION,
   '__module__' : 'actions_pb2'
   # @@protoc_insertion_point(class_scope:poker.v1.Action)
@@ -43,14 +108,40 @@ Action = _reflection.GeneratedProtocolMessageType('Action', (_message.Message,),
 _sym_db.RegisterMessage(Action)
 _sym_db.RegisterMessage(Action.Fold)
 _sym_db.RegisterMessage(Action.Bet)
+_sym_db.RegisterMessage(Action.Join)
+_sym_db.RegisterMessage(Action.Leave)
+_sym_db.RegisterMessage(Action.Chat)
+_sym_db.RegisterMessage(Action.Watch)
+_sym_db.RegisterMessage(Action.Unwatch)
+_sym_db.RegisterMessage(Action.Leaderboard)
+_sym_db.RegisterMessage(Action.Resume)
+_sym_db.RegisterMessage(Action.Stats)
 
 if _descriptor._USE_C_DESCRIPTORS == False:
 
   DESCRIPTOR._options = None
-  _ACTION._serialized_start=27
-  _ACTION._serialized_end=153
-  _ACTION_FOLD._serialized_start=113
-  _ACTION_FOLD._serialized_end=119
-  _ACTION_BET._serialized_start=121
-  _ACTION_BET._serialized_end=142
+  _ACTION._serialized_start=28
+  _ACTION._serialized_end=848
+  _ACTION_FOLD._serialized_start=491
+  _ACTION_FOLD._serialized_end=497
+  _ACTION_BET._serialized_start=499
+  _ACTION_BET._serialized_end=520
+  _ACTION_JOIN._serialized_start=522
+  _ACTION_JOIN._serialized_end=547
+  _ACTION_LEAVE._serialized_start=549
+  _ACTION_LEAVE._serialized_end=575
+  _ACTION_CHAT._serialized_start=577
+  _ACTION_CHAT._serialized_end=597
+  _ACTION_WATCH._serialized_start=599
+  _ACTION_WATCH._serialized_end=606
+  _ACTION_UNWATCH._serialized_start=608
+  _ACTION_UNWATCH._serialized_end=617
+  _ACTION_LEADERBOARD._serialized_start=620
+  _ACTION_LEADERBOARD._serialized_end=771
+  _ACTION_LEADERBOARD_BOARD._serialized_start=700
+  _ACTION_LEADERBOARD_BOARD._serialized_end=771
+  _ACTION_RESUME._serialized_start=773
+  _ACTION_RESUME._serialized_end=812
+  _ACTION_STATS._serialized_start=814
+  _ACTION_STATS._serialized_end=837
 # @@protoc_insertion_point(module_scope)
@@ -316,6 +316,18 @@ def main(stdscr):
                                 state.apply_event(msg.event)
                             elif payload == "error":
                                 state.log(f"error: {error_to_str(msg.error)}")
+                            elif payload == "chat":
+                                state.log(f"{msg.chat.who}: {msg.chat.text}")
+                            elif payload == "welcome":
+                                state.player_id = msg.welcome.player
+                                state.log(f"playing as {msg.welcome.player}")
+                            elif payload == "stats":
+                                st = msg.stats
+                                state.log(
+                                    f"{st.player}: {st.hands} hands, VPIP "
+                                    f"{st.vpip:.0%} PFR {st.pfr:.0%} AF "
+                                    f"{st.aggression:.1f}"
+                                )
                 if mask & selectors.EVENT_WRITE:
                     if out_buf:
                         sent = s.send(out_buf)
@@ -12,16 +12,58 @@ from google.protobuf import symbol_database as _symbol_database
 _sym_db = _symbol_database.Default()
 
 
+import actions_pb2 as actions__pb2
 import errors_pb2 as errors__pb2
 import events_pb2 as events__pb2
 
 
-DESCRIPTOR = _descriptor_pool.Default().AddSerializedFile(b'\n\x0eresponse.proto\x12\x08poker.v1\x1a\x0c\x65rrors.proto\x1a\x0c\x65vents.proto\"^\n\rServerMessage\x12 \n\x05\x65vent\x18\x01 \x01(\x0b\x32\x0f.poker.v1.EventH\x00\x12 \n\x05\x65rror\x18\x02 \x01(\x0b\x32\x0f.poker.v1.ErrorH\x00\x42\t\n\x07payload\"5\n\x08Response\x12)\n\x08messages\x18\x01 \x03(\x0b\x32\x17.poker.v1.ServerMessageb\x06proto3')
+DESCRIPTOR = _descriptor_pool.Default().AddSerializedFile(b'\n\x0eresponse.proto\x12\x08poker.v1\x1a\ractions.proto\x1a\x0c\x65rrors.proto\x1a\x0c\x65vents.proto\"%\n\x08\x43hatLine\x12\x0b\n\x03who\x18\x01 \x01(\x04\x12\x0c\n\x04text\x18\x02 \x01(\t\"\xcb\x01\n\x0fLeaderboardPage\x12\x31\n\x05\x62oard\x18\x01 \x01(\x0e\x32\".poker.v1.Action.Leaderboard.Board\x12\x0c\n\x04page\x18\x02 \x01(\r\x12\x0f\n\x07players\x18\x03 \x01(\x04\x12\x30\n\x07\x65ntries\x18\x04 \x03(\x0b\x32\x1f.poker.v1.LeaderboardPage.Entry\x1a\x34\n\x05\x45ntry\x12\x0c\n\x04rank\x18\x01 \x01(\x04\x12\x0e\n\x06player\x18\x02 \x01(\x04\x12\r\n\x05score\x18\x03 \x01(\x03\"(\n\x07Welcome\x12\x0e\n\x06player\x18\x01 \x01(\x04\x12\r\n\x05token\x18\x02 \x01(\x06\"m\n\x0bPlayerStats\x12\x0e\n\x06player\x18\x01 \x01(\x04\x12\r\n\x05hands\x18\x02 \x01(\r\x12\x0c\n\x04vpip\x18\x03 \x01(\x01\x12\x0b\n\x03pfr\x18\x04 \x01(\x01\x12\x12\n\naggression\x18\x05 \x01(\x01\x12\x10\n\x08showdown\x18\x06 \x01(\x01\"\xa5\x02\n\rServerMessage\x12 \n\x05\x65vent\x18\x01 \x01(\x0b\x32\x0f.poker.v1.EventH\x00\x12 \n\x05\x65rror\x18\x02 \x01(\x0b\x32\x0f.poker.v1.ErrorH\x00\x12\"\n\x04\x63hat\x18\x04 \x01(\x0b\x32\x12.poker.v1.ChatLineH\x00\x12\x30\n\x0bleaderboard\x18\x05 \x01(\x0b\x32\x19.poker.v1.LeaderboardPageH\x00\x12$\n\x07welcome\x18\x06 \x01(\x0b\x32\x11.poker.v1.WelcomeH\x00\x12&\n\x05stats\x18\x07 \x01(\x0b\x32\x15.poker.v1.PlayerStatsH\x00\x12\x10\n\x08table_id\x18\x03 \x01(\x04\x12\x0f\n\x07hand_id\x18\x08 \x01(\x04\x42\t\n\x07payload\"5\n\x08Response\x12)\n\x08messages\x18\x01 \x03(\x0b\x32\x17.poker.v1.ServerMessageb\x06proto3')
 
 
 
+_CHATLINE = DESCRIPTOR.message_types_by_name['ChatLine']
+_LEADERBOARDPAGE = DESCRIPTOR.message_types_by_name['LeaderboardPage']
+_LEADERBOARDPAGE_ENTRY = _LEADERBOARDPAGE.nested_types_by_name['Entry']
+_WELCOME = DESCRIPTOR.message_types_by_name['Welcome']
+_PLAYERSTATS = DESCRIPTOR.message_types_by_name['PlayerStats']
 _SERVERMESSAGE = DESCRIPTOR.message_types_by_name['ServerMessage']
 _RESPONSE = DESCRIPTOR.message_types_by_name['Response']
+ChatLine = _reflection.GeneratedProtocolMessageType('ChatLine', (_message.Message,), {
+  'DESCRIPTOR' : _CHATLINE,
+  '__module__' : 'response_pb2'
+  # @@protoc_insertion_point(class_scope:poker.v1.ChatLine)
+  })
+_sym_db.RegisterMessage(ChatLine)
+
+LeaderboardPage = _reflection.GeneratedProtocolMessageType('LeaderboardPage', (_message.Message,), {
+
+  'Entry' : _reflection.GeneratedProtocolMessageType('Entry', (_message.Message,), {
+    'DESCRIPTOR' : _LEADERBOARDPAGE_ENTRY,
+    '__module__' : 'response_pb2'
+    # @@protoc_insertion_point(class_scope:poker.v1.LeaderboardPage.Entry)
+    })
+  ,
+  'DESCRIPTOR' : _LEADERBOARDPAGE,
+  '__module__' : 'response_pb2'
+  # @@protoc_insertion_point(class_scope:poker.v1.LeaderboardPage)
+  })
+_sym_db.RegisterMessage(LeaderboardPage)
+_sym_db.RegisterMessage(LeaderboardPage.Entry)
+
+Welcome = _reflection.GeneratedProtocolMessageType('Welcome', (_message.Message,), {
+  'DESCRIPTOR' : _WELCOME,
+  '__module__' : 'response_pb2'
+  # @@protoc_insertion_point(class_scope:poker.v1.Welcome)
+  })
+_sym_db.RegisterMessage(Welcome)
+
+PlayerStats = _reflection.GeneratedProtocolMessageType('PlayerStats', (_message.Message,), {
+  'DESCRIPTOR' : _PLAYERSTATS,
+  '__module__' : 'response_pb2'
+  # @@protoc_insertion_point(class_scope:poker.v1.PlayerStats)
+  })
+_sym_db.RegisterMessage(PlayerStats)
+
 ServerMessage = _reflection.GeneratedProtocolMessageType('ServerMessage', (_message.Message,), {
   'DESCRIPTOR' : _SERVERMESSAGE,
   '__module__' : 'response_pb2'
@@ -39,8 +81,18 @@ _sym_db.RegisterMessage(Response)
 if _descriptor._USE_C_DESCRIPTORS == False:
 
   DESCRIPTOR._options = None
-  _SERVERMESSAGE._serialized_start=56
-  _SERVERMESSAGE._serialized_end=150
-  _RESPONSE._serialized_start=152
-  _RESPONSE._serialized_end=205
+  _CHATLINE._serialized_start=71
+  _CHATLINE._serialized_end=108
+  _LEADERBOARDPAGE._serialized_start=111
+  _LEADERBOARDPAGE._serialized_end=314
+  _LEADERBOARDPAGE_ENTRY._serialized_start=262
+  _LEADERBOARDPAGE_ENTRY._serialized_end=314
+  _WELCOME._serialized_start=316
+  _WELCOME._serialized_end=356
+  _PLAYERSTATS._serialized_start=358
+  _PLAYERSTATS._serialized_end=467
+  _SERVERMESSAGE._serialized_start=470
+  _SERVERMESSAGE._serialized_end=763
+  _RESPONSE._serialized_start=765
+  _RESPONSE._serialized_end=818
 # @@protoc_insertion_point(module_scope)
@@ -0,0 +1,38 @@
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "delay_line.h"
+
+namespace {
+
+// One table's frame delayed and then handed to range(0) watchers: the
+// push, the release and a copy into each watcher's output buffer.
+void BM_DelayedFanOut(benchmark::State &state) {
+  const auto watchers = static_cast<std::size_t>(state.range(0));
+  broadcast::DelayLine line(256 * 1024);
+  std::vector<std::string> out(watchers);
+  const std::string frame(180, 'e'); // a typical betting-round frame
+  broadcast::Clock::time_point now{};
+  for (auto _ : state) {
+    line.push(now, frame);
+    line.release(now, [&](std::string_view f) {
+      for (auto &o : out) {
+        o.append(f);
+      }
+    });
+    now += std::chrono::milliseconds{1};
+    if (out[0].size() > 64 * 1024) {
+      for (auto &o : out) {
+        o.clear(); // as the socket drains; keeps the capacity
+      }
+    }
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * watchers *
+                                               frame.size()));
+}
+BENCHMARK(BM_DelayedFanOut)->Arg(1)->Arg(100)->Arg(5000);
+
+} // namespace
@@ -0,0 +1,91 @@
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <vector>
+
+#include "deck.h"
+#include "encoder.h"
+
+namespace {
+
+// A hand that goes to showdown at a six-handed table, each seat dealt its
+// own hole cards.
+auto hand_events() -> std::vector<poker::Event> {
+  using namespace poker;
+  const auto card = cards::from_card_id;
+  std::vector<Event> events{HandStarted{}};
+  for (PlayerId id = 1; id <= 6; ++id) {
+    events.emplace_back(DealtHole{id, {card(id), card(id + 20)}});
+  }
+  events.emplace_back(BetPlaced{2, kSmallBlind});
+  events.emplace_back(BetPlaced{3, kBigBlind});
+  for (PlayerId id = 4; id <= 9; ++id) {
+    events.emplace_back(TurnAdvanced{(id - 1) % 6 + 1});
+    events.emplace_back(BetPlaced{(id - 1) % 6 + 1, kBigBlind});
+  }
+  events.emplace_back(PhaseAdvanced{Phase::flop});
+  events.emplace_back(DealtFlop{{card(40), card(41), card(42)}});
+  events.emplace_back(PhaseAdvanced{Phase::turn});
+  events.emplace_back(DealtStreet{card(46)});
+  events.emplace_back(PhaseAdvanced{Phase::river});
+  events.emplace_back(DealtStreet{card(48)});
+  events.emplace_back(ShowdownHand{1, {card(1), card(21)}});
+  events.emplace_back(ShowdownHand{4, {card(4), card(24)}});
+  events.emplace_back(WonPot{4, 60});
+  for (PlayerId id = 1; id <= 6; ++id) {
+    events.emplace_back(PlayerChips{id, kBuyIn - kBigBlind});
+  }
+  return events;
+}
+
+// Tables pushing in one tick, six players and a watchers' frame each.
+constexpr poker::TableId kTables = 64;
+const std::vector<poker::PlayerId> kViewers{1, 2, 3, 4, 5, 6,
+                                            encode::kEveryone};
+
+void BM_EncodeInline(benchmark::State &state) {
+  const auto events = hand_events();
+  encode::Batch batch;
+  for (auto _ : state) {
+    for (poker::TableId t = 1; t <= kTables; ++t) {
+      batch.table = t;
+      batch.events = events;
+      batch.viewers = kViewers;
+      encode::encode(batch);
+      benchmark::DoNotOptimize(batch.out.data());
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kTables);
+}
+BENCHMARK(BM_EncodeInline);
+
+// The whole tick, submit to drain; "submit" is the share of it the game
+// thread spends handing batches off.
+void BM_EncodePool(benchmark::State &state) {
+  const auto events = hand_events();
+  encode::Pool pool(static_cast<unsigned>(state.range(0)));
+  std::chrono::steady_clock::duration submitting{};
+  for (auto _ : state) {
+    const auto start = std::chrono::steady_clock::now();
+    for (poker::TableId t = 1; t <= kTables; ++t) {
+      auto &batch = pool.next();
+      batch.table = t;
+      batch.events = events;
+      batch.viewers = kViewers;
+      pool.submit();
+    }
+    submitting += std::chrono::steady_clock::now() - start;
+    pool.drain([](const encode::Batch &batch) {
+      benchmark::DoNotOptimize(batch.out.data());
+    });
+  }
+  state.SetItemsProcessed(state.iterations() * kTables);
+  state.counters["submit_ns"] = benchmark::Counter(
+      static_cast<double>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(submitting)
+              .count()),
+      benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_EncodePool)->Arg(1)->Arg(2)->Arg(4)->UseRealTime();
+
+} // namespace
@@ -0,0 +1,38 @@
+#include <benchmark/benchmark.h>
+
+#include <filesystem>
+#include <unistd.h>
+
+#include "equity_table.h"
+
+namespace {
+
+// A mapped lookup against the Monte Carlo estimate it replaces.
+void BM_MappedLookup(benchmark::State &state) {
+  const auto path = std::filesystem::temp_directory_path() /
+                    (std::to_string(getpid()) + "equity_bench.bin");
+  if (!poker::write_equity_tables(path, {.samples = 1})) {
+    state.SkipWithError("cannot write the equity file");
+    return;
+  }
+  auto table = poker::EquityTable::open(path);
+  std::filesystem::remove(path);
+  uint8_t cls = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(table->vs_random(cls, 6));
+    benchmark::DoNotOptimize(table->vs_class(cls, 168 - cls));
+    cls = static_cast<uint8_t>((cls + 1) % poker::kHandClasses);
+  }
+}
+BENCHMARK(BM_MappedLookup);
+
+void BM_EstimateVsRandom(benchmark::State &state) {
+  uint64_t seed = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(poker::equity_vs_random(
+        0, 6, static_cast<uint32_t>(state.range(0)), ++seed));
+  }
+}
+BENCHMARK(BM_EstimateVsRandom)->Arg(1000);
+
+} // namespace
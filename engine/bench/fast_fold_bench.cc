@@ -0,0 +1,99 @@
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <optional>
+#include <random>
+#include <vector>
+
+#include "fast_fold.h"
+#include "house_bot.h"
+
+namespace {
+
+auto next_turn(const std::vector<poker::Event> &events)
+    -> std::optional<poker::PlayerId> {
+  std::optional<poker::PlayerId> turn;
+  for (const auto &ev : events) {
+    if (const auto *t = std::get_if<poker::TurnAdvanced>(&ev)) {
+      turn = t->next;
+    }
+  }
+  return turn;
+}
+
+// Folds `dealt` round to the big blind, which ends it.
+void fold_out(poker::FastFoldPool &pool, const poker::DealtHand &dealt) {
+  for (auto turn = next_turn(dealt.events); turn;) {
+    const auto res = pool.on_action(dealt.hand, poker::Fold{*turn});
+    turn = res ? next_turn(*res) : std::nullopt;
+  }
+}
+
+// Hand-start latency: the time match() takes to seat a waiting six at a
+// recycled table and deal. range(0) is the pool size.
+void BM_HandStart(benchmark::State &state) {
+  poker::FastFoldPool pool(6);
+  for (poker::PlayerId id = 1; id <= static_cast<uint64_t>(state.range(0));
+       ++id) {
+    (void)pool.join(id);
+  }
+  std::vector<poker::DealtHand> live;
+  for (auto _ : state) {
+    const auto start = std::chrono::steady_clock::now();
+    auto dealt = pool.match();
+    const auto stop = std::chrono::steady_clock::now();
+    state.SetIterationTime(std::chrono::duration<double>(stop - start).count());
+    for (const auto &d : dealt) {
+      fold_out(pool, d);
+    }
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(pool.hands_dealt()));
+  state.counters["tables"] = static_cast<double>(pool.tables());
+}
+BENCHMARK(BM_HandStart)->Arg(6)->Arg(600)->UseManualTime();
+
+// Whole hands of bot play: every action, and the reseating it causes.
+void BM_FastFoldPlay(benchmark::State &state) {
+  poker::FastFoldPool pool(6, 3);
+  std::mt19937_64 rolls(4);
+  for (poker::PlayerId id = 1; id <= 600; ++id) {
+    (void)pool.join(id);
+  }
+  std::vector<std::pair<poker::HandId, poker::PlayerId>> turns;
+  poker::PlayerId next_id = 601;
+  for (auto _ : state) {
+    for (const auto &d : pool.match()) {
+      if (const auto turn = next_turn(d.events)) {
+        turns.emplace_back(d.hand, *turn);
+      }
+    }
+    if (turns.empty()) {
+      break;
+    }
+    const auto [hand, actor] = turns.back();
+    turns.pop_back();
+    const auto view = pool.seat_view(hand, actor);
+    if (!view) {
+      continue;
+    }
+    auto res =
+        pool.on_action(hand, poker::bot_action(actor, *view, rolls() % 100));
+    if (!res) {
+      res = pool.on_action(hand, poker::Timeout{actor});
+    }
+    if (const auto turn = res ? next_turn(*res) : std::nullopt;
+        turn && pool.seat_view(hand, *turn)) {
+      turns.emplace_back(hand, *turn);
+    }
+    // busted players are replaced so the pool stays the same size
+    for (const auto &gone [[maybe_unused]] : pool.take_departures()) {
+      (void)pool.join(next_id++);
+    }
+  }
+  state.counters["hands"] = benchmark::Counter(
+      static_cast<double>(pool.hands_dealt()), benchmark::Counter::kIsRate);
+  state.counters["tables"] = static_cast<double>(pool.tables());
+}
+BENCHMARK(BM_FastFoldPlay);
+
+} // namespace
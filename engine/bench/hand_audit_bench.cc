@@ -0,0 +1,26 @@
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include "hand_audit.h"
+
+namespace {
+
+// Hands audited per second on range(0) threads over 64 six-handed tables.
+void BM_AuditHands(benchmark::State &state) {
+  std::vector<poker::TableLog> logs;
+  for (poker::TableId t = 1; t <= 64; ++t) {
+    logs.push_back(poker::play_table(t, t, 6, 200));
+  }
+  uint64_t hands = 0;
+  for (auto _ : state) {
+    const auto report =
+        poker::audit(logs, static_cast<unsigned>(state.range(0)));
+    hands += report.hands;
+    benchmark::DoNotOptimize(report.findings.size());
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(hands));
+}
+BENCHMARK(BM_AuditHands)->Arg(1)->Arg(4)->UseRealTime();
+
+} // namespace
@@ -0,0 +1,105 @@
+#include <benchmark/benchmark.h>
+
+#include <filesystem>
+#include <random>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "column_store.h"
+
+namespace {
+
+// Synthetic store shaped like production: hands of 2-9 players drawn from a
+// population of 100k, ids and timestamps increasing, chips skewed small.
+class SyntheticStore {
+public:
+  explicit SyntheticStore(std::size_t rows)
+      : root_(std::filesystem::temp_directory_path() / "hh_bench" /
+              std::to_string(getpid())) {
+    std::filesystem::remove_all(root_);
+    std::filesystem::create_directories(root_);
+    std::mt19937_64 rng(7);
+    std::geometric_distribution<uint64_t> chips(0.01);
+    std::vector<poker::HandRow> part;
+    uint64_t hand = 1;
+    uint64_t ts = 1'700'000'000'000;
+    while (rows_ < rows) {
+      const auto seats = 2 + rng() % 8;
+      for (uint64_t s = 0; s < seats; ++s) {
+        part.push_back(poker::HandRow{hand, ts, hand % 5000, rng() % 100'000,
+                                      chips(rng), chips(rng),
+                                      static_cast<uint8_t>(rng() % 8),
+                                      static_cast<uint8_t>(rng() % 3),
+                                      static_cast<uint8_t>(rng() % 3)});
+      }
+      rows_ += seats;
+      ++hand;
+      ts += 3;
+      if (part.size() >= 1'000'000) {
+        flush(part);
+      }
+    }
+    flush(part);
+  }
+  ~SyntheticStore() { std::filesystem::remove_all(root_); }
+
+  const std::vector<std::filesystem::path> &parts() const { return parts_; }
+  std::size_t rows() const { return rows_; }
+  uint64_t bytes() const {
+    uint64_t total = 0;
+    for (const auto &p : parts_) {
+      total += std::filesystem::file_size(p);
+    }
+    return total;
+  }
+
+private:
+  void flush(std::vector<poker::HandRow> &part) {
+    parts_.push_back(root_ / (std::to_string(parts_.size()) + ".hhc"));
+    (void)hhstore::write_part(parts_.back(), part);
+    part.clear();
+  }
+
+  std::filesystem::path root_;
+  std::vector<std::filesystem::path> parts_;
+  std::size_t rows_{0};
+};
+
+// The reference query: per-player hands and net over the whole store.
+// range(0) is rows in millions, range(1) worker threads.
+void BM_PlayerResults(benchmark::State &state) {
+  const SyntheticStore store(static_cast<std::size_t>(state.range(0)) *
+                             1'000'000);
+  for (auto _ : state) {
+    auto res = hhstore::player_results(
+        store.parts(), 0, static_cast<unsigned>(state.range(1)));
+    benchmark::DoNotOptimize(res);
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() *
+                                               store.rows()));
+  state.counters["bytes/row"] =
+      static_cast<double>(store.bytes()) / static_cast<double>(store.rows());
+}
+BENCHMARK(BM_PlayerResults)
+    ->Args({10, 1})
+    ->Args({10, 4})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+void BM_DecodeBlock(benchmark::State &state) {
+  const SyntheticStore store(hhstore::kBlockRows * 16);
+  auto part = hhstore::PartFile::open(store.parts().front());
+  std::array<uint64_t, hhstore::kBlockRows> out{};
+  std::size_t block = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        part->decode(hhstore::Column::player, block, out));
+    block = (block + 1) % part->blocks();
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() *
+                                               hhstore::kBlockRows));
+}
+BENCHMARK(BM_DecodeBlock);
+
+} // namespace
@@ -0,0 +1,54 @@
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <vector>
+
+#include "house_bot.h"
+#include "table.h"
+
+namespace {
+
+// One decision for the bot on the clock at a fresh 6-max table.
+void BM_BotDecision(benchmark::State &state) {
+  std::mt19937_64 rng(1);
+  poker::Table table(rng);
+  poker::HouseBots bots(1);
+  for (poker::PlayerId id = 1; id <= 6; ++id) {
+    (void)table.add_player(id);
+    bots.add(id, 1);
+  }
+  auto start = table.handle_new_hand();
+  poker::PlayerId next = 0;
+  for (const auto &ev : *start) {
+    if (auto turn = std::get_if<poker::TurnAdvanced>(&ev)) {
+      next = turn->next;
+    }
+  }
+  for (auto _ : state) {
+    auto turn = bots.on_turn(1, next);
+    benchmark::DoNotOptimize(bots.decide(turn, table));
+  }
+}
+BENCHMARK(BM_BotDecision);
+
+// Bookkeeping for a large bot population: one turn each.
+void BM_ThousandsOfBots(benchmark::State &state) {
+  poker::HouseBots bots(1);
+  const auto n = static_cast<poker::PlayerId>(state.range(0));
+  for (poker::PlayerId id = 1; id <= n; ++id) {
+    bots.add(id, id);
+  }
+  std::vector<poker::BotTurn> turns;
+  turns.reserve(static_cast<std::size_t>(n));
+  for (auto _ : state) {
+    turns.clear();
+    for (poker::PlayerId id = 1; id <= n; ++id) {
+      turns.push_back(bots.on_turn(id, id));
+    }
+    benchmark::DoNotOptimize(turns.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ThousandsOfBots)->Arg(1000)->Arg(10000);
+
+} // namespace
@@ -0,0 +1,54 @@
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include "icm.h"
+
+namespace {
+
+auto field(std::size_t n) -> std::vector<Chips> {
+  std::vector<Chips> out;
+  for (std::size_t i = 0; i < n; ++i) {
+    out.push_back(1000 + 700 * ((i * 7) % n));
+  }
+  return out;
+}
+
+// A final table of range(0) where every place pays.
+void BM_IcmExact(benchmark::State &state) {
+  const auto n = static_cast<std::size_t>(state.range(0));
+  const auto stacks = field(n);
+  std::vector<double> payouts;
+  for (std::size_t p = 0; p < n; ++p) {
+    payouts.push_back(static_cast<double>(n - p) * 10);
+  }
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(poker::icm_exact(stacks, payouts));
+  }
+}
+BENCHMARK(BM_IcmExact)->Arg(6)->Arg(10)->Arg(16)->Arg(20)
+    ->Unit(benchmark::kMicrosecond);
+
+// A field of range(0) with only the top three paid.
+void BM_IcmExactTopThree(benchmark::State &state) {
+  const auto stacks = field(static_cast<std::size_t>(state.range(0)));
+  const std::vector<double> payouts{50, 30, 20};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(poker::icm_exact(stacks, payouts));
+  }
+}
+BENCHMARK(BM_IcmExactTopThree)->Arg(10)->Arg(20)
+    ->Unit(benchmark::kMicrosecond);
+
+// A field of range(0) with the top nine paid, 100k sampled orders.
+void BM_IcmMonteCarlo(benchmark::State &state) {
+  const auto stacks = field(static_cast<std::size_t>(state.range(0)));
+  const std::vector<double> payouts{30, 20, 14, 10, 8, 6, 5, 4, 3};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        poker::icm_monte_carlo(stacks, payouts, 100'000, 1));
+  }
+}
+BENCHMARK(BM_IcmMonteCarlo)->Arg(10)->Arg(100)->Unit(benchmark::kMillisecond);
+
+} // namespace
@@ -0,0 +1,42 @@
+#include <benchmark/benchmark.h>
+
+#include <random>
+
+#include "leaderboard.h"
+
+namespace {
+
+constexpr poker::PlayerId kPlayers = 1'000'000;
+
+auto filled(std::mt19937_64 &rolls) -> poker::RankTree {
+  poker::RankTree tree;
+  for (poker::PlayerId id = 1; id <= kPlayers; ++id) {
+    tree.set(id, static_cast<int64_t>(rolls() % 1'000'000));
+  }
+  return tree;
+}
+
+// Moving one player on a board of a million.
+void BM_RankUpdate(benchmark::State &state) {
+  std::mt19937_64 rolls(3);
+  auto tree = filled(rolls);
+  for (auto _ : state) {
+    const auto score = static_cast<int64_t>(rolls() % 1'000'000);
+    tree.set(1 + rolls() % kPlayers, score);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RankUpdate);
+
+// A player's rank on a board of a million.
+void BM_RankQuery(benchmark::State &state) {
+  std::mt19937_64 rolls(5);
+  const auto tree = filled(rolls);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(tree.rank(1 + rolls() % kPlayers));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RankQuery);
+
+} // namespace
@@ -0,0 +1,67 @@
+#include <benchmark/benchmark.h>
+
+#include "player_manager.h"
+
+namespace {
+
+auto seated(std::size_t n) -> poker::PlayerManager {
+  poker::PlayerManager pm;
+  for (poker::PlayerId id = 1; id <= n; ++id) {
+    (void)pm.add_player(id);
+  }
+  pm.seat_held_players();
+  return pm;
+}
+
+// The requeue Table::handle(const Bet &) does on every raise.
+void BM_ActiveCycle(benchmark::State &state) {
+  const auto n = static_cast<std::size_t>(state.range(0));
+  auto pm = seated(n);
+  poker::PlayerId from = 1;
+  for (auto _ : state) {
+    auto ring = pm.active_cycle_from(from);
+    benchmark::DoNotOptimize(ring.size());
+    from = from % n + 1;
+  }
+}
+BENCHMARK(BM_ActiveCycle)->Arg(2)->Arg(6)->Arg(10);
+
+void BM_NextPlayerLap(benchmark::State &state) {
+  const auto n = static_cast<std::size_t>(state.range(0));
+  auto pm = seated(n);
+  for (auto _ : state) {
+    poker::PlayerId p = 1;
+    for (std::size_t i = 0; i < n; ++i) {
+      p = *pm.next_player(p);
+    }
+    benchmark::DoNotOptimize(p);
+  }
+}
+BENCHMARK(BM_NextPlayerLap)->Arg(2)->Arg(6)->Arg(10);
+
+// Id lookup for every seat, as the betting path does per action.
+void BM_ChipsLookup(benchmark::State &state) {
+  const auto n = static_cast<std::size_t>(state.range(0));
+  auto pm = seated(n);
+  for (auto _ : state) {
+    Chips total = 0;
+    for (poker::PlayerId id = 1; id <= n; ++id) {
+      total += pm.get_chips(id);
+    }
+    benchmark::DoNotOptimize(total);
+  }
+}
+BENCHMARK(BM_ChipsLookup)->Arg(2)->Arg(6)->Arg(10);
+
+void BM_JoinAndLeave(benchmark::State &state) {
+  const auto n = static_cast<std::size_t>(state.range(0));
+  auto pm = seated(n - 1);
+  for (auto _ : state) {
+    (void)pm.add_player(99);
+    pm.seat_held_players();
+    (void)pm.remove_player(99);
+  }
+}
+BENCHMARK(BM_JoinAndLeave)->Arg(2)->Arg(6)->Arg(10);
+
+} // namespace
@@ -0,0 +1,67 @@
+#include <benchmark/benchmark.h>
+
+#include <filesystem>
+#include <random>
+#include <vector>
+
+#include "player_stats.h"
+
+namespace {
+
+// Rows for `hands` six-handed hands drawn from a population of `players`.
+auto make_rows(std::size_t hands, uint64_t players)
+    -> std::vector<poker::HandRow> {
+  std::mt19937_64 rng(5);
+  std::vector<poker::HandRow> rows;
+  for (std::size_t h = 0; h < hands; ++h) {
+    for (int s = 0; s < 6; ++s) {
+      rows.push_back(poker::HandRow{h, 0, 1, 1 + rng() % players, 0, 0,
+                                    static_cast<uint8_t>(rng() % 8),
+                                    static_cast<uint8_t>(rng() % 3),
+                                    static_cast<uint8_t>(rng() % 3)});
+    }
+  }
+  return rows;
+}
+
+// Cost the stats add to the end of each hand. range(0) is the player
+// population, so the larger runs miss cache like a busy server would.
+void BM_RecordHand(benchmark::State &state) {
+  const auto rows = make_rows(4096, static_cast<uint64_t>(state.range(0)));
+  poker::PlayerStats stats;
+  stats.record(rows); // size the array outside the timed loop
+  std::size_t hand = 0;
+  for (auto _ : state) {
+    stats.record(std::span(rows).subspan(hand * 6, 6));
+    hand = (hand + 1) % 4096;
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_RecordHand)->Arg(1000)->Arg(1'000'000);
+
+void BM_StatLine(benchmark::State &state) {
+  const auto rows = make_rows(100'000, 1'000'000);
+  poker::PlayerStats stats;
+  stats.record(rows);
+  std::mt19937_64 rng(1);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(stats.line(1 + rng() % 1'000'000));
+  }
+}
+BENCHMARK(BM_StatLine);
+
+void BM_SaveMillionPlayers(benchmark::State &state) {
+  const auto rows = make_rows(400'000, 1'000'000);
+  poker::PlayerStats stats;
+  stats.record(rows);
+  const auto path = std::filesystem::temp_directory_path() / "stats_bench";
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(stats.save(path));
+  }
+  state.counters["bytes"] =
+      static_cast<double>(std::filesystem::file_size(path));
+  std::filesystem::remove(path);
+}
+BENCHMARK(BM_SaveMillionPlayers)->Unit(benchmark::kMillisecond);
+
+} // namespace
@@ -0,0 +1,47 @@
+#include <benchmark/benchmark.h>
+
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "replica.h"
+
+namespace {
+
+// What replication adds to one action: journaling a bet and its events
+// into the batch and, once per tick of `range(0)` actions, one send to a
+// standby that keeps up.
+void BM_ReplicateActions(benchmark::State &state) {
+  int sv[2];
+  if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) != 0) {
+    state.SkipWithError("socketpair");
+    return;
+  }
+  std::jthread drain([fd = sv[1]] {
+    std::vector<char> buf(1 << 16);
+    while (read(fd, buf.data(), buf.size()) > 0) {
+    }
+  });
+  {
+    replica::Sender sender(sv[0]);
+    const poker::InputRecord in{
+        .tag = poker::InputTag::bet, .table = 1, .who = 2, .amount = 40};
+    const std::vector<poker::Event> events{poker::BetPlaced{2, 40},
+                                           poker::TurnAdvanced{3}};
+    const auto per_tick = state.range(0);
+    for (auto _ : state) {
+      for (int64_t i = 0; i < per_tick; ++i) {
+        sender.append(in, events);
+      }
+      sender.flush();
+    }
+    state.SetItemsProcessed(state.iterations() * per_tick);
+    state.counters["sent"] = static_cast<double>(sender.bytes_sent());
+  } // closing the sender ends the drain
+  drain.join();
+  close(sv[1]);
+}
+BENCHMARK(BM_ReplicateActions)->Arg(1)->Arg(16)->Arg(128);
+
+} // namespace
@@ -0,0 +1,102 @@
+#include <benchmark/benchmark.h>
+
+#include <deque>
+#include <random>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "table_batch.h"
+
+namespace {
+
+constexpr std::size_t kGames = 4096;
+
+// One move in ten folds and one in five min-raises; the rest check or
+// call. `roll` is uniform in [0, 10).
+auto pick(uint64_t roll, Chips call, Chips min_raise)
+    -> std::pair<bool, Chips> {
+  if (roll == 0) {
+    return {true, 0};
+  }
+  return {false, roll <= 2 ? call + min_raise : call};
+}
+
+// range(0) seats, every game stepped at once.
+void BM_TableBatch(benchmark::State &state) {
+  poker::TableBatch batch(kGames, static_cast<std::size_t>(state.range(0)));
+  std::mt19937_64 rolls(1);
+  std::vector<poker::Move> moves(kGames);
+  std::vector<Chips> amounts(kGames);
+  for (auto _ : state) {
+    for (std::size_t g = 0; g < kGames; ++g) {
+      const auto [fold, amount] =
+          pick(rolls() % 10, batch.to_call(g), batch.min_raise()[g]);
+      moves[g] = fold ? poker::Move::fold : poker::Move::bet;
+      amounts[g] = amount;
+    }
+    batch.step(moves, amounts);
+  }
+  state.SetItemsProcessed(state.iterations() * kGames);
+  state.counters["hands"] = benchmark::Counter(
+      static_cast<double>(batch.hands_played()), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_TableBatch)->Arg(2)->Arg(6);
+
+// The same games as a Table each, one on_action at a time.
+void BM_TablePerGame(benchmark::State &state) {
+  const auto seats = static_cast<poker::PlayerId>(state.range(0));
+  struct Game {
+    explicit Game(uint64_t seed) : rng(seed), table(rng) {}
+    std::mt19937_64 rng;
+    poker::Table table;
+    poker::PlayerId turn{0};
+  };
+  auto deal = [seats](Game &game) {
+    for (poker::PlayerId id = 1; id <= seats; ++id) {
+      (void)game.table.remove_player(id);
+      (void)game.table.add_player(id);
+    }
+    const auto events = game.table.handle_new_hand();
+    for (const auto &ev : *events) {
+      if (const auto *t = std::get_if<poker::TurnAdvanced>(&ev)) {
+        game.turn = t->next;
+      }
+    }
+  };
+  std::deque<Game> games;
+  for (std::size_t g = 0; g < kGames; ++g) {
+    deal(games.emplace_back(1 + g));
+  }
+  std::mt19937_64 rolls(1);
+  uint64_t hands = 0;
+  for (auto _ : state) {
+    for (auto &game : games) {
+      const auto view = game.table.seat_view(game.turn);
+      const auto [fold, amount] =
+          pick(rolls() % 10, view->to_call, view->min_raise);
+      const auto res =
+          fold ? game.table.on_action(poker::Fold{game.turn})
+               : game.table.on_action(poker::Bet{game.turn, amount});
+      if (!res) {
+        continue;
+      }
+      if (!game.table.hand_in_progress()) {
+        ++hands;
+        deal(game);
+        continue;
+      }
+      for (const auto &ev : *res) {
+        if (const auto *t = std::get_if<poker::TurnAdvanced>(&ev)) {
+          game.turn = t->next;
+        }
+      }
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kGames);
+  state.counters["hands"] = benchmark::Counter(static_cast<double>(hands),
+                                               benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_TablePerGame)->Arg(2)->Arg(6);
+
+} // namespace
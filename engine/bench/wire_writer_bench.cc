@@ -0,0 +1,81 @@
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+#include "deck.h"
+#include "proto_translate.h"
+#include "response.pb.h"
+#include "wire_writer.h"
+
+namespace {
+
+// The events a six-handed table sends one player over a hand that goes to
+// showdown.
+auto hand_events() -> std::vector<poker::Event> {
+  using namespace poker;
+  const auto card = cards::from_card_id;
+  std::vector<Event> events{HandStarted{}, DealtHole{1, {card(3), card(40)}},
+                            BetPlaced{2, kSmallBlind},
+                            BetPlaced{3, kBigBlind}, TurnAdvanced{4}};
+  for (PlayerId id = 4; id <= 6; ++id) {
+    events.emplace_back(BetPlaced{id, kBigBlind});
+    events.emplace_back(TurnAdvanced{id % 6 + 1});
+  }
+  events.emplace_back(PhaseAdvanced{Phase::flop});
+  events.emplace_back(DealtFlop{{card(7), card(20), card(33)}});
+  events.emplace_back(PhaseAdvanced{Phase::turn});
+  events.emplace_back(DealtStreet{card(46)});
+  events.emplace_back(PhaseAdvanced{Phase::river});
+  events.emplace_back(DealtStreet{card(11)});
+  events.emplace_back(ShowdownHand{1, {card(3), card(40)}});
+  events.emplace_back(ShowdownHand{4, {card(9), card(22)}});
+  events.emplace_back(WonPot{4, 60});
+  for (PlayerId id = 1; id <= 6; ++id) {
+    events.emplace_back(PlayerChips{id, kBuyIn - kBigBlind});
+  }
+  return events;
+}
+
+constexpr poker::TableId kTable = 17;
+
+// The path the server used before: build a Response, then serialize it.
+void BM_SerializeToString(benchmark::State &state) {
+  const auto events = hand_events();
+  std::string out;
+  for (auto _ : state) {
+    out.clear();
+    ::poker::v1::Response res;
+    for (const auto &ev : events) {
+      auto *msg = res.add_messages();
+      *msg->mutable_event() = poker::to_proto_event(ev);
+      msg->set_table_id(kTable);
+    }
+    res.AppendToString(&out);
+    benchmark::DoNotOptimize(out.data());
+  }
+  state.SetItemsProcessed(state.iterations() *
+                          static_cast<int64_t>(events.size()));
+  state.SetBytesProcessed(state.iterations() *
+                          static_cast<int64_t>(out.size()));
+}
+BENCHMARK(BM_SerializeToString);
+
+void BM_WireWriter(benchmark::State &state) {
+  const auto events = hand_events();
+  std::string out;
+  for (auto _ : state) {
+    out.clear();
+    for (const auto &ev : events) {
+      wire::append_event(out, ev, kTable);
+    }
+    benchmark::DoNotOptimize(out.data());
+  }
+  state.SetItemsProcessed(state.iterations() *
+                          static_cast<int64_t>(events.size()));
+  state.SetBytesProcessed(state.iterations() *
+                          static_cast<int64_t>(out.size()));
+}
+BENCHMARK(BM_WireWriter);
+
+} // namespace
@@ -0,0 +1,120 @@
+#include "accounts.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include "replace_file.h"
+#include "varint.h"
+
+namespace poker {
+namespace {
+
+constexpr std::array<char, 4> kMagic{'P', 'A', 'C', '1'};
+// ids are handed out one at a time from 1, so anything near the top of the
+// range is a corrupt snapshot
+constexpr PlayerId kMaxSavedId = PlayerId{1} << 48;
+
+} // namespace
+
+auto to_string(AccountError e) -> std::string_view {
+  switch (e) {
+  case AccountError::io:
+    return "io";
+  case AccountError::bad_format:
+  default:
+    return "bad_format";
+  }
+}
+
+void Accounts::add(Credential c) {
+  tokens_[c.player] = c.token;
+  bound_ = std::max(bound_, c.player + 1);
+}
+
+void Accounts::erase(PlayerId id) { tokens_.erase(id); }
+
+bool Accounts::contains(PlayerId id) const { return tokens_.contains(id); }
+
+bool Accounts::verify(const Credential &c) const {
+  const auto it = tokens_.find(c.player);
+  return it != tokens_.end() && it->second == c.token;
+}
+
+std::size_t Accounts::size() const { return tokens_.size(); }
+
+PlayerId Accounts::id_bound() const { return bound_; }
+
+auto Accounts::credentials() const -> std::vector<Credential> {
+  std::vector<Credential> out;
+  out.reserve(tokens_.size());
+  for (const auto &[player, token] : tokens_) {
+    out.push_back({player, token});
+  }
+  std::ranges::sort(out, {}, &Credential::player);
+  return out;
+}
+
+auto Accounts::save(const std::filesystem::path &path) const
+    -> std::expected<void, AccountError> {
+  std::string out(kMagic.begin(), kMagic.end());
+  varint::append(out, tokens_.size());
+  PlayerId prev = 0;
+  for (const auto &c : credentials()) {
+    varint::append(out, c.player - prev);
+    prev = c.player;
+    char token[sizeof(c.token)];
+    std::memcpy(token, &c.token, sizeof(token));
+    out.append(token, sizeof(token));
+  }
+
+  // tokens are as good as a password
+  if (!replace_file::write(path, out, 0600)) {
+    return std::unexpected(AccountError::io);
+  }
+  return {};
+}
+
+auto Accounts::load(const std::filesystem::path &path)
+    -> std::expected<Accounts, AccountError> {
+  std::ifstream f(path, std::ios::binary);
+  if (!f) {
+    return std::unexpected(AccountError::io);
+  }
+  const std::string data((std::istreambuf_iterator<char>(f)),
+                         std::istreambuf_iterator<char>());
+  std::string_view in(data);
+  if (!in.starts_with(std::string_view(kMagic.data(), kMagic.size()))) {
+    return std::unexpected(AccountError::bad_format);
+  }
+  in.remove_prefix(kMagic.size());
+
+  const auto count = varint::read(in);
+  if (!count) {
+    return std::unexpected(AccountError::bad_format);
+  }
+  Accounts accounts;
+  PlayerId id = 0;
+  for (uint64_t i = 0; i < *count; ++i) {
+    const auto gap = varint::read(in);
+    // ids are strictly increasing from 1
+    if (!gap || *gap == 0 || *gap >= kMaxSavedId - id ||
+        in.size() < sizeof(uint64_t)) {
+      return std::unexpected(AccountError::bad_format);
+    }
+    id += *gap;
+    uint64_t token = 0;
+    std::memcpy(&token, in.data(), sizeof(token));
+    in.remove_prefix(sizeof(token));
+    accounts.add({id, token});
+  }
+  if (!in.empty()) {
+    return std::unexpected(AccountError::bad_format);
+  }
+  return accounts;
+}
+
+} // namespace poker
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "player.h"
+
+namespace poker {
+
+// Proof of a player id: the id and the secret the server sent with it.
+struct Credential {
+  PlayerId player;
+  uint64_t token;
+};
+
+enum class AccountError : uint8_t { io, bad_format };
+
+auto to_string(AccountError e) -> std::string_view;
+
+// The player ids that belong to somebody. A connection is issued one on
+// connect and may come back as it later with the token, so a player's
+// stats and seats outlive the connection. House bots never hold one.
+class Accounts {
+public:
+  void add(Credential c);
+  void erase(PlayerId id);
+  bool contains(PlayerId id) const;
+  bool verify(const Credential &c) const;
+  std::size_t size() const;
+  // one past the largest id ever added
+  PlayerId id_bound() const;
+  auto credentials() const -> std::vector<Credential>;
+
+  // As varint id gaps and fixed tokens, through a temporary file so a
+  // crash never leaves a torn snapshot. Only the owner may read it.
+  auto save(const std::filesystem::path &path) const
+      -> std::expected<void, AccountError>;
+  static auto load(const std::filesystem::path &path)
+      -> std::expected<Accounts, AccountError>;
+
+private:
+  std::unordered_map<PlayerId, uint64_t> tokens_;
+  PlayerId bound_{0};
+};
+
+} // namespace poker
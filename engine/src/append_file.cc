@@ -0,0 +1,73 @@
+#include "append_file.h"
+
+#include <spdlog/spdlog.h>
+#include <utility>
+
+namespace append_file {
+
+auto Writer::open(const std::filesystem::path &path, std::string_view header,
+                  std::string what) -> std::unique_ptr<Writer> {
+  std::FILE *file = std::fopen(path.c_str(), "wb");
+  if (!file) {
+    return nullptr;
+  }
+  if (std::fwrite(header.data(), 1, header.size(), file) != header.size()) {
+    std::fclose(file);
+    return nullptr;
+  }
+  return std::unique_ptr<Writer>(new Writer(file, std::move(what)));
+}
+
+Writer::Writer(std::FILE *file, std::string what)
+    : file_(file), what_(std::move(what)), worker_([this] { run(); }) {}
+
+Writer::~Writer() {
+  flush();
+  {
+    std::lock_guard lock(mu_);
+    stop_ = true;
+  }
+  cv_.notify_one();
+  worker_.join();
+  std::fclose(file_);
+}
+
+auto Writer::buffer() -> std::string & { return buf_; }
+
+void Writer::flush() {
+  if (buf_.empty()) {
+    return;
+  }
+  {
+    std::lock_guard lock(mu_);
+    queue_.push_back(std::exchange(buf_, {}));
+  }
+  cv_.notify_one();
+}
+
+void Writer::flush_if_full() {
+  if (buf_.size() >= kFlushBytes) {
+    flush();
+  }
+}
+
+void Writer::run() {
+  for (;;) {
+    std::string batch;
+    {
+      std::unique_lock lock(mu_);
+      cv_.wait(lock, [&] { return stop_ || !queue_.empty(); });
+      if (queue_.empty()) {
+        return;
+      }
+      batch = std::move(queue_.front());
+      queue_.pop_front();
+    }
+    if (std::fwrite(batch.data(), 1, batch.size(), file_) != batch.size() ||
+        std::fflush(file_) != 0) {
+      spdlog::warn("Failed to write {} bytes of {}", batch.size(), what_);
+    }
+  }
+}
+
+} // namespace append_file
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdio>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+// A file written by a background thread. The owner encodes into buffer() on
+// its own thread and hands whole buffers over with flush(), so the reactor
+// never blocks on the disk and only takes a lock once per buffer. Behind
+// the traffic capture and the hand log.
+namespace append_file {
+
+// how much a buffer holds before flush_if_full hands it over
+inline constexpr std::size_t kFlushBytes = 64 * 1024;
+
+class Writer {
+public:
+  // Creates `path` starting with `header`; nullptr if that fails. `what`
+  // names the file in warnings.
+  static auto open(const std::filesystem::path &path, std::string_view header,
+                   std::string what) -> std::unique_ptr<Writer>;
+
+  Writer(const Writer &) = delete;
+  Writer &operator=(const Writer &) = delete;
+  // writes everything appended so far, then closes the file
+  ~Writer();
+
+  // only ever touched on the owner's thread
+  auto buffer() -> std::string &;
+  // hands the buffer to the writer thread
+  void flush();
+  void flush_if_full();
+
+private:
+  Writer(std::FILE *file, std::string what);
+  void run();
+
+  std::FILE *file_;
+  std::string what_;
+  std::string buf_;
+  std::mutex mu_;
+  std::condition_variable cv_;
+  std::deque<std::string> queue_;
+  bool stop_{false};
+  std::thread worker_;
+};
+
+} // namespace append_file
@@ -0,0 +1,134 @@
+#include "capture.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <utility>
+
+#include "varint.h"
+
+namespace capture {
+
+namespace {
+
+// bounds what a crash loses when traffic is light
+constexpr std::chrono::seconds kFlushInterval{1};
+
+bool has_payload(Kind kind) {
+  return kind == Kind::inbound || kind == Kind::outbound;
+}
+
+} // namespace
+
+auto to_string(CaptureError e) -> std::string_view {
+  switch (e) {
+  case CaptureError::io:
+    return "io";
+  case CaptureError::bad_format:
+    return "bad_format";
+  }
+  return "unknown";
+}
+
+void encode(const Record &rec, std::chrono::microseconds prev,
+            std::string &out) {
+  out.push_back(static_cast<char>(rec.kind));
+  varint::append(out, static_cast<uint64_t>((rec.at - prev).count()));
+  varint::append(out, rec.conn);
+  if (has_payload(rec.kind)) {
+    varint::append(out, rec.payload.size());
+    out += rec.payload;
+  }
+}
+
+auto Writer::open(const std::filesystem::path &path)
+    -> std::expected<std::unique_ptr<Writer>, CaptureError> {
+  auto file = append_file::Writer::open(path, kMagic, "traffic capture");
+  if (!file) {
+    return std::unexpected(CaptureError::io);
+  }
+  return std::unique_ptr<Writer>(new Writer(std::move(file)));
+}
+
+Writer::Writer(std::unique_ptr<append_file::Writer> file)
+    : file_(std::move(file)) {}
+
+void Writer::record(Kind kind, Clock::time_point now, uint64_t conn,
+                    std::string_view payload) {
+  if (!start_) {
+    start_ = now;
+    last_flush_ = now;
+  }
+  // records are appended in call order, so keep `at` monotonic even if a
+  // caller's clock reading is slightly stale
+  const auto at = std::max(
+      last_,
+      std::chrono::duration_cast<std::chrono::microseconds>(now - *start_));
+  encode({kind, at, conn, payload}, last_, file_->buffer());
+  last_ = at;
+  if (now - last_flush_ >= kFlushInterval) {
+    last_flush_ = now;
+    flush();
+  } else {
+    file_->flush_if_full();
+  }
+}
+
+void Writer::flush() { file_->flush(); }
+
+auto Reader::open(const std::filesystem::path &path)
+    -> std::expected<Reader, CaptureError> {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    return std::unexpected(CaptureError::io);
+  }
+  std::string bytes{std::istreambuf_iterator<char>(in),
+                    std::istreambuf_iterator<char>()};
+  if (in.bad()) {
+    return std::unexpected(CaptureError::io);
+  }
+  return parse(std::move(bytes));
+}
+
+auto Reader::parse(std::string bytes) -> std::expected<Reader, CaptureError> {
+  if (!bytes.starts_with(kMagic)) {
+    return std::unexpected(CaptureError::bad_format);
+  }
+  return Reader(std::move(bytes));
+}
+
+Reader::Reader(std::string bytes)
+    : bytes_(std::move(bytes)), off_(kMagic.size()) {}
+
+auto Reader::next() -> std::optional<Record> {
+  if (off_ >= bytes_.size()) {
+    return std::nullopt;
+  }
+  auto in = std::string_view(bytes_).substr(off_);
+  const auto kind = static_cast<Kind>(in.front());
+  in.remove_prefix(1);
+  const auto delta = varint::read(in);
+  const auto conn = varint::read(in);
+  if (static_cast<uint8_t>(kind) > static_cast<uint8_t>(Kind::close) ||
+      !delta || !conn) {
+    truncated_ = true;
+    return std::nullopt;
+  }
+  std::string_view payload;
+  if (has_payload(kind)) {
+    const auto len = varint::read(in);
+    if (!len || *len > in.size()) {
+      truncated_ = true;
+      return std::nullopt;
+    }
+    payload = in.substr(0, *len);
+    in.remove_prefix(*len);
+  }
+  off_ = bytes_.size() - in.size();
+  at_ += std::chrono::microseconds(*delta);
+  return Record{kind, at_, *conn, payload};
+}
+
+bool Reader::truncated() const { return truncated_; }
+
+} // namespace capture
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "append_file.h"
+
+// Traffic capture for replaying production workloads against new builds.
+// A capture file is a magic header followed by records of
+//
+//   kind (1 byte) | delta_us (varint) | conn (varint) | [len (varint) | bytes]
+//
+// where delta_us is the time since the previous record and conn the
+// player id the server gave the connection. Inbound records hold one frame
+// payload (a serialized Action); outbound records hold the serialized
+// Responses queued for one connection by one push, so a reader can compare
+// broadcasts message by message regardless of how they were framed.
+namespace capture {
+
+inline constexpr std::string_view kMagic{"PKRCAP1\n"};
+
+enum class Kind : uint8_t { open, inbound, outbound, close };
+
+enum class CaptureError : uint8_t { io, bad_format };
+
+auto to_string(CaptureError e) -> std::string_view;
+
+struct Record {
+  Kind kind;
+  // since the start of the capture
+  std::chrono::microseconds at;
+  uint64_t conn;
+  std::string_view payload;
+};
+
+// Appends `rec` in the file encoding, with `at` relative to `prev`.
+void encode(const Record &rec, std::chrono::microseconds prev,
+            std::string &out);
+
+// Encodes on the caller's thread and leaves the disk to an
+// append_file::Writer. Everything recorded is written by destruction.
+class Writer {
+public:
+  static auto open(const std::filesystem::path &path)
+      -> std::expected<std::unique_ptr<Writer>, CaptureError>;
+
+  using Clock = std::chrono::steady_clock;
+
+  void record(Kind kind, Clock::time_point now, uint64_t conn,
+              std::string_view payload = {});
+  // hands the current buffer to the writer thread
+  void flush();
+
+private:
+  explicit Writer(std::unique_ptr<append_file::Writer> file);
+
+  std::unique_ptr<append_file::Writer> file_;
+  std::optional<Clock::time_point> start_;
+  std::chrono::microseconds last_{0};
+  Clock::time_point last_flush_{};
+};
+
+// Walks a capture file loaded into memory.
+class Reader {
+public:
+  static auto open(const std::filesystem::path &path)
+      -> std::expected<Reader, CaptureError>;
+  // `bytes` is a whole file, header included
+  static auto parse(std::string bytes) -> std::expected<Reader, CaptureError>;
+
+  // std::nullopt at the end; a truncated tail reads as the end and sets
+  // truncated()
+  auto next() -> std::optional<Record>;
+  bool truncated() const;
+
+private:
+  explicit Reader(std::string bytes);
+
+  std::string bytes_;
+  std::size_t off_;
+  std::chrono::microseconds at_{0};
+  bool truncated_{false};
+};
+
+} // namespace capture
@@ -0,0 +1,523 @@
+#include "column_store.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <map>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <utility>
+
+#include <spdlog/spdlog.h>
+
+#include "replace_file.h"
+
+namespace hhstore {
+namespace {
+
+constexpr std::array<char, 4> kMagic{'H', 'H', 'C', '1'};
+constexpr uint32_t kVersion = 2; // 2: aggressive/passive columns
+constexpr uint64_t kHourMs = 3'600'000;
+
+struct FileHeader {
+  std::array<char, 4> magic;
+  uint32_t version;
+  uint64_t rows;
+  uint64_t blocks;
+  uint64_t min_started_ms;
+  uint64_t max_started_ms;
+  std::array<uint64_t, kColumns> column_offset; // to the BlockHeader array
+};
+
+struct BlockHeader {
+  uint64_t base;
+  uint64_t words_offset; // from the start of the file
+  uint32_t width;        // bits per value, 0..64
+  uint32_t count;
+};
+
+static_assert(std::is_trivially_copyable_v<FileHeader>);
+static_assert(std::is_trivially_copyable_v<BlockHeader>);
+
+auto column_value(const poker::HandRow &r, std::size_t col) -> uint64_t {
+  switch (static_cast<Column>(col)) {
+  case Column::hand_id:
+    return r.hand_id;
+  case Column::started_ms:
+    return r.started_ms;
+  case Column::table:
+    return r.table;
+  case Column::player:
+    return r.player;
+  case Column::invested:
+    return r.invested;
+  case Column::won:
+    return r.won;
+  case Column::flags:
+    return r.flags;
+  case Column::aggressive:
+    return r.aggressive;
+  case Column::passive:
+  default:
+    return r.passive;
+  }
+}
+
+auto word_count(std::size_t count, uint32_t width) -> std::size_t {
+  return (count * width + 63) / 64;
+}
+
+auto value_mask(uint32_t width) -> uint64_t {
+  return width == 64 ? ~uint64_t{0} : (uint64_t{1} << width) - 1;
+}
+
+template <typename T>
+void append_bytes(std::vector<std::byte> &buf, const T &v) {
+  const auto *p = reinterpret_cast<const std::byte *>(&v);
+  buf.insert(buf.end(), p, p + sizeof(T));
+}
+
+auto hour_dir(uint64_t started_ms) -> std::string {
+  const auto secs = static_cast<std::time_t>(started_ms / 1000);
+  std::tm tm{};
+  gmtime_r(&secs, &tm);
+  std::array<char, 32> name{};
+  std::strftime(name.data(), name.size(), "%Y-%m-%dT%H", &tm);
+  return name.data();
+}
+
+auto parse_hour_dir(const std::string &name) -> std::optional<uint64_t> {
+  std::tm tm{};
+  char tail = 0;
+  if (std::sscanf(name.c_str(), "%4d-%2d-%2dT%2d%c", &tm.tm_year, &tm.tm_mon,
+                  &tm.tm_mday, &tm.tm_hour, &tail) != 4) {
+    return std::nullopt;
+  }
+  tm.tm_year -= 1900;
+  tm.tm_mon -= 1;
+  const auto secs = timegm(&tm);
+  if (secs < 0) {
+    return std::nullopt;
+  }
+  return static_cast<uint64_t>(secs) * 1000;
+}
+
+struct Totals {
+  uint64_t hands;
+  int64_t net;
+};
+
+// Ids below this are counted in a flat array, the rest in a map, so a part
+// file with a huge id in it costs one map entry rather than the array.
+constexpr uint64_t kDenseIds = uint64_t{1} << 20;
+
+struct Accumulator {
+  std::vector<Totals> dense;
+  std::unordered_map<uint64_t, Totals> sparse;
+
+  auto at(uint64_t player) -> Totals & {
+    if (player < kDenseIds) {
+      return dense[player];
+    }
+    return sparse.try_emplace(player, Totals{0, 0}).first->second;
+  }
+};
+
+} // namespace
+
+auto to_string(StoreError e) -> std::string_view {
+  switch (e) {
+  case StoreError::io:
+    return "io";
+  case StoreError::bad_format:
+  default:
+    return "bad_format";
+  }
+}
+
+auto write_part(const std::filesystem::path &path,
+                std::span<const poker::HandRow> rows)
+    -> std::expected<void, StoreError> {
+  const std::size_t blocks = (rows.size() + kBlockRows - 1) / kBlockRows;
+  FileHeader header{kMagic, kVersion, rows.size(), blocks, UINT64_MAX, 0, {}};
+  for (const auto &r : rows) {
+    header.min_started_ms = std::min(header.min_started_ms, r.started_ms);
+    header.max_started_ms = std::max(header.max_started_ms, r.started_ms);
+  }
+  if (rows.empty()) {
+    header.min_started_ms = 0;
+  }
+
+  std::vector<std::byte> buf(sizeof(FileHeader));
+  std::array<uint64_t, kBlockRows> values{};
+  std::vector<uint64_t> words;
+  for (std::size_t col = 0; col < kColumns; ++col) {
+    header.column_offset[col] = buf.size();
+    const std::size_t headers_at = buf.size();
+    buf.resize(buf.size() + blocks * sizeof(BlockHeader));
+    for (std::size_t b = 0; b < blocks; ++b) {
+      const auto first = b * kBlockRows;
+      const auto count = std::min(kBlockRows, rows.size() - first);
+      for (std::size_t i = 0; i < count; ++i) {
+        values[i] = column_value(rows[first + i], col);
+      }
+      const auto [lo, hi] =
+          std::minmax_element(values.begin(), values.begin() + count);
+      const auto width = static_cast<uint32_t>(std::bit_width(*hi - *lo));
+      words.assign(word_count(count, width), 0);
+      for (std::size_t i = 0; width != 0 && i < count; ++i) {
+        const uint64_t v = values[i] - *lo;
+        const std::size_t bit = i * width;
+        const std::size_t off = bit % 64;
+        words[bit / 64] |= v << off;
+        if (off + width > 64) {
+          words[bit / 64 + 1] |= v >> (64 - off);
+        }
+      }
+      const BlockHeader bh{*lo, buf.size(), width,
+                           static_cast<uint32_t>(count)};
+      std::memcpy(buf.data() + headers_at + b * sizeof(BlockHeader), &bh,
+                  sizeof(bh));
+      for (const auto w : words) {
+        append_bytes(buf, w);
+      }
+    }
+  }
+  std::memcpy(buf.data(), &header, sizeof(header));
+
+  // readers only ever see complete parts
+  const std::string_view bytes(reinterpret_cast<const char *>(buf.data()),
+                               buf.size());
+  if (!replace_file::write(path, bytes)) {
+    return std::unexpected(StoreError::io);
+  }
+  return {};
+}
+
+PartFile::PartFile(const std::byte *base, std::size_t size)
+    : base_(base), size_(size) {}
+
+PartFile::PartFile(PartFile &&other) noexcept
+    : base_(std::exchange(other.base_, nullptr)),
+      size_(std::exchange(other.size_, 0)) {}
+
+PartFile &PartFile::operator=(PartFile &&other) noexcept {
+  if (this != &other) {
+    if (base_ != nullptr) {
+      munmap(const_cast<std::byte *>(base_), size_);
+    }
+    base_ = std::exchange(other.base_, nullptr);
+    size_ = std::exchange(other.size_, 0);
+  }
+  return *this;
+}
+
+PartFile::~PartFile() {
+  if (base_ != nullptr) {
+    munmap(const_cast<std::byte *>(base_), size_);
+  }
+}
+
+auto PartFile::open(const std::filesystem::path &path)
+    -> std::expected<PartFile, StoreError> {
+  const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return std::unexpected(StoreError::io);
+  }
+  struct stat st{};
+  if (fstat(fd, &st) != 0) {
+    ::close(fd);
+    return std::unexpected(StoreError::io);
+  }
+  const auto size = static_cast<std::size_t>(st.st_size);
+  if (size < sizeof(FileHeader)) {
+    ::close(fd);
+    return std::unexpected(StoreError::bad_format);
+  }
+  void *map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (map == MAP_FAILED) {
+    return std::unexpected(StoreError::io);
+  }
+  PartFile part(static_cast<const std::byte *>(map), size);
+
+  // validate everything up front so decode() can trust the offsets
+  FileHeader h;
+  std::memcpy(&h, part.base_, sizeof(h));
+  if (h.magic != kMagic || h.version != kVersion ||
+      h.blocks != (h.rows + kBlockRows - 1) / kBlockRows) {
+    return std::unexpected(StoreError::bad_format);
+  }
+  for (const auto off : h.column_offset) {
+    if (off % alignof(BlockHeader) != 0 ||
+        off > size || (size - off) / sizeof(BlockHeader) < h.blocks) {
+      return std::unexpected(StoreError::bad_format);
+    }
+    for (std::size_t b = 0; b < h.blocks; ++b) {
+      BlockHeader bh;
+      std::memcpy(&bh, part.base_ + off + b * sizeof(BlockHeader),
+                  sizeof(bh));
+      const auto expected_count =
+          std::min<uint64_t>(kBlockRows, h.rows - b * kBlockRows);
+      const auto bytes = word_count(bh.count, bh.width) * sizeof(uint64_t);
+      if (bh.width > 64 || bh.count != expected_count ||
+          bh.words_offset % alignof(uint64_t) != 0 ||
+          bh.words_offset > size || size - bh.words_offset < bytes) {
+        return std::unexpected(StoreError::bad_format);
+      }
+    }
+  }
+  madvise(const_cast<std::byte *>(part.base_), size, MADV_SEQUENTIAL);
+  return part;
+}
+
+uint64_t PartFile::rows() const {
+  return reinterpret_cast<const FileHeader *>(base_)->rows;
+}
+
+std::size_t PartFile::blocks() const {
+  return reinterpret_cast<const FileHeader *>(base_)->blocks;
+}
+
+uint64_t PartFile::min_started_ms() const {
+  return reinterpret_cast<const FileHeader *>(base_)->min_started_ms;
+}
+
+uint64_t PartFile::max_started_ms() const {
+  return reinterpret_cast<const FileHeader *>(base_)->max_started_ms;
+}
+
+std::size_t PartFile::decode(Column col, std::size_t block,
+                             std::span<uint64_t, kBlockRows> out) const {
+  const auto *h = reinterpret_cast<const FileHeader *>(base_);
+  const auto offset = h->column_offset[static_cast<std::size_t>(col)];
+  const auto *bh =
+      reinterpret_cast<const BlockHeader *>(base_ + offset) + block;
+  const auto *words =
+      reinterpret_cast<const uint64_t *>(base_ + bh->words_offset);
+  const uint32_t width = bh->width;
+  const uint64_t base = bh->base;
+  const std::size_t count = bh->count;
+  if (width == 0) {
+    std::fill_n(out.begin(), count, base);
+    return count;
+  }
+  const uint64_t mask = value_mask(width);
+  for (std::size_t i = 0; i < count; ++i) {
+    const std::size_t bit = i * width;
+    const std::size_t w = bit / 64;
+    const std::size_t off = bit % 64;
+    uint64_t v = words[w] >> off;
+    // the spill word is only read when the value straddles it
+    if (off + width > 64) {
+      v |= words[w + 1] << (64 - off);
+    }
+    out[i] = base + (v & mask);
+  }
+  return count;
+}
+
+auto list_parts(const std::filesystem::path &root, uint64_t from_ms,
+                uint64_t to_ms) -> std::vector<std::filesystem::path> {
+  std::vector<std::filesystem::path> out;
+  std::error_code ec;
+  for (const auto &dir : std::filesystem::directory_iterator(root, ec)) {
+    if (!dir.is_directory()) {
+      continue;
+    }
+    const auto hour = parse_hour_dir(dir.path().filename().string());
+    if (!hour || *hour > to_ms || *hour + kHourMs <= from_ms) {
+      continue;
+    }
+    for (const auto &f : std::filesystem::directory_iterator(dir, ec)) {
+      if (f.is_regular_file() && f.path().extension() == ".hhc") {
+        out.push_back(f.path());
+      }
+    }
+  }
+  std::sort(out.begin(), out.end());
+  return out;
+}
+
+auto player_results(std::span<const std::filesystem::path> paths,
+                    uint8_t require_flags, unsigned threads)
+    -> std::expected<std::vector<PlayerResult>, StoreError> {
+  std::vector<PartFile> parts;
+  std::vector<std::pair<uint32_t, uint32_t>> work; // (part, block)
+  for (const auto &p : paths) {
+    auto part = PartFile::open(p);
+    if (!part) {
+      return std::unexpected(part.error());
+    }
+    for (std::size_t b = 0; b < part->blocks(); ++b) {
+      work.emplace_back(static_cast<uint32_t>(parts.size()),
+                        static_cast<uint32_t>(b));
+    }
+    parts.push_back(std::move(*part));
+  }
+  if (threads == 0) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  threads = std::min<unsigned>(
+      threads, static_cast<unsigned>(std::max<std::size_t>(work.size(), 1)));
+
+  // player ids are handed out sequentially, so a flat array per worker beats
+  // a hash map; the workers merge once at the end
+  std::vector<Accumulator> totals(threads);
+  std::atomic<std::size_t> next{0};
+  auto scan = [&](Accumulator &acc) {
+    std::array<uint64_t, kBlockRows> player{};
+    std::array<uint64_t, kBlockRows> invested{};
+    std::array<uint64_t, kBlockRows> won{};
+    std::array<uint64_t, kBlockRows> flags{};
+    for (auto i = next.fetch_add(1, std::memory_order_relaxed);
+         i < work.size(); i = next.fetch_add(1, std::memory_order_relaxed)) {
+      const auto &part = parts[work[i].first];
+      const auto block = work[i].second;
+      const auto n = part.decode(Column::player, block, player);
+      part.decode(Column::invested, block, invested);
+      part.decode(Column::won, block, won);
+      if (require_flags != 0) {
+        part.decode(Column::flags, block, flags);
+      } else {
+        std::fill_n(flags.begin(), n, 0);
+      }
+      const auto top = *std::max_element(player.begin(), player.begin() + n);
+      if (top >= acc.dense.size()) {
+        acc.dense.resize(std::min(top + 1, kDenseIds), Totals{0, 0});
+      }
+      for (std::size_t r = 0; r < n; ++r) {
+        const uint64_t keep = (flags[r] & require_flags) == require_flags;
+        auto &t = acc.at(player[r]);
+        t.hands += keep;
+        t.net += static_cast<int64_t>(keep) *
+                 (static_cast<int64_t>(won[r]) -
+                  static_cast<int64_t>(invested[r]));
+      }
+    }
+  };
+  std::vector<std::jthread> workers;
+  for (unsigned t = 1; t < threads; ++t) {
+    workers.emplace_back([&, t] { scan(totals[t]); });
+  }
+  scan(totals[0]);
+  workers.clear();
+
+  std::size_t width = 0;
+  for (const auto &t : totals) {
+    width = std::max(width, t.dense.size());
+  }
+  std::vector<Totals> merged(width, Totals{0, 0});
+  std::map<uint64_t, Totals> sparse;
+  for (const auto &t : totals) {
+    for (std::size_t p = 0; p < t.dense.size(); ++p) {
+      merged[p].hands += t.dense[p].hands;
+      merged[p].net += t.dense[p].net;
+    }
+    for (const auto &[p, v] : t.sparse) {
+      auto &m = sparse.try_emplace(p, Totals{0, 0}).first->second;
+      m.hands += v.hands;
+      m.net += v.net;
+    }
+  }
+  std::vector<PlayerResult> out;
+  for (std::size_t p = 0; p < merged.size(); ++p) {
+    if (merged[p].hands != 0) {
+      out.push_back(PlayerResult{p, merged[p].hands, merged[p].net});
+    }
+  }
+  for (const auto &[p, m] : sparse) {
+    if (m.hands != 0) {
+      out.push_back(PlayerResult{p, m.hands, m.net});
+    }
+  }
+  return out;
+}
+
+Writer::Writer(std::filesystem::path root, std::size_t rows_per_part)
+    : root_(std::move(root)), rows_per_part_(rows_per_part),
+      worker_([this] { run(); }) {}
+
+Writer::~Writer() {
+  flush();
+  {
+    std::lock_guard lock(mu_);
+    stop_ = true;
+  }
+  cv_.notify_one();
+  worker_.join();
+}
+
+void Writer::append(std::span<const poker::HandRow> rows) {
+  pending_.insert(pending_.end(), rows.begin(), rows.end());
+  if (pending_.size() >= rows_per_part_) {
+    flush();
+  }
+}
+
+void Writer::flush() {
+  if (pending_.empty()) {
+    return;
+  }
+  {
+    std::lock_guard lock(mu_);
+    queue_.push_back(std::exchange(pending_, {}));
+  }
+  cv_.notify_one();
+}
+
+void Writer::run() {
+  for (;;) {
+    std::vector<poker::HandRow> batch;
+    {
+      std::unique_lock lock(mu_);
+      cv_.wait(lock, [&] { return stop_ || !queue_.empty(); });
+      if (queue_.empty()) {
+        return;
+      }
+      batch = std::move(queue_.front());
+      queue_.pop_front();
+    }
+    write_batch(batch);
+  }
+}
+
+// One part per hour the batch touches; rows arrive in finish order, which is
+// close to but not exactly start order.
+void Writer::write_batch(std::vector<poker::HandRow> &batch) {
+  std::stable_sort(batch.begin(), batch.end(),
+                   [](const poker::HandRow &a, const poker::HandRow &b) {
+                     return a.started_ms / kHourMs < b.started_ms / kHourMs;
+                   });
+  const auto stamp = std::chrono::duration_cast<std::chrono::milliseconds>(
+                         std::chrono::system_clock::now().time_since_epoch())
+                         .count();
+  auto first = batch.begin();
+  while (first != batch.end()) {
+    const auto hour = first->started_ms / kHourMs;
+    auto last = std::find_if(first, batch.end(), [&](const auto &r) {
+      return r.started_ms / kHourMs != hour;
+    });
+    const auto dir = root_ / hour_dir(first->started_ms);
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+    std::string name = "part-";
+    name += std::to_string(stamp) + "-" + std::to_string(getpid()) + "-" +
+            std::to_string(next_part_++) + ".hhc";
+    auto res = write_part(dir / name, {first, last});
+    if (!res) {
+      spdlog::warn("Failed to write hand history part {}: {}",
+                   (dir / name).string(), to_string(res.error()));
+    }
+    first = last;
+  }
+}
+
+} // namespace hhstore
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <expected>
+#include <filesystem>
+#include <mutex>
+#include <span>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "hand_history.h"
+
+// Columnar storage for HandRows. A part file holds every column of a batch
+// of rows; each column is cut into blocks of kBlockRows values stored as
+// frame-of-reference + bit-packed words, so a scan only touches the columns
+// it asks for and decodes them with a tight, branch-free loop. Part files
+// live in one directory per UTC hour (`<root>/2026-10-17T13/`) so time range
+// queries prune whole directories.
+namespace hhstore {
+
+inline constexpr std::size_t kBlockRows = 1024;
+
+enum class Column : uint8_t {
+  hand_id,
+  started_ms,
+  table,
+  player,
+  invested,
+  won,
+  flags,
+  aggressive,
+  passive,
+};
+inline constexpr std::size_t kColumns = 9;
+
+enum class StoreError : uint8_t { io, bad_format };
+
+auto to_string(StoreError e) -> std::string_view;
+
+// Writes `rows` as a single part file. Rows are stored in the given order.
+auto write_part(const std::filesystem::path &path,
+                std::span<const poker::HandRow> rows)
+    -> std::expected<void, StoreError>;
+
+// Read-only view of a memory-mapped part file.
+class PartFile {
+public:
+  static auto open(const std::filesystem::path &path)
+      -> std::expected<PartFile, StoreError>;
+
+  PartFile(PartFile &&other) noexcept;
+  PartFile &operator=(PartFile &&other) noexcept;
+  PartFile(const PartFile &) = delete;
+  PartFile &operator=(const PartFile &) = delete;
+  ~PartFile();
+
+  uint64_t rows() const;
+  std::size_t blocks() const;
+  uint64_t min_started_ms() const;
+  uint64_t max_started_ms() const;
+  // Decodes block `block` of `col` into `out` and returns its row count.
+  std::size_t decode(Column col, std::size_t block,
+                     std::span<uint64_t, kBlockRows> out) const;
+
+private:
+  PartFile(const std::byte *base, std::size_t size);
+
+  const std::byte *base_{nullptr};
+  std::size_t size_{0};
+};
+
+// Part files under `root` whose hour directory overlaps [from_ms, to_ms].
+auto list_parts(const std::filesystem::path &root, uint64_t from_ms = 0,
+                uint64_t to_ms = UINT64_MAX)
+    -> std::vector<std::filesystem::path>;
+
+struct PlayerResult {
+  poker::PlayerId player;
+  uint64_t hands;
+  int64_t net; // chips won minus chips invested
+};
+
+// Reference query: per-player hand count and net result over rows whose
+// flags contain `require_flags`, scanned with `threads` workers. Sorted by
+// player id.
+auto player_results(std::span<const std::filesystem::path> parts,
+                    uint8_t require_flags = 0, unsigned threads = 0)
+    -> std::expected<std::vector<PlayerResult>, StoreError>;
+
+// Export side: buffers rows from a HandRecorder and writes a part per hour
+// every `rows_per_part` rows on a background thread, keeping encoding and
+// disk writes off the reactor.
+class Writer {
+public:
+  explicit Writer(std::filesystem::path root,
+                  std::size_t rows_per_part = 64 * kBlockRows);
+  Writer(const Writer &) = delete;
+  Writer &operator=(const Writer &) = delete;
+  // flushes whatever is buffered and waits for the writes to land
+  ~Writer();
+
+  void append(std::span<const poker::HandRow> rows);
+  void flush();
+
+private:
+  void run();
+  void write_batch(std::vector<poker::HandRow> &batch);
+
+  std::filesystem::path root_;
+  std::size_t rows_per_part_;
+  std::vector<poker::HandRow> pending_;
+  uint64_t next_part_{0};
+
+  std::mutex mu_;
+  std::condition_variable cv_;
+  std::deque<std::vector<poker::HandRow>> queue_;
+  bool stop_{false};
+  std::thread worker_;
+};
+
+} // namespace hhstore
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// A counter cheap enough to read around every handler call: the TSC on x86,
+// the steady clock's ticks elsewhere. Only differences mean anything, and
+// only relative to each other.
+namespace cycles {
+
+inline uint64_t now() {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return static_cast<uint64_t>(
+      std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+// Adds the cycles between construction and destruction to `total`.
+class Meter {
+public:
+  explicit Meter(uint64_t &total) : total_(total), start_(now()) {}
+  ~Meter() { total_ += now() - start_; }
+  Meter(const Meter &) = delete;
+  Meter &operator=(const Meter &) = delete;
+
+private:
+  uint64_t &total_;
+  uint64_t start_;
+};
+
+} // namespace cycles
@@ -6,6 +6,7 @@
 #include <iterator>
 #include <numeric>
 #include <string>
+#include <utility>
 
 #include "cards.h"
 #include "poker_rules.h"
@@ -20,6 +21,13 @@ inline constexpr std::array<Card, kDeckSize> kCardIdMap = [] {
   return out;
 }();
 
+constexpr auto to_card_id(Card c) -> CardId {
+  return static_cast<CardId>(std::to_underlying(c.suit) * 13 +
+                             std::to_underlying(c.rank));
+}
+
+constexpr auto from_card_id(CardId id) -> Card { return kCardIdMap[id]; }
+
 class Deck {
 public:
   Deck() = default;
@@ -0,0 +1,84 @@
+#include "delay_line.h"
+
+#include <cstring>
+
+namespace broadcast {
+namespace {
+
+constexpr std::size_t kAlign = alignof(int64_t);
+
+auto padded(std::size_t n) -> std::size_t {
+  return (n + kAlign - 1) / kAlign * kAlign;
+}
+
+} // namespace
+
+DelayLine::DelayLine(std::size_t capacity) : ring_(padded(capacity)) {}
+
+void DelayLine::push(Clock::time_point due, std::string_view frame) {
+  const auto need = padded(sizeof(Record) + frame.size());
+  if (need > ring_.size()) {
+    ++dropped_;
+    return;
+  }
+  while (true) {
+    if (count_ == 0) {
+      head_ = tail_ = end_ = 0;
+    }
+    const bool wrapped = count_ != 0 && tail_ <= head_;
+    if (!wrapped) {
+      if (ring_.size() - tail_ >= need) {
+        write(tail_, due, frame);
+        end_ = tail_;
+        return;
+      }
+      if (head_ >= need) { // start over at the front, leaving a gap
+        end_ = tail_;
+        tail_ = 0;
+        write(tail_, due, frame);
+        return;
+      }
+    } else if (head_ - tail_ >= need) {
+      write(tail_, due, frame);
+      return;
+    }
+    pop();
+    ++dropped_;
+  }
+}
+
+auto DelayLine::next_due() const -> std::optional<Clock::time_point> {
+  if (count_ == 0) {
+    return std::nullopt;
+  }
+  return peek().due;
+}
+
+auto DelayLine::peek() const -> Front {
+  Record r;
+  std::memcpy(&r, ring_.data() + head_, sizeof(r));
+  return {Clock::time_point(Clock::duration(r.due)),
+          std::string_view(ring_.data() + head_ + sizeof(r), r.size)};
+}
+
+void DelayLine::pop() {
+  Record r;
+  std::memcpy(&r, ring_.data() + head_, sizeof(r));
+  head_ += padded(sizeof(r) + r.size);
+  --count_;
+  if (count_ != 0 && head_ == end_) {
+    head_ = 0;
+  }
+}
+
+void DelayLine::write(std::size_t at, Clock::time_point due,
+                      std::string_view frame) {
+  const Record r{due.time_since_epoch().count(),
+                 static_cast<uint32_t>(frame.size())};
+  std::memcpy(ring_.data() + at, &r, sizeof(r));
+  std::memcpy(ring_.data() + at + sizeof(r), frame.data(), frame.size());
+  tail_ = at + padded(sizeof(r) + frame.size());
+  ++count_;
+}
+
+} // namespace broadcast
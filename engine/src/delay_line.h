@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include "io.h"
+
+// Delayed broadcast of a table. Frames are encoded once when the table
+// produces them and parked in a fixed-size byte ring until their release
+// time, so a delayed feed costs one copy per viewer and its memory is
+// bounded however far behind the release runs.
+namespace broadcast {
+
+using Clock = reactor::Clock;
+
+class DelayLine {
+public:
+  explicit DelayLine(std::size_t capacity);
+
+  // Copies `frame` in, to be released at `due`. Due times must not go
+  // backwards. Room is made by dropping the oldest frames; a frame bigger
+  // than the whole ring is dropped itself.
+  void push(Clock::time_point due, std::string_view frame);
+
+  // Hands every frame due by `now` to `sink`, oldest first, and forgets it.
+  // The view is only valid during the call.
+  template <typename Sink> void release(Clock::time_point now, Sink &&sink) {
+    while (count_ != 0) {
+      const auto front = peek();
+      if (front.due > now) {
+        return;
+      }
+      sink(front.frame);
+      pop();
+    }
+  }
+
+  auto next_due() const -> std::optional<Clock::time_point>;
+  std::size_t frames() const { return count_; }
+  std::size_t capacity() const { return ring_.size(); }
+  // frames pushed out unreleased to make room
+  uint64_t dropped() const { return dropped_; }
+
+private:
+  struct Record {
+    int64_t due; // Clock ticks since its epoch
+    uint32_t size;
+  };
+  struct Front {
+    Clock::time_point due;
+    std::string_view frame;
+  };
+
+  auto peek() const -> Front;
+  void pop();
+  void write(std::size_t at, Clock::time_point due, std::string_view frame);
+
+  // Records sit back to back in [head_, end_) and, once the writer has
+  // wrapped, [0, tail_); the gap past end_ is unused.
+  std::vector<char> ring_;
+  std::size_t head_{0};
+  std::size_t tail_{0};
+  std::size_t end_{0};
+  std::size_t count_{0};
+  uint64_t dropped_{0};
+};
+
+} // namespace broadcast
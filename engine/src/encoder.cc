@@ -0,0 +1,97 @@
+#include "encoder.h"
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cstring>
+
+#include "wire_writer.h"
+
+namespace encode {
+
+void encode(Batch &batch) {
+  batch.out.resize(batch.viewers.size());
+  for (std::size_t i = 0; i < batch.viewers.size(); ++i) {
+    const auto viewer = batch.viewers[i];
+    auto &out = batch.out[i];
+    out.clear();
+    if (viewer == kEveryone) {
+      out.resize(sizeof(uint32_t));
+    }
+    for (const auto &ev : batch.events) {
+      if (visible_to(ev, viewer)) {
+        wire::append_event(out, ev, batch.table);
+      }
+    }
+    if (viewer == kEveryone) {
+      const uint32_t len =
+          htonl(static_cast<uint32_t>(out.size() - sizeof(len)));
+      std::memcpy(out.data(), &len, sizeof(len));
+    }
+  }
+}
+
+Pool::Pool(unsigned workers) : slots_(kDepth) {
+  for (unsigned i = 0; i < std::max(workers, 1u); ++i) {
+    auto &w = *workers_.emplace_back(std::make_unique<Worker>());
+    w.thread = std::thread([this, &w] { run(w); });
+  }
+}
+
+Pool::~Pool() {
+  for (auto &w : workers_) {
+    while (!w->in.push(nullptr)) { // the stop signal
+      std::this_thread::yield();
+    }
+  }
+  for (auto &w : workers_) {
+    w->thread.join();
+  }
+}
+
+auto Pool::next() -> Batch & {
+  auto &batch = slots_[submitted_ % kDepth];
+  batch.events.clear();
+  batch.viewers.clear();
+  return batch;
+}
+
+void Pool::submit() {
+  auto *batch = &slots_[submitted_ % kDepth];
+  // round robin keeps each worker's share small and even; no ring can
+  // fill, as no more than kDepth batches are ever out
+  auto &w = *workers_[submitted_ % workers_.size()];
+  (void)w.in.push(batch);
+  ++submitted_;
+}
+
+void Pool::run(Worker &w) {
+  while (true) {
+    const auto batch = w.in.pop();
+    if (!batch) {
+      w.in.wait();
+      continue;
+    }
+    if (*batch == nullptr) {
+      return;
+    }
+    encode(**batch);
+    (void)w.done.push(*batch);
+  }
+}
+
+void Pool::wait_all() {
+  while (completed_ != submitted_) {
+    bool any = false;
+    for (auto &w : workers_) {
+      while (w->done.pop()) {
+        ++completed_;
+        any = true;
+      }
+    }
+    if (!any) {
+      std::this_thread::yield();
+    }
+  }
+}
+
+} // namespace encode
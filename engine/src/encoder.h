@@ -0,0 +1,132 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "table.h"
+
+// An encoding stage between the game thread and the sockets. The game
+// thread fills a Batch with a table's events and who is to get them and
+// submits it; worker threads turn it into one serialized Response per
+// recipient, and the game thread collects the results, in submission
+// order, before it writes. The two sides meet only in single-producer,
+// single-consumer rings, so neither takes a lock.
+namespace encode {
+
+// A bounded queue for exactly one producer thread and one consumer thread.
+// Neither end blocks or allocates; the consumer may sleep in wait().
+template <typename T, std::size_t N> class SpscRing {
+  static_assert(std::has_single_bit(N));
+
+public:
+  bool push(T v) {
+    const auto tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_.load(std::memory_order_acquire) == N) {
+      return false;
+    }
+    slots_[tail % N] = v;
+    tail_.store(tail + 1, std::memory_order_release);
+    tail_.notify_one();
+    return true;
+  }
+
+  auto pop() -> std::optional<T> {
+    const auto head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load(std::memory_order_acquire)) {
+      return std::nullopt;
+    }
+    T v = slots_[head % N];
+    head_.store(head + 1, std::memory_order_release);
+    return v;
+  }
+
+  // Consumer only: sleeps while the ring is empty.
+  void wait() const {
+    tail_.wait(head_.load(std::memory_order_relaxed),
+               std::memory_order_acquire);
+  }
+
+private:
+  alignas(64) std::atomic<uint32_t> head_{0};
+  alignas(64) std::atomic<uint32_t> tail_{0};
+  std::array<T, N> slots_{};
+};
+
+// Everyone sees every card: the recipient of a watchers' frame.
+inline constexpr poker::PlayerId kEveryone = 0;
+
+// Hole cards are private to the player dealt them; every other event is
+// public. The one privacy rule for both the inline and the worker paths.
+inline bool visible_to(const poker::Event &ev, poker::PlayerId viewer) {
+  if (const auto *dealt = std::get_if<poker::DealtHole>(&ev)) {
+    return viewer == kEveryone || dealt->who == viewer;
+  }
+  return true;
+}
+
+struct Batch {
+  poker::TableId table{0};
+  std::vector<poker::Event> events;
+  std::vector<poker::PlayerId> viewers;
+  // out[i] is what viewers[i] may see, as a serialized Response; for
+  // kEveryone it is a whole length-prefixed frame.
+  std::vector<std::string> out;
+};
+
+// What a worker does with a batch; also the inline path.
+void encode(Batch &batch);
+
+class Pool {
+public:
+  // At most kDepth batches are in flight at once.
+  static constexpr std::size_t kDepth = 1024;
+
+  explicit Pool(unsigned workers);
+  Pool(const Pool &) = delete;
+  Pool &operator=(const Pool &) = delete;
+  ~Pool();
+
+  // The batch to fill next, emptied but keeping its buffers. Only valid
+  // while !full().
+  auto next() -> Batch &;
+  // Hands the batch from next() to a worker.
+  void submit();
+  bool full() const { return submitted_ - drained_ == kDepth; }
+  std::size_t in_flight() const { return submitted_ - drained_; }
+
+  // Waits for every submitted batch and hands each to `sink`, in the order
+  // they were submitted.
+  template <typename Sink> void drain(Sink &&sink) {
+    wait_all();
+    for (; drained_ != submitted_; ++drained_) {
+      sink(static_cast<const Batch &>(slots_[drained_ % kDepth]));
+    }
+  }
+
+private:
+  using Ring = SpscRing<Batch *, kDepth>;
+  struct Worker {
+    Ring in;
+    Ring done;
+    std::thread thread;
+  };
+
+  void run(Worker &w);
+  void wait_all();
+
+  std::vector<Batch> slots_;
+  std::vector<std::unique_ptr<Worker>> workers_;
+  uint64_t submitted_{0};
+  uint64_t completed_{0};
+  uint64_t drained_{0};
+};
+
+} // namespace encode
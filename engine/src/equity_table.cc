@@ -0,0 +1,355 @@
+#include "equity_table.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <initializer_list>
+#include <random>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+#include "deck.h"
+#include "hand_evaluator.h"
+#include "replace_file.h"
+
+namespace poker {
+namespace {
+
+constexpr uint32_t kVersion = 1;
+constexpr std::size_t kPlayerCounts = kMaxPlayers - kMinPlayers + 1;
+
+struct FileHeader {
+  std::array<char, 8> magic;
+  uint32_t version;
+  uint32_t samples;
+};
+
+// Followed by uint16 vs_random[kPlayerCounts][169] and then
+// uint16 vs_class[169][169].
+constexpr std::size_t kRandomOffset = sizeof(FileHeader);
+constexpr std::size_t kClassOffset =
+    kRandomOffset + kPlayerCounts * kHandClasses * sizeof(uint16_t);
+constexpr std::size_t kFileSize =
+    kClassOffset + kHandClasses * kHandClasses * sizeof(uint16_t);
+
+static_assert(sizeof(FileHeader) == 16);
+
+using cards::CardId;
+
+// The 6, 4 or 12 concrete two-card hands of a class.
+struct Combos {
+  std::array<std::array<CardId, 2>, 12> hands;
+  std::size_t size{0};
+};
+
+auto combos_of(uint8_t cls) -> Combos {
+  const auto row = static_cast<uint8_t>(cls / kRanks);
+  const auto col = static_cast<uint8_t>(cls % kRanks);
+  const auto card = [](uint8_t rank, uint8_t suit) {
+    return static_cast<CardId>(suit * kRanks + rank);
+  };
+  Combos out;
+  for (uint8_t s1 = 0; s1 < 4; ++s1) {
+    for (uint8_t s2 = 0; s2 < 4; ++s2) {
+      const bool keep = row == col   ? s1 < s2
+                        : row > col ? s1 == s2 // suited
+                                    : s1 != s2;
+      if (keep) {
+        out.hands[out.size++] = {card(row, s1), card(col, s2)};
+      }
+    }
+  }
+  return out;
+}
+
+auto rank_of(std::array<CardId, 2> hole, const CardId *board) -> HandRank {
+  return rank_best_of_seven(
+      {cards::from_card_id(hole[0]), cards::from_card_id(hole[1]),
+       cards::from_card_id(board[0]), cards::from_card_id(board[1]),
+       cards::from_card_id(board[2]), cards::from_card_id(board[3]),
+       cards::from_card_id(board[4])});
+}
+
+// The deck with `dead` moved past the end of the live prefix.
+class LiveDeck {
+public:
+  explicit LiveDeck(std::initializer_list<CardId> dead) {
+    for (std::size_t i = 0; i < kDeckSize; ++i) {
+      cards_[i] = static_cast<CardId>(i);
+    }
+    live_ = kDeckSize;
+    for (const auto id : dead) {
+      const auto at = std::find(cards_.begin(), cards_.begin() + live_, id);
+      std::iter_swap(at, cards_.begin() + --live_);
+    }
+  }
+
+  // Draws `n` distinct live cards into the front of the deck.
+  template <class URBG> auto deal(std::size_t n, URBG &rng) -> const CardId * {
+    for (std::size_t i = 0; i < n; ++i) {
+      std::uniform_int_distribution<std::size_t> pick(i, live_ - 1);
+      std::swap(cards_[i], cards_[pick(rng)]);
+    }
+    return cards_.data();
+  }
+
+private:
+  std::array<CardId, kDeckSize> cards_;
+  std::size_t live_;
+};
+
+bool overlaps(std::array<CardId, 2> a, std::array<CardId, 2> b) {
+  return a[0] == b[0] || a[0] == b[1] || a[1] == b[0] || a[1] == b[1];
+}
+
+auto quantize(double equity) -> uint16_t {
+  return static_cast<uint16_t>(std::lround(equity * kEquityScale));
+}
+
+auto entry_seed(uint64_t seed, std::size_t entry) -> uint64_t {
+  return seed * 0x9e3779b97f4a7c15ull + entry;
+}
+
+} // namespace
+
+auto to_string(EquityError e) -> std::string_view {
+  switch (e) {
+  case EquityError::io:
+    return "io";
+  case EquityError::bad_format:
+    return "bad_format";
+  }
+  return "unknown";
+}
+
+auto class_name(uint8_t cls) -> std::string {
+  const auto row = static_cast<uint8_t>(cls / kRanks);
+  const auto col = static_cast<uint8_t>(cls % kRanks);
+  std::string out{cards::to_char(static_cast<cards::Rank>(std::max(row, col))),
+                  cards::to_char(static_cast<cards::Rank>(std::min(row, col)))};
+  if (row != col) {
+    out += row > col ? 's' : 'o';
+  }
+  return out;
+}
+
+auto equity_vs_random(uint8_t cls, std::size_t players, uint32_t samples,
+                      uint64_t seed) -> double {
+  const auto combos = combos_of(cls);
+  const auto opponents = players - 1;
+  std::mt19937_64 rng(seed);
+  std::uniform_int_distribution<std::size_t> pick(0, combos.size - 1);
+  double won = 0;
+  for (uint32_t i = 0; i < samples; ++i) {
+    const auto hero = combos.hands[pick(rng)];
+    LiveDeck deck{hero[0], hero[1]};
+    const CardId *dealt = deck.deal(2 * opponents + kBoardSize, rng);
+    const CardId *board = dealt + 2 * opponents;
+    const auto mine = rank_of(hero, board);
+    std::size_t tied = 1;
+    bool lost = false;
+    for (std::size_t o = 0; o < opponents && !lost; ++o) {
+      const auto theirs = rank_of({dealt[2 * o], dealt[2 * o + 1]}, board);
+      lost = theirs < mine;
+      tied += theirs == mine;
+    }
+    if (!lost) {
+      won += 1.0 / static_cast<double>(tied);
+    }
+  }
+  return samples == 0 ? 0.0 : won / samples;
+}
+
+auto equity_vs_class(uint8_t hero, uint8_t villain, uint32_t samples,
+                     uint64_t seed) -> double {
+  const auto mine = combos_of(hero);
+  const auto theirs = combos_of(villain);
+  std::mt19937_64 rng(seed);
+  std::uniform_int_distribution<std::size_t> pick_mine(0, mine.size - 1);
+  std::uniform_int_distribution<std::size_t> pick_theirs(0, theirs.size - 1);
+  double won = 0;
+  for (uint32_t i = 0; i < samples; ++i) {
+    const auto h = mine.hands[pick_mine(rng)];
+    auto v = theirs.hands[pick_theirs(rng)];
+    while (overlaps(h, v)) { // every pair of classes has a disjoint combo
+      v = theirs.hands[pick_theirs(rng)];
+    }
+    LiveDeck deck{h[0], h[1], v[0], v[1]};
+    const CardId *board = deck.deal(kBoardSize, rng);
+    const auto a = rank_of(h, board);
+    const auto b = rank_of(v, board);
+    won += a < b ? 1.0 : a == b ? 0.5 : 0.0;
+  }
+  return samples == 0 ? 0.0 : won / samples;
+}
+
+auto build_equity_tables(const EquityOptions &opts) -> std::string {
+  constexpr std::size_t kRandomEntries = kPlayerCounts * kHandClasses;
+  std::vector<uint16_t> random(kRandomEntries);
+  std::vector<uint16_t> heads_up(kHandClasses * kHandClasses);
+
+  // the heads-up grid is antisymmetric, so only the upper triangle is run
+  std::vector<std::pair<uint8_t, uint8_t>> pairs;
+  for (std::size_t a = 0; a < kHandClasses; ++a) {
+    heads_up[a * kHandClasses + a] = kEquityScale / 2;
+    for (std::size_t b = a + 1; b < kHandClasses; ++b) {
+      pairs.emplace_back(static_cast<uint8_t>(a), static_cast<uint8_t>(b));
+    }
+  }
+
+  const std::size_t jobs = kRandomEntries + pairs.size();
+  std::atomic<std::size_t> next{0};
+  auto work = [&] {
+    for (auto j = next++; j < jobs; j = next++) {
+      const auto seed = entry_seed(opts.seed, j);
+      if (j < kRandomEntries) {
+        const auto cls = static_cast<uint8_t>(j % kHandClasses);
+        const auto players = kMinPlayers + j / kHandClasses;
+        random[j] =
+            quantize(equity_vs_random(cls, players, opts.samples, seed));
+        continue;
+      }
+      const auto [a, b] = pairs[j - kRandomEntries];
+      const auto q = quantize(equity_vs_class(a, b, opts.samples, seed));
+      heads_up[a * kHandClasses + b] = q;
+      heads_up[b * kHandClasses + a] = static_cast<uint16_t>(kEquityScale - q);
+    }
+  };
+  auto threads = opts.threads;
+  if (threads == 0) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  std::vector<std::jthread> workers;
+  for (unsigned t = 1; t < threads; ++t) {
+    workers.emplace_back(work);
+  }
+  work();
+  workers.clear();
+
+  FileHeader h{};
+  std::copy(kEquityMagic.begin(), kEquityMagic.end(), h.magic.begin());
+  h.version = kVersion;
+  h.samples = opts.samples;
+  std::string out(kFileSize, '\0');
+  std::memcpy(out.data(), &h, sizeof(h));
+  std::memcpy(out.data() + kRandomOffset, random.data(),
+              random.size() * sizeof(uint16_t));
+  std::memcpy(out.data() + kClassOffset, heads_up.data(),
+              heads_up.size() * sizeof(uint16_t));
+  return out;
+}
+
+auto write_equity_tables(const std::filesystem::path &path,
+                         const EquityOptions &opts)
+    -> std::expected<void, EquityError> {
+  const auto bytes = build_equity_tables(opts);
+  // readers keep their mapping of the old inode across the rename
+  if (!replace_file::write(path, bytes)) {
+    return std::unexpected(EquityError::io);
+  }
+  return {};
+}
+
+EquityTable::EquityTable(const std::byte *base, std::size_t size)
+    : base_(base), size_(size) {}
+
+EquityTable::EquityTable(EquityTable &&other) noexcept
+    : base_(std::exchange(other.base_, nullptr)),
+      size_(std::exchange(other.size_, 0)) {}
+
+EquityTable &EquityTable::operator=(EquityTable &&other) noexcept {
+  if (this != &other) {
+    if (base_ != nullptr) {
+      munmap(const_cast<std::byte *>(base_), size_);
+    }
+    base_ = std::exchange(other.base_, nullptr);
+    size_ = std::exchange(other.size_, 0);
+  }
+  return *this;
+}
+
+EquityTable::~EquityTable() {
+  if (base_ != nullptr) {
+    munmap(const_cast<std::byte *>(base_), size_);
+  }
+}
+
+auto EquityTable::open(const std::filesystem::path &path)
+    -> std::expected<EquityTable, EquityError> {
+  const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return std::unexpected(EquityError::io);
+  }
+  struct stat st{};
+  if (fstat(fd, &st) != 0) {
+    ::close(fd);
+    return std::unexpected(EquityError::io);
+  }
+  if (static_cast<std::size_t>(st.st_size) != kFileSize) {
+    ::close(fd);
+    return std::unexpected(EquityError::bad_format);
+  }
+  // shared and read-only: one copy in the page cache for every process
+  void *map = mmap(nullptr, kFileSize, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (map == MAP_FAILED) {
+    return std::unexpected(EquityError::io);
+  }
+  EquityTable table(static_cast<const std::byte *>(map), kFileSize);
+
+  FileHeader h;
+  std::memcpy(&h, table.base_, sizeof(h));
+  if (std::string_view(h.magic.data(), h.magic.size()) != kEquityMagic ||
+      h.version != kVersion) {
+    return std::unexpected(EquityError::bad_format);
+  }
+  // lookups trust every entry to be a fraction of kEquityScale
+  const auto *random =
+      reinterpret_cast<const uint16_t *>(table.base_ + kRandomOffset);
+  const auto *heads_up =
+      reinterpret_cast<const uint16_t *>(table.base_ + kClassOffset);
+  for (std::size_t i = 0; i < kPlayerCounts * kHandClasses; ++i) {
+    if (random[i] > kEquityScale) {
+      return std::unexpected(EquityError::bad_format);
+    }
+  }
+  for (std::size_t a = 0; a < kHandClasses; ++a) {
+    for (std::size_t b = a; b < kHandClasses; ++b) {
+      if (heads_up[a * kHandClasses + b] + heads_up[b * kHandClasses + a] !=
+          kEquityScale) {
+        return std::unexpected(EquityError::bad_format);
+      }
+    }
+  }
+  madvise(map, kFileSize, MADV_WILLNEED);
+  return table;
+}
+
+double EquityTable::vs_random(uint8_t cls, std::size_t players) const {
+  const auto *random =
+      reinterpret_cast<const uint16_t *>(base_ + kRandomOffset);
+  return static_cast<double>(
+             random[(players - kMinPlayers) * kHandClasses + cls]) /
+         kEquityScale;
+}
+
+double EquityTable::vs_class(uint8_t hero, uint8_t villain) const {
+  const auto *heads_up =
+      reinterpret_cast<const uint16_t *>(base_ + kClassOffset);
+  return static_cast<double>(heads_up[hero * kHandClasses + villain]) /
+         kEquityScale;
+}
+
+uint32_t EquityTable::samples() const {
+  return reinterpret_cast<const FileHeader *>(base_)->samples;
+}
+
+} // namespace poker
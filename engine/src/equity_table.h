@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+#include "hand_class.h"
+#include "poker_rules.h"
+
+// Preflop all-in equities for the 169 starting-hand classes. equity_gen
+// estimates them once into a small file; EquityTable maps that file
+// read-only, so every process on a host shares one copy of the pages and a
+// lookup is two loads.
+namespace poker {
+
+inline constexpr std::string_view kEquityMagic{"PKREQT01"};
+inline constexpr std::size_t kMinPlayers = 2;
+
+// Equities are stored as uint16 fractions of kEquityScale. The scale is even
+// so that a coin flip (and a class against itself) is exact.
+inline constexpr uint32_t kEquityScale = 65534;
+
+enum class EquityError : uint8_t { io, bad_format };
+
+auto to_string(EquityError e) -> std::string_view;
+
+// "AA", "AKs", "72o".
+auto class_name(uint8_t cls) -> std::string;
+
+// Monte Carlo estimates: a combo of `cls` dealt against `players - 1`
+// random hands, or against a combo of `villain`, run out to a random board.
+// Ties count as the hero's share of the pot. Standard error is below
+// 0.5 / sqrt(samples).
+auto equity_vs_random(uint8_t cls, std::size_t players, uint32_t samples,
+                      uint64_t seed) -> double;
+auto equity_vs_class(uint8_t hero, uint8_t villain, uint32_t samples,
+                     uint64_t seed) -> double;
+
+struct EquityOptions {
+  uint32_t samples{20'000}; // per table entry
+  unsigned threads{0};      // 0 = one per core
+  uint64_t seed{1};
+};
+
+// The file image: every class against 1..9 random hands, and heads-up
+// against every other class. Each entry draws from its own seed, so the
+// output does not depend on the thread count.
+auto build_equity_tables(const EquityOptions &opts) -> std::string;
+auto write_equity_tables(const std::filesystem::path &path,
+                         const EquityOptions &opts)
+    -> std::expected<void, EquityError>;
+
+class EquityTable {
+public:
+  static auto open(const std::filesystem::path &path)
+      -> std::expected<EquityTable, EquityError>;
+
+  EquityTable(EquityTable &&other) noexcept;
+  EquityTable &operator=(EquityTable &&other) noexcept;
+  EquityTable(const EquityTable &) = delete;
+  EquityTable &operator=(const EquityTable &) = delete;
+  ~EquityTable();
+
+  // `players` counts the hero, kMinPlayers..kMaxPlayers.
+  double vs_random(uint8_t cls, std::size_t players) const;
+  double vs_class(uint8_t hero, uint8_t villain) const;
+  uint32_t samples() const;
+
+private:
+  EquityTable(const std::byte *base, std::size_t size);
+
+  const std::byte *base_{nullptr};
+  std::size_t size_{0};
+};
+
+} // namespace poker
@@ -9,7 +9,12 @@ enum class ServerError {
   unspecified,
   too_many_clients,
   all_tables_full,
-  illegal_action
+  illegal_action,
+  too_many_tables,
+  chat_too_long,
+  chat_rate_limited,
+  overloaded,
+  bad_credential
 };
 
 enum class GameError {
@@ -39,6 +44,16 @@ inline auto to_string(ServerError err) -> std::string_view {
     return "all_tables_full";
   case ServerError::illegal_action:
     return "illegal_action";
+  case ServerError::too_many_tables:
+    return "too_many_tables";
+  case ServerError::chat_too_long:
+    return "chat_too_long";
+  case ServerError::chat_rate_limited:
+    return "chat_rate_limited";
+  case ServerError::overloaded:
+    return "overloaded";
+  case ServerError::bad_credential:
+    return "bad_credential";
   case ServerError::unspecified:
   default:
     return "unspecified_server_error";
@@ -0,0 +1,161 @@
+#include "event_record.h"
+
+#include <type_traits>
+
+#include "deck.h"
+
+namespace poker {
+namespace {
+
+template <std::size_t N>
+void put_cards(EventRecord &rec, const std::array<cards::Card, N> &cs) {
+  static_assert(N <= kFlopSize);
+  for (std::size_t i = 0; i < N; ++i) {
+    rec.cards[i] = cards::to_card_id(cs[i]);
+  }
+}
+
+template <std::size_t N>
+auto get_cards(const EventRecord &rec) -> std::array<cards::Card, N> {
+  std::array<cards::Card, N> out{};
+  for (std::size_t i = 0; i < N; ++i) {
+    out[i] = cards::from_card_id(rec.cards[i]);
+  }
+  return out;
+}
+
+// Card slots of `rec` its tag fills.
+auto cards_used(EventTag tag) -> std::size_t {
+  switch (tag) {
+  case EventTag::dealt_hole:
+  case EventTag::showdown_hand:
+    return kHoleSize;
+  case EventTag::dealt_flop:
+    return kFlopSize;
+  case EventTag::dealt_street:
+    return 1;
+  default:
+    return 0;
+  }
+}
+
+} // namespace
+
+auto to_string(RecordError e) -> std::string_view {
+  switch (e) {
+  case RecordError::bad_tag:
+    return "bad_tag";
+  case RecordError::bad_card:
+    return "bad_card";
+  case RecordError::bad_phase:
+    return "bad_phase";
+  }
+  return "unknown";
+}
+
+auto to_record(const Event &ev) -> EventRecord {
+  EventRecord rec{};
+  rec.tag = static_cast<EventTag>(ev.index());
+  std::visit(
+      [&](const auto &e) {
+        using T = std::decay_t<decltype(e)>;
+        if constexpr (std::is_same_v<T, PlayerAdded> ||
+                      std::is_same_v<T, PlayerRemoved>) {
+          rec.who = e.who;
+        } else if constexpr (std::is_same_v<T, BetPlaced> ||
+                             std::is_same_v<T, WonPot>) {
+          rec.who = e.who;
+          rec.amount = e.amount;
+        } else if constexpr (std::is_same_v<T, TurnAdvanced>) {
+          rec.who = e.next;
+        } else if constexpr (std::is_same_v<T, PhaseAdvanced>) {
+          rec.phase = e.next;
+        } else if constexpr (std::is_same_v<T, PlayerChips>) {
+          rec.who = e.who;
+          rec.amount = e.chips;
+        } else if constexpr (std::is_same_v<T, DealtHole> ||
+                             std::is_same_v<T, ShowdownHand>) {
+          rec.who = e.who;
+          put_cards(rec, e.hole);
+        } else if constexpr (std::is_same_v<T, DealtFlop>) {
+          put_cards(rec, e.flop);
+        } else if constexpr (std::is_same_v<T, DealtStreet>) {
+          rec.cards[0] = cards::to_card_id(e.street);
+        }
+      },
+      ev);
+  return rec;
+}
+
+auto check_record(const EventRecord &rec)
+    -> std::expected<void, RecordError> {
+  if (rec.tag > EventTag::showdown_hand) {
+    return std::unexpected(RecordError::bad_tag);
+  }
+  if (rec.tag == EventTag::phase_advanced && rec.phase > Phase::showdown) {
+    return std::unexpected(RecordError::bad_phase);
+  }
+  for (std::size_t i = 0; i < cards_used(rec.tag); ++i) {
+    if (rec.cards[i] >= kDeckSize) {
+      return std::unexpected(RecordError::bad_card);
+    }
+  }
+  return {};
+}
+
+auto from_record(const EventRecord &rec) -> std::expected<Event, RecordError> {
+  if (auto ok = check_record(rec); !ok) {
+    return std::unexpected(ok.error());
+  }
+  switch (rec.tag) {
+  case EventTag::player_added:
+    return PlayerAdded{rec.who};
+  case EventTag::player_removed:
+    return PlayerRemoved{rec.who};
+  case EventTag::bet_placed:
+    return BetPlaced{rec.who, rec.amount};
+  case EventTag::turn_advanced:
+    return TurnAdvanced{rec.who};
+  case EventTag::phase_advanced:
+    return PhaseAdvanced{rec.phase};
+  case EventTag::won_pot:
+    return WonPot{rec.who, rec.amount};
+  case EventTag::player_chips:
+    return PlayerChips{rec.who, rec.amount};
+  case EventTag::dealt_hole:
+    return DealtHole{rec.who, get_cards<kHoleSize>(rec)};
+  case EventTag::dealt_flop:
+    return DealtFlop{get_cards<kFlopSize>(rec)};
+  case EventTag::dealt_street:
+    return DealtStreet{cards::from_card_id(rec.cards[0])};
+  case EventTag::showdown_hand:
+    return ShowdownHand{rec.who, get_cards<kHoleSize>(rec)};
+  case EventTag::hand_started:
+    break;
+  }
+  return HandStarted{};
+}
+
+void append_records(std::span<const Event> events,
+                    std::vector<EventRecord> &out) {
+  out.reserve(out.size() + events.size());
+  for (const auto &ev : events) {
+    out.push_back(to_record(ev));
+  }
+}
+
+auto to_events(std::span<const EventRecord> records)
+    -> std::expected<std::vector<Event>, RecordError> {
+  std::vector<Event> out;
+  out.reserve(records.size());
+  for (const auto &rec : records) {
+    auto ev = from_record(rec);
+    if (!ev) {
+      return std::unexpected(ev.error());
+    }
+    out.push_back(std::move(*ev));
+  }
+  return out;
+}
+
+} // namespace poker
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <expected>
+#include <span>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "cards.h"
+#include "player.h"
+#include "poker_rules.h"
+#include "table.h"
+
+namespace poker {
+
+// Same order as the Event alternatives.
+enum class EventTag : uint8_t {
+  player_added,
+  player_removed,
+  bet_placed,
+  turn_advanced,
+  phase_advanced,
+  won_pot,
+  player_chips,
+  hand_started,
+  dealt_hole,
+  dealt_flop,
+  dealt_street,
+  showdown_hand
+};
+
+// Fixed-size, trivially copyable form of an Event for the internal streams
+// (broadcast, logging, replay, snapshots). Records are memcpy'd into ring
+// buffers and files as-is; std::variant Events only exist at API edges.
+//
+// `who` carries the player (or TurnAdvanced::next), `amount` the chips, and
+// `cards` up to three card ids (see cards::to_card_id).
+struct EventRecord {
+  EventTag tag;
+  Phase phase;
+  std::array<cards::CardId, kFlopSize> cards;
+  std::array<uint8_t, 3> reserved;
+  PlayerId who;
+  Chips amount;
+};
+
+static_assert(std::is_trivially_copyable_v<EventRecord>);
+static_assert(std::is_standard_layout_v<EventRecord>);
+static_assert(sizeof(EventRecord) == 24);
+static_assert(std::variant_size_v<Event> == 12);
+
+enum class RecordError : uint8_t { bad_tag, bad_card, bad_phase };
+
+auto to_string(RecordError e) -> std::string_view;
+
+auto to_record(const Event &ev) -> EventRecord;
+// Records read back from logs or sockets are not trusted: the tag must be
+// known and every card id its event uses inside the deck.
+auto check_record(const EventRecord &rec) -> std::expected<void, RecordError>;
+auto from_record(const EventRecord &rec) -> std::expected<Event, RecordError>;
+
+void append_records(std::span<const Event> events,
+                    std::vector<EventRecord> &out);
+auto to_events(std::span<const EventRecord> records)
+    -> std::expected<std::vector<Event>, RecordError>;
+
+} // namespace poker
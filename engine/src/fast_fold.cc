@@ -0,0 +1,221 @@
+#include "fast_fold.h"
+
+#include <algorithm>
+#include <iterator>
+#include <span>
+#include <utility>
+
+namespace poker {
+namespace {
+
+// A hand id keeps its table's index in the low bits, so finding the table
+// is an array lookup, and the hand's serial above them, so an id goes stale
+// once its table moves on to another hand.
+constexpr unsigned kSlotBits = 24;
+constexpr uint64_t kSlotMask = (uint64_t{1} << kSlotBits) - 1;
+
+} // namespace
+
+FastFoldPool::FastFoldPool(std::size_t seats, uint64_t seed)
+    : seats_(std::clamp<std::size_t>(seats, 2, kMaxPlayers)), seeds_(seed) {}
+
+auto FastFoldPool::join(PlayerId id, Chips stack)
+    -> std::expected<void, PlayerMgmtError> {
+  if (id == 0 || stack == 0) {
+    return std::unexpected(PlayerMgmtError::invalid_id);
+  }
+  const auto [it, added] = members_.try_emplace(id, Member{stack});
+  if (!added) {
+    return std::unexpected(PlayerMgmtError::invalid_id);
+  }
+  enqueue(id, it->second);
+  return {};
+}
+
+auto FastFoldPool::leave(PlayerId id) -> std::expected<void, PlayerMgmtError> {
+  const auto it = members_.find(id);
+  if (it == members_.end()) {
+    return std::unexpected(PlayerMgmtError::player_not_found);
+  }
+  if (it->second.hand != 0) {
+    it->second.leaving = true;
+    return {};
+  }
+  departures_.push_back({id, it->second.stack});
+  members_.erase(it); // its queue entry goes stale
+  --waiting_;
+  return {};
+}
+
+auto FastFoldPool::match() -> std::vector<DealtHand> {
+  std::vector<DealtHand> dealt;
+  while (waiting_ >= seats_) {
+    const bool fresh = idle_.empty();
+    const auto index = idle_slot();
+    auto &slot = slots_[index];
+    const HandId hand = (++hands_dealt_ << kSlotBits) | index;
+    DealtHand d{hand, {}, {}, std::nullopt};
+    if (fresh) {
+      d.opened = slot.seed;
+    }
+    d.events.reserve(seats_ * 4 + 8);
+    d.stacks.reserve(seats_);
+    slot.hand = hand;
+    slot.seated = seats_;
+    for (std::size_t i = 0; i < seats_; ++i) {
+      const auto id = pop_waiting();
+      auto &m = members_.find(id)->second;
+      m.hand = hand;
+      slot.players[i] = id;
+      slot.stacks[i] = m.stack;
+      d.stacks.push_back(m.stack);
+      d.events.push_back(*slot.table.add_player(id, m.stack));
+    }
+    // every seat has chips, so the hand always starts
+    auto started = slot.table.handle_new_hand();
+    d.events.insert(d.events.end(), started->begin(), started->end());
+    ++live_;
+    settle(index, d.events);
+    dealt.push_back(std::move(d));
+  }
+  return dealt;
+}
+
+auto FastFoldPool::on_action(HandId hand, Action action)
+    -> std::expected<std::vector<Event>, GameError> {
+  const auto index = slot_of(hand);
+  if (!index) {
+    return std::unexpected(GameError::invalid_action);
+  }
+  auto res = slots_[*index].table.on_action(action);
+  if (res) {
+    settle(*index, *res);
+  }
+  return res;
+}
+
+auto FastFoldPool::seat_view(HandId hand, PlayerId id) const
+    -> std::optional<SeatView> {
+  const auto index = slot_of(hand);
+  if (!index) {
+    return std::nullopt;
+  }
+  return slots_[*index].table.seat_view(id);
+}
+
+bool FastFoldPool::live(HandId hand) const { return slot_of(hand).has_value(); }
+
+auto FastFoldPool::players(HandId hand) const -> std::vector<PlayerId> {
+  std::vector<PlayerId> out;
+  if (const auto index = slot_of(hand)) {
+    const auto &slot = slots_[*index];
+    std::copy_if(slot.players.begin(), slot.players.begin() + slot.seated,
+                 std::back_inserter(out), [](PlayerId id) { return id != 0; });
+  }
+  return out;
+}
+
+auto FastFoldPool::on_clock(HandId hand) const -> std::optional<PlayerId> {
+  const auto index = slot_of(hand);
+  if (!index) {
+    return std::nullopt;
+  }
+  return slots_[*index].table.on_clock();
+}
+
+auto FastFoldPool::hand_of(PlayerId id) const -> std::optional<HandId> {
+  const auto it = members_.find(id);
+  if (it == members_.end() || it->second.hand == 0) {
+    return std::nullopt;
+  }
+  return it->second.hand;
+}
+
+auto FastFoldPool::take_departures() -> std::vector<Departure> {
+  return std::exchange(departures_, {});
+}
+
+auto FastFoldPool::table_of(HandId hand) -> TableId {
+  return kPoolTables | (hand & kSlotMask);
+}
+
+auto FastFoldPool::slot_of(HandId hand) const -> std::optional<uint32_t> {
+  const auto index = hand & kSlotMask;
+  if (hand == 0 || index >= slots_.size() || slots_[index].hand != hand) {
+    return std::nullopt;
+  }
+  return static_cast<uint32_t>(index);
+}
+
+auto FastFoldPool::idle_slot() -> uint32_t {
+  if (!idle_.empty()) {
+    const auto index = idle_.back();
+    idle_.pop_back();
+    return index;
+  }
+  slots_.emplace_back(seeds_());
+  return static_cast<uint32_t>(slots_.size() - 1);
+}
+
+void FastFoldPool::enqueue(PlayerId id, Member &m) {
+  m.hand = 0;
+  m.ticket = ++next_ticket_;
+  queue_.push_back({id, m.ticket});
+  ++waiting_;
+}
+
+auto FastFoldPool::pop_waiting() -> PlayerId {
+  while (true) {
+    const auto [id, ticket] = queue_.front();
+    queue_.pop_front();
+    const auto it = members_.find(id);
+    if (it != members_.end() && it->second.hand == 0 &&
+        it->second.ticket == ticket) {
+      --waiting_;
+      return id;
+    }
+  }
+}
+
+// Tracks stacks through `events`, then lets go of everyone who is out of
+// the hand. A finished hand lets go of all its players and frees the table.
+void FastFoldPool::settle(uint32_t index, const std::vector<Event> &events) {
+  auto &slot = slots_[index];
+  const auto seated = std::span(slot.players).first(slot.seated);
+  for (const auto &ev : events) {
+    if (const auto *c = std::get_if<PlayerChips>(&ev)) {
+      const auto it = std::find(seated.begin(), seated.end(), c->who);
+      if (it != seated.end()) {
+        slot.stacks[static_cast<std::size_t>(it - seated.begin())] = c->chips;
+      }
+    }
+  }
+  const bool over = !slot.table.hand_in_progress();
+  for (std::size_t i = 0; i < slot.seated; ++i) {
+    const auto id = slot.players[i];
+    if (id != 0 && (over || !slot.table.in_hand(id))) {
+      slot.players[i] = 0;
+      release(id, slot.stacks[i]);
+    }
+  }
+  if (over) {
+    slot.table.clear();
+    slot.hand = 0;
+    slot.seated = 0;
+    idle_.push_back(index);
+    --live_;
+  }
+}
+
+void FastFoldPool::release(PlayerId id, Chips stack) {
+  const auto it = members_.find(id);
+  if (it->second.leaving || stack == 0) {
+    departures_.push_back({id, stack});
+    members_.erase(it);
+    return;
+  }
+  it->second.stack = stack;
+  enqueue(id, it->second);
+}
+
+} // namespace poker
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <expected>
+#include <optional>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "errors.h"
+#include "player.h"
+#include "poker_rules.h"
+#include "table.h"
+
+// Fast-fold play: players wait in one pool rather than at a table. Whenever
+// enough of them are waiting the pool deals them a hand at an idle table, and
+// a player who folds goes straight back into the pool while the hand plays on
+// without them. A table lives for one hand and is then reused, so a busy
+// pool starts thousands of hands a second without building a Table for any.
+namespace poker {
+
+// Names one hand at one pooled table; never reused.
+using HandId = uint64_t;
+
+// Pooled tables take their ids from the top half of the TableId space, so
+// their journals and hand records never meet a table's.
+inline constexpr TableId kPoolTables = TableId{1} << 63;
+
+constexpr bool is_pool_table(TableId id) { return (id & kPoolTables) != 0; }
+
+struct DealtHand {
+  HandId hand;
+  std::vector<Event> events; // a PlayerAdded per seat, then the deal
+  std::vector<Chips> stacks; // each seat's chips, in PlayerAdded order
+  // the rng seed of a table dealing its first hand
+  std::optional<uint64_t> opened;
+};
+
+// A player the pool has let go of: they left, or they have no chips.
+struct Departure {
+  PlayerId who;
+  Chips stack;
+};
+
+class FastFoldPool {
+public:
+  // Hands are dealt `seats`-handed, 2 to kMaxPlayers.
+  explicit FastFoldPool(std::size_t seats = 6, uint64_t seed = 1);
+
+  // Queues `id` with `stack` chips; invalid_id if they are already pooled.
+  auto join(PlayerId id, Chips stack = kBuyIn)
+      -> std::expected<void, PlayerMgmtError>;
+  // Takes `id` out of the pool: at once if they are waiting, otherwise when
+  // their hand lets them go. Either way they end up in take_departures().
+  auto leave(PlayerId id) -> std::expected<void, PlayerMgmtError>;
+
+  // Deals every hand the waiting players fill, longest waiting first.
+  auto match() -> std::vector<DealtHand>;
+  // Plays `action` in `hand`. Whoever it takes out of the hand is queued
+  // again straight away; the rest are queued when the hand ends.
+  auto on_action(HandId hand, Action action)
+      -> std::expected<std::vector<Event>, GameError>;
+
+  auto seat_view(HandId hand, PlayerId id) const -> std::optional<SeatView>;
+  // False once the hand is over.
+  bool live(HandId hand) const;
+  // Who `hand` has not let go of yet: the audience for its events.
+  auto players(HandId hand) const -> std::vector<PlayerId>;
+  // Who is to act in `hand`, if it is live.
+  auto on_clock(HandId hand) const -> std::optional<PlayerId>;
+  // The hand `id` is seated in, if they are not waiting.
+  auto hand_of(PlayerId id) const -> std::optional<HandId>;
+  auto take_departures() -> std::vector<Departure>;
+  // The pooled table `hand` is dealt at. Between hands it is cleared, so
+  // its calls journal like any table's with a clear after each hand.
+  static auto table_of(HandId hand) -> TableId;
+
+  std::size_t waiting() const { return waiting_; }
+  std::size_t live_hands() const { return live_; }
+  uint64_t hands_dealt() const { return hands_dealt_; }
+  // Tables built so far, live or idle.
+  std::size_t tables() const { return slots_.size(); }
+
+private:
+  struct Member {
+    Chips stack;
+    HandId hand{0}; // 0 while waiting
+    uint64_t ticket{0};
+    bool leaving{false};
+  };
+  // A queue entry is stale once its member has been queued again or left.
+  struct Ticket {
+    PlayerId who;
+    uint64_t ticket;
+  };
+  struct Slot {
+    explicit Slot(uint64_t seed) : seed(seed), rng(seed), table(rng) {}
+    uint64_t seed;
+    std::mt19937_64 rng;
+    Table table;
+    HandId hand{0}; // 0 while idle
+    std::size_t seated{0};
+    std::array<PlayerId, kMaxPlayers> players{}; // 0 once let go
+    std::array<Chips, kMaxPlayers> stacks{};
+  };
+
+  auto slot_of(HandId hand) const -> std::optional<uint32_t>;
+  auto idle_slot() -> uint32_t;
+  void enqueue(PlayerId id, Member &m);
+  auto pop_waiting() -> PlayerId;
+  void settle(uint32_t index, const std::vector<Event> &events);
+  void release(PlayerId id, Chips stack);
+
+  std::size_t seats_;
+  std::mt19937_64 seeds_;
+  std::unordered_map<PlayerId, Member> members_;
+  std::deque<Ticket> queue_;
+  std::size_t waiting_{0};
+  uint64_t next_ticket_{0};
+  std::deque<Slot> slots_; // a deque, as each Table holds onto its rng
+  std::vector<uint32_t> idle_;
+  std::size_t live_{0};
+  uint64_t hands_dealt_{0};
+  std::vector<Departure> departures_;
+};
+
+} // namespace poker
@@ -0,0 +1,713 @@
+#include "hand_audit.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <optional>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+#include "hand_evaluator.h"
+#include "house_bot.h"
+
+namespace poker {
+
+namespace {
+
+auto tag_name(InputTag tag) -> std::string_view {
+  switch (tag) {
+  case InputTag::open:
+    return "open";
+  case InputTag::add_player:
+    return "add_player";
+  case InputTag::remove_player:
+    return "remove_player";
+  case InputTag::new_hand:
+    return "new_hand";
+  case InputTag::fold:
+    return "fold";
+  case InputTag::bet:
+    return "bet";
+  case InputTag::timeout:
+    return "timeout";
+  case InputTag::credential:
+    return "credential";
+  case InputTag::revoke:
+    return "revoke";
+  case InputTag::house_bot:
+    return "house_bot";
+  case InputTag::clear:
+    return "clear";
+  }
+  return "unknown";
+}
+
+// Journals one Table call into an in-memory log.
+template <typename T, typename E>
+auto journal(TableLog &log, InputRecord in, std::expected<T, E> res)
+    -> std::expected<T, E> {
+  in.table = log.table;
+  if (!res) {
+    in.failed = 1;
+    log.inputs.push_back(in);
+    return res;
+  }
+  std::vector<Event> events;
+  if constexpr (std::is_same_v<T, Event>) {
+    events.push_back(*res);
+  } else {
+    events = *res;
+  }
+  in.events = static_cast<uint16_t>(events.size());
+  log.inputs.push_back(in);
+  append_records(events, log.events);
+  return res;
+}
+
+// Drives a Table from a journal and reports the first call whose outcome
+// differs from the one recorded.
+class Replayer {
+public:
+  explicit Replayer(uint64_t seed) : rng_(seed), table_(rng_) {}
+
+  auto apply(const InputRecord &in) -> std::optional<std::vector<Event>> {
+    return replay_input(table_, in);
+  }
+
+private:
+  std::mt19937_64 rng_;
+  Table table_;
+};
+
+template <typename E>
+auto value_or_null(std::expected<std::vector<Event>, E> res)
+    -> std::optional<std::vector<Event>> {
+  if (!res) {
+    return std::nullopt;
+  }
+  return std::move(*res);
+}
+
+auto describe(const std::map<PlayerId, Chips> &payouts) -> std::string {
+  std::string out = "{";
+  for (const auto &[who, amount] : payouts) {
+    if (out.size() > 1) {
+      out += ", ";
+    }
+    out += std::to_string(who) + ": " + std::to_string(amount);
+  }
+  return out + "}";
+}
+
+// Rebuilds each hand from its events alone -- stacks, contributions, who
+// folded or left, the cards -- and settles it from the rules, without
+// consulting Table.
+class Ledger {
+public:
+  Ledger(TableId table, AuditReport &report)
+      : table_(table), report_(report) {}
+
+  void flag(Check check, std::string detail) {
+    report_.findings.push_back({table_, hand_, check, std::move(detail)});
+  }
+
+  void step(const InputRecord &in, std::span<const EventRecord> events) {
+    if (!in.failed && in.tag == InputTag::add_player) {
+      stacks_[in.who] = in.amount != 0 ? in.amount : kBuyIn;
+    } else if (in.tag == InputTag::clear) {
+      stacks_.clear(); // the seats go without a PlayerRemoved
+    }
+    if (!in.failed && in_hand_) {
+      const bool bet = std::any_of(
+          events.begin(), events.end(), [&](const EventRecord &rec) {
+            return rec.tag == EventTag::bet_placed && rec.who == in.who;
+          });
+      // a timeout checks when it can and folds otherwise
+      if (in.tag == InputTag::fold || (in.tag == InputTag::timeout && !bet)) {
+        if (auto *s = seat(in.who)) {
+          s->out = true;
+        }
+      }
+    }
+    for (const auto &rec : events) {
+      observe(rec);
+    }
+    if (in_hand_ && !paid_.empty()) {
+      settle();
+    }
+  }
+
+private:
+  struct Seat {
+    PlayerId who;
+    Chips committed{0};
+    bool out{false}; // folded or left
+    std::array<cards::CardId, kHoleSize> hole{};
+  };
+
+  auto seat(PlayerId who) -> Seat * {
+    auto it = std::find_if(seats_.begin(), seats_.end(),
+                           [&](const Seat &s) { return s.who == who; });
+    return it == seats_.end() ? nullptr : &*it;
+  }
+
+  void observe(const EventRecord &rec) {
+    if (rec.tag != EventTag::player_chips &&
+        rec.tag != EventTag::phase_advanced) {
+      starting_ = false;
+    }
+    switch (rec.tag) {
+    case EventTag::hand_started:
+      // the last hand ended without paying anyone
+      if (in_hand_) {
+        settle();
+      }
+      ++hand_;
+      ++report_.hands;
+      in_hand_ = true;
+      starting_ = true;
+      seats_.clear();
+      board_.clear();
+      paid_.clear();
+      shown_.clear();
+      break;
+    case EventTag::player_chips:
+      if (starting_) {
+        const auto it = stacks_.find(rec.who);
+        const Chips expected = it == stacks_.end() ? kBuyIn : it->second;
+        if (rec.amount != expected) {
+          flag(Check::stack, "player " + std::to_string(rec.who) +
+                                 " starts with " + std::to_string(rec.amount) +
+                                 ", expected " + std::to_string(expected));
+        }
+        seats_.push_back({rec.who});
+      } else if (stacks_[rec.who] != rec.amount) {
+        flag(Check::stack, "player " + std::to_string(rec.who) + " has " +
+                               std::to_string(rec.amount) + ", expected " +
+                               std::to_string(stacks_[rec.who]));
+      }
+      stacks_[rec.who] = rec.amount;
+      break;
+    case EventTag::bet_placed: {
+      auto *s = seat(rec.who);
+      auto &stack = stacks_[rec.who];
+      if (!s || rec.amount > stack) {
+        flag(Check::stack, "player " + std::to_string(rec.who) + " bet " +
+                               std::to_string(rec.amount) + " holding " +
+                               std::to_string(stack));
+        break;
+      }
+      s->committed += rec.amount;
+      stack -= rec.amount;
+      break;
+    }
+    case EventTag::dealt_hole:
+      if (auto *s = seat(rec.who)) {
+        std::copy_n(rec.cards.begin(), kHoleSize, s->hole.begin());
+      }
+      break;
+    case EventTag::dealt_flop:
+      board_.insert(board_.end(), rec.cards.begin(), rec.cards.end());
+      break;
+    case EventTag::dealt_street:
+      board_.push_back(rec.cards[0]);
+      break;
+    case EventTag::showdown_hand: {
+      const auto *s = seat(rec.who);
+      if (!s || !std::equal(s->hole.begin(), s->hole.end(),
+                            rec.cards.begin())) {
+        flag(Check::settlement,
+             "player " + std::to_string(rec.who) + " showed cards not dealt");
+      }
+      shown_.push_back(rec.who);
+      break;
+    }
+    case EventTag::won_pot:
+      paid_.emplace_back(rec.who, rec.amount);
+      stacks_[rec.who] += rec.amount;
+      break;
+    case EventTag::player_removed:
+      stacks_.erase(rec.who);
+      if (auto *s = seat(rec.who)) {
+        s->out = true;
+      }
+      break;
+    default:
+      break;
+    }
+  }
+
+  auto rank(const Seat &s) const -> HandRank {
+    std::array<cards::Card, kHoleSize + kBoardSize> cs{};
+    cs[0] = cards::from_card_id(s.hole[0]);
+    cs[1] = cards::from_card_id(s.hole[1]);
+    for (std::size_t i = 0; i < kBoardSize; ++i) {
+      cs[kHoleSize + i] = cards::from_card_id(board_[i]);
+    }
+    return rank_best_of_seven(cs);
+  }
+
+  void settle() {
+    in_hand_ = false;
+    Chips bet = 0;
+    std::map<PlayerId, Chips> paid;
+    for (const auto &s : seats_) {
+      bet += s.committed;
+    }
+    Chips total = 0;
+    for (const auto &[who, amount] : paid_) {
+      paid[who] += amount;
+      total += amount;
+    }
+    if (bet != total) {
+      flag(Check::conservation, std::to_string(bet) + " bet but " +
+                                    std::to_string(total) + " paid");
+    }
+
+    std::vector<const Seat *> contenders;
+    for (const auto &s : seats_) {
+      if (!s.out) {
+        contenders.push_back(&s);
+      }
+    }
+    std::map<PlayerId, Chips> expected;
+    if (contenders.size() == 1 && shown_.empty()) {
+      expected[contenders.front()->who] = bet;
+    } else if (!settle_showdown(contenders, expected)) {
+      return;
+    }
+    if (expected != paid) {
+      flag(Check::settlement,
+           "expected " + describe(expected) + ", paid " + describe(paid));
+    }
+  }
+
+  bool settle_showdown(const std::vector<const Seat *> &contenders,
+                       std::map<PlayerId, Chips> &expected) {
+    if (board_.size() != kBoardSize) {
+      flag(Check::settlement, "showdown without a full board");
+      return false;
+    }
+    std::vector<PlayerId> shown = shown_;
+    std::vector<PlayerId> live;
+    for (const auto *s : contenders) {
+      live.push_back(s->who);
+    }
+    std::sort(shown.begin(), shown.end());
+    std::sort(live.begin(), live.end());
+    if (shown != live) {
+      flag(Check::settlement, "showdown hands differ from live players");
+    }
+    std::unordered_map<PlayerId, HandRank> ranks;
+    for (const auto *s : contenders) {
+      ranks[s->who] = rank(*s);
+    }
+
+    // each distinct contribution level caps a pot; contenders who reached
+    // it are eligible, and a pot nobody live reached joins the one below
+    std::vector<Chips> levels;
+    for (const auto &s : seats_) {
+      if (s.committed > 0) {
+        levels.push_back(s.committed);
+      }
+    }
+    std::sort(levels.begin(), levels.end());
+    levels.erase(std::unique(levels.begin(), levels.end()), levels.end());
+    std::vector<std::pair<Chips, std::vector<PlayerId>>> pots;
+    Chips below = 0;
+    for (const auto level : levels) {
+      Chips amount = 0;
+      for (const auto &s : seats_) {
+        amount += std::min(s.committed, level) - std::min(s.committed, below);
+      }
+      below = level;
+      std::vector<PlayerId> eligible;
+      for (const auto *s : contenders) {
+        if (s->committed >= level) {
+          eligible.push_back(s->who);
+        }
+      }
+      if (eligible.empty() && !pots.empty()) {
+        pots.back().first += amount;
+      } else {
+        pots.emplace_back(amount, std::move(eligible));
+      }
+    }
+    for (const auto &[amount, eligible] : pots) {
+      if (eligible.empty()) {
+        continue;
+      }
+      HandRank best = ranks.at(eligible.front());
+      for (const auto who : eligible) {
+        best = std::min(best, ranks.at(who));
+      }
+      // seats_ is in button order, which decides the odd chips
+      std::vector<PlayerId> winners;
+      for (const auto &s : seats_) {
+        if (std::find(eligible.begin(), eligible.end(), s.who) !=
+                eligible.end() &&
+            ranks.at(s.who) == best) {
+          winners.push_back(s.who);
+        }
+      }
+      const auto n = static_cast<Chips>(winners.size());
+      for (std::size_t i = 0; i < winners.size(); ++i) {
+        expected[winners[i]] += amount / n + (i < amount % n ? 1 : 0);
+      }
+    }
+    return true;
+  }
+
+  TableId table_;
+  AuditReport &report_;
+  std::unordered_map<PlayerId, Chips> stacks_;
+  uint64_t hand_{0};
+  bool in_hand_{false};
+  bool starting_{false};
+  std::vector<Seat> seats_; // participants in button order
+  std::vector<cards::CardId> board_;
+  std::vector<std::pair<PlayerId, Chips>> paid_;
+  std::vector<PlayerId> shown_;
+};
+
+} // namespace
+
+auto to_input(TableId table, const Action &action) -> InputRecord {
+  InputRecord in{};
+  in.table = table;
+  std::visit(
+      [&](const auto &a) {
+        using T = std::decay_t<decltype(a)>;
+        in.who = a.id;
+        if constexpr (std::is_same_v<T, Fold>) {
+          in.tag = InputTag::fold;
+        } else if constexpr (std::is_same_v<T, Bet>) {
+          in.tag = InputTag::bet;
+          in.amount = a.amount;
+        } else {
+          in.tag = InputTag::timeout;
+        }
+      },
+      action);
+  return in;
+}
+
+void append_input(std::string &out, const InputRecord &in,
+                  std::span<const Event> events) {
+  const auto at = out.size();
+  out.resize(at + sizeof(InputRecord) + events.size() * sizeof(EventRecord));
+  std::memcpy(out.data() + at, &in, sizeof(in));
+  auto *dst = out.data() + at + sizeof(InputRecord);
+  for (const auto &ev : events) {
+    const auto rec = to_record(ev);
+    std::memcpy(dst, &rec, sizeof(rec));
+    dst += sizeof(rec);
+  }
+}
+
+auto replay_input(Table &table, const InputRecord &in)
+    -> std::optional<std::vector<Event>> {
+  switch (in.tag) {
+  case InputTag::open:
+    return std::vector<Event>{};
+  case InputTag::add_player:
+    if (auto res = table.add_player(in.who,
+                                    in.amount != 0 ? in.amount : kBuyIn)) {
+      return std::vector<Event>{*res};
+    }
+    return std::nullopt;
+  case InputTag::remove_player:
+    return value_or_null(table.remove_player(in.who));
+  case InputTag::new_hand:
+    return value_or_null(table.handle_new_hand());
+  case InputTag::fold:
+    return value_or_null(table.on_action(Fold{in.who}));
+  case InputTag::bet:
+    return value_or_null(table.on_action(Bet{in.who, in.amount}));
+  case InputTag::timeout:
+    return value_or_null(table.on_action(Timeout{in.who}));
+  case InputTag::credential:
+  case InputTag::revoke:
+  case InputTag::house_bot:
+    return std::vector<Event>{};
+  case InputTag::clear:
+    table.clear();
+    return std::vector<Event>{};
+  }
+  return std::nullopt;
+}
+
+bool same_events(std::span<const Event> got,
+                 std::span<const EventRecord> want) {
+  if (got.size() != want.size()) {
+    return false;
+  }
+  for (std::size_t i = 0; i < got.size(); ++i) {
+    const auto rec = to_record(got[i]);
+    if (std::memcmp(&rec, &want[i], sizeof(rec)) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+auto to_string(AuditError e) -> std::string_view {
+  switch (e) {
+  case AuditError::io:
+    return "io";
+  case AuditError::bad_format:
+    return "bad_format";
+  }
+  return "unknown";
+}
+
+auto to_string(Check c) -> std::string_view {
+  switch (c) {
+  case Check::replay:
+    return "replay";
+  case Check::stack:
+    return "stack";
+  case Check::conservation:
+    return "conservation";
+  case Check::settlement:
+    return "settlement";
+  }
+  return "unknown";
+}
+
+auto HandLogWriter::open(const std::filesystem::path &path)
+    -> std::expected<std::unique_ptr<HandLogWriter>, AuditError> {
+  auto file = append_file::Writer::open(path, kHandLogMagic, "hand log");
+  if (!file) {
+    return std::unexpected(AuditError::io);
+  }
+  return std::unique_ptr<HandLogWriter>(new HandLogWriter(std::move(file)));
+}
+
+HandLogWriter::HandLogWriter(std::unique_ptr<append_file::Writer> file)
+    : file_(std::move(file)) {}
+
+void HandLogWriter::append(InputRecord in, std::span<const Event> events) {
+  in.events = static_cast<uint16_t>(events.size());
+  append_input(file_->buffer(), in, events);
+  file_->flush_if_full();
+}
+
+void HandLogWriter::flush() { file_->flush(); }
+
+auto read_hand_log(const std::filesystem::path &path)
+    -> std::expected<std::vector<TableLog>, AuditError> {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    return std::unexpected(AuditError::io);
+  }
+  const std::string bytes{std::istreambuf_iterator<char>(in),
+                          std::istreambuf_iterator<char>()};
+  if (in.bad()) {
+    return std::unexpected(AuditError::io);
+  }
+  return parse_hand_log(bytes);
+}
+
+auto parse_hand_log(std::string_view bytes)
+    -> std::expected<std::vector<TableLog>, AuditError> {
+  if (!bytes.starts_with(kHandLogMagic)) {
+    return std::unexpected(AuditError::bad_format);
+  }
+  std::vector<TableLog> logs;
+  std::unordered_map<TableId, std::size_t> index;
+  std::size_t off = kHandLogMagic.size();
+  while (off < bytes.size()) {
+    InputRecord in;
+    if (bytes.size() - off < sizeof(in)) {
+      return std::unexpected(AuditError::bad_format);
+    }
+    std::memcpy(&in, bytes.data() + off, sizeof(in));
+    off += sizeof(in);
+    const auto len = std::size_t{in.events} * sizeof(EventRecord);
+    if (bytes.size() - off < len) {
+      return std::unexpected(AuditError::bad_format);
+    }
+    const auto [it, fresh] = index.try_emplace(in.table, logs.size());
+    if (fresh) {
+      logs.push_back({in.table});
+    }
+    auto &log = logs[it->second];
+    if (in.tag == InputTag::open) {
+      log.seed = in.amount;
+    }
+    log.inputs.push_back(in);
+    const auto at = log.events.size();
+    log.events.resize(at + in.events);
+    std::memcpy(log.events.data() + at, bytes.data() + off, len);
+    off += len;
+    for (auto i = at; i < log.events.size(); ++i) {
+      if (!check_record(log.events[i])) {
+        return std::unexpected(AuditError::bad_format);
+      }
+    }
+  }
+  return logs;
+}
+
+auto audit_table(const TableLog &log) -> AuditReport {
+  AuditReport report;
+  report.tables = 1;
+  report.inputs = log.inputs.size();
+  Ledger ledger(log.table, report);
+  Replayer replayer(log.seed);
+  bool replaying = true;
+  std::size_t off = 0;
+  for (std::size_t i = 0; i < log.inputs.size(); ++i) {
+    const auto &in = log.inputs[i];
+    if (log.events.size() - off < in.events) {
+      ledger.flag(Check::replay, "journal ends inside input " +
+                                     std::to_string(i));
+      break;
+    }
+    const std::span<const EventRecord> events(log.events.data() + off,
+                                              in.events);
+    off += in.events;
+    if (replaying) {
+      const auto got = replayer.apply(in);
+      const bool failed = !got.has_value();
+      if (failed != static_cast<bool>(in.failed) ||
+          (got && !same_events(*got, events))) {
+        std::string detail = "input ";
+        detail += std::to_string(i) + " (" + std::string(tag_name(in.tag)) +
+                  " by " + std::to_string(in.who) + ") ";
+        detail += failed ? "failed" : "returned different events";
+        ledger.flag(Check::replay, std::move(detail));
+        // the Table has diverged; the ledger still checks the journal
+        replaying = false;
+      }
+    }
+    ledger.step(in, events);
+  }
+  return report;
+}
+
+auto audit(std::span<const TableLog> logs, unsigned threads) -> AuditReport {
+  if (threads == 0) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  std::vector<AuditReport> reports(logs.size());
+  std::atomic<std::size_t> next{0};
+  auto work = [&] {
+    for (auto i = next++; i < logs.size(); i = next++) {
+      reports[i] = audit_table(logs[i]);
+    }
+  };
+  std::vector<std::jthread> workers;
+  for (unsigned t = 1; t < std::min<std::size_t>(threads, logs.size()); ++t) {
+    workers.emplace_back(work);
+  }
+  work();
+  workers.clear();
+
+  AuditReport total;
+  for (auto &r : reports) {
+    total.tables += r.tables;
+    total.hands += r.hands;
+    total.inputs += r.inputs;
+    std::move(r.findings.begin(), r.findings.end(),
+              std::back_inserter(total.findings));
+  }
+  std::stable_sort(total.findings.begin(), total.findings.end(),
+                   [](const Finding &a, const Finding &b) {
+                     return std::pair(a.table, a.hand) <
+                            std::pair(b.table, b.hand);
+                   });
+  return total;
+}
+
+auto play_table(TableId table, uint64_t seed, std::size_t players,
+                std::size_t hands) -> TableLog {
+  TableLog log{table, seed};
+  log.inputs.push_back({.tag = InputTag::open, .table = table, .amount = seed});
+  std::mt19937_64 rng(seed);
+  std::mt19937_64 rolls(seed ^ 0x9e3779b97f4a7c15ull);
+  Table t(rng);
+  PlayerId next_id = 1;
+  std::unordered_map<PlayerId, Chips> chips;
+  auto add = [&] {
+    const auto id = next_id++;
+    if (journal(log, {.tag = InputTag::add_player, .who = id},
+                t.add_player(id))) {
+      chips[id] = kBuyIn;
+    }
+  };
+  // who the hand is waiting on after `events`, if anyone
+  auto after = [&](const std::vector<Event> &events,
+                   std::optional<PlayerId> turn = std::nullopt) {
+    for (const auto &ev : events) {
+      if (const auto *c = std::get_if<PlayerChips>(&ev)) {
+        chips[c->who] = c->chips;
+      } else if (const auto *n = std::get_if<TurnAdvanced>(&ev)) {
+        turn = n->next;
+      }
+    }
+    return t.hand_in_progress() ? turn : std::nullopt;
+  };
+  for (std::size_t i = 0; i < players; ++i) {
+    add();
+  }
+  for (std::size_t h = 0; h < hands; ++h) {
+    // replace the broke so the table keeps going
+    std::vector<PlayerId> broke;
+    for (const auto &[id, stack] : chips) {
+      if (stack == 0) {
+        broke.push_back(id);
+      }
+    }
+    std::sort(broke.begin(), broke.end());
+    for (const auto id : broke) {
+      (void)journal(log, {.tag = InputTag::remove_player, .who = id},
+                    t.remove_player(id));
+      chips.erase(id);
+      add();
+    }
+    auto started = journal(log, {.tag = InputTag::new_hand},
+                           t.handle_new_hand());
+    if (!started) {
+      break;
+    }
+    auto turn = after(*started);
+    while (turn) {
+      const auto who = *turn;
+      // now and then someone walks away, the player on the clock included
+      if (rolls() % 100 == 0 && chips.size() > 2) {
+        auto it = std::next(chips.begin(), static_cast<std::ptrdiff_t>(
+                                               rolls() % chips.size()));
+        const auto gone = it->first;
+        auto res = journal(log, {.tag = InputTag::remove_player, .who = gone},
+                           t.remove_player(gone));
+        chips.erase(gone);
+        add();
+        const auto still = gone == who ? std::nullopt : std::optional(who);
+        turn = res ? after(*res, still) : std::nullopt;
+        continue;
+      }
+      const auto view = t.seat_view(who);
+      const auto action = bot_action(who, *view, rolls() % 100);
+      auto res = journal(log, to_input(table, action), t.on_action(action));
+      if (!res) {
+        res = journal(log, to_input(table, Timeout{who}),
+                      t.on_action(Timeout{who}));
+      }
+      turn = res ? after(*res) : std::nullopt;
+    }
+    if (t.hand_in_progress()) {
+      // nobody left to act (everyone else walked); stop here
+      break;
+    }
+  }
+  return log;
+}
+
+} // namespace poker
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "append_file.h"
+#include "event_record.h"
+#include "player.h"
+#include "poker_rules.h"
+#include "table.h"
+
+// Offline compliance audit. The server journals every call it makes into a
+// Table -- the input, whether it failed and the events it returned -- to a
+// hand log. The auditor re-executes each table's journal against a fresh
+// Table seeded the same way and, independently of Table, rebuilds every
+// hand from its events: stacks, pot contributions, side pots and winners.
+// Tables are independent, so they are audited in parallel.
+namespace poker {
+
+inline constexpr std::string_view kHandLogMagic{"PKRHLOG1"};
+
+enum class InputTag : uint8_t {
+  open,       // a new table; `amount` holds its rng seed
+  add_player, // `amount` holds the buy-in, 0 for the default
+  remove_player,
+  new_hand,
+  fold,
+  bet,
+  timeout,
+  // Replication only, never in a hand log: state a standby needs to take
+  // over that is not a Table call.
+  credential, // `who` holds an account; `amount` is its token
+  revoke,     // `who` no longer does
+  house_bot,  // `who`, just seated at `table`, is a house bot
+  // A Table call again, last so the tags above keep their values:
+  // Table::clear, which a pooled fast-fold table gets after each hand.
+  clear
+};
+
+// One Table call. The `events` EventRecords it returned follow it in the
+// log.
+struct InputRecord {
+  InputTag tag{InputTag::open};
+  uint8_t failed{0}; // the call returned an error
+  uint16_t events{0};
+  uint32_t reserved{0};
+  TableId table{0};
+  PlayerId who{0};
+  Chips amount{0};
+};
+
+static_assert(std::is_trivially_copyable_v<InputRecord>);
+static_assert(sizeof(InputRecord) == 32);
+
+auto to_input(TableId table, const Action &action) -> InputRecord;
+
+// Appends `in` and its events in hand log format (without the magic).
+void append_input(std::string &out, const InputRecord &in,
+                  std::span<const Event> events);
+// Makes the Table call `in` records; std::nullopt if it fails. An open
+// input is a no-op: the caller seeds the Table. So are the replication
+// only inputs.
+auto replay_input(Table &table, const InputRecord &in)
+    -> std::optional<std::vector<Event>>;
+// True if `got` is what was journaled as `want`.
+bool same_events(std::span<const Event> got,
+                 std::span<const EventRecord> want);
+
+// A table's journal in call order; inputs[i] owns the next
+// inputs[i].events entries of `events`.
+struct TableLog {
+  TableId table{0};
+  uint64_t seed{0};
+  std::vector<InputRecord> inputs{};
+  std::vector<EventRecord> events{};
+};
+
+enum class AuditError : uint8_t { io, bad_format };
+
+auto to_string(AuditError e) -> std::string_view;
+
+// Appends journal entries on the caller's thread and leaves the disk to an
+// append_file::Writer. Everything appended is written by destruction.
+class HandLogWriter {
+public:
+  static auto open(const std::filesystem::path &path)
+      -> std::expected<std::unique_ptr<HandLogWriter>, AuditError>;
+
+  void append(InputRecord in, std::span<const Event> events);
+  // hands the current buffer to the writer thread
+  void flush();
+
+private:
+  explicit HandLogWriter(std::unique_ptr<append_file::Writer> file);
+
+  std::unique_ptr<append_file::Writer> file_;
+};
+
+// Splits a hand log into per-table journals, in order of first appearance.
+auto read_hand_log(const std::filesystem::path &path)
+    -> std::expected<std::vector<TableLog>, AuditError>;
+auto parse_hand_log(std::string_view bytes)
+    -> std::expected<std::vector<TableLog>, AuditError>;
+
+enum class Check : uint8_t {
+  replay,       // Table no longer reproduces the journal
+  stack,        // a stack does not follow from bets and winnings
+  conservation, // a hand paid out more or less than was bet
+  settlement    // side pots or winners differ from the rules
+};
+
+auto to_string(Check c) -> std::string_view;
+
+struct Finding {
+  TableId table;
+  uint64_t hand; // 1-based within the table; 0 outside any hand
+  Check check;
+  std::string detail;
+};
+
+struct AuditReport {
+  uint64_t tables{0};
+  uint64_t hands{0};
+  uint64_t inputs{0};
+  std::vector<Finding> findings;
+};
+
+auto audit_table(const TableLog &log) -> AuditReport;
+// Audits `logs` on `threads` workers (0 = one per core). Findings come back
+// ordered by table, then hand.
+auto audit(std::span<const TableLog> logs, unsigned threads = 0)
+    -> AuditReport;
+
+// Journal of `hands` hands of house-bot play between `players` seats; the
+// synthetic workload for tests, benches and `hand_audit --synthetic`.
+auto play_table(TableId table, uint64_t seed, std::size_t players,
+                std::size_t hands) -> TableLog;
+
+} // namespace poker
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#include "cards.h"
+
+namespace poker {
+
+// Starting hands collapse to 169 classes: 13 pairs, 78 suited and 78 offsuit
+// combinations. They are laid out on a 13x13 grid indexed by rank, with pairs
+// on the diagonal, suited classes at (high, low) and offsuit at (low, high).
+inline constexpr std::size_t kHandClasses = 169;
+inline constexpr std::size_t kRanks = 13;
+
+constexpr auto hand_class(cards::Card a, cards::Card b) -> uint8_t {
+  auto hi = std::to_underlying(a.rank);
+  auto lo = std::to_underlying(b.rank);
+  if (hi < lo) {
+    std::swap(hi, lo);
+  }
+  if (a.suit == b.suit) {
+    return static_cast<uint8_t>(hi * kRanks + lo);
+  }
+  return static_cast<uint8_t>(lo * kRanks + hi);
+}
+
+} // namespace poker
@@ -0,0 +1,100 @@
+#include "hand_history.h"
+
+#include <algorithm>
+#include <chrono>
+#include <type_traits>
+#include <utility>
+
+namespace poker {
+namespace {
+
+auto now_ms() -> uint64_t {
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+          std::chrono::system_clock::now().time_since_epoch())
+          .count());
+}
+
+} // namespace
+
+HandRecorder::HandRecorder(Sink sink) : sink_(std::move(sink)) {}
+
+auto HandRecorder::OpenHand::seat(PlayerId who) -> Seat & {
+  auto it = std::find_if(seats.begin(), seats.end(),
+                         [&](const Seat &s) { return s.who == who; });
+  if (it != seats.end()) {
+    return *it;
+  }
+  return seats.emplace_back(Seat{who, 0, 0, 0, 0, 0, 0});
+}
+
+void HandRecorder::observe(TableId table, const Event &ev) {
+  if (std::holds_alternative<HandStarted>(ev)) {
+    open_[table] =
+        OpenHand{next_hand_id_++, now_ms(), Phase::preflop, true, 0, {}};
+    return;
+  }
+  auto it = open_.find(table);
+  if (it == open_.end()) {
+    return;
+  }
+  auto &hand = it->second;
+  std::visit(
+      [&](const auto &e) {
+        using T = std::decay_t<decltype(e)>;
+        if constexpr (std::is_same_v<T, PlayerChips>) {
+          hand.seat(e.who);
+        } else if constexpr (std::is_same_v<T, PhaseAdvanced>) {
+          hand.phase = e.next;
+          hand.street_max = 0;
+          for (auto &s : hand.seats) {
+            s.street = 0;
+          }
+        } else if constexpr (std::is_same_v<T, TurnAdvanced>) {
+          hand.posting_blinds = false;
+        } else if constexpr (std::is_same_v<T, BetPlaced>) {
+          auto &s = hand.seat(e.who);
+          s.invested += e.amount;
+          s.street += e.amount;
+          if (!hand.posting_blinds && e.amount > 0) {
+            const bool raised = s.street > hand.street_max;
+            auto &tally = raised ? s.aggressive : s.passive;
+            tally = static_cast<uint8_t>(std::min(tally + 1, 255));
+            if (hand.phase == Phase::preflop) {
+              s.flags |= raised ? kVpip | kPfr : kVpip;
+            }
+          }
+          hand.street_max = std::max(hand.street_max, s.street);
+        } else if constexpr (std::is_same_v<T, WonPot>) {
+          hand.seat(e.who).won += e.amount;
+        } else if constexpr (std::is_same_v<T, ShowdownHand>) {
+          hand.seat(e.who).flags |= kShowdown;
+        }
+      },
+      ev);
+}
+
+void HandRecorder::finish(TableId table) {
+  auto it = open_.find(table);
+  if (it == open_.end()) {
+    return;
+  }
+  const auto &hand = it->second;
+  rows_.clear();
+  for (const auto &s : hand.seats) {
+    rows_.push_back(HandRow{hand.hand_id, hand.started_ms, table, s.who,
+                            s.invested, s.won, s.flags, s.aggressive,
+                            s.passive});
+  }
+  open_.erase(it);
+  sink_(rows_);
+}
+
+bool HandRecorder::in_hand(PlayerId who) const {
+  return std::ranges::any_of(open_, [&](const auto &entry) {
+    return std::ranges::any_of(entry.second.seats,
+                               [&](const Seat &s) { return s.who == who; });
+  });
+}
+
+} // namespace poker
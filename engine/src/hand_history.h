@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include "player.h"
+#include "poker_rules.h"
+#include "table.h"
+
+namespace poker {
+
+enum HandFlag : uint8_t {
+  kVpip = 1 << 0,     // put chips in preflop voluntarily
+  kPfr = 1 << 1,      // raised preflop
+  kShowdown = 1 << 2, // reached showdown
+};
+
+// One player's part in one completed hand; the unit the history store keeps
+// and the live stats count.
+struct HandRow {
+  uint64_t hand_id;
+  uint64_t started_ms; // unix epoch
+  TableId table;
+  PlayerId player;
+  Chips invested;
+  Chips won;
+  uint8_t flags;
+  uint8_t aggressive; // bets and raises, blinds excluded
+  uint8_t passive;    // calls
+};
+
+// Folds the event stream of every table into HandRows. The caller feeds the
+// events it publishes and calls finish() once a table's hand is over (the
+// Event stream has no explicit end-of-hand marker).
+class HandRecorder {
+public:
+  using Sink = std::function<void(std::span<const HandRow>)>;
+
+  explicit HandRecorder(Sink sink);
+
+  void observe(TableId table, const Event &ev);
+  void finish(TableId table);
+  // whether `who` has a seat in a hand not yet finished, so a row for them
+  // is still to come
+  bool in_hand(PlayerId who) const;
+
+private:
+  struct Seat {
+    PlayerId who;
+    Chips invested;
+    Chips street;
+    Chips won;
+    uint8_t flags;
+    uint8_t aggressive;
+    uint8_t passive;
+  };
+  struct OpenHand {
+    uint64_t hand_id;
+    uint64_t started_ms;
+    Phase phase{Phase::preflop};
+    bool posting_blinds{true};
+    Chips street_max{0};
+    std::vector<Seat> seats;
+
+    auto seat(PlayerId who) -> Seat &;
+  };
+
+  Sink sink_;
+  uint64_t next_hand_id_{1};
+  std::unordered_map<TableId, OpenHand> open_;
+  std::vector<HandRow> rows_;
+};
+
+} // namespace poker
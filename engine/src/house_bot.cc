@@ -0,0 +1,79 @@
+#include "house_bot.h"
+
+namespace poker {
+namespace {
+
+constexpr std::chrono::milliseconds kMinThink{600};
+constexpr std::chrono::milliseconds kMaxThink{2500};
+
+} // namespace
+
+// Doubled Chen thresholds: 20 is roughly TT+/AK, 12 any playable hand.
+auto bot_action(PlayerId id, const SeatView &view, uint32_t roll) -> Action {
+  const int score = kPreflopScore[hand_class(view.hole[0], view.hole[1])];
+  const Chips raise = view.to_call + view.min_raise;
+  if (view.phase == Phase::preflop) {
+    if (score >= 20 || (score >= 16 && roll < 50)) {
+      return Bet{id, raise};
+    }
+    if (score >= 12 || view.to_call == 0 || roll < 5) {
+      return Bet{id, view.to_call};
+    }
+    return Fold{id};
+  }
+  // no board reading after the flop: lean on starting strength and price
+  if (view.to_call == 0) {
+    if (score >= 16 && roll < 35) {
+      return Bet{id, view.min_raise};
+    }
+    return Bet{id, 0};
+  }
+  const bool cheap = view.to_call * 4 <= view.chips;
+  if (score >= 18 || (cheap && score >= 10) || roll < 10) {
+    return Bet{id, view.to_call};
+  }
+  return Fold{id};
+}
+
+HouseBots::HouseBots(uint64_t seed) : rng_(seed) {}
+
+void HouseBots::add(PlayerId id, TableId table) { bots_[id] = Bot{table, 0}; }
+
+void HouseBots::remove(PlayerId id) { bots_.erase(id); }
+
+bool HouseBots::is_bot(PlayerId id) const { return bots_.contains(id); }
+
+auto HouseBots::at_table(TableId table) const -> std::vector<PlayerId> {
+  std::vector<PlayerId> out;
+  for (const auto &[id, bot] : bots_) {
+    if (bot.table == table) {
+      out.push_back(id);
+    }
+  }
+  return out;
+}
+
+std::size_t HouseBots::size() const { return bots_.size(); }
+
+auto HouseBots::on_turn(TableId table, PlayerId bot) -> BotTurn {
+  auto &b = bots_.at(bot);
+  std::uniform_int_distribution<int64_t> think(kMinThink.count(),
+                                               kMaxThink.count());
+  return BotTurn{table, bot, ++b.seq, std::chrono::milliseconds{think(rng_)}};
+}
+
+bool HouseBots::is_current(const BotTurn &turn) const {
+  auto it = bots_.find(turn.bot);
+  return it != bots_.end() && it->second.seq == turn.seq;
+}
+
+auto HouseBots::decide(const BotTurn &turn, const Table &table) -> Action {
+  auto view = table.seat_view(turn.bot);
+  if (!view) {
+    return Timeout{turn.bot};
+  }
+  std::uniform_int_distribution<uint32_t> roll(0, 99);
+  return bot_action(turn.bot, *view, roll(rng_));
+}
+
+} // namespace poker
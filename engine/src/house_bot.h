@@ -0,0 +1,96 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "hand_class.h"
+#include "player.h"
+#include "table.h"
+
+namespace poker {
+
+// Chen formula score for every starting-hand class, doubled so the half
+// points stay integral (AA = 40, 72o = -3).
+inline constexpr std::array<int8_t, kHandClasses> kPreflopScore = [] {
+  constexpr auto high_card = [](int r) {
+    switch (r) {
+    case 12: // ace
+      return 20;
+    case 11: // king
+      return 16;
+    case 10: // queen
+      return 14;
+    case 9: // jack
+      return 12;
+    default:
+      return r + 2; // face value
+    }
+  };
+  constexpr std::array<int, 5> gap_penalty{0, 2, 4, 8, 10};
+  std::array<int8_t, kHandClasses> out{};
+  for (int hi = 0; hi < static_cast<int>(kRanks); ++hi) {
+    out[static_cast<std::size_t>(hi) * (kRanks + 1)] =
+        static_cast<int8_t>(std::max(2 * high_card(hi), 10));
+    for (int lo = 0; lo < hi; ++lo) {
+      const int gap = hi - lo - 1;
+      int score = high_card(hi) - gap_penalty[std::min(gap, 4)];
+      if (gap <= 1 && hi < 10) {
+        score += 2;
+      }
+      const auto h = static_cast<std::size_t>(hi);
+      const auto l = static_cast<std::size_t>(lo);
+      out[h * kRanks + l] = static_cast<int8_t>(score + 4); // suited
+      out[l * kRanks + h] = static_cast<int8_t>(score);
+    }
+  }
+  return out;
+}();
+
+// Picks an action for a seat from its starting-hand score and the price to
+// continue. `roll` is a uniform draw in [0, 100) that mixes the strategy.
+auto bot_action(PlayerId id, const SeatView &view, uint32_t roll) -> Action;
+
+// A bot decision waiting on the reactor. `seq` goes stale if the bot is
+// handed another turn (or leaves) before the delay expires.
+struct BotTurn {
+  TableId table;
+  PlayerId bot;
+  uint32_t seq;
+  std::chrono::milliseconds delay;
+};
+
+// In-process players that keep short-handed tables running. A bot is only a
+// PlayerId seated at a Table: it has no connection and acts directly through
+// Table::on_action.
+class HouseBots {
+public:
+  explicit HouseBots(uint64_t seed);
+
+  void add(PlayerId id, TableId table);
+  void remove(PlayerId id);
+  bool is_bot(PlayerId id) const;
+  auto at_table(TableId table) const -> std::vector<PlayerId>;
+  std::size_t size() const;
+
+  // Records that it is `bot`'s turn and draws a humanlike think time.
+  auto on_turn(TableId table, PlayerId bot) -> BotTurn;
+  bool is_current(const BotTurn &turn) const;
+  auto decide(const BotTurn &turn, const Table &table) -> Action;
+
+private:
+  struct Bot {
+    TableId table;
+    uint32_t seq;
+  };
+
+  std::unordered_map<PlayerId, Bot> bots_;
+  std::mt19937_64 rng_;
+};
+
+} // namespace poker
@@ -0,0 +1,264 @@
+#include "icm.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <random>
+
+namespace poker {
+namespace {
+
+// The players still holding chips, and how the rest split what they leave.
+struct Field {
+  std::vector<std::size_t> live; // indices into the stacks
+  std::size_t paid{0};           // places that pay, within the live field
+  double bust_share{0.0};        // each busted player's equity
+};
+
+auto field_of(std::span<const Chips> stacks, std::span<const double> payouts)
+    -> std::expected<Field, IcmError> {
+  if (std::ranges::any_of(
+          payouts, [](double p) { return !std::isfinite(p) || p < 0.0; })) {
+    return std::unexpected(IcmError::bad_payouts);
+  }
+  Field f;
+  for (std::size_t i = 0; i < stacks.size(); ++i) {
+    if (stacks[i] != 0) {
+      f.live.push_back(i);
+    }
+  }
+  if (f.live.empty()) {
+    return std::unexpected(IcmError::no_chips);
+  }
+  f.paid = std::min(f.live.size(), payouts.size());
+  const auto busted = stacks.size() - f.live.size();
+  if (busted != 0) {
+    const auto last = std::min(stacks.size(), payouts.size());
+    double left = 0.0;
+    for (std::size_t p = f.live.size(); p < last; ++p) {
+      left += payouts[p];
+    }
+    f.bust_share = left / static_cast<double>(busted);
+  }
+  return f;
+}
+
+// binom[k * (n + 1) + m] is C(m, k) for m <= n and k <= n + 1, a row per k
+auto binomials(std::size_t n) -> std::vector<std::size_t> {
+  const std::size_t stride = n + 1;
+  std::vector<std::size_t> binom((n + 2) * stride, 0);
+  for (std::size_t m = 0; m <= n; ++m) {
+    binom[m] = 1;
+    for (std::size_t k = 1; k <= m; ++k) {
+      binom[k * stride + m] =
+          binom[(k - 1) * stride + m - 1] + binom[k * stride + m - 1];
+    }
+  }
+  return binom;
+}
+
+// The next larger mask with as many bits set as `s`, which is not 0.
+auto next_set(uint64_t s) -> uint64_t {
+  const uint64_t low = s & -s;
+  const uint64_t up = s + low;
+  return (((up ^ s) >> 2) / low) | up;
+}
+
+// Live equities by one pass over every set of players in mask order.
+// reach[s] is the chance that the players in s take the top |s| places,
+// in some order; placed[s] is their chips. Adding a player only sets
+// higher bits, so the pass sees every set after all of the sets it grows
+// from.
+auto by_mask(std::span<const double> chips, std::span<const double> prizes)
+    -> std::vector<double> {
+  const auto n = chips.size();
+  const double total = std::accumulate(chips.begin(), chips.end(), 0.0);
+  const std::size_t sets = std::size_t{1} << n;
+  std::vector<double> reach(sets, 0.0);
+  std::vector<double> placed(sets, 0.0);
+  std::vector<double> equity(n, 0.0);
+  reach[0] = 1.0;
+  for (std::size_t s = 0; s < sets; ++s) {
+    if (s != 0) {
+      const auto low = static_cast<std::size_t>(std::countr_zero(s));
+      placed[s] = placed[s & (s - 1)] + chips[low];
+    }
+    const auto place = static_cast<std::size_t>(std::popcount(s));
+    if (reach[s] == 0.0 || place >= prizes.size()) {
+      continue;
+    }
+    const double scale = reach[s] / (total - placed[s]);
+    for (std::size_t j = 0; j < n; ++j) {
+      const std::size_t bit = std::size_t{1} << j;
+      if ((s & bit) != 0) {
+        continue;
+      }
+      const double p = scale * chips[j];
+      equity[j] += p * prizes[place];
+      reach[s | bit] += p;
+    }
+  }
+  return equity;
+}
+
+// The same DP over only the sets smaller than the paid places, one size
+// at a time. The sets of a size are taken in colex order, which is rising
+// order of their masks, and reach[r] is for the set of rank r among them:
+// the sum of C(e, i + 1) over its i-th lowest member e.
+auto by_size(std::span<const double> chips, std::span<const double> prizes,
+             std::span<const std::size_t> binom) -> std::vector<double> {
+  const auto n = chips.size();
+  const std::size_t stride = n + 1;
+  const double total = std::accumulate(chips.begin(), chips.end(), 0.0);
+  std::vector<double> reach{1.0};
+  std::vector<double> equity(n, 0.0);
+  for (std::size_t place = 0; place < prizes.size(); ++place) {
+    const bool last = place + 1 == prizes.size();
+    std::vector<double> next(last ? 0 : binom[(place + 1) * stride + n], 0.0);
+    uint64_t s = (uint64_t{1} << place) - 1;
+    for (std::size_t rank = 0; rank < reach.size(); ++rank) {
+      if (rank != 0) {
+        s = next_set(s);
+      }
+      if (reach[rank] == 0.0) {
+        continue;
+      }
+      // Joining j moves the members past it up a place: `above` is what
+      // they add to a rank then, `below` what the members before j add.
+      double placed = 0.0;
+      std::size_t above = 0;
+      std::size_t i = 0;
+      for (uint64_t rest = s; rest != 0; rest &= rest - 1, ++i) {
+        const auto e = static_cast<std::size_t>(std::countr_zero(rest));
+        placed += chips[e];
+        above += binom[(i + 2) * stride + e];
+      }
+      const double scale = reach[rank] / (total - placed);
+      std::size_t below = 0;
+      std::size_t j = 0;
+      i = 0;
+      // the players not yet placed, a gap between members at a time
+      for (uint64_t rest = s;; rest &= rest - 1, ++i) {
+        const auto member =
+            rest != 0 ? static_cast<std::size_t>(std::countr_zero(rest)) : n;
+        const std::size_t base = below + above;
+        const std::size_t *row = &binom[(i + 1) * stride];
+        for (; j < member; ++j) {
+          const double p = scale * chips[j];
+          equity[j] += p * prizes[place];
+          if (!last) {
+            next[base + row[j]] += p;
+          }
+        }
+        if (member == n) {
+          break;
+        }
+        below += row[member];
+        above -= binom[(i + 2) * stride + member];
+        j = member + 1;
+      }
+    }
+    reach = std::move(next);
+  }
+  return equity;
+}
+
+auto spread(std::span<const Chips> stacks, const Field &f,
+            std::span<const double> live_equity) -> std::vector<double> {
+  std::vector<double> out(stacks.size(), f.bust_share);
+  for (std::size_t j = 0; j < f.live.size(); ++j) {
+    out[f.live[j]] = live_equity[j];
+  }
+  return out;
+}
+
+} // namespace
+
+auto to_string(IcmError e) -> std::string_view {
+  switch (e) {
+  case IcmError::no_chips:
+    return "no_chips";
+  case IcmError::bad_payouts:
+    return "bad_payouts";
+  case IcmError::too_many_players:
+    return "too_many_players";
+  }
+  return "unknown";
+}
+
+auto icm_exact(std::span<const Chips> stacks, std::span<const double> payouts)
+    -> std::expected<std::vector<double>, IcmError> {
+  const auto field = field_of(stacks, payouts);
+  if (!field) {
+    return std::unexpected(field.error());
+  }
+  const auto n = field->live.size();
+  if (n > kIcmExactMax) {
+    return std::unexpected(IcmError::too_many_players);
+  }
+  std::vector<double> chips(n);
+  for (std::size_t j = 0; j < n; ++j) {
+    chips[j] = static_cast<double>(stacks[field->live[j]]);
+  }
+  const auto binom = binomials(n);
+  std::size_t expanded = 0;
+  for (std::size_t k = 0; k < field->paid; ++k) {
+    expanded += binom[k * (n + 1) + n];
+  }
+  // the pass over every subset is the quicker when most of them count
+  const auto equity = 2 * expanded > std::size_t{1} << n
+                          ? by_mask(chips, payouts.first(field->paid))
+                          : by_size(chips, payouts.first(field->paid), binom);
+  return spread(stacks, *field, equity);
+}
+
+auto icm_monte_carlo(std::span<const Chips> stacks,
+                     std::span<const double> payouts, uint32_t trials,
+                     uint64_t seed)
+    -> std::expected<std::vector<double>, IcmError> {
+  const auto field = field_of(stacks, payouts);
+  if (!field) {
+    return std::unexpected(field.error());
+  }
+  const auto n = field->live.size();
+  std::vector<double> rate(n);
+  for (std::size_t j = 0; j < n; ++j) {
+    rate[j] = 1.0 / static_cast<double>(stacks[field->live[j]]);
+  }
+
+  // Ordering players by an exponential draw with rate equal to their chips
+  // gives exactly the Malmuth-Harville order, so a trial is n draws and a
+  // partial sort of the paid places.
+  std::mt19937_64 rng(seed);
+  std::exponential_distribution<double> draw;
+  std::vector<std::pair<double, uint32_t>> keys(n);
+  std::vector<double> won(n, 0.0);
+  const auto paid = static_cast<std::ptrdiff_t>(field->paid);
+  for (uint32_t t = 0; t < trials; ++t) {
+    for (std::size_t j = 0; j < n; ++j) {
+      keys[j] = {draw(rng) * rate[j], static_cast<uint32_t>(j)};
+    }
+    std::partial_sort(keys.begin(), keys.begin() + paid, keys.end());
+    for (std::size_t p = 0; p < field->paid; ++p) {
+      won[keys[p].second] += payouts[p];
+    }
+  }
+  for (auto &w : won) {
+    w /= std::max<double>(trials, 1);
+  }
+  return spread(stacks, *field, won);
+}
+
+auto icm_equities(std::span<const Chips> stacks,
+                  std::span<const double> payouts, const IcmOptions &opts)
+    -> std::expected<std::vector<double>, IcmError> {
+  auto exact = icm_exact(stacks, payouts);
+  if (exact || exact.error() != IcmError::too_many_players) {
+    return exact;
+  }
+  return icm_monte_carlo(stacks, payouts, opts.trials, opts.seed);
+}
+
+} // namespace poker
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "poker_rules.h"
+
+// Independent Chip Model equities for a tournament's remaining stacks.
+// Finishing orders follow Malmuth-Harville: each place goes to a remaining
+// player with probability proportional to their chips. Equity is the prize
+// money each player expects over those orders.
+//
+// `payouts[p]` is the prize for place p + 1, highest first; places past its
+// end pay nothing and payouts past the field are ignored. Players with no
+// chips share the places below everyone still in. Results follow the order
+// of `stacks`.
+namespace poker {
+
+// Live players the exact mode takes. With every place paid it visits all
+// 2^n subsets of them.
+inline constexpr std::size_t kIcmExactMax = 20;
+
+enum class IcmError : uint8_t { no_chips, bad_payouts, too_many_players };
+
+auto to_string(IcmError e) -> std::string_view;
+
+// Exact, by a DP over the sets of players already placed. Only sets
+// smaller than the number of paid places are visited, so three paid
+// places take a few hundred sets even at kIcmExactMax.
+auto icm_exact(std::span<const Chips> stacks, std::span<const double> payouts)
+    -> std::expected<std::vector<double>, IcmError>;
+
+// An estimate from `trials` sampled finishing orders, for fields too big
+// for the DP. The standard error of each equity is below
+// payouts[0] / (2 * sqrt(trials)).
+auto icm_monte_carlo(std::span<const Chips> stacks,
+                     std::span<const double> payouts, uint32_t trials,
+                     uint64_t seed)
+    -> std::expected<std::vector<double>, IcmError>;
+
+struct IcmOptions {
+  uint32_t trials{200'000}; // when the field is past kIcmExactMax
+  uint64_t seed{1};
+};
+
+// icm_exact when the live field allows it, else icm_monte_carlo.
+auto icm_equities(std::span<const Chips> stacks,
+                  std::span<const double> payouts, const IcmOptions &opts = {})
+    -> std::expected<std::vector<double>, IcmError>;
+
+} // namespace poker
@@ -0,0 +1,55 @@
+#include "io.h"
+
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/random.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace reactor {
+namespace {
+
+class SystemIo final : public Io {
+public:
+  ssize_t read(int fd, void *buf, std::size_t n) override {
+    return ::read(fd, buf, n);
+  }
+  ssize_t write(int fd, const void *buf, std::size_t n) override {
+    return ::write(fd, buf, n);
+  }
+  int accept(int listenfd) override {
+    const int fd = ::accept4(listenfd, nullptr, nullptr, SOCK_NONBLOCK);
+    if (fd >= 0) {
+      // frames are flushed whole once per tick; Nagle would hold the next
+      // one until the client's delayed ACK
+      const int one = 1;
+      ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+    return fd;
+  }
+  int close(int fd) override { return ::close(fd); }
+  int epoll_ctl(int epfd, int op, int fd, epoll_event *ev) override {
+    return ::epoll_ctl(epfd, op, fd, ev);
+  }
+  int epoll_wait(int epfd, epoll_event *events, int max_events,
+                 int timeout_ms) override {
+    return ::epoll_wait(epfd, events, max_events, timeout_ms);
+  }
+  auto now() -> Clock::time_point override { return Clock::now(); }
+  uint64_t random() override {
+    uint64_t v = 0;
+    // the urandom pool never blocks once the system is up
+    while (::getrandom(&v, sizeof(v), 0) != sizeof(v)) {
+    }
+    return v;
+  }
+};
+
+} // namespace
+
+auto system_io() -> Io & {
+  static SystemIo io;
+  return io;
+}
+
+} // namespace reactor
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <sys/epoll.h>
+#include <sys/types.h>
+
+namespace reactor {
+
+using Clock = std::chrono::steady_clock;
+
+// The system calls and clock the reactor and Server run on. Production uses
+// system_io(); a simulation (see sim.h) stands in an in-memory network and
+// a virtual clock. Calls follow the syscalls they replace: -1 and errno on
+// failure.
+class Io {
+public:
+  virtual ~Io() = default;
+
+  virtual ssize_t read(int fd, void *buf, std::size_t n) = 0;
+  virtual ssize_t write(int fd, const void *buf, std::size_t n) = 0;
+  // the accepted fd is already non-blocking
+  virtual int accept(int listenfd) = 0;
+  virtual int close(int fd) = 0;
+  virtual int epoll_ctl(int epfd, int op, int fd, epoll_event *ev) = 0;
+  virtual int epoll_wait(int epfd, epoll_event *events, int max_events,
+                         int timeout_ms) = 0;
+  virtual auto now() -> Clock::time_point = 0;
+  // 64 bits a client cannot guess, for the secrets handed to players
+  virtual uint64_t random() = 0;
+};
+
+// The kernel and steady_clock.
+auto system_io() -> Io &;
+
+} // namespace reactor
@@ -0,0 +1,239 @@
+#include "leaderboard.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace poker {
+
+void RankTree::set(PlayerId id, int64_t score) {
+  auto &slot = node_of_[id]; // 0 for a new player
+  if (slot != 0) {
+    // take the node out, then put it back where its new score goes
+    auto &node = nodes_[slot];
+    auto [l, rest] = split(root_, node, false);
+    auto [mid, r] = split(rest, node, true);
+    root_ = merge(l, r);
+    (void)mid;
+  } else {
+    // xorshift: treap priorities only need to look random
+    prio_state_ ^= prio_state_ << 13;
+    prio_state_ ^= prio_state_ >> 7;
+    prio_state_ ^= prio_state_ << 17;
+    slot = static_cast<uint32_t>(nodes_.size());
+    nodes_.push_back({0, id, 0, 0, 1, static_cast<uint32_t>(prio_state_)});
+  }
+  auto &node = nodes_[slot];
+  node.score = score;
+  node.left = node.right = 0;
+  node.size = 1;
+  auto [l, r] = split(root_, node, false);
+  root_ = merge(merge(l, slot), r);
+}
+
+auto RankTree::score(PlayerId id) const -> std::optional<int64_t> {
+  const auto it = node_of_.find(id);
+  if (it == node_of_.end()) {
+    return std::nullopt;
+  }
+  return nodes_[it->second].score;
+}
+
+auto RankTree::rank(PlayerId id) const -> std::optional<uint64_t> {
+  const auto it = node_of_.find(id);
+  if (it == node_of_.end()) {
+    return std::nullopt;
+  }
+  const auto &key = nodes_[it->second];
+  uint64_t ahead_of = 0;
+  for (auto t = root_; t != 0;) {
+    const auto &n = nodes_[t];
+    if (ahead(n, key)) {
+      ahead_of += nodes_[n.left].size + 1;
+      t = n.right;
+    } else if (ahead(key, n)) {
+      t = n.left;
+    } else {
+      return ahead_of + nodes_[n.left].size + 1;
+    }
+  }
+  return std::nullopt;
+}
+
+auto RankTree::at(uint64_t rank) const -> std::optional<LeaderEntry> {
+  if (rank == 0 || rank > size()) {
+    return std::nullopt;
+  }
+  auto k = rank;
+  for (auto t = root_;;) {
+    const auto &n = nodes_[t];
+    const auto left = nodes_[n.left].size;
+    if (k <= left) {
+      t = n.left;
+    } else if (k == left + 1) {
+      return LeaderEntry{rank, n.id, n.score};
+    } else {
+      k -= left + 1;
+      t = n.right;
+    }
+  }
+}
+
+std::size_t RankTree::size() const { return nodes_[root_].size; }
+
+void RankTree::update(uint32_t t) {
+  auto &n = nodes_[t];
+  n.size = nodes_[n.left].size + nodes_[n.right].size + 1;
+}
+
+auto RankTree::split(uint32_t t, const Node &key, bool inclusive)
+    -> std::pair<uint32_t, uint32_t> {
+  if (t == 0) {
+    return {0, 0};
+  }
+  auto &n = nodes_[t];
+  const bool goes_left = ahead(n, key) || (inclusive && n.id == key.id);
+  if (goes_left) {
+    auto [l, r] = split(n.right, key, inclusive);
+    nodes_[t].right = l;
+    update(t);
+    return {t, r};
+  }
+  auto [l, r] = split(n.left, key, inclusive);
+  nodes_[t].left = r;
+  update(t);
+  return {l, t};
+}
+
+auto RankTree::merge(uint32_t l, uint32_t r) -> uint32_t {
+  if (l == 0 || r == 0) {
+    return l | r;
+  }
+  if (nodes_[l].prio > nodes_[r].prio) {
+    nodes_[l].right = merge(nodes_[l].right, r);
+    update(l);
+    return l;
+  }
+  nodes_[r].left = merge(l, nodes_[r].left);
+  update(r);
+  return r;
+}
+
+Leaderboard::Leaderboard() : worker_([this] { run(); }) {}
+
+Leaderboard::~Leaderboard() {
+  {
+    std::lock_guard lock(mu_);
+    stop_ = true;
+  }
+  cv_.notify_one();
+  worker_.join();
+}
+
+void Leaderboard::record(std::span<const HandRow> rows) {
+  if (rows.empty()) {
+    return;
+  }
+  {
+    std::lock_guard lock(mu_);
+    for (const auto &row : rows) {
+      queue_.push_back({row.player, static_cast<int64_t>(row.won) -
+                                        static_cast<int64_t>(row.invested)});
+    }
+    ++queued_;
+  }
+  cv_.notify_one();
+}
+
+void Leaderboard::sync() {
+  std::unique_lock lock(mu_);
+  applied_cv_.wait(lock, [&] { return applied_ == queued_; });
+}
+
+auto Leaderboard::rank(Board board, PlayerId id) const
+    -> std::optional<uint64_t> {
+  std::shared_lock lock(trees_mu_);
+  return trees_[std::to_underlying(board)].rank(id);
+}
+
+auto Leaderboard::score(Board board, PlayerId id) const
+    -> std::optional<int64_t> {
+  std::shared_lock lock(trees_mu_);
+  return trees_[std::to_underlying(board)].score(id);
+}
+
+auto Leaderboard::page(Board board, std::size_t n) const
+    -> std::shared_ptr<const LeaderPage> {
+  if (n >= kCachedPages) {
+    return nullptr;
+  }
+  std::lock_guard lock(pages_mu_);
+  return pages_[std::to_underlying(board)][n];
+}
+
+void Leaderboard::run() {
+  std::vector<Delta> batch;
+  for (;;) {
+    uint64_t upto;
+    {
+      std::unique_lock lock(mu_);
+      cv_.wait(lock, [&] { return stop_ || queued_ != applied_; });
+      if (queued_ == applied_) {
+        return;
+      }
+      batch.swap(queue_);
+      upto = queued_;
+    }
+    apply(batch);
+    batch.clear();
+    {
+      std::lock_guard lock(mu_);
+      applied_ = upto;
+    }
+    applied_cv_.notify_all();
+  }
+}
+
+void Leaderboard::apply(std::vector<Delta> &batch) {
+  // one tree update per player however many hands they finished
+  std::sort(batch.begin(), batch.end(),
+            [](const Delta &a, const Delta &b) { return a.who < b.who; });
+  {
+    std::unique_lock lock(trees_mu_);
+    auto &net = trees_[std::to_underlying(Board::net_winnings)];
+    auto &hands = trees_[std::to_underlying(Board::hands)];
+    for (auto it = batch.begin(); it != batch.end();) {
+      const auto who = it->who;
+      int64_t won = 0;
+      int64_t played = 0;
+      for (; it != batch.end() && it->who == who; ++it) {
+        won += it->net;
+        ++played;
+      }
+      net.set(who, net.score(who).value_or(0) + won);
+      hands.set(who, hands.score(who).value_or(0) + played);
+    }
+  }
+  // only this thread writes the trees, so reading them needs no lock
+  std::array<Pages, kBoards> pages{build_pages(Board::net_winnings),
+                                   build_pages(Board::hands)};
+  std::lock_guard lock(pages_mu_);
+  pages_ = std::move(pages);
+}
+
+auto Leaderboard::build_pages(Board board) const -> Pages {
+  const auto &tree = trees_[std::to_underlying(board)];
+  Pages pages{};
+  for (std::size_t p = 0; p < kCachedPages; ++p) {
+    auto page = std::make_shared<LeaderPage>();
+    page->players = tree.size();
+    for (std::size_t i = 0; i < kLeaderPageSize; ++i) {
+      if (auto entry = tree.at(p * kLeaderPageSize + i + 1)) {
+        page->entries.push_back(*entry);
+      }
+    }
+    pages[p] = std::move(page);
+  }
+  return pages;
+}
+
+} // namespace poker
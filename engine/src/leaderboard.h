@@ -0,0 +1,128 @@
+#pragma once
+
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <span>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "hand_history.h"
+#include "player.h"
+
+// Live leaderboards over every player who has finished a hand. Scores live
+// in order-statistic trees, so moving a player or asking their rank costs
+// O(log n) however many players there are, and the first pages of each
+// board are kept ready to hand to clients.
+namespace poker {
+
+enum class Board : uint8_t { net_winnings, hands };
+inline constexpr std::size_t kBoards = 2;
+inline constexpr std::size_t kLeaderPageSize = 20;
+inline constexpr std::size_t kCachedPages = 5;
+
+struct LeaderEntry {
+  uint64_t rank; // 1-based
+  PlayerId player;
+  int64_t score;
+};
+
+struct LeaderPage {
+  uint64_t players; // on the board in all
+  std::vector<LeaderEntry> entries;
+};
+
+// Players ordered by score, highest first and ties to the lower id, in a
+// treap whose nodes count their subtrees. Nodes sit in one flat pool and
+// are found by PlayerId through a hash map, so ids need not be dense.
+class RankTree {
+public:
+  // Sets `id`'s score, adding the player if new.
+  void set(PlayerId id, int64_t score);
+  auto score(PlayerId id) const -> std::optional<int64_t>;
+  auto rank(PlayerId id) const -> std::optional<uint64_t>;
+  // The player at 1-based `rank`.
+  auto at(uint64_t rank) const -> std::optional<LeaderEntry>;
+  std::size_t size() const;
+
+private:
+  struct Node {
+    int64_t score;
+    PlayerId id;
+    uint32_t left;
+    uint32_t right;
+    uint32_t size;
+    uint32_t prio;
+  };
+
+  // a goes ahead of b
+  static bool ahead(const Node &a, const Node &b) {
+    return a.score != b.score ? a.score > b.score : a.id < b.id;
+  }
+  void update(uint32_t t);
+  // Splits `t` into the nodes ahead of `key` and the rest; with `inclusive`
+  // `key` itself goes left.
+  auto split(uint32_t t, const Node &key, bool inclusive)
+      -> std::pair<uint32_t, uint32_t>;
+  auto merge(uint32_t l, uint32_t r) -> uint32_t;
+
+  std::vector<Node> nodes_{Node{}}; // nodes_[0] is the empty tree
+  std::unordered_map<PlayerId, uint32_t> node_of_;
+  uint32_t root_{0};
+  uint64_t prio_state_{0x9e3779b97f4a7c15ull};
+};
+
+// Both boards, fed the rows a HandRecorder produces. The reactor only
+// queues each hand's results; a background thread applies them and
+// refreshes the cached pages, and readers on any thread take rank queries
+// and pages without waiting on the game.
+class Leaderboard {
+public:
+  Leaderboard();
+  Leaderboard(const Leaderboard &) = delete;
+  Leaderboard &operator=(const Leaderboard &) = delete;
+  ~Leaderboard();
+
+  void record(std::span<const HandRow> rows);
+  // Waits until everything recorded so far is on the boards.
+  void sync();
+
+  auto rank(Board board, PlayerId id) const -> std::optional<uint64_t>;
+  auto score(Board board, PlayerId id) const -> std::optional<int64_t>;
+  // Page `n` as of the last update; nullptr past the cached pages.
+  auto page(Board board, std::size_t n) const
+      -> std::shared_ptr<const LeaderPage>;
+
+private:
+  struct Delta {
+    PlayerId who;
+    int64_t net;
+  };
+  using Pages = std::array<std::shared_ptr<const LeaderPage>, kCachedPages>;
+
+  void run();
+  void apply(std::vector<Delta> &batch);
+  auto build_pages(Board board) const -> Pages;
+
+  std::array<RankTree, kBoards> trees_;
+  mutable std::shared_mutex trees_mu_;
+  std::array<Pages, kBoards> pages_{};
+  mutable std::mutex pages_mu_;
+
+  std::mutex mu_;
+  std::condition_variable cv_;
+  std::condition_variable applied_cv_;
+  std::vector<Delta> queue_;
+  uint64_t queued_{0};
+  uint64_t applied_{0};
+  bool stop_{false};
+  std::thread worker_;
+};
+
+} // namespace poker
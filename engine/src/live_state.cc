@@ -0,0 +1,316 @@
+#include "live_state.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+#include <spdlog/spdlog.h>
+
+namespace live {
+namespace {
+
+constexpr uint32_t kVersion = 1;
+constexpr std::size_t kWords = sizeof(TableSummary) / sizeof(uint64_t);
+
+struct FileHeader {
+  std::array<char, 8> magic;
+  uint32_t version;
+  uint32_t capacity;
+  uint32_t slot_size;
+  uint32_t reserved;
+  uint64_t used; // slots handed out so far; only grows
+};
+
+// `seq` is odd while the writer is inside `words`. Every field is accessed
+// through atomic_ref so a reader racing the writer is well defined and
+// simply retries.
+struct alignas(64) Slot {
+  uint64_t seq;
+  std::array<uint64_t, kWords> words;
+};
+
+constexpr std::size_t kSlotsOffset = 64;
+static_assert(sizeof(FileHeader) <= kSlotsOffset);
+
+auto file_size(uint32_t capacity) -> std::size_t {
+  return kSlotsOffset + std::size_t{capacity} * sizeof(Slot);
+}
+
+auto seat_of(TableSummary &s, poker::PlayerId who) -> Seat * {
+  const auto end = s.seats.begin() + s.seated;
+  const auto it = std::find_if(
+      s.seats.begin(), end, [&](const Seat &seat) { return seat.who == who; });
+  return it == end ? nullptr : &*it;
+}
+
+void clear_bets(TableSummary &s) {
+  for (auto &seat : s.seats) {
+    seat.bet = 0;
+  }
+}
+
+} // namespace
+
+void apply(TableSummary &s, const poker::Event &ev) {
+  if (const auto *e = std::get_if<poker::PlayerAdded>(&ev)) {
+    if (s.seated < s.seats.size()) {
+      s.seats[s.seated++] = {e->who, kBuyIn, 0};
+    }
+  } else if (const auto *e = std::get_if<poker::PlayerRemoved>(&ev)) {
+    if (auto *seat = seat_of(s, e->who)) {
+      std::copy(seat + 1, s.seats.data() + s.seated, seat);
+      s.seats[--s.seated] = {};
+    }
+  } else if (std::holds_alternative<poker::HandStarted>(ev)) {
+    ++s.hands;
+    s.pot = 0;
+    s.actor = 0;
+    s.board_size = 0;
+    clear_bets(s);
+  } else if (const auto *e = std::get_if<poker::PhaseAdvanced>(&ev)) {
+    s.phase = e->next;
+    clear_bets(s);
+  } else if (const auto *e = std::get_if<poker::BetPlaced>(&ev)) {
+    s.pot += e->amount;
+    if (auto *seat = seat_of(s, e->who)) {
+      seat->bet += e->amount;
+    }
+  } else if (const auto *e = std::get_if<poker::PlayerChips>(&ev)) {
+    if (auto *seat = seat_of(s, e->who)) {
+      seat->stack = e->chips;
+    }
+  } else if (const auto *e = std::get_if<poker::TurnAdvanced>(&ev)) {
+    s.actor = e->next;
+  } else if (const auto *e = std::get_if<poker::WonPot>(&ev)) {
+    s.pot -= std::min(s.pot, e->amount);
+    if (s.pot == 0) { // the last pot is paid: the hand is over
+      s.phase = poker::Phase::holding;
+      s.actor = 0;
+      clear_bets(s);
+    }
+  } else if (const auto *e = std::get_if<poker::DealtFlop>(&ev)) {
+    for (const auto card : e->flop) {
+      s.board[s.board_size++] = cards::to_card_id(card);
+    }
+  } else if (const auto *e = std::get_if<poker::DealtStreet>(&ev)) {
+    if (s.board_size < s.board.size()) {
+      s.board[s.board_size++] = cards::to_card_id(e->street);
+    }
+  }
+  // hole cards and showdowns are not part of the public summary
+}
+
+auto to_string(LiveError e) -> std::string_view {
+  switch (e) {
+  case LiveError::io:
+    return "io";
+  case LiveError::bad_format:
+    return "bad_format";
+  }
+  return "unknown";
+}
+
+Publisher::Publisher(std::byte *base, std::size_t size, uint32_t capacity)
+    : base_(base), size_(size), capacity_(capacity) {}
+
+Publisher::~Publisher() { munmap(base_, size_); }
+
+auto Publisher::open(const std::filesystem::path &path, uint32_t capacity)
+    -> std::expected<std::unique_ptr<Publisher>, LiveError> {
+  // a fresh inode, so readers of a previous run keep their old mapping
+  // rather than faulting on a truncated one
+  std::error_code ec;
+  std::filesystem::remove(path, ec);
+  const int fd =
+      ::open(path.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    return std::unexpected(LiveError::io);
+  }
+  const auto size = file_size(capacity);
+  if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+    ::close(fd);
+    return std::unexpected(LiveError::io);
+  }
+  void *map = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (map == MAP_FAILED) {
+    return std::unexpected(LiveError::io);
+  }
+  FileHeader h{};
+  std::copy(kMagic.begin(), kMagic.end(), h.magic.begin());
+  h.version = kVersion;
+  h.capacity = capacity;
+  h.slot_size = sizeof(Slot);
+  std::memcpy(map, &h, sizeof(h));
+  return std::unique_ptr<Publisher>(
+      new Publisher(static_cast<std::byte *>(map), size, capacity));
+}
+
+void Publisher::apply(poker::TableId table,
+                      std::span<const poker::Event> events) {
+  auto it = tables_.find(table);
+  if (it == tables_.end()) {
+    if (tables_.size() >= capacity_) {
+      if (!std::exchange(full_warned_, true)) {
+        spdlog::warn("Live state is full ({} tables); table {} and later "
+                     "ones are not published",
+                     capacity_, table);
+      }
+      return;
+    }
+    const auto slot = static_cast<uint32_t>(tables_.size());
+    it = tables_.emplace(table, Entry{slot, TableSummary{.table = table}})
+             .first;
+  }
+  for (const auto &ev : events) {
+    live::apply(it->second.summary, ev);
+  }
+  publish(it->second);
+}
+
+void Publisher::clear(poker::TableId table) {
+  const auto it = tables_.find(table);
+  if (it == tables_.end()) {
+    return;
+  }
+  auto &summary = it->second.summary;
+  summary = TableSummary{.table = table, .hands = summary.hands};
+  publish(it->second);
+}
+
+void Publisher::publish(const Entry &entry) {
+  const auto &[slot_index, summary] = entry;
+  auto *slot = reinterpret_cast<Slot *>(base_ + kSlotsOffset) + slot_index;
+  std::array<uint64_t, kWords> words;
+  std::memcpy(words.data(), &summary, sizeof(summary));
+  std::atomic_ref<uint64_t> seq(slot->seq);
+  const auto s = seq.load(std::memory_order_relaxed);
+  seq.store(s + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  for (std::size_t i = 0; i < kWords; ++i) {
+    std::atomic_ref<uint64_t>(slot->words[i])
+        .store(words[i], std::memory_order_relaxed);
+  }
+  seq.store(s + 2, std::memory_order_release);
+
+  // readers only look at slots below `used`
+  auto *header = reinterpret_cast<FileHeader *>(base_);
+  std::atomic_ref<uint64_t> used(header->used);
+  if (used.load(std::memory_order_relaxed) <= slot_index) {
+    used.store(slot_index + 1, std::memory_order_release);
+  }
+}
+
+Reader::Reader(const std::byte *base, std::size_t size)
+    : base_(base), size_(size) {}
+
+Reader::Reader(Reader &&other) noexcept
+    : base_(std::exchange(other.base_, nullptr)),
+      size_(std::exchange(other.size_, 0)) {}
+
+Reader &Reader::operator=(Reader &&other) noexcept {
+  if (this != &other) {
+    if (base_ != nullptr) {
+      munmap(const_cast<std::byte *>(base_), size_);
+    }
+    base_ = std::exchange(other.base_, nullptr);
+    size_ = std::exchange(other.size_, 0);
+  }
+  return *this;
+}
+
+Reader::~Reader() {
+  if (base_ != nullptr) {
+    munmap(const_cast<std::byte *>(base_), size_);
+  }
+}
+
+auto Reader::open(const std::filesystem::path &path)
+    -> std::expected<Reader, LiveError> {
+  const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return std::unexpected(LiveError::io);
+  }
+  struct stat st{};
+  if (fstat(fd, &st) != 0) {
+    ::close(fd);
+    return std::unexpected(LiveError::io);
+  }
+  const auto size = static_cast<std::size_t>(st.st_size);
+  if (size < kSlotsOffset) {
+    ::close(fd);
+    return std::unexpected(LiveError::bad_format);
+  }
+  void *map = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (map == MAP_FAILED) {
+    return std::unexpected(LiveError::io);
+  }
+  Reader reader(static_cast<const std::byte *>(map), size);
+
+  FileHeader h;
+  std::memcpy(&h, reader.base_, sizeof(h));
+  if (std::string_view(h.magic.data(), h.magic.size()) != kMagic ||
+      h.version != kVersion || h.slot_size != sizeof(Slot) ||
+      size < file_size(h.capacity)) {
+    return std::unexpected(LiveError::bad_format);
+  }
+  return reader;
+}
+
+uint32_t Reader::capacity() const {
+  return reinterpret_cast<const FileHeader *>(base_)->capacity;
+}
+
+bool Reader::read(uint32_t slot_index, TableSummary &out) const {
+  if (slot_index >= capacity()) {
+    return false;
+  }
+  // the mapping is read-only; atomic_ref is only ever used to load from it
+  auto *slot = const_cast<Slot *>(
+      reinterpret_cast<const Slot *>(base_ + kSlotsOffset) + slot_index);
+  std::atomic_ref<uint64_t> seq(slot->seq);
+  std::array<uint64_t, kWords> words;
+  while (true) {
+    const auto before = seq.load(std::memory_order_acquire);
+    if (before == 0) {
+      return false; // never published
+    }
+    if (before % 2 != 0) {
+      continue; // a write is in progress
+    }
+    for (std::size_t i = 0; i < kWords; ++i) {
+      words[i] = std::atomic_ref<uint64_t>(slot->words[i])
+                     .load(std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (seq.load(std::memory_order_relaxed) == before) {
+      break;
+    }
+  }
+  std::memcpy(static_cast<void *>(&out), words.data(), sizeof(out));
+  return true;
+}
+
+auto Reader::snapshot() const -> std::vector<TableSummary> {
+  auto *header = const_cast<FileHeader *>(
+      reinterpret_cast<const FileHeader *>(base_));
+  const auto used = std::min<uint64_t>(
+      std::atomic_ref<uint64_t>(header->used).load(std::memory_order_acquire),
+      capacity());
+  std::vector<TableSummary> out;
+  out.reserve(used);
+  for (uint32_t i = 0; i < used; ++i) {
+    if (read(i, out.emplace_back())) {
+      continue;
+    }
+    out.pop_back();
+  }
+  return out;
+}
+
+} // namespace live
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "cards.h"
+#include "player.h"
+#include "poker_rules.h"
+#include "table.h"
+
+// Live table state for out-of-process observers. The server folds each
+// table's events into a fixed-size summary and publishes it to a slot of a
+// shared file (put it on /dev/shm) under a per-slot seqlock. Readers map the
+// file and copy out consistent summaries with plain loads: no syscalls, no
+// locks and nothing the reactor ever waits on.
+namespace live {
+
+inline constexpr std::string_view kMagic{"PKRLIVE1"};
+inline constexpr uint32_t kDefaultCapacity = 4096;
+
+struct Seat {
+  poker::PlayerId who{0};
+  Chips stack{0};
+  Chips bet{0}; // this street
+};
+
+// Public information only: hole cards never leave the server.
+struct TableSummary {
+  poker::TableId table{0}; // 0 in an unused slot
+  uint64_t hands{0};       // hands started
+  Chips pot{0};
+  poker::PlayerId actor{0}; // 0 between hands
+  poker::Phase phase{poker::Phase::holding};
+  uint8_t seated{0};
+  uint8_t board_size{0};
+  std::array<cards::CardId, kBoardSize> board{};
+  std::array<Seat, kMaxPlayers> seats{};
+};
+
+static_assert(std::is_trivially_copyable_v<TableSummary>);
+static_assert(sizeof(TableSummary) % sizeof(uint64_t) == 0);
+static_assert(std::atomic_ref<uint64_t>::is_always_lock_free);
+
+// Folds one of the table's events into its summary.
+void apply(TableSummary &s, const poker::Event &ev);
+
+enum class LiveError : uint8_t { io, bad_format };
+
+auto to_string(LiveError e) -> std::string_view;
+
+// The server's side: owns the file and is its only writer.
+class Publisher {
+public:
+  static auto open(const std::filesystem::path &path,
+                   uint32_t capacity = kDefaultCapacity)
+      -> std::expected<std::unique_ptr<Publisher>, LiveError>;
+
+  Publisher(const Publisher &) = delete;
+  Publisher &operator=(const Publisher &) = delete;
+  ~Publisher();
+
+  // Folds `events` into `table`'s summary and republishes it. Tables past
+  // the capacity are not published.
+  void apply(poker::TableId table, std::span<const poker::Event> events);
+  // Empties `table`'s seats and hand, as Table::clear does, and republishes
+  // it; its hand count carries on.
+  void clear(poker::TableId table);
+
+private:
+  Publisher(std::byte *base, std::size_t size, uint32_t capacity);
+
+  std::byte *base_;
+  std::size_t size_;
+  uint32_t capacity_;
+  struct Entry {
+    uint32_t slot;
+    TableSummary summary;
+  };
+  // writes `entry`'s summary to its slot under the seqlock
+  void publish(const Entry &entry);
+  std::unordered_map<poker::TableId, Entry> tables_;
+  bool full_warned_{false};
+};
+
+// An observer's view of the file; any number may map it at once.
+class Reader {
+public:
+  static auto open(const std::filesystem::path &path)
+      -> std::expected<Reader, LiveError>;
+
+  Reader(Reader &&other) noexcept;
+  Reader &operator=(Reader &&other) noexcept;
+  Reader(const Reader &) = delete;
+  Reader &operator=(const Reader &) = delete;
+  ~Reader();
+
+  uint32_t capacity() const;
+  // Copies slot `slot` out once no write overlaps the copy; false if the
+  // slot holds no table yet.
+  bool read(uint32_t slot, TableSummary &out) const;
+  // Every published table, each consistent on its own.
+  auto snapshot() const -> std::vector<TableSummary>;
+
+private:
+  Reader(const std::byte *base, std::size_t size);
+
+  const std::byte *base_{nullptr};
+  std::size_t size_{0};
+};
+
+} // namespace live
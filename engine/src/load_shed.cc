@@ -0,0 +1,65 @@
+#include "load_shed.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace load {
+namespace {
+
+// weight of the newest tick in the smoothed lag
+constexpr int kSmoothing = 8;
+
+} // namespace
+
+auto to_string(Mode m) -> std::string_view {
+  switch (m) {
+  case Mode::normal:
+    return "normal";
+  case Mode::shedding:
+    return "shedding";
+  case Mode::closed:
+    return "closed";
+  default:
+    return "unknown_mode";
+  }
+}
+
+Governor::Governor(Slo slo) : slo_(slo) {}
+
+bool Governor::observe(Clock::time_point now, Clock::duration lag) {
+  if (since_ == Clock::time_point{}) {
+    since_ = now;
+  }
+  auto &m = metrics_;
+  m.lag += (lag - m.lag) / kSmoothing;
+  m.max_lag = std::max(m.max_lag, lag);
+  auto target = Mode::normal;
+  if (m.lag >= slo_.close_at) {
+    target = Mode::closed;
+  } else if (m.lag >= slo_.shed_at) {
+    target = Mode::shedding;
+  }
+  if (target > m.mode) {
+    enter(now, target);
+    return true;
+  }
+  if (m.mode != Mode::normal && m.lag < threshold(m.mode) / 2 &&
+      now - since_ >= slo_.min_dwell) {
+    enter(now, static_cast<Mode>(std::to_underlying(m.mode) - 1));
+    return true;
+  }
+  return false;
+}
+
+auto Governor::threshold(Mode m) const -> Clock::duration {
+  return m == Mode::closed ? slo_.close_at : slo_.shed_at;
+}
+
+void Governor::enter(Clock::time_point now, Mode m) {
+  metrics_.time_in[std::to_underlying(metrics_.mode)] += now - since_;
+  ++metrics_.entered[std::to_underlying(m)];
+  metrics_.mode = m;
+  since_ = now;
+}
+
+} // namespace load
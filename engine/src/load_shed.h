@@ -0,0 +1,65 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string_view>
+
+#include "io.h"
+
+// Admission control keyed to the reactor's loop lag. When the loop falls
+// behind, the server sheds work in steps so hands in progress keep their
+// latency: first the traffic nobody is waiting on (chat, spectators), then
+// growth (new connections, new tables).
+namespace load {
+
+using Clock = reactor::Clock;
+
+enum class Mode : uint8_t {
+  normal,
+  shedding, // no chat, no new watchers, delayed broadcasts held back
+  closed,   // also no accepts and no new tables
+};
+inline constexpr std::size_t kModes = 3;
+
+auto to_string(Mode m) -> std::string_view;
+
+// Smoothed lag at which each degraded mode is entered. A mode is left once
+// the lag is under half its threshold and it has lasted `min_dwell`, so the
+// server doesn't flap on a boundary.
+struct Slo {
+  Clock::duration shed_at{std::chrono::milliseconds{20}};
+  Clock::duration close_at{std::chrono::milliseconds{50}};
+  Clock::duration min_dwell{std::chrono::seconds{1}};
+};
+
+struct Metrics {
+  Mode mode{Mode::normal};
+  Clock::duration lag{0};     // smoothed over recent ticks
+  Clock::duration max_lag{0}; // worst single tick
+  std::array<uint64_t, kModes> entered{};        // transitions into each
+  std::array<Clock::duration, kModes> time_in{}; // up to the last change
+  uint64_t shed{0}; // requests refused or deferred by the mode
+};
+
+class Governor {
+public:
+  explicit Governor(Slo slo = {});
+
+  // Folds in one tick's lag; true if the mode changed. Degrading takes one
+  // bad enough average, recovering goes a mode at a time.
+  bool observe(Clock::time_point now, Clock::duration lag);
+  Mode mode() const { return metrics_.mode; }
+  void note_shed() { ++metrics_.shed; }
+  auto metrics() const -> const Metrics & { return metrics_; }
+
+private:
+  auto threshold(Mode m) const -> Clock::duration;
+  void enter(Clock::time_point now, Mode m);
+
+  Slo slo_;
+  Metrics metrics_;
+  Clock::time_point since_{};
+};
+
+} // namespace load
@@ -1,71 +1,152 @@
+#include <charconv>
+#include <chrono>
 #include <csignal>
 #include <cstdlib>
-#include <cstring>
-#include <errno.h>
+#include <optional>
+#include <string_view>
+#include <system_error>
 #include <fcntl.h>
 #include <netinet/in.h>
 #include <sys/epoll.h>
 #include <sys/socket.h>
 #include <unistd.h>
 
-#include "actions.pb.h"
 #include "errors.h"
+#include "reactor.h"
 #include "server.h"
+#include "server_loop.h"
 #include "spdlog/spdlog.h"
 
 constexpr int PORT = 65432;
-constexpr int MAX_EVENTS = 64;
-constexpr int BUF_SIZE = 1024;
+constexpr std::chrono::seconds kPlayersSaveInterval{60};
+constexpr std::size_t kBroadcastBytesPerTable = 256 * 1024;
+// how often a dump request is looked for, and how many connections it lists
+constexpr std::chrono::seconds kDumpPoll{1};
+constexpr std::size_t kDumpConnections = 10;
+// more encoder threads than this is a typo, not a tuning choice
+constexpr unsigned kMaxEncoderThreads = 256;
 
 int set_nonblocking(int fd) {
   int flags = fcntl(fd, F_GETFL, 0);
   return fcntl(fd, F_SETFL, flags | O_NONBLOCK);
 }
 
+// A whole decimal count of encoder threads in [1, kMaxEncoderThreads].
+auto parse_workers(std::string_view text) -> std::optional<unsigned> {
+  unsigned n = 0;
+  const auto *end = text.data() + text.size();
+  const auto [ptr, ec] = std::from_chars(text.data(), end, n);
+  if (ec != std::errc{} || ptr != end || n == 0 || n > kMaxEncoderThreads) {
+    return std::nullopt;
+  }
+  return n;
+}
+
 volatile sig_atomic_t g_stop = 0;
 
-bool try_parse_frame(Conn *c, std::string &out_msg) {
-  // Step 1: header
-  if (c->in_size == 0) {
-    if (c->in.size() < sizeof(uint32_t))
-      return false;
-    uint32_t net_len = 0;
-    std::memcpy(&net_len, c->in.data(), sizeof(net_len));
-    c->in_size = ntohl(net_len);
-    c->in_off = sizeof(uint32_t);
-  }
-
-  // Step 2: body
-  if (c->in.size() < c->in_off + c->in_size)
-    return false;
-
-  out_msg.assign(c->in.data() + c->in_off, c->in_size);
-  c->in.erase(0, c->in_off + c->in_size);
-  c->in_off = 0;
-  c->in_size = 0;
-  return true;
+void handle_sigint(int) { g_stop = 1; }
+
+// `kill -USR1` asks for the load mode and heaviest connections to be logged
+volatile sig_atomic_t g_dump = 0;
+
+void handle_sigusr1(int) { g_dump = 1; }
+
+// Accounts go first: stats are only restored for players they still name.
+void save_players(const Server &state, const char *accounts_path,
+                  const char *stats_path) {
+  if (auto res = state.accounts().save(accounts_path); !res) {
+    spdlog::warn("Failed to save accounts to {}: {}", accounts_path,
+                 poker::to_string(res.error()));
+  }
+  if (!stats_path) {
+    return;
+  }
+  if (auto res = state.stats().save(stats_path); !res) {
+    spdlog::warn("Failed to save player stats to {}: {}", stats_path,
+                 poker::to_string(res.error()));
+  }
 }
 
-std::string action_to_string(const ::poker::v1::Action &action) {
-  using Payload = ::poker::v1::Action::PayloadCase;
-  switch (action.payload_case()) {
-  case Payload::kFold:
-    return "fold";
-  case Payload::kBet:
-    return "bet " + std::to_string(action.bet().amount());
-  case Payload::PAYLOAD_NOT_SET:
-  default:
-    return "unknown";
+reactor::Task save_players_loop(reactor::Reactor &r, const Server &state,
+                                const char *accounts_path,
+                                const char *stats_path) {
+  while (true) {
+    co_await r.sleep_for(kPlayersSaveInterval);
+    save_players(state, accounts_path, stats_path);
   }
 }
 
-void handle_sigint(int) { g_stop = 1; }
+void dump_admin(const Server &state) {
+  const auto &load = state.load();
+  const auto ms = [](reactor::Clock::duration d) {
+    return std::chrono::duration<double, std::milli>(d).count();
+  };
+  spdlog::info("Load mode {}: lag {:.1f} ms, worst {:.1f} ms, {} shed; "
+               "entered shedding {}x, closed {}x",
+               load::to_string(load.mode), ms(load.lag), ms(load.max_lag),
+               load.shed, load.entered[1], load.entered[2]);
+  const auto top = state.heaviest(kDumpConnections);
+  spdlog::info("Heaviest {} of {} connections:", top.size(),
+               state.connections());
+  for (const auto &[player, cost] : top) {
+    spdlog::info("  player {}: {} cycles, in {} frames / {} bytes, out {} "
+                 "frames / {} bytes, {} rejected",
+                 player, cost.cycles, cost.frames_in, cost.bytes_in,
+                 cost.frames_out, cost.bytes_out, cost.rejected);
+  }
+}
+
+reactor::Task admin_dump_loop(reactor::Reactor &r, const Server &state) {
+  while (true) {
+    co_await r.sleep_for(kDumpPoll);
+    if (g_dump) {
+      g_dump = 0;
+      dump_admin(state);
+    }
+  }
+}
+
+// Follows a primary until it goes away, then hands back its tables.
+auto run_standby(const char *path) -> std::optional<replica::Replicated> {
+  spdlog::info("Standing by for a primary on {}", path);
+  auto fd = replica::Standby::accept_primary(path);
+  if (!fd) {
+    spdlog::warn("Failed to take a primary on {}: {}", path,
+                 replica::to_string(fd.error()));
+    return std::nullopt;
+  }
+  spdlog::info("Following the primary");
+  replica::Standby standby;
+  auto res = standby.follow(*fd);
+  close(*fd);
+  if (!res) {
+    // everything applied so far is whole calls; keep it
+    spdlog::warn("Replication stream failed: {}",
+                 replica::to_string(res.error()));
+  }
+  spdlog::warn("Primary gone; taking over {} tables ({} hands in flight, "
+               "{} calls replayed, {} diverged)",
+               standby.tables(), standby.hands_in_flight(), standby.inputs(),
+               standby.diverged());
+  return standby.take();
+}
 
 int main() {
   std::signal(SIGINT, handle_sigint);
+  std::signal(SIGUSR1, handle_sigusr1);
   spdlog::set_level(spdlog::level::info);
   spdlog::set_pattern("[%Y-%m-%d %H:%M:%S.%e] [%^%l%$] %v");
 
+  // POKER_STANDBY with POKER_REPLICA_SOCKET follows the primary that
+  // replicates to that socket and serves in its place once it dies
+  const char *replica_path = std::getenv("POKER_REPLICA_SOCKET");
+  const bool standby = replica_path && std::getenv("POKER_STANDBY");
+  std::optional<replica::Replicated> adopted;
+  if (standby) {
+    adopted = run_standby(replica_path);
+  }
+  const auto takeover_start = reactor::Clock::now();
+
   int listenfd = socket(AF_INET, SOCK_STREAM, 0);
   if (listenfd < 0)
     exit(1);
@@ -90,134 +171,97 @@ int main() {
     exit(1);
 
   Server state(epfd, listenfd);
+  if (const char *dir = std::getenv("POKER_HAND_HISTORY_DIR")) {
+    state.enable_hand_history(dir);
+  }
+  if (const char *path = std::getenv("POKER_CAPTURE_FILE")) {
+    if (auto res = state.enable_capture(path); !res) {
+      spdlog::warn("Failed to open traffic capture {}: {}", path,
+                   capture::to_string(res.error()));
+    }
+  }
+  if (const char *path = std::getenv("POKER_HAND_LOG")) {
+    if (auto res = state.enable_hand_log(path); !res) {
+      spdlog::warn("Failed to open hand log {}: {}", path,
+                   poker::to_string(res.error()));
+    }
+  }
+  if (const char *path = std::getenv("POKER_LIVE_STATE")) {
+    if (auto res = state.enable_live_state(path); !res) {
+      spdlog::warn("Failed to publish live state to {}: {}", path,
+                   live::to_string(res.error()));
+    }
+  }
+  if (const char *workers = std::getenv("POKER_ENCODER_THREADS")) {
+    if (const auto n = parse_workers(workers)) {
+      state.enable_encoders(*n);
+    } else {
+      spdlog::warn("Ignoring POKER_ENCODER_THREADS={}: not a count from 1 "
+                   "to {}",
+                   workers, kMaxEncoderThreads);
+    }
+  }
+  if (const char *delay = std::getenv("POKER_BROADCAST_DELAY")) {
+    state.enable_broadcast(std::chrono::seconds{std::atoi(delay)},
+                           kBroadcastBytesPerTable);
+  }
+  const char *accounts_path = std::getenv("POKER_ACCOUNTS_FILE");
+  const char *stats_path = std::getenv("POKER_STATS_FILE");
+  if (stats_path && !accounts_path) {
+    // without them nobody could claim the stats after a restart
+    spdlog::warn("Not keeping player stats: POKER_ACCOUNTS_FILE is unset");
+    stats_path = nullptr;
+  }
+  if (accounts_path) {
+    // a missing file is just the first run
+    auto accounts = poker::Accounts::load(accounts_path);
+    if (accounts) {
+      spdlog::info("Loaded {} accounts", accounts->size());
+      state.restore_accounts(std::move(*accounts));
+    } else if (accounts.error() == poker::AccountError::bad_format) {
+      spdlog::warn("Ignoring unreadable accounts in {}", accounts_path);
+    }
+  }
+  if (stats_path) {
+    auto stats = poker::PlayerStats::load(stats_path);
+    if (stats) {
+      spdlog::info("Loaded stats for {} players", stats->players());
+      state.restore_stats(std::move(*stats));
+    } else if (stats.error() == poker::StatsError::bad_format) {
+      spdlog::warn("Ignoring unreadable player stats in {}", stats_path);
+    }
+  }
+
+  if (adopted) {
+    state.adopt(std::move(*adopted));
+  } else if (replica_path && !standby) {
+    if (auto res = state.enable_replication(replica_path); !res) {
+      spdlog::warn("Failed to reach the standby on {}: {}", replica_path,
+                   replica::to_string(res.error()));
+    }
+  }
 
   epoll_event ev{};
   ev.events = EPOLLIN | EPOLLET;
-  ev.data.fd = state.listenfd();
+  ev.data.ptr = nullptr; // the reactor's marker for the listening socket
   epoll_ctl(epfd, EPOLL_CTL_ADD, state.listenfd(), &ev);
 
-  epoll_event events[MAX_EVENTS];
-
   spdlog::info("Started server on port {}", PORT);
+  if (standby) {
+    spdlog::info("Took over from the primary in {:.1f} ms",
+                 std::chrono::duration<double, std::milli>(
+                     reactor::Clock::now() - takeover_start)
+                     .count());
+  }
 
-  while (!g_stop) {
-    int n = epoll_wait(state.epfd(), events, MAX_EVENTS, -1);
-    if (n < 0) {
-      if (errno == EINTR)
-        continue;
-      exit(1);
-    }
-    spdlog::debug("Processing epoll batch with {} events", n);
-    for (int i = 0; i < n; ++i) {
-      auto &e = events[i];
-
-      /* Error path */
-      if (e.events & (EPOLLERR | EPOLLHUP)) {
-        if (e.data.fd != state.listenfd()) {
-          close(e.data.fd); // TODO: do we leak resources here?
-        }
-        continue;
-      }
-
-      /* New connections */
-      if (e.data.fd == state.listenfd()) {
-        while (true) {
-          // max players/tables will be limiting factor here
-          int cfd = accept(state.listenfd(), nullptr, nullptr);
-          if (cfd < 0) {
-            if (errno == EAGAIN || errno == EWOULDBLOCK)
-              break;
-            // potentially handle other errno's
-            break;
-          }
-          set_nonblocking(cfd);
-          auto cr = state.handle_connect(cfd);
-          auto tid = cr.conn->table_id;
-          if (cr.result) {
-            state.push_table(tid, Outbound{*cr.result});
-            if (auto start_result = state.maybe_start_hand(tid)) {
-              state.push_table(cr.conn->table_id, Outbound{*start_result});
-            }
-          } else {
-            state.push_one(cr.conn->player_id, Outbound{cr.result.error()});
-          }
-        }
-        continue;
-      }
-
-      /* Client socket */
-      Conn *c = static_cast<Conn *>(e.data.ptr);
-
-      /* Read */
-      if (e.events & EPOLLIN) {
-        char buf[BUF_SIZE];
-        while (true) {
-          ssize_t r = read(c->fd, buf, sizeof(buf));
-          if (r == 0) {
-            spdlog::info("Peer closed connection for player {}", c->player_id);
-            state.handle_close(c->player_id);
-            goto next_event;
-          }
-          if (r < 0) {
-            if (errno == EAGAIN || errno == EWOULDBLOCK)
-              break;
-            spdlog::warn("Read error on fd {}: {}", c->fd, strerror(errno));
-            state.handle_close(c->player_id);
-            goto next_event;
-          }
-          c->in.append(buf, r);
-          std::string msg;
-          while (try_parse_frame(c, msg)) {
-            ::poker::v1::Action action;
-            if (!action.ParseFromString(msg)) {
-              spdlog::warn("Invalid action payload from player {}",
-                           c->player_id);
-              state.push_one(c->player_id, poker::GameError::invalid_action);
-            } else {
-              spdlog::info("Received action from player {}: {}", c->player_id,
-                            action_to_string(action));
-              auto ar = state.apply_action(action, c->player_id);
-              if (!ar) {
-                spdlog::info("Action rejected for player {}: {}", c->player_id,
-                             poker::to_string(ar.error()));
-              }
-              if (ar) {
-                state.push_table(c->table_id, Outbound{*ar});
-                if (auto next = state.maybe_start_hand(c->table_id)) {
-                  state.push_table(c->table_id, Outbound{*next});
-                }
-              } else {
-                state.push_one(c->player_id, Outbound{ar.error()});
-              }
-            }
-          }
-        }
-      }
-
-      /* Write */
-      if (e.events & EPOLLOUT) {
-        while (!c->out.empty()) {
-          ssize_t w = write(c->fd, c->out.data(), c->out.size());
-          if (w < 0) {
-            if (errno == EAGAIN || errno == EWOULDBLOCK)
-              break;
-            spdlog::warn("Write error on fd {}: {}", c->fd, strerror(errno));
-            state.handle_close(c->player_id);
-            goto next_event;
-          }
-          c->out.erase(0, w);
-          spdlog::debug("Wrote {} bytes to fd {}", w, c->fd);
-        }
-      }
-
-      /* Update interest mask */
-      if (c->is_dead) {
-        state.handle_close(c->player_id);
-      } else {
-        update_interest(c, state.epfd());
-      }
-
-    next_event:;
-    }
+  reactor::Reactor r(epfd);
+  start_server(r, state);
+  admin_dump_loop(r, state);
+  if (accounts_path) {
+    save_players_loop(r, state, accounts_path, stats_path);
+  }
+  r.run(g_stop);
+  if (accounts_path) {
+    save_players(state, accounts_path, stats_path);
   }
 }
@@ -10,6 +10,7 @@ using PlayerId = uint64_t;
 
 class Player {
 public:
+  Player() = default;
   explicit Player(PlayerId id);
 
   PlayerId id() const;
@@ -21,7 +22,7 @@ public:
   void add_chips(Chips chips);
 
 private:
-  PlayerId id_;
+  PlayerId id_{0};
   Chips purse_{0};
 };
 
@@ -1,24 +1,33 @@
 #include "player_manager.h"
 
-#include <algorithm>
-#include <iterator>
-#include <numeric>
+#include <bit>
 
 namespace poker {
-
-PlayerManager::PlayerManager() : seats_(kMaxPlayers), open_seats_(kMaxPlayers) {
-  std::iota(open_seats_.begin(), open_seats_.end(), 0);
+namespace {
+
+// First seat in `mask` after `seat`, wrapping around. `mask` must be
+// non-empty.
+template <typename Mask>
+auto next_seat(Mask mask, std::size_t seat) -> std::size_t {
+  const auto after = static_cast<Mask>(mask & ~((2u << seat) - 1));
+  return static_cast<std::size_t>(std::countr_zero(after ? after : mask));
 }
 
-auto PlayerManager::add_player(PlayerId id)
+} // namespace
+
+PlayerManager::PlayerManager() = default;
+
+auto PlayerManager::add_player(PlayerId id, Chips buy_in)
     -> std::expected<void, PlayerMgmtError> {
-  if (open_seats_.empty()) {
+  const auto open = static_cast<SeatMask>(~taken_ & kAllSeats);
+  if (open == 0) {
     return std::unexpected(PlayerMgmtError::not_enough_seats);
   }
-  const auto seat = open_seats_.front();
-  open_seats_.pop_front();
-  holding_.push_back(id);
-  index_[id] = seat;
+  const auto seat = static_cast<std::size_t>(std::countr_zero(open));
+  ids_[seat] = id;
+  buy_ins_[seat] = buy_in;
+  seat_hint_[id % kSeatHints] = static_cast<uint8_t>(seat);
+  taken_ |= static_cast<SeatMask>(1u << seat);
   return {};
 }
 
@@ -26,99 +35,107 @@ auto PlayerManager::add_player(PlayerId id)
 // free their seat right away.
 auto PlayerManager::remove_player(PlayerId id)
     -> std::expected<void, PlayerMgmtError> {
-  if (!index_.count(id)) {
+  const auto seat = seat_of(id);
+  if (!seat) {
     return std::unexpected(PlayerMgmtError::invalid_id);
   }
-  const auto seat = index_[id];
-  auto held_it = std::find(holding_.begin(), holding_.end(), id);
-  if (held_it != holding_.end()) {
-    holding_.erase(held_it);
-    open_seats_.push_back(seat);
-    index_.erase(id);
-    return {};
-  }
-  seats_[seat].reset();
-  open_seats_.push_back(seat);
-  index_.erase(id);
+  const auto clear = static_cast<SeatMask>(~(1u << *seat));
+  taken_ &= clear;
+  sat_ &= clear;
   return {};
 }
 
 // Move players from holding into seats (start of hand).
 void PlayerManager::seat_held_players() {
-  while (!holding_.empty()) {
-    Player cur(holding_.front());
-    holding_.pop_front();
-    cur.add_chips(kBuyIn);
-    seats_[index_[cur.id()]] = cur;
+  for (auto held = static_cast<SeatMask>(taken_ & ~sat_); held != 0;
+       held &= static_cast<SeatMask>(held - 1)) {
+    const auto seat = static_cast<std::size_t>(std::countr_zero(held));
+    seats_[seat] = Player(ids_[seat]);
+    seats_[seat].add_chips(buy_ins_[seat]);
   }
+  sat_ = taken_;
 }
 
 auto PlayerManager::get_first_player() const
     -> std::expected<PlayerId, PlayerMgmtError> {
-  for (auto it = seats_.begin(); it != seats_.end(); it = std::next(it)) {
-    if (*it) {
-      return (*it)->id();
-    }
+  if (sat_ == 0) {
+    return std::unexpected(PlayerMgmtError::no_players);
   }
-  return std::unexpected(PlayerMgmtError::no_players);
+  return ids_[static_cast<std::size_t>(std::countr_zero(sat_))];
 }
 
 auto PlayerManager::next_player(PlayerId p) const
     -> std::expected<PlayerId, PlayerMgmtError> {
-  if (!index_.count(p)) {
+  const auto seat = seat_of(p);
+  if (!seat) {
     return std::unexpected(PlayerMgmtError::invalid_id);
   }
-  const auto total = seats_.size();
-  auto it = std::next(seats_.begin() + index_.at(p));
-  for (std::size_t checked = 0; checked < total;
-       ++checked, it = std::next(it)) {
-    if (it == seats_.end()) {
-      it = seats_.begin();
-    }
-    if (*it) {
-      return (*it)->id();
-    }
+  const auto others = static_cast<SeatMask>(sat_ & ~(1u << *seat));
+  if (others == 0) {
+    // No other active players found; return self.
+    return p;
   }
-  // No other active players found; return self.
-  return p;
+  return ids_[next_seat(others, *seat)];
 }
 
-std::vector<PlayerId> PlayerManager::active_cycle_from(PlayerId start) const {
-  std::vector<PlayerId> ordered;
-  if (!index_.count(start) || seats_.empty()) {
+SeatCycle PlayerManager::active_cycle_from(PlayerId start) const {
+  SeatCycle ordered;
+  const auto seat = seat_of(start);
+  if (!seat) {
     return ordered;
   }
   ordered.push_back(start);
-  for (auto nxt = next_player(start); nxt && *nxt != start;
-       nxt = next_player(*nxt)) {
-    ordered.push_back(*nxt);
+  // rotate so the seats after `start` come first, then walk the set bits
+  const auto others = static_cast<uint32_t>(sat_ & ~(1u << *seat));
+  const auto shift = static_cast<unsigned>(*seat + 1);
+  auto rotated = (others >> shift) | (others << (kMaxPlayers - shift));
+  rotated &= kAllSeats;
+  for (; rotated != 0; rotated &= rotated - 1) {
+    const auto offset = static_cast<std::size_t>(std::countr_zero(rotated));
+    ordered.push_back(ids_[(offset + shift) % kMaxPlayers]);
   }
   return ordered;
 }
 
 std::size_t PlayerManager::num_players() const {
-  return kMaxPlayers - open_seats_.size();
+  return static_cast<std::size_t>(std::popcount(taken_));
 }
 
-
 bool PlayerManager::is_sat(PlayerId id) const {
-  return index_.contains(id) && seats_[index_.at(id)].has_value();
+  const auto seat = seat_of(id);
+  return seat && (sat_ >> *seat) & 1u;
 }
 
 bool PlayerManager::has_enough_chips(PlayerId id, Chips bet) const {
-  return seats_[index_.at(id)]->sufficient_chips(bet);
+  return seats_[*seat_of(id)].sufficient_chips(bet);
 }
 
 Chips PlayerManager::get_chips(PlayerId id) const {
-  return seats_[index_.at(id)]->chips();
+  return seats_[*seat_of(id)].chips();
 }
 
 void PlayerManager::place_bet(PlayerId id, Chips bet) {
-  seats_[index_.at(id)]->place_bet(bet);
+  seats_[*seat_of(id)].place_bet(bet);
 }
 
 void PlayerManager::award_chips(PlayerId id, Chips amount) {
-  seats_[index_.at(id)]->add_chips(amount);
+  seats_[*seat_of(id)].add_chips(amount);
+}
+
+// Ids are hinted into a 16-entry direct-mapped table; a stale or colliding
+// hint falls back to scanning the (at most kMaxPlayers) taken seats.
+auto PlayerManager::seat_of(PlayerId id) const -> std::optional<std::size_t> {
+  const auto hint = static_cast<std::size_t>(seat_hint_[id % kSeatHints]);
+  if (hint < kMaxPlayers && ids_[hint] == id && (taken_ >> hint) & 1u) {
+    return hint;
+  }
+  for (auto m = static_cast<uint32_t>(taken_); m != 0; m &= m - 1) {
+    const auto seat = static_cast<std::size_t>(std::countr_zero(m));
+    if (ids_[seat] == id) {
+      return seat;
+    }
+  }
+  return std::nullopt;
 }
 
 } // namespace poker
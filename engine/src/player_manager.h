@@ -1,10 +1,10 @@
 #pragma once
 
+#include <array>
 #include <cstddef>
-#include <deque>
+#include <cstdint>
 #include <expected>
 #include <optional>
-#include <unordered_map>
 #include <vector>
 
 #include "errors.h"
@@ -13,11 +13,30 @@
 
 namespace poker {
 
+// Players in seat order, stored inline so walking the ring never allocates.
+class SeatCycle {
+public:
+  void push_back(PlayerId id) { ids_[size_++] = id; }
+
+  std::size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  PlayerId operator[](std::size_t i) const { return ids_[i]; }
+  const PlayerId *begin() const { return ids_.data(); }
+  const PlayerId *end() const { return ids_.data() + size_; }
+
+private:
+  std::array<PlayerId, kMaxPlayers> ids_{};
+  std::size_t size_{0};
+};
+
 class PlayerManager {
 public:
   PlayerManager();
 
-  auto add_player(PlayerId id) -> std::expected<void, PlayerMgmtError>;
+  // The player is held until the next hand starts, then seated with
+  // `buy_in` chips.
+  auto add_player(PlayerId id, Chips buy_in = kBuyIn)
+      -> std::expected<void, PlayerMgmtError>;
 
   auto remove_player(PlayerId id) -> std::expected<void, PlayerMgmtError>;
 
@@ -28,7 +47,7 @@ public:
   auto next_player(PlayerId p) const
       -> std::expected<PlayerId, PlayerMgmtError>;
 
-  std::vector<PlayerId> active_cycle_from(PlayerId start) const;
+  SeatCycle active_cycle_from(PlayerId start) const;
 
   std::size_t num_players() const;
 
@@ -43,10 +62,22 @@ public:
   void award_chips(PlayerId id, Chips amount);
 
 private:
-  std::vector<std::optional<Player>> seats_;
-  std::deque<std::size_t> open_seats_;
-  std::unordered_map<PlayerId, std::size_t> index_;
-  std::deque<PlayerId> holding_;
+  // bit i stands for seat i
+  using SeatMask = uint16_t;
+  static_assert(kMaxPlayers <= 16);
+  static constexpr SeatMask kAllSeats =
+      static_cast<SeatMask>((1u << kMaxPlayers) - 1);
+
+  static constexpr std::size_t kSeatHints = 16;
+
+  auto seat_of(PlayerId id) const -> std::optional<std::size_t>;
+
+  std::array<Player, kMaxPlayers> seats_{};
+  std::array<PlayerId, kMaxPlayers> ids_{};
+  std::array<Chips, kMaxPlayers> buy_ins_{}; // of held players
+  std::array<uint8_t, kSeatHints> seat_hint_{};
+  SeatMask taken_{0}; // held or seated
+  SeatMask sat_{0};
 };
 
 } // namespace poker
@@ -0,0 +1,140 @@
+#include "player_stats.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include "replace_file.h"
+#include "varint.h"
+
+namespace poker {
+namespace {
+
+constexpr std::array<char, 4> kMagic{'P', 'S', 'T', '1'};
+// ids are handed out one at a time from 1, so anything near the top of the
+// range is a corrupt snapshot
+constexpr PlayerId kMaxSavedId = PlayerId{1} << 48;
+
+auto ratio(uint32_t num, uint32_t den) -> double {
+  return den == 0 ? 0.0 : static_cast<double>(num) / den;
+}
+
+} // namespace
+
+auto to_string(StatsError e) -> std::string_view {
+  switch (e) {
+  case StatsError::io:
+    return "io";
+  case StatsError::bad_format:
+  default:
+    return "bad_format";
+  }
+}
+
+void PlayerStats::record(std::span<const HandRow> rows) {
+  for (const auto &r : rows) {
+    auto &c = counters_[r.player];
+    c.hands += 1;
+    c.vpip += (r.flags & kVpip) != 0;
+    c.pfr += (r.flags & kPfr) != 0;
+    c.showdowns += (r.flags & kShowdown) != 0;
+    c.aggressive += r.aggressive;
+    c.passive += r.passive;
+  }
+}
+
+auto PlayerStats::counters(PlayerId id) const -> StatCounters {
+  const auto it = counters_.find(id);
+  return it != counters_.end() ? it->second : StatCounters{};
+}
+
+auto PlayerStats::line(PlayerId id) const -> StatLine {
+  const auto c = counters(id);
+  return StatLine{c.hands, ratio(c.vpip, c.hands), ratio(c.pfr, c.hands),
+                  ratio(c.aggressive, c.passive),
+                  ratio(c.showdowns, c.hands)};
+}
+
+std::size_t PlayerStats::players() const { return counters_.size(); }
+
+auto PlayerStats::save(const std::filesystem::path &path) const
+    -> std::expected<void, StatsError> {
+  std::string out(kMagic.begin(), kMagic.end());
+  varint::append(out, counters_.size());
+  std::vector<PlayerId> ids;
+  ids.reserve(counters_.size());
+  for (const auto &[id, _] : counters_) {
+    ids.push_back(id);
+  }
+  std::ranges::sort(ids);
+  PlayerId prev = 0;
+  for (const auto id : ids) {
+    const auto &c = counters_.at(id);
+    varint::append(out, id - prev);
+    prev = id;
+    for (const auto v : {c.hands, c.vpip, c.pfr, c.showdowns, c.aggressive,
+                         c.passive}) {
+      varint::append(out, v);
+    }
+  }
+
+  if (!replace_file::write(path, out)) {
+    return std::unexpected(StatsError::io);
+  }
+  return {};
+}
+
+auto PlayerStats::load(const std::filesystem::path &path)
+    -> std::expected<PlayerStats, StatsError> {
+  std::ifstream f(path, std::ios::binary);
+  if (!f) {
+    return std::unexpected(StatsError::io);
+  }
+  const std::string data((std::istreambuf_iterator<char>(f)),
+                         std::istreambuf_iterator<char>());
+  std::string_view in(data);
+  if (!in.starts_with(std::string_view(kMagic.data(), kMagic.size()))) {
+    return std::unexpected(StatsError::bad_format);
+  }
+  in.remove_prefix(kMagic.size());
+
+  PlayerStats stats;
+  const auto players = varint::read(in);
+  if (!players) {
+    return std::unexpected(StatsError::bad_format);
+  }
+  PlayerId id = 0;
+  for (uint64_t i = 0; i < *players; ++i) {
+    // ids are strictly increasing from 1
+    const auto gap = varint::read(in);
+    if (!gap || *gap == 0 || *gap >= kMaxSavedId - id) {
+      return std::unexpected(StatsError::bad_format);
+    }
+    id += *gap;
+    std::array<uint32_t, 6> v{};
+    for (auto &x : v) {
+      auto got = varint::read(in);
+      if (!got || *got > UINT32_MAX) {
+        return std::unexpected(StatsError::bad_format);
+      }
+      x = static_cast<uint32_t>(*got);
+    }
+    // a saved player has hands, which bound how many were voluntary,
+    // raised or shown down
+    const auto [hands, vpip, pfr, showdowns, aggressive, passive] = v;
+    if (hands == 0 || vpip > hands || pfr > hands || showdowns > hands) {
+      return std::unexpected(StatsError::bad_format);
+    }
+    stats.counters_.emplace(
+        id, StatCounters{hands, vpip, pfr, showdowns, aggressive, passive});
+  }
+  if (!in.empty()) {
+    return std::unexpected(StatsError::bad_format);
+  }
+  return stats;
+}
+
+} // namespace poker
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <span>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "hand_history.h"
+#include "player.h"
+
+namespace poker {
+
+// Lifetime counters for one player.
+struct StatCounters {
+  uint32_t hands;
+  uint32_t vpip;
+  uint32_t pfr;
+  uint32_t showdowns;
+  uint32_t aggressive;
+  uint32_t passive;
+};
+static_assert(sizeof(StatCounters) == 24);
+
+// The HUD view of a player's counters; ratios are 0 with no hands.
+struct StatLine {
+  uint32_t hands;
+  double vpip;       // fraction of hands
+  double pfr;        // fraction of hands
+  double aggression; // (bets + raises) / calls
+  double showdown;   // fraction of hands
+};
+
+enum class StatsError : uint8_t { io, bad_format };
+
+auto to_string(StatsError e) -> std::string_view;
+
+// HUD stats keyed by PlayerId, for players with at least one hand. Fed the
+// rows a HandRecorder produces as hands finish, so an update is a handful
+// of adds per seat and a query is one hash lookup. The server only feeds it
+// account holders, whose ids outlive their connections.
+class PlayerStats {
+public:
+  void record(std::span<const HandRow> rows);
+
+  auto counters(PlayerId id) const -> StatCounters;
+  auto line(PlayerId id) const -> StatLine;
+  std::size_t players() const;
+  // drops every player `pred` is true for; returns how many went
+  template <typename Pred> std::size_t erase_if(Pred pred) {
+    return std::erase_if(counters_,
+                         [&](const auto &entry) { return pred(entry.first); });
+  }
+
+  // Only players with hands are written, as varint id gaps and counters,
+  // through a temporary file so a crash never leaves a torn snapshot.
+  auto save(const std::filesystem::path &path) const
+      -> std::expected<void, StatsError>;
+  static auto load(const std::filesystem::path &path)
+      -> std::expected<PlayerStats, StatsError>;
+
+private:
+  std::unordered_map<PlayerId, StatCounters> counters_;
+};
+
+} // namespace poker
@@ -16,6 +16,16 @@ auto to_proto_server_error(ServerError err) -> ::poker::v1::Error::ServerError {
     return Proto::Error_ServerError_SERVERERROR_ALL_TABLES_FULL;
   case ServerError::illegal_action:
     return Proto::Error_ServerError_SERVERERROR_ILLEGAL_ACTION;
+  case ServerError::too_many_tables:
+    return Proto::Error_ServerError_SERVERERROR_TOO_MANY_TABLES;
+  case ServerError::chat_too_long:
+    return Proto::Error_ServerError_SERVERERROR_CHAT_TOO_LONG;
+  case ServerError::chat_rate_limited:
+    return Proto::Error_ServerError_SERVERERROR_CHAT_RATE_LIMITED;
+  case ServerError::overloaded:
+    return Proto::Error_ServerError_SERVERERROR_OVERLOADED;
+  case ServerError::bad_credential:
+    return Proto::Error_ServerError_SERVERERROR_BAD_CREDENTIAL;
   case ServerError::unspecified:
   default:
     return Proto::Error_ServerError_SERVERERROR_UNSPECIFIED;
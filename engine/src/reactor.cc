@@ -0,0 +1,365 @@
+#include "reactor.h"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <netinet/in.h>
+#include <new>
+#include <spdlog/spdlog.h>
+#include <sys/epoll.h>
+#include <utility>
+
+#include "server.h"
+
+namespace reactor {
+namespace {
+
+constexpr int kMaxEvents = 64;
+constexpr std::size_t kReadChunk = 1024;
+
+constexpr std::size_t kFrameBucket = 64;
+constexpr std::size_t kFrameBuckets = 32; // frames up to 2 KiB are pooled
+
+struct FreeFrame {
+  FreeFrame *next;
+};
+
+thread_local std::array<FreeFrame *, kFrameBuckets> free_frames{};
+
+auto bucket_for(std::size_t size) -> std::size_t {
+  return (size + kFrameBucket - 1) / kFrameBucket;
+}
+
+bool try_parse_frame(Conn *c, std::string &out_msg) {
+  // Step 1: header
+  if (c->in_size == 0) {
+    if (c->in.size() < sizeof(uint32_t))
+      return false;
+    uint32_t net_len = 0;
+    std::memcpy(&net_len, c->in.data(), sizeof(net_len));
+    c->in_size = ntohl(net_len);
+    c->in_off = sizeof(uint32_t);
+  }
+
+  // Step 2: body
+  if (c->in.size() < c->in_off + c->in_size)
+    return false;
+
+  out_msg.assign(c->in.data() + c->in_off, c->in_size);
+  c->in.erase(0, c->in_off + c->in_size);
+  c->in_off = 0;
+  c->in_size = 0;
+  return true;
+}
+
+} // namespace
+
+bool flush(Io &io, Conn *c) {
+  frame_pending(c);
+  while (!c->out.empty() && c->io.writable) {
+    ssize_t w = io.write(c->fd, c->out.data(), c->out.size());
+    if (w < 0) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        c->io.writable = false;
+        break;
+      }
+      spdlog::warn("Write error on fd {}: {}", c->fd, strerror(errno));
+      c->io.failed = true;
+      return false;
+    }
+    c->out.erase(0, static_cast<std::size_t>(w));
+    spdlog::debug("Wrote {} bytes to fd {}", w, c->fd);
+  }
+  return true;
+}
+
+auto FramePool::allocate(std::size_t size) -> void * {
+  const auto bucket = bucket_for(size);
+  if (bucket >= kFrameBuckets) {
+    return ::operator new(size);
+  }
+  if (auto *head = free_frames[bucket]) {
+    free_frames[bucket] = head->next;
+    return head;
+  }
+  return ::operator new(bucket * kFrameBucket);
+}
+
+void FramePool::deallocate(void *p, std::size_t size) noexcept {
+  const auto bucket = bucket_for(size);
+  if (bucket >= kFrameBuckets) {
+    ::operator delete(p);
+    return;
+  }
+  auto *node = static_cast<FreeFrame *>(p);
+  node->next = free_frames[bucket];
+  free_frames[bucket] = node;
+}
+
+bool ReadFrame::poll() {
+  if (c_->io.failed) {
+    closed_ = true;
+    return true;
+  }
+  std::string msg;
+  while (true) {
+    if (!r_.has_budget(c_)) {
+      return false;
+    }
+    if (try_parse_frame(c_, msg)) {
+      ++c_->io.frames;
+      frame_ = std::move(msg);
+      return true;
+    }
+    if (!c_->io.readable) {
+      return false;
+    }
+    char buf[kReadChunk];
+    ssize_t r = r_.io_.read(c_->fd, buf, sizeof(buf));
+    if (r == 0) {
+      spdlog::info("Peer closed connection for player {}", c_->player_id);
+      closed_ = true;
+      return true;
+    }
+    if (r < 0) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        c_->io.readable = false;
+        return false;
+      }
+      spdlog::warn("Read error on fd {}: {}", c_->fd, strerror(errno));
+      c_->io.failed = true;
+      closed_ = true;
+      return true;
+    }
+    c_->in.append(buf, static_cast<std::size_t>(r));
+    c_->io.bytes += static_cast<uint32_t>(r);
+  }
+}
+
+// Parking for input is the point where the coroutine has produced all it can
+// for now, so flush its output here rather than one write per frame.
+bool ReadFrame::await_suspend(std::coroutine_handle<> h) {
+  if (!flush(r_.io_, c_)) {
+    closed_ = true;
+    return false;
+  }
+  c_->io.read_op = this;
+  c_->io.waiter = h;
+  update_interest(r_.io_, c_, r_.epfd_);
+  return true;
+}
+
+auto ReadFrame::await_resume() -> std::optional<std::string> {
+  if (closed_) {
+    return std::nullopt;
+  }
+  return std::move(frame_);
+}
+
+bool WriteAll::poll() {
+  if (c_->io.failed || !flush(r_.io_, c_)) {
+    failed_ = true;
+    return true;
+  }
+  return c_->out.empty();
+}
+
+void WriteAll::await_suspend(std::coroutine_handle<> h) {
+  c_->io.write_op = this;
+  c_->io.waiter = h;
+  update_interest(r_.io_, c_, r_.epfd_);
+}
+
+bool Accept::poll() {
+  while (r_.listen_readable_ && r_.accepts_ < kAcceptBudget) {
+    fd_ = r_.io_.accept(listenfd_);
+    if (fd_ >= 0) {
+      ++r_.accepts_;
+      return true;
+    }
+    if (errno == EAGAIN || errno == EWOULDBLOCK) {
+      r_.listen_readable_ = false;
+      break;
+    }
+    if (errno == EINTR || errno == ECONNABORTED) {
+      continue;
+    }
+    // potentially handle other errno's; wait for the next edge
+    spdlog::warn("Accept error: {}", strerror(errno));
+    r_.listen_readable_ = false;
+  }
+  return false;
+}
+
+void Accept::await_suspend(std::coroutine_handle<> h) {
+  r_.accept_op_ = this;
+  r_.acceptor_ = h;
+}
+
+bool Sleep::await_ready() const { return deadline_ <= r_.io_.now(); }
+
+void Sleep::await_suspend(std::coroutine_handle<> h) {
+  r_.timers_.push(Reactor::Timer{deadline_, r_.timer_seq_++, h});
+}
+
+Reactor::Reactor(int epfd, Io &io) : epfd_(epfd), io_(io) {}
+
+void Reactor::on_tick_end(std::function<void()> fn) {
+  tick_end_ = std::move(fn);
+}
+
+void Reactor::run(const volatile std::sig_atomic_t &stop) {
+  while (!stop) {
+    poll();
+  }
+}
+
+bool Reactor::has_ready() const {
+  return !ready_.empty() || (accept_op_ && listen_readable_);
+}
+
+void Reactor::poll(int timeout_ms) {
+  epoll_event events[kMaxEvents];
+  int n =
+      io_.epoll_wait(epfd_, events, kMaxEvents, wait_timeout(timeout_ms));
+  if (n < 0) {
+    if (errno != EINTR) {
+      spdlog::error("epoll_wait failed: {}", strerror(errno));
+    }
+    return;
+  }
+  spdlog::debug("Processing epoll batch with {} events", n);
+  ++tick_;
+  const auto woke = io_.now();
+  // connections carried over have been ready since the last wake
+  auto ready_since = ready_.empty() ? woke : woke_;
+  woke_ = woke;
+  // connections that ran out of budget last tick; anything that runs out
+  // during this one lands in ready_ for the next
+  running_.swap(ready_);
+  for (int i = 0; i < n; ++i) {
+    dispatch(events[i].events, static_cast<Conn *>(events[i].data.ptr));
+  }
+  run_ready(running_);
+  fire_timers();
+  run_accepts();
+  if (tick_end_) {
+    tick_end_();
+  }
+  ready_since = std::min(ready_since, oldest_timer_);
+  oldest_timer_ = Clock::time_point::max();
+  lag_ = io_.now() - ready_since;
+}
+
+bool Reactor::has_budget(Conn *c) {
+  auto &io = c->io;
+  if (io.budget_tick != tick_) {
+    io.budget_tick = tick_;
+    io.frames = 0;
+    io.bytes = 0;
+  }
+  if (io.frames < kFrameBudget && io.bytes < kByteBudget) {
+    return true;
+  }
+  if (!io.on_ready_list) {
+    io.on_ready_list = true;
+    ready_.push_back(c);
+  }
+  return false;
+}
+
+void Reactor::run_ready(std::vector<Conn *> &ready) {
+  for (auto *c : ready) {
+    auto &io = c->io;
+    io.on_ready_list = false;
+    if (io.read_op && io.read_op->poll()) {
+      io.read_op = nullptr;
+      std::exchange(io.waiter, {}).resume();
+    }
+  }
+  ready.clear();
+}
+
+// Connection setup waits until the tick's game work is done, and only so
+// many connections are set up per tick.
+void Reactor::run_accepts() {
+  accepts_ = 0;
+  if (accept_op_ && accept_op_->poll()) {
+    accept_op_ = nullptr;
+    std::exchange(acceptor_, {}).resume();
+  }
+}
+
+// Any resumed coroutine may close its connection, so the Conn must not be
+// touched after the resume.
+void Reactor::dispatch(uint32_t events, Conn *c) {
+  if (c == nullptr) {
+    listen_readable_ = true;
+    return;
+  }
+
+  auto &io = c->io;
+  if (events & EPOLLERR) {
+    io.failed = true;
+  }
+  if (events & (EPOLLIN | EPOLLHUP)) {
+    io.readable = true;
+  }
+  if (events & EPOLLOUT) {
+    io.writable = true;
+  }
+  // output queued by other connections' broadcasts
+  if (!io.write_op && !io.failed) {
+    flush(io_, c);
+  }
+  // out of budget: it gets its turn in run_ready
+  if (io.on_ready_list) {
+    update_interest(io_, c, epfd_);
+    return;
+  }
+
+  bool done = false;
+  if (io.read_op) {
+    done = io.read_op->poll();
+  } else if (io.write_op) {
+    done = io.write_op->poll();
+  }
+  if (done && io.waiter) {
+    io.read_op = nullptr;
+    io.write_op = nullptr;
+    std::exchange(io.waiter, {}).resume();
+    return;
+  }
+  update_interest(io_, c, epfd_);
+}
+
+void Reactor::fire_timers() {
+  const auto now = io_.now();
+  while (!timers_.empty() && timers_.top().deadline <= now) {
+    oldest_timer_ = std::min(oldest_timer_, timers_.top().deadline);
+    auto h = timers_.top().h;
+    timers_.pop();
+    h.resume();
+  }
+}
+
+auto Reactor::wait_timeout(int requested_ms) const -> int {
+  if (has_ready()) {
+    return 0;
+  }
+  if (timers_.empty()) {
+    return requested_ms;
+  }
+  const auto until = timers_.top().deadline - io_.now();
+  auto ms = std::chrono::ceil<std::chrono::milliseconds>(until).count();
+  if (ms < 0) {
+    ms = 0;
+  }
+  if (requested_ms >= 0 && requested_ms < ms) {
+    return requested_ms;
+  }
+  return static_cast<int>(ms);
+}
+
+} // namespace reactor
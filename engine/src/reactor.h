@@ -0,0 +1,219 @@
+#pragma once
+
+#include <chrono>
+#include <coroutine>
+#include <csignal>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <optional>
+#include <queue>
+#include <string>
+#include <vector>
+
+#include "io.h"
+
+struct Conn;
+
+namespace reactor {
+
+// Per-tick allowances; see Reactor.
+inline constexpr uint32_t kFrameBudget = 8;
+inline constexpr uint32_t kByteBudget = 16 * 1024;
+inline constexpr uint32_t kAcceptBudget = 16;
+
+// Size-bucketed free lists for coroutine frames. Frames are recycled instead
+// of being handed back to the heap, so once a connection's coroutine has been
+// created, awaiting reads, writes and timers allocates nothing.
+class FramePool {
+public:
+  static auto allocate(std::size_t size) -> void *;
+  static void deallocate(void *p, std::size_t size) noexcept;
+};
+
+// Fire-and-forget coroutine. It starts running immediately and its frame is
+// returned to the pool when it finishes.
+struct Task {
+  struct promise_type {
+    Task get_return_object() noexcept { return {}; }
+    std::suspend_never initial_suspend() noexcept { return {}; }
+    std::suspend_never final_suspend() noexcept { return {}; }
+    void return_void() noexcept {}
+    void unhandled_exception() noexcept { std::terminate(); }
+
+    static void *operator new(std::size_t size) {
+      return FramePool::allocate(size);
+    }
+    static void operator delete(void *p, std::size_t size) noexcept {
+      FramePool::deallocate(p, size);
+    }
+  };
+};
+
+class ReadFrame;
+class WriteAll;
+
+// Frames the connection's pending output and writes until the buffer is
+// empty or the socket would block. Returns false on a hard write error.
+bool flush(Io &io, Conn *c);
+
+// Per-fd readiness, tracked because we register edge-triggered: a coroutine
+// only parks once the fd has reported EAGAIN or has used up its budget for
+// the tick, in which case the reactor keeps it on its ready list.
+struct IoState {
+  bool readable{true};
+  bool writable{true};
+  bool failed{false};
+  bool on_ready_list{false};
+  uint64_t budget_tick{0};
+  uint32_t frames{0};
+  uint32_t bytes{0};
+  ReadFrame *read_op{nullptr};
+  WriteAll *write_op{nullptr};
+  std::coroutine_handle<> waiter{};
+};
+
+class Reactor;
+
+// Resolves to the next complete frame on the connection, or std::nullopt once
+// the peer has closed or the socket has failed.
+class ReadFrame {
+public:
+  ReadFrame(Reactor &r, Conn *c) : r_(r), c_(c) {}
+  bool await_ready() { return poll(); }
+  bool await_suspend(std::coroutine_handle<> h);
+  auto await_resume() -> std::optional<std::string>;
+
+  // Makes as much progress as the socket allows; true once the await is done.
+  bool poll();
+
+private:
+  Reactor &r_;
+  Conn *c_;
+  std::optional<std::string> frame_{};
+  bool closed_{false};
+};
+
+// Resolves once the connection's output buffer has been drained; false if
+// the socket failed first.
+class WriteAll {
+public:
+  WriteAll(Reactor &r, Conn *c) : r_(r), c_(c) {}
+  bool await_ready() { return poll(); }
+  void await_suspend(std::coroutine_handle<> h);
+  bool await_resume() const { return !failed_; }
+
+  bool poll();
+
+private:
+  Reactor &r_;
+  Conn *c_;
+  bool failed_{false};
+};
+
+// Resolves to the next accepted client fd.
+class Accept {
+public:
+  Accept(Reactor &r, int listenfd) : r_(r), listenfd_(listenfd) {}
+  bool await_ready() { return poll(); }
+  void await_suspend(std::coroutine_handle<> h);
+  int await_resume() const { return fd_; }
+
+  bool poll();
+
+private:
+  Reactor &r_;
+  int listenfd_;
+  int fd_{-1};
+};
+
+class Sleep {
+public:
+  Sleep(Reactor &r, Clock::time_point deadline) : r_(r), deadline_(deadline) {}
+  bool await_ready() const;
+  void await_suspend(std::coroutine_handle<> h);
+  void await_resume() const {}
+
+private:
+  Reactor &r_;
+  Clock::time_point deadline_;
+};
+
+// Drives coroutines off the server's epoll instance. Connections are
+// registered with epoll_event::data.ptr set to their Conn; the listening
+// socket is registered with a null data.ptr.
+//
+// Each poll() is one tick. A connection may consume kFrameBudget frames or
+// kByteBudget bytes of input per tick; past that its reader parks on the
+// ready list and resumes next tick, so one chatty client can't hold up the
+// rest. Ticks run game work first (socket events, the ready list, timers)
+// and only then at most kAcceptBudget accepts.
+class Reactor {
+public:
+  explicit Reactor(int epfd, Io &io = system_io());
+
+  auto read_frame(Conn *c) -> ReadFrame { return ReadFrame{*this, c}; }
+  auto write(Conn *c) -> WriteAll { return WriteAll{*this, c}; }
+  auto accept(int listenfd) -> Accept { return Accept{*this, listenfd}; }
+  auto sleep_for(Clock::duration d) -> Sleep {
+    return Sleep{*this, io_.now() + d};
+  }
+
+  // Runs one epoll_wait round and fires any due timers. A negative timeout
+  // waits until the next timer (or forever if there is none).
+  void poll(int timeout_ms = -1);
+  void run(const volatile std::sig_atomic_t &stop);
+  // Work is carried over to the next tick: poll(0) rather than wait.
+  bool has_ready() const;
+  // Called at the end of every poll(), once the round's coroutines have run.
+  void on_tick_end(std::function<void()> fn);
+  // The last tick's loop lag: how long the longest-waiting work it ran had
+  // been ready, from epoll reporting it (or from the previous tick, for a
+  // connection carried over, or a timer's deadline) to the tick's end.
+  auto lag() const -> Clock::duration { return lag_; }
+
+private:
+  friend class ReadFrame;
+  friend class WriteAll;
+  friend class Accept;
+  friend class Sleep;
+
+  struct Timer {
+    Clock::time_point deadline;
+    uint64_t seq;
+    std::coroutine_handle<> h;
+    bool operator>(const Timer &o) const {
+      return deadline != o.deadline ? deadline > o.deadline : seq > o.seq;
+    }
+  };
+
+  void dispatch(uint32_t events, Conn *c);
+  void run_ready(std::vector<Conn *> &ready);
+  void run_accepts();
+  void fire_timers();
+  auto wait_timeout(int requested_ms) const -> int;
+  // Starts a fresh budget on a new tick. False once this tick's is spent,
+  // after queueing the connection to resume next tick.
+  bool has_budget(Conn *c);
+
+  int epfd_;
+  Io &io_;
+  uint64_t tick_{1};
+  // a connection is only closed by its own coroutine, which is parked for
+  // as long as the connection sits here
+  std::vector<Conn *> ready_;
+  std::vector<Conn *> running_;
+  uint32_t accepts_{0};
+  bool listen_readable_{true};
+  Accept *accept_op_{nullptr};
+  std::coroutine_handle<> acceptor_{};
+  uint64_t timer_seq_{0};
+  std::priority_queue<Timer, std::vector<Timer>, std::greater<>> timers_;
+  std::function<void()> tick_end_;
+  Clock::time_point woke_{};
+  Clock::time_point oldest_timer_{Clock::time_point::max()};
+  Clock::duration lag_{0};
+};
+
+} // namespace reactor
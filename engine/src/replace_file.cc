@@ -0,0 +1,42 @@
+#include "replace_file.h"
+
+#include <cerrno>
+#include <fcntl.h>
+#include <system_error>
+#include <unistd.h>
+
+namespace replace_file {
+
+bool write(const std::filesystem::path &path, std::string_view bytes,
+           mode_t mode) {
+  auto tmp = path;
+  tmp += ".tmp";
+  // one left by a crash may carry other permissions, which O_CREAT keeps
+  ::unlink(tmp.c_str());
+  const int fd =
+      ::open(tmp.c_str(), O_CREAT | O_EXCL | O_WRONLY | O_CLOEXEC, mode);
+  if (fd < 0) {
+    return false;
+  }
+  bool ok = true;
+  while (ok && !bytes.empty()) {
+    const auto n = ::write(fd, bytes.data(), bytes.size());
+    if (n > 0) {
+      bytes.remove_prefix(static_cast<std::size_t>(n));
+    } else {
+      ok = n < 0 && errno == EINTR;
+    }
+  }
+  ok = ::close(fd) == 0 && ok;
+  std::error_code ec;
+  if (ok) {
+    std::filesystem::rename(tmp, path, ec);
+  }
+  if (!ok || ec) {
+    std::filesystem::remove(tmp, ec);
+    return false;
+  }
+  return true;
+}
+
+} // namespace replace_file
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <filesystem>
+#include <string_view>
+#include <sys/types.h>
+
+// Swaps a whole file for new contents: the bytes go to `path` plus ".tmp",
+// which is then renamed over `path`. Readers see the old file or the new
+// one, never a torn write, and a reader that mapped the old file keeps its
+// inode. Behind the stats and account snapshots, the history store's parts
+// and the equity tables.
+namespace replace_file {
+
+// `mode` is the new file's permissions before the umask; the temporary
+// file is created afresh with it, so the contents are never readable more
+// widely. False, with the temporary file gone, if anything fails.
+bool write(const std::filesystem::path &path, std::string_view bytes,
+           mode_t mode = 0666);
+
+} // namespace replace_file
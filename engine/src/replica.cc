@@ -0,0 +1,263 @@
+#include "replica.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <spdlog/spdlog.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace replica {
+namespace {
+
+// unsent stream past which the standby is given up on
+constexpr std::size_t kMaxBacklog = std::size_t{64} << 20;
+constexpr std::size_t kReadChunk = 64 * 1024;
+
+auto unix_address(const std::filesystem::path &path)
+    -> std::expected<sockaddr_un, ReplicaError> {
+  sockaddr_un addr{};
+  addr.sun_family = AF_UNIX;
+  const auto &name = path.native();
+  if (name.size() >= sizeof(addr.sun_path)) {
+    return std::unexpected(ReplicaError::io);
+  }
+  std::memcpy(addr.sun_path, name.c_str(), name.size() + 1);
+  return addr;
+}
+
+} // namespace
+
+auto to_string(ReplicaError e) -> std::string_view {
+  switch (e) {
+  case ReplicaError::io:
+    return "io";
+  case ReplicaError::bad_format:
+    return "bad_format";
+  }
+  return "unknown";
+}
+
+auto Sender::connect(const std::filesystem::path &path)
+    -> std::expected<std::unique_ptr<Sender>, ReplicaError> {
+  const auto addr = unix_address(path);
+  if (!addr) {
+    return std::unexpected(addr.error());
+  }
+  const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) {
+    return std::unexpected(ReplicaError::io);
+  }
+  if (::connect(fd, reinterpret_cast<const sockaddr *>(&*addr),
+                sizeof(*addr)) < 0) {
+    close(fd);
+    return std::unexpected(ReplicaError::io);
+  }
+  return std::make_unique<Sender>(fd);
+}
+
+Sender::Sender(int fd) : fd_(fd), buf_(poker::kHandLogMagic) {}
+
+Sender::~Sender() {
+  flush();
+  drop();
+}
+
+void Sender::append(poker::InputRecord in,
+                    std::span<const poker::Event> events) {
+  if (fd_ < 0) {
+    return;
+  }
+  in.events = static_cast<uint16_t>(events.size());
+  poker::append_input(buf_, in, events);
+}
+
+bool Sender::flush() {
+  if (fd_ < 0) {
+    return false;
+  }
+  while (off_ < buf_.size()) {
+    const auto n = send(fd_, buf_.data() + off_, buf_.size() - off_,
+                        MSG_DONTWAIT | MSG_NOSIGNAL);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        break;
+      }
+      spdlog::warn("Lost the standby: {}", std::strerror(errno));
+      drop();
+      return false;
+    }
+    off_ += static_cast<std::size_t>(n);
+    sent_ += static_cast<uint64_t>(n);
+  }
+  if (off_ == buf_.size()) {
+    buf_.clear();
+    off_ = 0;
+  } else if (buf_.size() - off_ > kMaxBacklog) {
+    spdlog::warn("Dropping the standby: {} bytes behind", buf_.size() - off_);
+    drop();
+    return false;
+  } else if (off_ >= buf_.size() / 2) {
+    buf_.erase(0, off_);
+    off_ = 0;
+  }
+  return true;
+}
+
+void Sender::drop() {
+  if (fd_ >= 0) {
+    close(fd_);
+    fd_ = -1;
+  }
+  buf_.clear();
+  off_ = 0;
+}
+
+auto Standby::accept_primary(const std::filesystem::path &path)
+    -> std::expected<int, ReplicaError> {
+  const auto addr = unix_address(path);
+  if (!addr) {
+    return std::unexpected(addr.error());
+  }
+  const int listenfd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (listenfd < 0) {
+    return std::unexpected(ReplicaError::io);
+  }
+  unlink(path.c_str());
+  if (bind(listenfd, reinterpret_cast<const sockaddr *>(&*addr),
+           sizeof(*addr)) < 0 ||
+      listen(listenfd, 1) < 0) {
+    close(listenfd);
+    return std::unexpected(ReplicaError::io);
+  }
+  int fd;
+  while ((fd = accept(listenfd, nullptr, nullptr)) < 0 && errno == EINTR) {
+  }
+  close(listenfd);
+  if (fd < 0) {
+    return std::unexpected(ReplicaError::io);
+  }
+  return fd;
+}
+
+auto Standby::consume(std::string_view bytes)
+    -> std::expected<void, ReplicaError> {
+  buf_.append(bytes);
+  std::size_t off = 0;
+  if (!started_) {
+    const auto n = std::min(buf_.size(), poker::kHandLogMagic.size());
+    if (std::string_view(buf_).substr(0, n) !=
+        poker::kHandLogMagic.substr(0, n)) {
+      return std::unexpected(ReplicaError::bad_format);
+    }
+    if (n < poker::kHandLogMagic.size()) {
+      return {};
+    }
+    started_ = true;
+    off = n;
+  }
+  std::vector<poker::EventRecord> events;
+  while (buf_.size() - off >= sizeof(poker::InputRecord)) {
+    poker::InputRecord in;
+    std::memcpy(&in, buf_.data() + off, sizeof(in));
+    const auto len = std::size_t{in.events} * sizeof(poker::EventRecord);
+    if (buf_.size() - off - sizeof(in) < len) {
+      break;
+    }
+    events.resize(in.events);
+    std::memcpy(static_cast<void *>(events.data()),
+                buf_.data() + off + sizeof(in), len);
+    off += sizeof(in) + len;
+    for (const auto &rec : events) {
+      if (!poker::check_record(rec)) {
+        return std::unexpected(ReplicaError::bad_format);
+      }
+    }
+    apply(in, events);
+  }
+  buf_.erase(0, off);
+  return {};
+}
+
+auto Standby::follow(int fd) -> std::expected<void, ReplicaError> {
+  std::string chunk(kReadChunk, '\0');
+  for (;;) {
+    const auto n = read(fd, chunk.data(), chunk.size());
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    // a killed primary reads as end of stream, or as a reset
+    if (n == 0 || (n < 0 && errno == ECONNRESET)) {
+      return {};
+    }
+    if (n < 0) {
+      return std::unexpected(ReplicaError::io);
+    }
+    if (auto res = consume(std::string_view(chunk.data(),
+                                            static_cast<std::size_t>(n)));
+        !res) {
+      return res;
+    }
+  }
+}
+
+std::size_t Standby::hands_in_flight() const {
+  return static_cast<std::size_t>(
+      std::count_if(state_.tables.begin(), state_.tables.end(),
+                    [](const auto &t) { return t.second.hand_in_progress(); }));
+}
+
+void Standby::apply(const poker::InputRecord &in,
+                    std::span<const poker::EventRecord> events) {
+  ++inputs_;
+  switch (in.tag) {
+  case poker::InputTag::open: {
+    auto &rng = state_.rngs.try_emplace(in.table, in.amount).first->second;
+    state_.tables.try_emplace(in.table, rng);
+    return;
+  }
+  case poker::InputTag::credential:
+    state_.accounts.add({in.who, in.amount});
+    state_.max_player = std::max(state_.max_player, in.who);
+    return;
+  case poker::InputTag::revoke:
+    state_.accounts.erase(in.who);
+    return;
+  case poker::InputTag::house_bot:
+    state_.bots[in.who] = in.table;
+    return;
+  default:
+    break;
+  }
+  auto it = state_.tables.find(in.table);
+  if (it == state_.tables.end()) {
+    ++diverged_;
+    return;
+  }
+  const auto got = poker::replay_input(it->second, in);
+  if (got.has_value() == static_cast<bool>(in.failed) ||
+      (got && !poker::same_events(*got, events))) {
+    if (diverged_++ == 0) {
+      spdlog::warn("Standby diverged from the primary at table {}", in.table);
+    }
+  }
+  if (!got) {
+    return;
+  }
+  auto &seated = state_.seated[in.table];
+  for (const auto &ev : *got) {
+    if (const auto *added = std::get_if<poker::PlayerAdded>(&ev)) {
+      seated.push_back(added->who);
+      state_.max_player = std::max(state_.max_player, added->who);
+    } else if (const auto *removed = std::get_if<poker::PlayerRemoved>(&ev)) {
+      std::erase(seated, removed->who);
+      state_.bots.erase(removed->who);
+    }
+  }
+}
+
+} // namespace replica
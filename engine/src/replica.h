@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <memory>
+#include <random>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "accounts.h"
+#include "hand_audit.h"
+#include "table.h"
+
+// Hot standby. The primary streams every Table call it makes -- the same
+// records it journals to the hand log -- to a standby process over a local
+// socket, and the standby makes the same calls on its own Tables, checking
+// each against the events the primary got. When the primary dies the
+// socket closes and the standby takes over with the tables as they were.
+// Accounts and house bots ride along on the same stream, so players can
+// resume on the standby and its bots keep playing.
+namespace replica {
+
+enum class ReplicaError : uint8_t { io, bad_format };
+
+auto to_string(ReplicaError e) -> std::string_view;
+
+// The primary's side. Records are batched in memory and written once per
+// reactor tick without blocking, so replication costs the action path a
+// copy and, per tick, one send.
+class Sender {
+public:
+  static auto connect(const std::filesystem::path &path)
+      -> std::expected<std::unique_ptr<Sender>, ReplicaError>;
+  // Takes ownership of a connected stream socket.
+  explicit Sender(int fd);
+  Sender(const Sender &) = delete;
+  Sender &operator=(const Sender &) = delete;
+  ~Sender();
+
+  void append(poker::InputRecord in, std::span<const poker::Event> events);
+  // Sends what the socket will take now and keeps the rest for next time.
+  // False once the standby is gone or too far behind; it is then dropped.
+  bool flush();
+  bool connected() const { return fd_ >= 0; }
+  uint64_t bytes_sent() const { return sent_; }
+
+private:
+  void drop();
+
+  int fd_;
+  std::string buf_;
+  std::size_t off_{0}; // sent from the front of buf_
+  uint64_t sent_{0};
+};
+
+// What a standby hands over to the server it becomes. The tables hold
+// references into `rngs`, which is node-based, so both move as they are.
+struct Replicated {
+  std::unordered_map<poker::TableId, std::mt19937_64> rngs;
+  std::unordered_map<poker::TableId, poker::Table> tables;
+  // who the primary had seated, house bots included
+  std::unordered_map<poker::TableId, std::vector<poker::PlayerId>> seated;
+  // the seated house bots and their tables
+  std::unordered_map<poker::PlayerId, poker::TableId> bots;
+  poker::Accounts accounts;
+  poker::PlayerId max_player{0};
+};
+
+// The standby's side.
+class Standby {
+public:
+  // Waits on `path` for the primary to connect; the connected socket.
+  static auto accept_primary(const std::filesystem::path &path)
+      -> std::expected<int, ReplicaError>;
+
+  // Applies the next bytes of the stream; they may split records anywhere.
+  auto consume(std::string_view bytes) -> std::expected<void, ReplicaError>;
+  // Reads `fd` and applies it until the primary goes away.
+  auto follow(int fd) -> std::expected<void, ReplicaError>;
+
+  uint64_t inputs() const { return inputs_; }
+  // calls whose outcome here differs from the primary's
+  uint64_t diverged() const { return diverged_; }
+  std::size_t tables() const { return state_.tables.size(); }
+  std::size_t hands_in_flight() const;
+  auto take() -> Replicated { return std::move(state_); }
+
+private:
+  void apply(const poker::InputRecord &in,
+             std::span<const poker::EventRecord> events);
+
+  Replicated state_;
+  std::string buf_;
+  bool started_{false}; // the magic has been read
+  uint64_t inputs_{0};
+  uint64_t diverged_{0};
+};
+
+} // namespace replica
@@ -1,127 +1,152 @@
 #include "server.h"
 
+#include <algorithm>
+#include <chrono>
 #include <cstdint>
+#include <iterator>
 #include <netinet/in.h>
 #include <random>
 #include <span>
 #include <spdlog/spdlog.h>
+#include <string>
 #include <sys/epoll.h>
-#include <sys/socket.h>
-#include <unistd.h>
+#include <utility>
 
 #include "errors.h"
 #include "player.h"
 #include "proto_translate.h"
 #include "response.pb.h"
+#include "wire_writer.h"
 
 namespace {
 
 constexpr std::size_t kMaxConnections = 102;
+constexpr std::size_t kMaxTablesPerConn = 16;
+// TODO: make this different for each table
+constexpr uint64_t kTableSeed = 0;
+// A chat line is at most kMaxChatBytes. A sender may say kChatBurst lines
+// at once, then one per kChatInterval.
+constexpr std::size_t kMaxChatBytes = 256;
+constexpr int kChatBurst = 5;
+constexpr auto kChatInterval = std::chrono::seconds{2};
+// a watcher this far behind on writes is dropped rather than buffered for
+constexpr std::size_t kMaxWatcherBacklog = std::size_t{1} << 20;
+// how soon held-back broadcasts are looked at again while shedding
+constexpr auto kShedRetry = std::chrono::milliseconds{100};
+// how long an adopted player has to reconnect and Resume
+constexpr auto kAdoptGrace = std::chrono::seconds{30};
+// fast-fold hands are dealt this many handed, and a player who takes longer
+// than kPoolTurnTime to act is timed out
+constexpr std::size_t kPoolSeats = 6;
+constexpr auto kPoolTurnTime = std::chrono::milliseconds{15000};
 
-void publish_msg(const std::string &msg, Conn *conn) {
-  uint32_t len = htonl(static_cast<uint32_t>(msg.size()));
-  spdlog::debug("Going to write {} bytes to fd {}", msg.size(), conn->fd);
-  conn->out.append(reinterpret_cast<const char *>(&len), sizeof(len));
-  conn->out += msg;
+bool seated_at(const Conn *conn, poker::TableId table) {
+  return std::ranges::find(conn->tables, table) != conn->tables.end();
 }
 
-void append_event(::poker::v1::Response &res, const poker::Event &ev) {
-  *res.add_messages()->mutable_event() = poker::to_proto_event(ev);
+bool watching(const Conn *conn, poker::TableId table) {
+  return std::ranges::find(conn->watching, table) != conn->watching.end();
 }
 
-bool event_visible_to(const poker::Event &ev, const Conn *conn) {
-  if (const auto *dealt = std::get_if<poker::DealtHole>(&ev)) {
-    return dealt->who == conn->player_id;
-  }
-  return true;
-}
-
-::poker::v1::Response make_response(const Outbound &out) {
-  ::poker::v1::Response res;
-  if (std::holds_alternative<std::vector<poker::Event>>(out)) {
-    for (const auto &ev : std::get<std::vector<poker::Event>>(out)) {
-      append_event(res, ev);
+// Appends `out` to `buf` as a serialized Response: events straight in wire
+// format, errors through protobuf.
+void append_outbound(std::string &buf, const Outbound &out,
+                     poker::TableId table, poker::HandId hand = 0) {
+  if (const auto *ev = std::get_if<poker::Event>(&out)) {
+    wire::append_event(buf, *ev, table, hand);
+  } else if (const auto *events =
+                 std::get_if<std::vector<poker::Event>>(&out)) {
+    for (const auto &ev : *events) {
+      wire::append_event(buf, ev, table, hand);
     }
-  } else if (std::holds_alternative<poker::Event>(out)) {
-    const auto &err = std::get<poker::Event>(out);
-    append_event(res, err);
   } else {
-    const auto &err = std::get<poker::Error>(out);
-    *res.add_messages()->mutable_error() = poker::to_proto_error(err);
+    ::poker::v1::Response res;
+    auto *msg = res.add_messages();
+    *msg->mutable_error() = poker::to_proto_error(std::get<poker::Error>(out));
+    msg->set_table_id(table);
+    msg->set_hand_id(hand);
+    res.AppendToString(&buf);
   }
-  return res;
 }
 
-void publish(const Outbound &out, Conn *const conn) {
-  ::poker::v1::Response res = make_response(out);
-  std::string msg;
-  res.SerializeToString(&msg);
-  publish_msg(msg, conn);
+void publish(const Outbound &out, Conn *const conn, poker::TableId table,
+             poker::HandId hand = 0) {
+  const auto from = conn->pending.size();
+  append_outbound(conn->pending, out, table, hand);
+  spdlog::debug("Queueing {} bytes for fd {}", conn->pending.size() - from,
+                conn->fd);
 }
 
-void publish(const Outbound &out, std::span<Conn *const> conns) {
+// Each connection gets the events it may see, written into its queue.
+void publish(const Outbound &out, std::span<Conn *const> conns,
+             poker::TableId table, poker::HandId hand = 0) {
   if (std::holds_alternative<poker::Error>(out)) {
     spdlog::warn("Attempted to broadcast error to table; dropping");
     return;
   }
-  if (std::holds_alternative<poker::Event>(out)) {
-    const auto &ev = std::get<poker::Event>(out);
-    for (const auto &conn : conns) {
-      if (!event_visible_to(ev, conn)) {
-        continue;
-      }
-      ::poker::v1::Response res;
-      append_event(res, ev);
-      std::string msg;
-      res.SerializeToString(&msg);
-      publish_msg(msg, conn);
-    }
-    return;
-  }
-  const auto &events = std::get<std::vector<poker::Event>>(out);
-  for (const auto &conn : conns) {
-    ::poker::v1::Response res;
+  const auto single = std::get_if<poker::Event>(&out);
+  const auto events =
+      single != nullptr ? std::span<const poker::Event>(single, 1)
+                        : std::span<const poker::Event>(
+                              std::get<std::vector<poker::Event>>(out));
+  for (auto *conn : conns) {
+    const auto from = conn->pending.size();
     for (const auto &ev : events) {
-      if (event_visible_to(ev, conn)) {
-        append_event(res, ev);
+      if (encode::visible_to(ev, conn->player_id)) {
+        wire::append_event(conn->pending, ev, table, hand);
       }
     }
-    if (res.messages_size() == 0) {
-      continue;
-    }
-    std::string msg;
-    res.SerializeToString(&msg);
-    publish_msg(msg, conn);
+    spdlog::debug("Queueing {} bytes for fd {}", conn->pending.size() - from,
+                  conn->fd);
   }
 }
 
 } // namespace
 
-void update_interest(Conn *const c, int epfd) {
+void update_interest(reactor::Io &io, Conn *const c, int epfd) {
   epoll_event nev{};
   nev.data.ptr = c;
   nev.events = EPOLLIN | EPOLLET | (!c->out.empty() * EPOLLOUT);
   spdlog::debug("Conn fd {} EPOLLOUT: {}", c->fd,
                 static_cast<int>(nev.events & EPOLLOUT));
-  epoll_ctl(epfd, EPOLL_CTL_MOD, c->fd, &nev);
+  io.epoll_ctl(epfd, EPOLL_CTL_MOD, c->fd, &nev);
+}
+
+void frame_pending(Conn *const c) {
+  if (c->pending.empty()) {
+    return;
+  }
+  uint32_t len = htonl(static_cast<uint32_t>(c->pending.size()));
+  c->out.append(reinterpret_cast<const char *>(&len), sizeof(len));
+  c->out += c->pending;
+  ++c->cost.frames_out;
+  c->cost.bytes_out += sizeof(len) + c->pending.size();
+  c->pending.clear();
 }
 
-Conn::Conn(int cfd, poker::PlayerId id) : fd(cfd), player_id(id) {}
+Conn::Conn(int cfd, poker::PlayerId id)
+    : fd(cfd), player_id(id), connected_as(id) {}
 
-Server::Server(int epfd, int listenfd) : epfd_(epfd), listenfd_(listenfd) {}
+Server::Server(int epfd, int listenfd, reactor::Io &io, load::Slo slo)
+    : epfd_(epfd), listenfd_(listenfd), io_(io), pool_(kPoolSeats),
+      governor_(slo) {}
 
 Server::~Server() {
   for (auto &[_, conn] : connections_) {
-    close(conn->fd);
+    io_.close(conn->fd);
   }
-  close(epfd_);
-  close(listenfd_);
+  io_.close(epfd_);
+  io_.close(listenfd_);
 }
 
 int Server::epfd() const { return epfd_; }
 
 int Server::listenfd() const { return listenfd_; }
 
+auto Server::io() const -> reactor::Io & { return io_; }
+
+std::size_t Server::connections() const { return connections_.size(); }
+
 auto Server::handle_connect(const int cfd) -> ConnectResult {
   // create a connection object
   poker::PlayerId new_pid = next_player_id_++;
@@ -133,41 +158,24 @@ auto Server::handle_connect(const int cfd) -> ConnectResult {
   epoll_event cev{};
   cev.events = EPOLLIN | EPOLLOUT | EPOLLET;
   cev.data.ptr = conn;
-  epoll_ctl(epfd_, EPOLL_CTL_ADD, cfd, &cev);
+  io_.epoll_ctl(epfd_, EPOLL_CTL_ADD, cfd, &cev);
   spdlog::info("Accepted connection on fd {}", cfd);
+  if (capture_) {
+    capture_->record(capture::Kind::open, io_.now(), new_pid);
+  }
   // if we exceed max number of connected clients, return an error
   if (connections_.size() > kMaxConnections) {
     spdlog::warn("Too many clients connected ({}), rejecting player {}",
                  connections_.size(), new_pid);
     return {conn, std::unexpected(poker::ServerError::too_many_clients)};
   }
-  // find a table to seat the player
-  poker::TableId tid = 0;
-  for (const auto &[id, table] : tables_) {
-    if (table.has_open_seat()) {
-      tid = id;
-      break;
-    }
-  }
-  // if no open tables, create one
-  auto it = tables_.find(tid);
-  if (it == tables_.end()) {
-    tid = next_table_id_++;
-    std::mt19937_64 rng(0); // TODO: make this different for each table
-    it = tables_.emplace(tid, poker::Table(rng)).first;
-    spdlog::info("Created new table {}", tid);
-  }
-  // seat the player at the found table or return an error
-  auto add_result = it->second.add_player(new_pid);
-  conn->table_id = tid;
-  if (add_result) {
-    spdlog::info("Seated player {} at table {}", new_pid, tid);
-  } else {
-    spdlog::warn("Failed to seat player {} at table {}: {}", new_pid, tid,
-                 poker::to_string(add_result.error()));
-  }
-  conn->is_dead = add_result ? false : true;
-  return {conn, add_result};
+  const poker::Credential cred{new_pid, io_.random()};
+  accounts_.add(cred);
+  replicate({.tag = poker::InputTag::credential,
+             .who = cred.player,
+             .amount = cred.token});
+  welcome(conn, cred);
+  return {conn, join_table(conn)};
 }
 
 void Server::handle_close(const poker::PlayerId id) {
@@ -175,18 +183,37 @@ void Server::handle_close(const poker::PlayerId id) {
     spdlog::warn("Attempted close on player id {} which does not exist", id);
     return;
   }
+  if (connections_.at(id)->encoding != 0) {
+    drain_encoders(); // or a Resume as this id would be sent its batches
+  }
   auto conn = std::move(connections_[id]);
-  epoll_ctl(epfd_, EPOLL_CTL_DEL, conn->fd, nullptr);
-  close(conn->fd);
+  if (capture_) {
+    capture_->record(capture::Kind::close, io_.now(), conn->connected_as);
+  }
+  io_.epoll_ctl(epfd_, EPOLL_CTL_DEL, conn->fd, nullptr);
+  io_.close(conn->fd);
   connections_.erase(id);
-  if (conn->table_id != 0 && tables_.contains(conn->table_id)) {
-    auto result = tables_.at(conn->table_id).remove_player(id);
-    if (!result) {
-      spdlog::warn("Failed to remove player {} from table {}: {}", id,
-                   conn->table_id, poker::to_string(result.error()));
+  if (conn->flush_queued) {
+    std::erase(dirty_, conn.get());
+  }
+  for (const auto tid : std::vector(conn->watching)) {
+    unwatch(conn.get(), tid);
+  }
+  // a hand the player was in may end with them, so the table hears about
+  // it and deals again as after any action
+  for (const auto tid : std::vector(conn->tables)) {
+    if (auto events = leave_table(conn.get(), tid); !events.empty()) {
+      settle_table(tid, Outbound{std::move(events)});
     }
   }
-  spdlog::info("Closed connection on fd {}", conn->fd);
+  // a fast-fold hand plays on, timing them out, until it lets them go
+  quit_pool(id);
+  release_account(id);
+  const auto line = stats_.line(id);
+  spdlog::info("Closed connection on fd {} (player {}: {} hands, VPIP {:.0f}% "
+               "PFR {:.0f}% AF {:.1f})",
+               conn->fd, id, line.hands, line.vpip * 100, line.pfr * 100,
+               line.aggression);
 }
 
 auto Server::start_hand(const poker::TableId id)
@@ -194,7 +221,9 @@ auto Server::start_hand(const poker::TableId id)
   if (!tables_.contains(id)) {
     return std::unexpected(poker::ServerError::illegal_action);
   }
-  return tables_.at(id).handle_new_hand();
+  auto res = tables_.at(id).handle_new_hand();
+  journal({.tag = poker::InputTag::new_hand, .table = id}, res);
+  return res;
 }
 
 auto Server::maybe_start_hand(const poker::TableId id)
@@ -204,49 +233,1127 @@ auto Server::maybe_start_hand(const poker::TableId id)
     return std::nullopt;
   }
   auto &table = it->second;
-  if (!table.can_start_hand()) {
+  if (table.hand_in_progress()) {
+    return std::nullopt;
+  }
+  std::vector<poker::Event> events;
+  seat_house_bots(id, table, events);
+  if (table.can_start_hand()) {
+    auto res = table.handle_new_hand();
+    journal({.tag = poker::InputTag::new_hand, .table = id}, res);
+    if (res) {
+      events.insert(events.end(), res->begin(), res->end());
+    } else {
+      spdlog::warn("Failed to auto-start hand at table {}: {}", id,
+                   poker::to_string(res.error()));
+    }
+  }
+  if (events.empty()) {
     return std::nullopt;
   }
-  auto res = table.handle_new_hand();
+  return events;
+}
+
+void Server::settle_table(const poker::TableId id, const Outbound &out) {
+  push_table(id, out);
+  if (auto next = maybe_start_hand(id)) {
+    push_table(id, Outbound{*next});
+  }
+}
+
+auto Server::apply_bot_turn(const poker::BotTurn &turn)
+    -> std::optional<std::vector<poker::Event>> {
+  auto it = tables_.find(turn.table);
+  if (it == tables_.end() || !bots_.is_current(turn)) {
+    return std::nullopt;
+  }
+  auto &table = it->second;
+  const auto action = bots_.decide(turn, table);
+  auto res = table.on_action(action);
+  journal(poker::to_input(turn.table, action), res);
   if (!res) {
-    spdlog::warn("Failed to auto-start hand at table {}: {}", id,
-                 poker::to_string(res.error()));
+    // a timeout is always legal for the player on the clock
+    res = table.on_action(poker::Timeout{turn.bot});
+    journal(poker::to_input(turn.table, poker::Timeout{turn.bot}), res);
+  }
+  if (!res) {
+    spdlog::warn("House bot {} could not act at table {}: {}", turn.bot,
+                 turn.table, poker::to_string(res.error()));
     return std::nullopt;
   }
   return std::move(*res);
 }
 
+auto Server::take_bot_turns() -> std::vector<poker::BotTurn> {
+  return std::exchange(bot_turns_, {});
+}
+
+bool Server::take_pool_clock() {
+  if (pool_clock_ || pool_turns_.empty()) {
+    return false;
+  }
+  pool_clock_ = true;
+  return true;
+}
+
+auto Server::time_out_pool_turns()
+    -> std::optional<reactor::Clock::duration> {
+  while (!pool_turns_.empty()) {
+    const auto turn = pool_turns_.front();
+    if (const auto now = io_.now(); turn.due > now) {
+      return turn.due - now;
+    }
+    pool_turns_.pop_front();
+    const auto it = pool_turn_.find(turn.hand);
+    if (it != pool_turn_.end() && it->second == turn.seq) {
+      pool_turn_.erase(it);
+      time_out(turn.hand, turn.who);
+    }
+  }
+  pool_clock_ = false;
+  return std::nullopt;
+}
+
 auto Server::apply_action(const ::poker::v1::Action a, poker::PlayerId id)
-    -> std::expected<std::vector<poker::Event>, poker::Error> {
+    -> std::expected<TableEvents, poker::Error> {
+  using Payload = ::poker::v1::Action::PayloadCase;
+  auto conn = connections_.at(id).get();
+  if (a.payload_case() == Payload::kJoin) {
+    return a.join().fast_fold() ? join_pool(conn) : join_table(conn);
+  }
+  if (a.payload_case() == Payload::kLeave && a.leave().fast_fold()) {
+    return leave_pool(conn);
+  }
+  if (a.hand_id() != 0) {
+    return act_in_pool(conn, a);
+  }
+  if (a.payload_case() == Payload::kWatch) {
+    if (auto watched = watch(conn, a.table_id()); !watched) {
+      return std::unexpected(watched.error());
+    }
+    return TableEvents{a.table_id(), {}};
+  }
+  if (a.payload_case() == Payload::kUnwatch) {
+    unwatch(conn, a.table_id());
+    return TableEvents{a.table_id(), {}};
+  }
+  if (a.payload_case() == Payload::kLeaderboard) {
+    show_leaderboard(conn, a.leaderboard());
+    return TableEvents{0, {}};
+  }
+  if (a.payload_case() == Payload::kStats) {
+    show_stats(conn, a.stats());
+    return TableEvents{0, {}};
+  }
+  const auto tid = a.table_id() != 0      ? a.table_id()
+                   : conn->tables.empty() ? 0
+                                          : conn->tables.front();
+  if (!seated_at(conn, tid) || !tables_.contains(tid)) {
+    return std::unexpected(poker::ServerError::illegal_action);
+  }
+  if (a.payload_case() == Payload::kChat) {
+    if (auto said = say(conn, tid, a.chat().text()); !said) {
+      return std::unexpected(said.error());
+    }
+    return TableEvents{tid, {}};
+  }
+  if (a.payload_case() == Payload::kLeave) {
+    auto events = leave_table(conn, tid);
+    push_one(id, Outbound{events}, tid);
+    return TableEvents{tid, std::move(events)};
+  }
   auto action = poker::from_proto_action(a, id);
   if (!action) {
     return std::unexpected(action.error());
   }
-  auto conn = connections_.at(id).get();
-  if (conn->table_id == 0 || !tables_.contains(conn->table_id)) {
-    return std::unexpected(poker::ServerError::illegal_action);
+  auto res = tables_.at(tid).on_action(action.value());
+  journal(poker::to_input(tid, *action), res);
+  if (!res) {
+    return std::unexpected(res.error());
   }
-  return tables_.at(conn->table_id).on_action(action.value());
+  return TableEvents{tid, std::move(*res)};
 }
 
-void Server::push_one(const poker::PlayerId id, const Outbound &out) {
-  publish(out, connections_[id].get());
+void Server::push_one(const poker::PlayerId id, const Outbound &out,
+                      const poker::TableId table, const poker::HandId hand) {
+  auto *conn = connections_[id].get();
+  if (conn->encoding != 0) {
+    drain_encoders(); // so this lands after the broadcasts ahead of it
+  }
+  const auto from = conn->pending.size();
+  publish(out, conn, table, hand);
+  capture_outbound(conn, from);
+  queue_flush(conn);
 }
 
 void Server::push_table(const poker::TableId id, const Outbound &out) {
   auto conns = get_table_conns(id);
-  publish(out, conns);
-  for (const auto &conn : conns) {
-    update_interest(conn, epfd_);
+  if (encoders_ && !std::holds_alternative<poker::Error>(out)) {
+    submit_encode(id, out, conns);
+    queue_bot_turns(id, out);
+    record_hand(id, out);
+    return;
+  }
+  std::vector<std::size_t> from;
+  if (capture_) {
+    for (const auto *conn : conns) {
+      from.push_back(conn->pending.size());
+    }
+  }
+  publish(out, conns, id);
+  for (std::size_t i = 0; i < conns.size(); ++i) {
+    if (capture_) {
+      capture_outbound(conns[i], from[i]);
+    }
+    queue_flush(conns[i]);
+  }
+  if (auto feed = feeds_.find(id);
+      feed != feeds_.end() && !std::holds_alternative<poker::Error>(out)) {
+    // one encoding for every watcher, hole cards and all
+    std::string frame(sizeof(uint32_t), '\0');
+    append_outbound(frame, out, id);
+    const auto body = frame.size() - sizeof(uint32_t);
+    const uint32_t len = htonl(static_cast<uint32_t>(body));
+    frame.replace(0, sizeof(len), reinterpret_cast<const char *>(&len),
+                  sizeof(len));
+    feed->second.line.push(io_.now() + broadcast_delay_, frame);
+  }
+  queue_bot_turns(id, out);
+  record_hand(id, out);
+}
+
+void Server::enable_encoders(unsigned workers) {
+  encoders_ = std::make_unique<encode::Pool>(workers);
+  spdlog::info("Encoding broadcasts on {} threads", std::max(workers, 1u));
+}
+
+void Server::submit_encode(poker::TableId id, const Outbound &out,
+                           std::span<Conn *const> conns) {
+  if (encoders_->full()) {
+    drain_encoders();
+  }
+  auto &batch = encoders_->next();
+  batch.table = id;
+  if (const auto *ev = std::get_if<poker::Event>(&out)) {
+    batch.events.push_back(*ev);
+  } else {
+    const auto &events = std::get<std::vector<poker::Event>>(out);
+    batch.events.assign(events.begin(), events.end());
+  }
+  for (auto *conn : conns) {
+    batch.viewers.push_back(conn->player_id);
+    ++conn->encoding;
+  }
+  if (feeds_.contains(id)) {
+    batch.viewers.push_back(encode::kEveryone);
+  }
+  encoders_->submit();
+}
+
+void Server::drain_encoders() {
+  if (!encoders_) {
+    return;
+  }
+  encoders_->drain([this](const encode::Batch &batch) {
+    for (std::size_t i = 0; i < batch.viewers.size(); ++i) {
+      const auto viewer = batch.viewers[i];
+      if (viewer == encode::kEveryone) {
+        if (auto feed = feeds_.find(batch.table); feed != feeds_.end()) {
+          feed->second.line.push(io_.now() + broadcast_delay_, batch.out[i]);
+        }
+        continue;
+      }
+      // the connection may have closed since
+      const auto it = connections_.find(viewer);
+      if (it == connections_.end()) {
+        continue;
+      }
+      auto *conn = it->second.get();
+      --conn->encoding;
+      const auto from = conn->pending.size();
+      conn->pending += batch.out[i];
+      capture_outbound(conn, from);
+      queue_flush(conn);
+    }
+  });
+}
+
+void Server::enable_hand_history(const std::filesystem::path &root) {
+  hh_writer_ = std::make_unique<hhstore::Writer>(root);
+  spdlog::info("Exporting hand history to {}", root.string());
+}
+
+auto Server::enable_capture(const std::filesystem::path &path)
+    -> std::expected<void, capture::CaptureError> {
+  auto writer = capture::Writer::open(path);
+  if (!writer) {
+    return std::unexpected(writer.error());
+  }
+  capture_ = std::move(*writer);
+  spdlog::info("Capturing traffic to {}", path.string());
+  return {};
+}
+
+void Server::capture_inbound(const poker::PlayerId id,
+                             std::string_view payload) {
+  if (capture_) {
+    capture_->record(capture::Kind::inbound, io_.now(), id, payload);
+  }
+}
+
+void Server::flush_logs() {
+  if (capture_) {
+    capture_->flush();
+  }
+  if (hand_log_) {
+    hand_log_->flush();
+  }
+}
+
+bool Server::logging() const { return capture_ || hand_log_; }
+
+void Server::capture_outbound(const Conn *conn, std::size_t from) {
+  if (capture_ && conn->pending.size() > from) {
+    capture_->record(capture::Kind::outbound, io_.now(), conn->connected_as,
+                     std::string_view(conn->pending).substr(from));
+  }
+}
+
+auto Server::enable_hand_log(const std::filesystem::path &path)
+    -> std::expected<void, poker::AuditError> {
+  auto writer = poker::HandLogWriter::open(path);
+  if (!writer) {
+    return std::unexpected(writer.error());
+  }
+  hand_log_ = std::move(*writer);
+  spdlog::info("Journaling tables to {}", path.string());
+  return {};
+}
+
+auto Server::enable_replication(const std::filesystem::path &path)
+    -> std::expected<void, replica::ReplicaError> {
+  auto sender = replica::Sender::connect(path);
+  if (!sender) {
+    return std::unexpected(sender.error());
+  }
+  replica_ = std::move(*sender);
+  for (const auto &cred : accounts_.credentials()) {
+    replicate({.tag = poker::InputTag::credential,
+               .who = cred.player,
+               .amount = cred.token});
+  }
+  spdlog::info("Replicating tables to the standby at {}", path.string());
+  return {};
+}
+
+void Server::adopt(replica::Replicated replicated) {
+  rngs_ = std::move(replicated.rngs);
+  tables_ = std::move(replicated.tables);
+  for (const auto &[tid, table] : tables_) {
+    next_table_id_ = std::max(next_table_id_, tid + 1);
+  }
+  next_player_id_ = std::max(next_player_id_, replicated.max_player + 1);
+  // the stream is newer than any accounts file
+  for (const auto &cred : replicated.accounts.credentials()) {
+    accounts_.add(cred);
+  }
+  next_player_id_ = std::max(next_player_id_, accounts_.id_bound());
+  for (const auto &[bot, tid] : replicated.bots) {
+    bots_.add(bot, tid);
+  }
+  for (const auto &[tid, seated] : replicated.seated) {
+    for (const auto who : seated) {
+      if (!bots_.is_bot(who)) {
+        held_[who].push_back(tid);
+      }
+    }
+    const auto next = tables_.at(tid).on_clock();
+    if (next && bots_.is_bot(*next)) {
+      bot_turns_.push_back(bots_.on_turn(tid, *next));
+    }
+  }
+  held_until_ = io_.now() + kAdoptGrace;
+  spdlog::info("Adopted {} tables, {} house bots and {} players' seats from "
+               "the primary",
+               tables_.size(), replicated.bots.size(), held_.size());
+}
+
+auto Server::seats_held_for() const
+    -> std::optional<reactor::Clock::duration> {
+  if (held_.empty()) {
+    return std::nullopt;
+  }
+  return std::max(held_until_ - io_.now(), reactor::Clock::duration::zero());
+}
+
+auto Server::release_held_seats() -> std::vector<TableEvents> {
+  std::vector<TableEvents> out;
+  for (const auto &[who, tables] : std::exchange(held_, {})) {
+    for (const auto tid : tables) {
+      auto events = vacate(tid, who);
+      auto it = std::ranges::find(out, tid, &TableEvents::table);
+      if (it == out.end()) {
+        out.push_back({tid, std::move(events)});
+      } else {
+        it->events.insert(it->events.end(), events.begin(), events.end());
+      }
+    }
+    spdlog::info("Player {} did not resume; gave up their seats", who);
+  }
+  return out;
+}
+
+auto Server::enable_live_state(const std::filesystem::path &path)
+    -> std::expected<void, live::LiveError> {
+  auto publisher = live::Publisher::open(path);
+  if (!publisher) {
+    return std::unexpected(publisher.error());
+  }
+  live_ = std::move(*publisher);
+  spdlog::info("Publishing live table state to {}", path.string());
+  return {};
+}
+
+auto Server::stats() const -> const poker::PlayerStats & { return stats_; }
+
+auto Server::leaderboard() const -> const poker::Leaderboard & {
+  return leaderboard_;
+}
+
+void Server::show_leaderboard(Conn *conn,
+                              const ::poker::v1::Action::Leaderboard &req) {
+  using Proto = ::poker::v1::Action::Leaderboard;
+  const auto board = req.board() == Proto::BOARD_HANDS
+                         ? poker::Board::hands
+                         : poker::Board::net_winnings;
+  ::poker::v1::Response res;
+  auto *out = res.add_messages()->mutable_leaderboard();
+  out->set_board(req.board());
+  out->set_page(req.page());
+  if (const auto page = leaderboard_.page(board, req.page())) {
+    out->set_players(page->players);
+    for (const auto &e : page->entries) {
+      auto *entry = out->add_entries();
+      entry->set_rank(e.rank);
+      entry->set_player(e.player);
+      entry->set_score(e.score);
+    }
+  }
+  send(conn, res);
+}
+
+void Server::show_stats(Conn *conn, const ::poker::v1::Action::Stats &req) {
+  const auto line = stats_.line(req.player());
+  ::poker::v1::Response res;
+  auto *out = res.add_messages()->mutable_stats();
+  out->set_player(req.player());
+  out->set_hands(line.hands);
+  out->set_vpip(line.vpip);
+  out->set_pfr(line.pfr);
+  out->set_aggression(line.aggression);
+  out->set_showdown(line.showdown);
+  send(conn, res);
+}
+
+void Server::send(Conn *conn, const ::poker::v1::Response &res) {
+  if (conn->encoding != 0) {
+    drain_encoders(); // so this lands after the broadcasts ahead of it
+  }
+  const auto from = conn->pending.size();
+  res.AppendToString(&conn->pending);
+  capture_outbound(conn, from);
+  queue_flush(conn);
+}
+
+void Server::welcome(Conn *conn, const poker::Credential &cred) {
+  ::poker::v1::Response res;
+  auto *out = res.add_messages()->mutable_welcome();
+  out->set_player(cred.player);
+  out->set_token(cred.token);
+  send(conn, res);
+}
+
+auto Server::resume(const poker::PlayerId id,
+                    const ::poker::v1::Action::Resume &req)
+    -> std::expected<std::vector<TableEvents>, poker::Error> {
+  const poker::Credential cred{req.player(), req.token()};
+  // a player still connected keeps their connection
+  if (!accounts_.verify(cred) || connections_.contains(cred.player)) {
+    return std::unexpected(poker::ServerError::bad_credential);
+  }
+  auto *conn = connections_.at(id).get();
+  if (conn->encoding != 0) {
+    drain_encoders(); // the encoders name their viewers by player id
+  }
+  std::vector<TableEvents> out;
+  for (const auto tid : std::vector(conn->tables)) {
+    auto events = leave_table(conn, tid);
+    push_one(id, Outbound{events}, tid);
+    out.push_back({tid, std::move(events)});
+  }
+  auto node = connections_.extract(id);
+  node.key() = cred.player;
+  connections_.insert(std::move(node));
+  conn->player_id = cred.player;
+  // the connection's own id is gone from here on
+  quit_pool(id);
+  release_account(id);
+  spdlog::info("Player {} resumed as player {}", id, cred.player);
+  welcome(conn, cred);
+  if (auto held = held_.extract(cred.player)) {
+    for (const auto tid : held.mapped()) {
+      conn->tables.push_back(tid);
+      catch_up(conn, tid);
+    }
+    spdlog::info("Player {} took back {} adopted seats", cred.player,
+                 conn->tables.size());
+    return out;
+  }
+  if (auto joined = join_table(conn)) {
+    out.push_back(std::move(*joined));
+  }
+  return out;
+}
+
+void Server::release_account(const poker::PlayerId id) {
+  // a hand they left part way through records them once it ends
+  if (stats_.counters(id).hands == 0 && !recorder_.in_hand(id)) {
+    accounts_.erase(id);
+    replicate({.tag = poker::InputTag::revoke, .who = id});
+  }
+}
+
+auto Server::accounts() const -> const poker::Accounts & { return accounts_; }
+
+void Server::restore_accounts(poker::Accounts accounts) {
+  accounts_ = std::move(accounts);
+  next_player_id_ = std::max(next_player_id_, accounts_.id_bound());
+}
+
+void Server::restore_stats(poker::PlayerStats stats) {
+  stats_ = std::move(stats);
+  const auto dropped = stats_.erase_if(
+      [this](poker::PlayerId id) { return !accounts_.contains(id); });
+  if (dropped != 0) {
+    spdlog::info("Dropped stats for {} players without an account", dropped);
   }
 }
 
 std::vector<Conn *> Server::get_table_conns(const poker::TableId id) const {
   std::vector<Conn *> result;
   for (const auto &[pid, conn] : connections_) {
-    if (conn->table_id == id) {
+    if (seated_at(conn.get(), id)) {
       result.push_back(conn.get());
     }
   }
   return result;
 }
+
+void Server::flush_pending() {
+  drain_encoders();
+  // the standby hears about the tick ahead of the players
+  if (replica_ && !replica_->flush()) {
+    replica_.reset();
+  }
+  for (auto *conn : dirty_) {
+    conn->flush_queued = false;
+    if (conn->io.failed) {
+      continue;
+    }
+    // write straight away; only a socket that fills up waits on EPOLLOUT
+    reactor::flush(io_, conn);
+    if (!conn->out.empty()) {
+      update_interest(io_, conn, epfd_);
+    }
+  }
+  dirty_.clear();
+  flush_chat();
+}
+
+auto Server::heaviest(std::size_t n) const -> std::vector<ConnReport> {
+  std::vector<ConnReport> all;
+  all.reserve(connections_.size());
+  for (const auto &[id, conn] : connections_) {
+    all.push_back({id, conn->cost});
+  }
+  const auto top = std::min(n, all.size());
+  std::partial_sort(all.begin(), all.begin() + top, all.end(),
+                    [](const ConnReport &a, const ConnReport &b) {
+                      if (a.cost.cycles != b.cost.cycles) {
+                        return a.cost.cycles > b.cost.cycles;
+                      }
+                      return a.cost.bytes_out > b.cost.bytes_out;
+                    });
+  all.resize(top);
+  return all;
+}
+
+uint64_t Server::chat_dropped() const { return chat_dropped_; }
+
+void Server::observe_lag(reactor::Clock::duration lag) {
+  if (!governor_.observe(io_.now(), lag)) {
+    return;
+  }
+  const auto &m = governor_.metrics();
+  spdlog::warn("Load mode now {}: loop lag {:.1f} ms (worst {:.1f} ms)",
+               load::to_string(m.mode),
+               std::chrono::duration<double, std::milli>(m.lag).count(),
+               std::chrono::duration<double, std::milli>(m.max_lag).count());
+}
+
+auto Server::load() const -> const load::Metrics & {
+  return governor_.metrics();
+}
+
+bool Server::accepting() const {
+  return governor_.mode() != load::Mode::closed;
+}
+
+auto Server::say(Conn *conn, poker::TableId table, const std::string &text)
+    -> std::expected<void, poker::Error> {
+  if (text.empty()) {
+    return std::unexpected(poker::ServerError::illegal_action);
+  }
+  if (text.size() > kMaxChatBytes) {
+    return std::unexpected(poker::ServerError::chat_too_long);
+  }
+  if (governor_.mode() != load::Mode::normal) {
+    governor_.note_shed();
+    return std::unexpected(poker::ServerError::overloaded);
+  }
+  const auto now = io_.now();
+  const auto due = std::max(conn->chat_due, now);
+  if (due - now > (kChatBurst - 1) * kChatInterval) {
+    return std::unexpected(poker::ServerError::chat_rate_limited);
+  }
+  conn->chat_due = due + kChatInterval;
+  chat_.push_back({table, conn->player_id, text});
+  return {};
+}
+
+// Each table's lines are serialized once into a frame every recipient
+// shares. Chat goes out after the tick's game traffic has been written, and
+// a connection still holding unwritten bytes gets none: chat never queues
+// in front of an action's reply.
+void Server::flush_chat() {
+  if (chat_.empty()) {
+    return;
+  }
+  std::ranges::stable_sort(chat_, {}, &ChatLine::table);
+  std::string frame;
+  for (auto first = chat_.begin(); first != chat_.end();) {
+    const auto table = first->table;
+    const auto last = std::find_if(first, chat_.end(), [&](const auto &l) {
+      return l.table != table;
+    });
+    ::poker::v1::Response res;
+    for (auto it = first; it != last; ++it) {
+      auto *msg = res.add_messages();
+      msg->set_table_id(table);
+      msg->mutable_chat()->set_who(it->who);
+      msg->mutable_chat()->set_text(std::move(it->text));
+    }
+    frame.assign(sizeof(uint32_t), '\0');
+    res.AppendToString(&frame);
+    const auto body = frame.size() - sizeof(uint32_t);
+    const uint32_t len = htonl(static_cast<uint32_t>(body));
+    frame.replace(0, sizeof(len), reinterpret_cast<const char *>(&len),
+                  sizeof(len));
+    const auto lines = static_cast<uint64_t>(last - first);
+    for (auto *conn : get_table_conns(table)) {
+      if (conn->io.failed || !conn->out.empty()) {
+        chat_dropped_ += lines;
+        continue;
+      }
+      conn->out += frame;
+      ++conn->cost.frames_out;
+      conn->cost.bytes_out += frame.size();
+      if (capture_) {
+        capture_->record(capture::Kind::outbound, io_.now(),
+                         conn->connected_as,
+                         std::string_view(frame).substr(sizeof(len)));
+      }
+      reactor::flush(io_, conn);
+      if (!conn->out.empty()) {
+        update_interest(io_, conn, epfd_);
+      }
+    }
+    first = last;
+  }
+  chat_.clear();
+}
+
+void Server::enable_broadcast(reactor::Clock::duration delay,
+                              std::size_t bytes_per_table) {
+  broadcast_delay_ = delay;
+  broadcast_bytes_ = bytes_per_table;
+  spdlog::info("Broadcasting watched tables {} s late",
+               std::chrono::duration<double>(delay).count());
+}
+
+auto Server::broadcast_delay() const -> reactor::Clock::duration {
+  return broadcast_delay_;
+}
+
+auto Server::release_broadcasts() -> reactor::Clock::duration {
+  if (governor_.mode() != load::Mode::normal) {
+    governor_.note_shed();
+    return kShedRetry; // held in the delay lines until the loop catches up
+  }
+  const auto now = io_.now();
+  auto next = broadcast_delay_;
+  std::vector<std::pair<Conn *, poker::TableId>> laggards;
+  for (auto &[tid, feed] : feeds_) {
+    feed.line.release(now, [&](std::string_view frame) {
+      for (auto *conn : feed.watchers) {
+        if (conn->out.size() > kMaxWatcherBacklog) {
+          laggards.emplace_back(conn, tid);
+          continue;
+        }
+        conn->out += frame;
+        ++conn->cost.frames_out;
+        conn->cost.bytes_out += frame.size();
+        if (capture_) {
+          capture_->record(capture::Kind::outbound, now, conn->connected_as,
+                           frame.substr(sizeof(uint32_t)));
+        }
+        queue_flush(conn);
+      }
+    });
+    if (const auto due = feed.line.next_due()) {
+      next = std::min(next, *due - now);
+    }
+  }
+  // a gap would leave the watcher with a wrong picture of the table
+  for (const auto &[conn, tid] : laggards) {
+    if (watching(conn, tid)) {
+      spdlog::warn("Dropping player {} from table {}'s broadcast: {} bytes "
+                   "behind",
+                   conn->player_id, tid, conn->out.size());
+      unwatch(conn, tid);
+    }
+  }
+  return next;
+}
+
+auto Server::watch(Conn *conn, poker::TableId table)
+    -> std::expected<void, poker::Error> {
+  if (broadcast_delay_ <= reactor::Clock::duration::zero() ||
+      !tables_.contains(table) || seated_at(conn, table)) {
+    return std::unexpected(poker::ServerError::illegal_action);
+  }
+  if (watching(conn, table)) {
+    return {};
+  }
+  if (governor_.mode() != load::Mode::normal) {
+    governor_.note_shed();
+    return std::unexpected(poker::ServerError::overloaded);
+  }
+  auto feed = feeds_.find(table);
+  if (feed == feeds_.end()) {
+    feed = feeds_
+               .emplace(table, Feed{broadcast::DelayLine(broadcast_bytes_), {}})
+               .first;
+  }
+  feed->second.watchers.push_back(conn);
+  conn->watching.push_back(table);
+  return {};
+}
+
+void Server::unwatch(Conn *conn, poker::TableId table) {
+  std::erase(conn->watching, table);
+  auto feed = feeds_.find(table);
+  if (feed == feeds_.end()) {
+    return;
+  }
+  std::erase(feed->second.watchers, conn);
+  if (feed->second.watchers.empty()) {
+    feeds_.erase(feed);
+  }
+}
+
+void Server::queue_flush(Conn *conn) {
+  if (!conn->flush_queued) {
+    conn->flush_queued = true;
+    dirty_.push_back(conn);
+  }
+}
+
+auto Server::join_table(Conn *conn)
+    -> std::expected<TableEvents, poker::Error> {
+  if (conn->tables.size() >= kMaxTablesPerConn) {
+    return std::unexpected(poker::ServerError::too_many_tables);
+  }
+  // find a table to seat the player
+  poker::TableId tid = 0;
+  for (const auto &[id, table] : tables_) {
+    if (table.has_open_seat() && !seated_at(conn, id) &&
+        !watching(conn, id)) {
+      tid = id;
+      break;
+    }
+  }
+  // if no open tables, create one
+  auto it = tables_.find(tid);
+  if (it == tables_.end()) {
+    if (governor_.mode() == load::Mode::closed) {
+      governor_.note_shed();
+      return std::unexpected(poker::ServerError::overloaded);
+    }
+    tid = next_table_id_++;
+    auto &rng = rngs_.try_emplace(tid, kTableSeed).first->second;
+    it = tables_.emplace(tid, poker::Table(rng)).first;
+    const poker::InputRecord open{
+        .tag = poker::InputTag::open, .table = tid, .amount = kTableSeed};
+    if (hand_log_) {
+      hand_log_->append(open, {});
+    }
+    if (replica_) {
+      replica_->append(open, {});
+    }
+    spdlog::info("Created new table {}", tid);
+  }
+  // seat the player at the found table or return an error
+  const auto pid = conn->player_id;
+  auto added = it->second.add_player(pid);
+  journal({.tag = poker::InputTag::add_player, .table = tid, .who = pid},
+          added);
+  if (!added) {
+    spdlog::warn("Failed to seat player {} at table {}: {}", pid, tid,
+                 poker::to_string(added.error()));
+    return std::unexpected(added.error());
+  }
+  conn->tables.push_back(tid);
+  spdlog::info("Seated player {} at table {}", pid, tid);
+  return TableEvents{tid, {*added}};
+}
+
+auto Server::leave_table(Conn *conn, const poker::TableId id)
+    -> std::vector<poker::Event> {
+  std::erase(conn->tables, id);
+  return vacate(id, conn->player_id);
+}
+
+auto Server::vacate(const poker::TableId id, const poker::PlayerId who)
+    -> std::vector<poker::Event> {
+  std::vector<poker::Event> events;
+  auto it = tables_.find(id);
+  if (it == tables_.end()) {
+    return events;
+  }
+  auto &table = it->second;
+  auto removed = table.remove_player(who);
+  journal({.tag = poker::InputTag::remove_player, .table = id, .who = who},
+          removed);
+  if (removed) {
+    events = std::move(*removed);
+  } else {
+    spdlog::warn("Failed to remove player {} from table {}: {}", who, id,
+                 poker::to_string(removed.error()));
+  }
+  // nobody is left to play against the house
+  if (humans_at(id) == 0) {
+    for (auto bot : bots_.at_table(id)) {
+      bots_.remove(bot);
+      auto removed = table.remove_player(bot);
+      journal(
+          {.tag = poker::InputTag::remove_player, .table = id, .who = bot},
+          removed);
+      if (removed) {
+        events.insert(events.end(), removed->begin(), removed->end());
+      }
+    }
+  }
+  return events;
+}
+
+std::size_t Server::humans_at(const poker::TableId id) const {
+  return get_table_conns(id).size() +
+         static_cast<std::size_t>(
+             std::ranges::count_if(held_, [id](const auto &held) {
+               return std::ranges::find(held.second, id) != held.second.end();
+             }));
+}
+
+void Server::catch_up(Conn *conn, const poker::TableId id) {
+  const auto &table = tables_.at(id);
+  std::vector<poker::Event> events;
+  if (const auto view = table.seat_view(conn->player_id)) {
+    events.push_back(poker::DealtHole{conn->player_id, view->hole});
+  }
+  if (const auto next = table.on_clock()) {
+    events.push_back(poker::TurnAdvanced{*next});
+  }
+  if (!events.empty()) {
+    push_one(conn->player_id, Outbound{std::move(events)}, id);
+  }
+}
+
+auto Server::join_pool(Conn *conn) -> std::expected<TableEvents, poker::Error> {
+  if (auto joined = pool_.join(conn->player_id); !joined) {
+    return std::unexpected(joined.error());
+  }
+  spdlog::info("Player {} joined the fast-fold pool", conn->player_id);
+  settle_pool();
+  return TableEvents{0, {}};
+}
+
+auto Server::leave_pool(Conn *conn)
+    -> std::expected<TableEvents, poker::Error> {
+  if (auto left = pool_.leave(conn->player_id); !left) {
+    return std::unexpected(left.error());
+  }
+  settle_pool();
+  return TableEvents{0, {}};
+}
+
+auto Server::act_in_pool(Conn *conn, const ::poker::v1::Action &a)
+    -> std::expected<TableEvents, poker::Error> {
+  // the player may already have folded into a newer hand
+  if (pool_.hand_of(conn->player_id) != a.hand_id()) {
+    return std::unexpected(poker::ServerError::illegal_action);
+  }
+  auto action = poker::from_proto_action(a, conn->player_id);
+  if (!action) {
+    return std::unexpected(action.error());
+  }
+  if (auto played = play_pool(a.hand_id(), *action); !played) {
+    return std::unexpected(played.error());
+  }
+  return TableEvents{0, {}};
+}
+
+auto Server::play_pool(const poker::HandId hand, const poker::Action &action)
+    -> std::expected<void, poker::Error> {
+  // a folder is let go of by the action, but still hears how it went
+  const auto players = pool_.players(hand);
+  auto res = pool_.on_action(hand, action);
+  if (!players.empty()) { // a live hand, so its table made the call
+    journal(poker::to_input(poker::FastFoldPool::table_of(hand), action),
+            res);
+  }
+  if (!res) {
+    return std::unexpected(res.error());
+  }
+  publish_hand(hand, players, *res);
+  settle_pool();
+  return {};
+}
+
+void Server::time_out(const poker::HandId hand, const poker::PlayerId who) {
+  if (auto played = play_pool(hand, poker::Timeout{who}); !played) {
+    spdlog::warn("Could not time out player {} in fast-fold hand {}: {}", who,
+                 hand, poker::to_string(played.error()));
+  }
+}
+
+void Server::quit_pool(const poker::PlayerId id) {
+  if (!pool_.leave(id)) {
+    return;
+  }
+  if (const auto hand = pool_.hand_of(id);
+      hand && pool_.on_clock(*hand) == id) {
+    pool_turn_.erase(*hand);
+    time_out(*hand, id);
+  }
+  settle_pool();
+}
+
+void Server::publish_hand(const poker::HandId hand,
+                          std::span<const poker::PlayerId> players,
+                          const std::vector<poker::Event> &events) {
+  // a player who is gone is timed out until the hand lets them go
+  std::vector<Conn *> conns;
+  for (const auto who : players) {
+    if (const auto it = connections_.find(who); it != connections_.end()) {
+      conns.push_back(it->second.get());
+    }
+  }
+  if (std::ranges::any_of(conns,
+                          [](const Conn *c) { return c->encoding != 0; })) {
+    drain_encoders(); // so this lands after the broadcasts ahead of it
+  }
+  std::vector<std::size_t> from;
+  for (const auto *conn : conns) {
+    from.push_back(conn->pending.size());
+  }
+  publish(Outbound{events}, conns, 0, hand);
+  for (std::size_t i = 0; i < conns.size(); ++i) {
+    capture_outbound(conns[i], from[i]);
+    queue_flush(conns[i]);
+  }
+  const auto table = poker::FastFoldPool::table_of(hand);
+  for (const auto &ev : events) {
+    recorder_.observe(table, ev);
+  }
+  if (!pool_.live(hand)) {
+    recorder_.finish(table);
+    journal({.tag = poker::InputTag::clear, .table = table}, {});
+  }
+  const auto who = pool_.on_clock(hand);
+  if (!who) {
+    pool_turn_.erase(hand);
+    return;
+  }
+  if (!connections_.contains(*who)) {
+    // nobody is there to act, and the others should not wait out the clock
+    pool_turn_.erase(hand);
+    time_out(hand, *who);
+    return;
+  }
+  const auto seq = ++pool_turns_given_;
+  pool_turn_[hand] = seq;
+  pool_turns_.push_back({hand, *who, seq, io_.now() + kPoolTurnTime});
+}
+
+void Server::settle_pool() {
+  for (const auto &dealt : pool_.match()) {
+    const auto table = poker::FastFoldPool::table_of(dealt.hand);
+    if (dealt.opened && hand_log_) {
+      hand_log_->append({.tag = poker::InputTag::open,
+                         .table = table,
+                         .amount = *dealt.opened},
+                        {});
+    }
+    // the pool seats each player, then starts the hand
+    const std::span<const poker::Event> events(dealt.events);
+    std::vector<poker::PlayerId> players;
+    for (const auto &ev : events.first(dealt.stacks.size())) {
+      const auto who = std::get<poker::PlayerAdded>(ev).who;
+      journal({.tag = poker::InputTag::add_player,
+               .table = table,
+               .who = who,
+               .amount = dealt.stacks[players.size()]},
+              std::span(&ev, 1));
+      players.push_back(who);
+    }
+    journal({.tag = poker::InputTag::new_hand, .table = table},
+            events.subspan(players.size()));
+    publish_hand(dealt.hand, players, dealt.events);
+  }
+  for (const auto &gone : pool_.take_departures()) {
+    spdlog::info("Player {} left the fast-fold pool with {} chips", gone.who,
+                 gone.stack);
+    if (connections_.contains(gone.who)) {
+      push_one(gone.who,
+               Outbound{poker::Event{poker::PlayerRemoved{gone.who}}});
+    }
+  }
+}
+
+// Keeps one house bot at a table with a lone human and none anywhere else.
+// Only called between hands.
+void Server::seat_house_bots(const poker::TableId id, poker::Table &table,
+                             std::vector<poker::Event> &events) {
+  const auto humans = humans_at(id);
+  const auto seated = bots_.at_table(id);
+  if (humans == 1) {
+    if (!seated.empty()) {
+      return;
+    }
+    const poker::PlayerId bot = next_player_id_++;
+    auto added = table.add_player(bot);
+    journal({.tag = poker::InputTag::add_player, .table = id, .who = bot},
+            added);
+    if (added) {
+      bots_.add(bot, id);
+      replicate({.tag = poker::InputTag::house_bot, .table = id, .who = bot});
+      events.push_back(*added);
+      spdlog::info("Seated house bot {} at table {}", bot, id);
+    }
+    return;
+  }
+  for (auto bot : seated) {
+    bots_.remove(bot);
+    auto removed = table.remove_player(bot);
+    journal({.tag = poker::InputTag::remove_player, .table = id, .who = bot},
+            removed);
+    if (removed) {
+      events.insert(events.end(), removed->begin(), removed->end());
+    }
+    spdlog::info("Removed house bot {} from table {}", bot, id);
+  }
+}
+
+void Server::queue_bot_turns(const poker::TableId id, const Outbound &out) {
+  auto queue = [&](const poker::Event &ev) {
+    const auto *turn = std::get_if<poker::TurnAdvanced>(&ev);
+    if (turn && bots_.is_bot(turn->next)) {
+      bot_turns_.push_back(bots_.on_turn(id, turn->next));
+    }
+  };
+  if (const auto *ev = std::get_if<poker::Event>(&out)) {
+    queue(*ev);
+  } else if (const auto *evs = std::get_if<std::vector<poker::Event>>(&out)) {
+    for (const auto &ev : *evs) {
+      queue(ev);
+    }
+  }
+}
+
+void Server::record_hand(const poker::TableId id, const Outbound &out) {
+  if (const auto *ev = std::get_if<poker::Event>(&out)) {
+    recorder_.observe(id, *ev);
+  } else if (const auto *evs = std::get_if<std::vector<poker::Event>>(&out)) {
+    for (const auto &ev : *evs) {
+      recorder_.observe(id, ev);
+    }
+  }
+  auto it = tables_.find(id);
+  if (it != tables_.end() && !it->second.hand_in_progress()) {
+    recorder_.finish(id);
+  }
+}
+
+template <typename T, typename E>
+void Server::journal(poker::InputRecord in, const std::expected<T, E> &res) {
+  std::span<const poker::Event> events;
+  if (!res) {
+    in.failed = 1;
+  } else if constexpr (std::is_same_v<T, poker::Event>) {
+    events = std::span(&*res, 1);
+  } else {
+    events = *res;
+  }
+  journal(in, events);
+}
+
+void Server::journal(const poker::InputRecord &in,
+                     std::span<const poker::Event> events) {
+  if (hand_log_) {
+    hand_log_->append(in, events);
+  }
+  if (live_) {
+    if (in.tag == poker::InputTag::clear) {
+      live_->clear(in.table);
+    } else {
+      live_->apply(in.table, events);
+    }
+  }
+  // a standby takes over tables but not the pool, so fast-fold hands end
+  // with the primary
+  if (replica_ && !poker::is_pool_table(in.table)) {
+    replica_->append(in, events);
+  }
+}
+
+void Server::replicate(const poker::InputRecord &in) {
+  if (replica_) {
+    replica_->append(in, {});
+  }
+}
+
+void Server::on_hands(std::span<const poker::HandRow> rows) {
+  // house bots have no account, and their ids are never seen again, so
+  // neither keeps stats for them nor ranks them against people
+  std::vector<poker::HandRow> held;
+  std::ranges::copy_if(rows, std::back_inserter(held),
+                       [this](const poker::HandRow &r) {
+                         return accounts_.contains(r.player);
+                       });
+  stats_.record(held);
+  leaderboard_.record(held);
+  if (hh_writer_) {
+    hh_writer_->append(rows);
+  }
+}
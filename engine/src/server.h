@@ -1,19 +1,52 @@
 #pragma once
 
+#include <chrono>
 #include <cstdint>
+#include <deque>
 #include <expected>
+#include <filesystem>
 #include <memory>
 #include <optional>
+#include <random>
+#include <span>
 #include <string>
 #include <unordered_map>
 #include <variant>
 #include <vector>
 
+#include "accounts.h"
 #include "actions.pb.h"
+#include "capture.h"
+#include "column_store.h"
+#include "delay_line.h"
+#include "encoder.h"
 #include "errors.h"
+#include "fast_fold.h"
+#include "hand_audit.h"
+#include "hand_history.h"
+#include "house_bot.h"
+#include "leaderboard.h"
+#include "live_state.h"
+#include "load_shed.h"
 #include "player.h"
+#include "player_stats.h"
+#include "reactor.h"
+#include "replica.h"
+#include "response.pb.h"
 #include "table.h"
 
+// What a connection has cost the server since it connected. `cycles` is
+// time spent handling its frames, in cycles::now() units; bytes include the
+// length prefixes.
+struct ConnCost {
+  uint64_t frames_in{0};
+  uint64_t bytes_in{0};
+  uint64_t frames_out{0};
+  uint64_t bytes_out{0};
+  uint64_t rejected{0}; // unparsable or refused actions
+  uint64_t cycles{0};
+};
+
 struct Conn {
   Conn(int cfd, poker::PlayerId id);
   int fd;
@@ -22,51 +55,301 @@ struct Conn {
   uint32_t in_size{0};
   std::string out;
   uint32_t out_off{0};
-  poker::TableId table_id{0};
+  // Serialized Responses queued since the last flush. Concatenated Responses
+  // parse as one, so everything queued goes out as a single frame no matter
+  // how many tables contributed.
+  std::string pending;
+  bool flush_queued{false};
+  // seated tables in join order; the first is the default for actions
+  std::vector<poker::TableId> tables;
+  // tables whose delayed broadcast this connection follows
+  std::vector<poker::TableId> watching;
   poker::PlayerId player_id{0};
-  bool is_dead{true};
+  // the id given on connect; names the connection in captures even after
+  // a Resume makes it another player
+  poker::PlayerId connected_as{0};
+  reactor::IoState io{};
+  // chat rate limit: the sender is over it while this is too far ahead of
+  // now (GCRA, one emission interval per line)
+  reactor::Clock::time_point chat_due{};
+  ConnCost cost{};
+  // table broadcasts for this connection still with the encoders
+  uint32_t encoding{0};
 };
 
-void update_interest(Conn *const c, int epfd);
+void update_interest(reactor::Io &io, Conn *const c, int epfd);
+// Moves the queued Responses into `out` as one length-prefixed frame.
+void frame_pending(Conn *const c);
 
 using Outbound =
     std::variant<poker::Event, std::vector<poker::Event>, poker::Error>;
 
+struct TableEvents {
+  poker::TableId table;
+  std::vector<poker::Event> events;
+};
+
+// A fast-fold player on the clock: timed out at `due`, unless the hand
+// has moved on. `seq` goes stale with the next turn in the hand.
+struct PoolTurn {
+  poker::HandId hand;
+  poker::PlayerId who;
+  uint64_t seq;
+  reactor::Clock::time_point due;
+};
+
+struct ConnReport {
+  poker::PlayerId player;
+  ConnCost cost;
+};
+
 struct ConnectResult {
   Conn *conn;
-  std::expected<poker::Event, poker::Error> result;
+  std::expected<TableEvents, poker::Error> result;
 };
 
 class Server {
 public:
-  Server(int epfd, int listenfd);
+  Server(int epfd, int listenfd, reactor::Io &io = reactor::system_io(),
+         load::Slo slo = {});
   ~Server();
 
   int epfd() const;
   int listenfd() const;
+  auto io() const -> reactor::Io &;
+  std::size_t connections() const;
 
   // the caller is responsible for publishing events produced by this
   // method to the appropriate audience
   // returning a raw Conn* inside the ConnectResult isn't great, but the server
   // is single threaded so we don't risk much
   auto handle_connect(const int cfd) -> ConnectResult;
+  // Gives up the player's seats and settles each table as settle_table
+  // does; the caller schedules the bot turns that leaves owed.
   void handle_close(const poker::PlayerId id);
   auto start_hand(const poker::TableId id)
       -> std::expected<std::vector<poker::Event>, poker::Error>;
+  // between hands this also keeps a house bot seated opposite a lone human,
+  // so any PlayerAdded/PlayerRemoved for bots is part of the returned events
   auto maybe_start_hand(const poker::TableId id)
       -> std::optional<std::vector<poker::Event>>;
+  // Pushes `out` to the table, then deals the next hand if it is ready.
+  // Bot turns owed are left for take_bot_turns.
+  void settle_table(const poker::TableId id, const Outbound &out);
+  // std::nullopt if the turn went stale while the bot was thinking
+  auto apply_bot_turn(const poker::BotTurn &turn)
+      -> std::optional<std::vector<poker::Event>>;
+  // bot decisions owed for the events pushed since the last call; the
+  // caller schedules them on the reactor
+  auto take_bot_turns() -> std::vector<poker::BotTurn>;
+  // True once a fast-fold player is on the clock and nothing is timing
+  // them yet; the caller then calls time_out_pool_turns on a timer.
+  bool take_pool_clock();
+  // Times out and publishes every fast-fold turn that is up. Returns how
+  // long until the next one is; nullopt, and the clock stops, once nobody
+  // is on it.
+  auto time_out_pool_turns() -> std::optional<reactor::Clock::duration>;
+  // Join and Leave are handled here too; the leaving player is sent the
+  // removal directly since it is no longer part of the table's audience.
+  // Chat, Watch, Unwatch, Leaderboard and Stats return no events. Nor does
+  // fast-fold play, which is published here as it has no table. Resume
+  // goes through resume().
   auto apply_action(const ::poker::v1::Action action, poker::PlayerId)
-      -> std::expected<std::vector<poker::Event>, poker::Error>;
-  void push_one(const poker::PlayerId id, const Outbound &out);
+      -> std::expected<TableEvents, poker::Error>;
+  // Makes connection `id` the player `req` names, whose connection is
+  // gone: the connection gives up its own seats, is sent a Welcome for the
+  // player and takes back the seats adopt() held for it, or else is seated
+  // again. The caller publishes every table's events.
+  auto resume(poker::PlayerId id, const ::poker::v1::Action::Resume &req)
+      -> std::expected<std::vector<TableEvents>, poker::Error>;
+  // `table` or a fast-fold `hand` tags the messages; neither for
+  // connection-level errors
+  void push_one(const poker::PlayerId id, const Outbound &out,
+                const poker::TableId table = 0, const poker::HandId hand = 0);
   void push_table(const poker::TableId id, const Outbound &out);
+  // Frames and writes everything pushed since the last call. Run once per
+  // reactor tick so broadcasts from several tables share a frame and a
+  // write. The tick's chat follows once the game traffic is written.
+  void flush_pending();
+  // The `n` connections that have cost the most handler time, heaviest
+  // first.
+  auto heaviest(std::size_t n) const -> std::vector<ConnReport>;
+  // chat lines not delivered because the recipient was behind
+  uint64_t chat_dropped() const;
+  // Feeds a tick's loop lag to admission control. While the loop is behind
+  // chat, new watchers and delayed broadcasts are shed (overloaded errors);
+  // further behind, accepts pause and no new tables are opened.
+  void observe_lag(reactor::Clock::duration lag);
+  auto load() const -> const load::Metrics &;
+  bool accepting() const;
+  // Lets connections Watch a table: its events, hole cards included, are
+  // encoded once and sent to watchers `delay` later. Each watched table
+  // buffers at most `bytes_per_table` of encoded frames.
+  void enable_broadcast(reactor::Clock::duration delay,
+                        std::size_t bytes_per_table);
+  auto broadcast_delay() const -> reactor::Clock::duration;
+  // Queues every delayed frame now due to its watchers; returns how long
+  // until the next one can be due.
+  auto release_broadcasts() -> reactor::Clock::duration;
+  // Moves the encoding of table broadcasts onto `workers` threads. The
+  // game thread only copies each batch of events and its recipients;
+  // flush_pending collects the encoded Responses, in order, before writing.
+  void enable_encoders(unsigned workers);
+  // export completed hands to a columnar store under `root`
+  void enable_hand_history(const std::filesystem::path &root);
+  // record connections and their inbound and outbound traffic to `path`
+  auto enable_capture(const std::filesystem::path &path)
+      -> std::expected<void, capture::CaptureError>;
+  // the payload of each frame read from the connection that connected as
+  // `id`, ahead of parsing it
+  void capture_inbound(const poker::PlayerId id, std::string_view payload);
+  // Hands the capture's and the hand log's buffered tails to their writer
+  // threads. Run on a timer so an idle server's last records still reach
+  // the disk.
+  void flush_logs();
+  bool logging() const;
+  // journal every Table call to `path` for the offline auditor
+  auto enable_hand_log(const std::filesystem::path &path)
+      -> std::expected<void, poker::AuditError>;
+  // stream every Table call to a standby listening on `path`
+  auto enable_replication(const std::filesystem::path &path)
+      -> std::expected<void, replica::ReplicaError>;
+  // Takes over a standby's tables, accounts and house bots after the
+  // primary died. Nobody is connected yet, so the primary's players keep
+  // their seats for a grace period in which they may Resume; bots on the
+  // clock are owed their turn.
+  void adopt(replica::Replicated replicated);
+  // how long adopted seats are still held for; std::nullopt once none are
+  auto seats_held_for() const -> std::optional<reactor::Clock::duration>;
+  // Gives up every adopted seat nobody resumed, as handle_close would. The
+  // caller publishes every table's events.
+  auto release_held_seats() -> std::vector<TableEvents>;
+  // publish every table's live summary to a shared file at `path`
+  auto enable_live_state(const std::filesystem::path &path)
+      -> std::expected<void, live::LiveError>;
+  auto accounts() const -> const poker::Accounts &;
+  auto stats() const -> const poker::PlayerStats &;
+  auto leaderboard() const -> const poker::Leaderboard &;
+  // adopts persisted accounts; new players get ids past every one of them
+  void restore_accounts(poker::Accounts accounts);
+  // adopts persisted stats for the players that hold an account
+  void restore_stats(poker::PlayerStats stats);
 
 private:
   int epfd_;
   int listenfd_;
+  reactor::Io &io_;
   std::unordered_map<poker::PlayerId, std::unique_ptr<Conn>> connections_;
+  // Table keeps a reference to its rng, so the engines live in a node-based
+  // map (stable addresses) declared ahead of the tables that use them.
+  std::unordered_map<poker::TableId, std::mt19937_64> rngs_;
   std::unordered_map<poker::TableId, poker::Table> tables_;
+  poker::FastFoldPool pool_;
+  // the seq of each live pool hand's current turn
+  std::unordered_map<poker::HandId, uint64_t> pool_turn_;
+  uint64_t pool_turns_given_{0};
+  // every turn gets the same time, so they come due in this order
+  std::deque<PoolTurn> pool_turns_;
+  bool pool_clock_{false};
+  poker::HouseBots bots_{0};
+  std::vector<poker::BotTurn> bot_turns_;
+  // the recorder's sink writes into both, so it is declared after them
+  std::unique_ptr<hhstore::Writer> hh_writer_;
+  std::unique_ptr<capture::Writer> capture_;
+  std::unique_ptr<poker::HandLogWriter> hand_log_;
+  std::unique_ptr<live::Publisher> live_;
+  std::unique_ptr<replica::Sender> replica_;
+  std::unique_ptr<encode::Pool> encoders_;
+  poker::Accounts accounts_;
+  poker::PlayerStats stats_;
+  poker::Leaderboard leaderboard_;
+  load::Governor governor_;
+  poker::HandRecorder recorder_{
+      [this](std::span<const poker::HandRow> rows) { on_hands(rows); }};
   poker::PlayerId next_player_id_{1};
   poker::TableId next_table_id_{1};
+  std::vector<Conn *> dirty_;
+  struct ChatLine {
+    poker::TableId table;
+    poker::PlayerId who;
+    std::string text;
+  };
+  std::vector<ChatLine> chat_; // said this tick
+  uint64_t chat_dropped_{0};
+  struct Feed {
+    broadcast::DelayLine line;
+    std::vector<Conn *> watchers;
+  };
+  reactor::Clock::duration broadcast_delay_{0};
+  std::size_t broadcast_bytes_{0};
+  std::unordered_map<poker::TableId, Feed> feeds_; // watched tables only
+  // adopted players' seats, kept for them to Resume until held_until_
+  std::unordered_map<poker::PlayerId, std::vector<poker::TableId>> held_;
+  reactor::Clock::time_point held_until_{};
 
   std::vector<Conn *> get_table_conns(poker::TableId id) const;
+  auto join_table(Conn *conn) -> std::expected<TableEvents, poker::Error>;
+  auto leave_table(Conn *conn, poker::TableId id) -> std::vector<poker::Event>;
+  // removes `who` from the table, and the house bots once no human is left
+  auto vacate(poker::TableId id, poker::PlayerId who)
+      -> std::vector<poker::Event>;
+  // connected players seated at the table and adopted seats held there
+  std::size_t humans_at(poker::TableId id) const;
+  // sends a player back in mid-hand their cards and who is on the clock
+  void catch_up(Conn *conn, poker::TableId id);
+  auto join_pool(Conn *conn) -> std::expected<TableEvents, poker::Error>;
+  auto leave_pool(Conn *conn) -> std::expected<TableEvents, poker::Error>;
+  auto act_in_pool(Conn *conn, const ::poker::v1::Action &a)
+      -> std::expected<TableEvents, poker::Error>;
+  auto play_pool(poker::HandId hand, const poker::Action &action)
+      -> std::expected<void, poker::Error>;
+  void time_out(poker::HandId hand, poker::PlayerId who);
+  // Takes a player whose connection is gone out of the pool, timing out
+  // their turn at once if the hand is waiting on them.
+  void quit_pool(poker::PlayerId id);
+  // Publishes a pool hand's events to `players`, records them as its
+  // table's, and starts the clock on whoever is next to act, or times them
+  // out if they are gone.
+  void publish_hand(poker::HandId hand,
+                    std::span<const poker::PlayerId> players,
+                    const std::vector<poker::Event> &events);
+  // deals every hand the waiting players fill and sends off whoever the
+  // pool let go of
+  void settle_pool();
+  void queue_flush(Conn *conn);
+  auto say(Conn *conn, poker::TableId table, const std::string &text)
+      -> std::expected<void, poker::Error>;
+  void flush_chat();
+  // queues the cached leaderboard page asked for
+  void show_leaderboard(Conn *conn,
+                        const ::poker::v1::Action::Leaderboard &req);
+  void show_stats(Conn *conn, const ::poker::v1::Action::Stats &req);
+  // queues `res` for `conn` alone
+  void send(Conn *conn, const ::poker::v1::Response &res);
+  void welcome(Conn *conn, const poker::Credential &cred);
+  // drops the account of a leaving player with nothing to come back for
+  void release_account(poker::PlayerId id);
+  auto watch(Conn *conn, poker::TableId table)
+      -> std::expected<void, poker::Error>;
+  void unwatch(Conn *conn, poker::TableId table);
+  // hands a table broadcast to the encoders
+  void submit_encode(poker::TableId id, const Outbound &out,
+                     std::span<Conn *const> conns);
+  // queues everything the encoders have finished
+  void drain_encoders();
+  // records what publish appended to `conn->pending` past `from`
+  void capture_outbound(const Conn *conn, std::size_t from);
+  void seat_house_bots(poker::TableId id, poker::Table &table,
+                       std::vector<poker::Event> &events);
+  void queue_bot_turns(poker::TableId id, const Outbound &out);
+  void record_hand(poker::TableId id, const Outbound &out);
+  // appends a Table call and what it returned to the hand log, and folds
+  // the events into the table's live summary
+  template <typename T, typename E>
+  void journal(poker::InputRecord in, const std::expected<T, E> &res);
+  void journal(const poker::InputRecord &in,
+               std::span<const poker::Event> events);
+  // streams state that is not a Table call to the standby
+  void replicate(const poker::InputRecord &in);
+  void on_hands(std::span<const poker::HandRow> rows);
 };
@@ -0,0 +1,218 @@
+#include "server_loop.h"
+
+#include <chrono>
+
+#include "cycles.h"
+#include "errors.h"
+#include "spdlog/spdlog.h"
+
+namespace {
+
+// how often a paused accept loop checks whether it may resume
+constexpr auto kAcceptPause = std::chrono::milliseconds{100};
+// longest a logged record waits in memory when the server goes quiet
+constexpr auto kLogFlush = std::chrono::seconds{1};
+
+reactor::Task bot_turn(reactor::Reactor &r, Server &state,
+                       poker::BotTurn turn);
+reactor::Task pool_clock(reactor::Reactor &r, Server &state);
+
+// Puts any house bot now on the clock to sleep on its decision, and starts
+// the fast-fold clock if a player is on it.
+void schedule_turns(reactor::Reactor &r, Server &state) {
+  for (const auto &turn : state.take_bot_turns()) {
+    bot_turn(r, state, turn);
+  }
+  if (state.take_pool_clock()) {
+    pool_clock(r, state);
+  }
+}
+
+// Publishes table events, starts the next hand if the table is ready and
+// schedules the bots.
+void publish_table(reactor::Reactor &r, Server &state, poker::TableId tid,
+                   const Outbound &out) {
+  state.settle_table(tid, out);
+  schedule_turns(r, state);
+}
+
+reactor::Task bot_turn(reactor::Reactor &r, Server &state,
+                       poker::BotTurn turn) {
+  co_await r.sleep_for(turn.delay);
+  if (auto events = state.apply_bot_turn(turn)) {
+    publish_table(r, state, turn.table, Outbound{*events});
+  }
+}
+
+// Times out fast-fold players as their turns come due, one timer for all
+// of them, for as long as anyone is on the clock.
+reactor::Task pool_clock(reactor::Reactor &r, Server &state) {
+  while (const auto next = state.time_out_pool_turns()) {
+    co_await r.sleep_for(*next);
+  }
+}
+
+void reject(Server &state, Conn *c, const poker::Error &err,
+            poker::TableId tid, poker::HandId hand = 0) {
+  spdlog::info("Action rejected for player {}: {}", c->player_id,
+               poker::to_string(err));
+  ++c->cost.rejected;
+  state.push_one(c->player_id, Outbound{err}, tid, hand);
+}
+
+reactor::Task serve(reactor::Reactor &r, Server &state, Conn *c,
+                    bool admitted) {
+  if (!admitted) {
+    // flush the rejection before hanging up
+    co_await r.write(c);
+    state.handle_close(c->player_id);
+    schedule_turns(r, state);
+    co_return;
+  }
+  while (auto msg = co_await r.read_frame(c)) {
+    // read per frame: a Resume changes who the connection plays as
+    const auto pid = c->player_id;
+    const cycles::Meter meter(c->cost.cycles);
+    ++c->cost.frames_in;
+    c->cost.bytes_in += sizeof(uint32_t) + msg->size();
+    state.capture_inbound(c->connected_as, *msg);
+    ::poker::v1::Action action;
+    if (!action.ParseFromString(*msg)) {
+      spdlog::warn("Invalid action payload from player {}", pid);
+      ++c->cost.rejected;
+      state.push_one(pid, poker::GameError::invalid_action);
+      continue;
+    }
+    spdlog::info("Received action from player {}: {}", pid,
+                 action_to_string(action));
+    if (action.has_resume()) {
+      auto resumed = state.resume(pid, action.resume());
+      if (!resumed) {
+        reject(state, c, resumed.error(), 0);
+        continue;
+      }
+      for (const auto &te : *resumed) {
+        if (!te.events.empty()) {
+          publish_table(r, state, te.table, Outbound{te.events});
+        }
+      }
+      schedule_turns(r, state);
+      continue;
+    }
+    auto ar = state.apply_action(action, pid);
+    if (!ar) {
+      reject(state, c, ar.error(), action.table_id(), action.hand_id());
+      continue;
+    }
+    if (!ar->events.empty()) { // chat goes out with the tick's flush
+      publish_table(r, state, ar->table, Outbound{ar->events});
+    }
+    // fast-fold play is published by the server; its turns start here
+    schedule_turns(r, state);
+  }
+  state.handle_close(c->player_id);
+  schedule_turns(r, state);
+}
+
+// Releases delayed broadcast frames as they come due.
+reactor::Task broadcast_clock(reactor::Reactor &r, Server &state) {
+  while (true) {
+    co_await r.sleep_for(state.release_broadcasts());
+  }
+}
+
+// Flushes the logs' buffered tails, which otherwise wait for more traffic.
+reactor::Task log_clock(reactor::Reactor &r, Server &state) {
+  while (true) {
+    co_await r.sleep_for(kLogFlush);
+    state.flush_logs();
+  }
+}
+
+// Frees the adopted seats nobody resumed once the grace period is over.
+reactor::Task release_seats(reactor::Reactor &r, Server &state) {
+  while (const auto left = state.seats_held_for()) {
+    if (*left > reactor::Clock::duration::zero()) {
+      co_await r.sleep_for(*left);
+      continue;
+    }
+    for (const auto &te : state.release_held_seats()) {
+      if (!te.events.empty()) {
+        publish_table(r, state, te.table, Outbound{te.events});
+      }
+    }
+  }
+}
+
+reactor::Task accept_loop(reactor::Reactor &r, Server &state) {
+  while (true) {
+    // new connections wait in the listen backlog while the loop is behind
+    if (!state.accepting()) {
+      co_await r.sleep_for(kAcceptPause);
+      continue;
+    }
+    // max players/tables will be limiting factor here
+    int cfd = co_await r.accept(state.listenfd());
+    auto cr = state.handle_connect(cfd);
+    if (cr.result) {
+      publish_table(r, state, cr.result->table, Outbound{cr.result->events});
+    } else {
+      state.push_one(cr.conn->player_id, Outbound{cr.result.error()});
+    }
+    serve(r, state, cr.conn, cr.result.has_value());
+  }
+}
+
+} // namespace
+
+std::string action_to_string(const ::poker::v1::Action &action) {
+  using Payload = ::poker::v1::Action::PayloadCase;
+  std::string table =
+      action.hand_id() != 0
+          ? " (hand " + std::to_string(action.hand_id()) + ")"
+          : " (table " + std::to_string(action.table_id()) + ")";
+  switch (action.payload_case()) {
+  case Payload::kFold:
+    return "fold" + table;
+  case Payload::kBet:
+    return "bet " + std::to_string(action.bet().amount()) + table;
+  case Payload::kJoin:
+    return action.join().fast_fold() ? "join fast-fold" : "join";
+  case Payload::kLeave:
+    return action.leave().fast_fold() ? "leave fast-fold" : "leave" + table;
+  case Payload::kChat:
+    return "chat" + table;
+  case Payload::kWatch:
+    return "watch" + table;
+  case Payload::kUnwatch:
+    return "unwatch" + table;
+  case Payload::kLeaderboard:
+    return "leaderboard page " + std::to_string(action.leaderboard().page());
+  case Payload::kResume:
+    return "resume as player " + std::to_string(action.resume().player());
+  case Payload::kStats:
+    return "stats for player " + std::to_string(action.stats().player());
+  case Payload::PAYLOAD_NOT_SET:
+  default:
+    return "unknown";
+  }
+}
+
+void start_server(reactor::Reactor &r, Server &state) {
+  r.on_tick_end([&r, &state] {
+    state.observe_lag(r.lag()); // the tick before this one
+    state.flush_pending();
+  });
+  if (state.broadcast_delay() > reactor::Clock::duration::zero()) {
+    broadcast_clock(r, state);
+  }
+  if (state.logging()) {
+    log_clock(r, state);
+  }
+  if (state.seats_held_for()) {
+    release_seats(r, state);
+  }
+  // an adopted table may be waiting on a bot
+  schedule_turns(r, state);
+  accept_loop(r, state);
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <string>
+
+#include "actions.pb.h"
+#include "reactor.h"
+#include "server.h"
+
+// The coroutines that run a Server on a Reactor: accepting connections,
+// serving each one's actions and playing house bot turns. Shared by main()
+// and the simulator so both exercise the same loop.
+
+std::string action_to_string(const ::poker::v1::Action &action);
+
+// Hooks the Server's per-tick flush into the reactor and starts accepting on
+// its listening socket. Both must outlive the reactor's coroutines.
+void start_server(reactor::Reactor &r, Server &state);
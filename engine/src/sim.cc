@@ -0,0 +1,690 @@
+#include "sim.h"
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <spdlog/spdlog.h>
+
+#include "actions.pb.h"
+#include "poker_rules.h"
+#include "reactor.h"
+#include "response.pb.h"
+#include "server.h"
+#include "server_loop.h"
+
+namespace sim {
+namespace {
+
+constexpr std::size_t kSocketBuffer = 64 * 1024;
+constexpr int kFirstFd = 3;
+// steady_clock's epoch is arbitrary; start somewhere that isn't zero
+constexpr Clock::time_point kStart{std::chrono::hours{1}};
+constexpr uint64_t kFnvOffset = 14695981039346656037ull;
+constexpr uint64_t kFnvPrime = 1099511628211ull;
+
+auto fnv(uint64_t h, const void *p, std::size_t n) -> uint64_t {
+  const auto *b = static_cast<const unsigned char *>(p);
+  for (std::size_t i = 0; i < n; ++i) {
+    h = (h ^ b[i]) * kFnvPrime;
+  }
+  return h;
+}
+
+} // namespace
+
+Network::Network(uint64_t seed, Faults faults)
+    : faults_(faults), rng_(seed), secrets_(~seed), now_(kStart),
+      sockets_(kFirstFd),
+      trace_(kFnvOffset) {}
+
+auto Network::alloc(Kind kind) -> int {
+  int fd = static_cast<int>(sockets_.size());
+  if (!free_fds_.empty()) {
+    fd = free_fds_.top();
+    free_fds_.pop();
+  } else {
+    sockets_.emplace_back();
+  }
+  auto &s = sockets_[fd];
+  const auto gen = s.gen + 1;
+  s = Socket{};
+  s.kind = kind;
+  s.gen = gen;
+  return fd;
+}
+
+void Network::release(int fd) {
+  auto &s = sockets_[fd];
+  const auto gen = s.gen;
+  s = Socket{};
+  s.gen = gen;
+  free_fds_.push(fd);
+}
+
+auto Network::live(Ref r) -> Socket * {
+  if (r.fd < 0 || static_cast<std::size_t>(r.fd) >= sockets_.size()) {
+    return nullptr;
+  }
+  auto &s = sockets_[r.fd];
+  return s.kind != Kind::closed && s.gen == r.gen ? &s : nullptr;
+}
+
+auto Network::find(int fd, Kind kind) -> Socket * {
+  if (fd < 0 || static_cast<std::size_t>(fd) >= sockets_.size() ||
+      sockets_[fd].kind != kind) {
+    errno = EBADF;
+    return nullptr;
+  }
+  return &sockets_[fd];
+}
+
+auto Network::ref(int fd) const -> Ref { return Ref{fd, sockets_[fd].gen}; }
+
+auto Network::latency() -> Clock::duration {
+  std::uniform_int_distribution<int64_t> us(faults_.min_latency.count(),
+                                             faults_.max_latency.count());
+  return std::chrono::microseconds{us(rng_)};
+}
+
+auto Network::space(const Socket &s) -> std::size_t {
+  const auto *peer = live(s.peer);
+  const auto used = s.in_flight + (peer ? peer->rx.size() - peer->rx_off : 0);
+  return used >= kSocketBuffer ? 0 : kSocketBuffer - used;
+}
+
+auto Network::readiness(int fd) -> uint32_t {
+  auto &s = sockets_[fd];
+  if (s.kind == Kind::listener) {
+    return s.backlog.empty() ? 0u : uint32_t{EPOLLIN};
+  }
+  if (s.reset) {
+    return EPOLLIN | EPOLLERR | EPOLLHUP;
+  }
+  uint32_t ev = 0;
+  if (s.rx.size() > s.rx_off || s.eof) {
+    ev |= EPOLLIN;
+  }
+  if (space(s) > 0) {
+    ev |= EPOLLOUT;
+  }
+  return ev;
+}
+
+void Network::raise(int fd, uint32_t events) {
+  auto &s = sockets_[fd];
+  auto *ep = live(s.epoll);
+  if (ep == nullptr) {
+    return;
+  }
+  s.pending |= events & (s.interest | EPOLLERR | EPOLLHUP);
+  if (s.pending != 0 && !s.queued) {
+    s.queued = true;
+    ep->ready.push_back(ref(fd));
+  }
+}
+
+void Network::schedule(Scheduled item) {
+  item.seq = seq_++;
+  queue_.push(std::move(item));
+}
+
+void Network::send(int from, What what, std::string bytes) {
+  auto &s = sockets_[from];
+  const auto when = std::max(now_ + latency(), s.last_arrival);
+  s.last_arrival = when;
+  s.in_flight += bytes.size();
+  schedule(Scheduled{when, 0, what, s.peer, ref(from), std::move(bytes), {}});
+}
+
+void Network::deliver(Scheduled &item) {
+  const int64_t when = item.when.time_since_epoch().count();
+  trace_ = fnv(trace_, &when, sizeof(when));
+  trace_ = fnv(trace_, &item.what, sizeof(item.what));
+  trace_ = fnv(trace_, &item.to.fd, sizeof(item.to.fd));
+  trace_ = fnv(trace_, item.bytes.data(), item.bytes.size());
+
+  if (item.what == What::call) {
+    item.fn();
+    return;
+  }
+  if (auto *from = live(item.from); from && item.what == What::data) {
+    from->in_flight -= item.bytes.size();
+  }
+  if (item.what == What::connect) {
+    auto *listener = live(item.to);
+    if (listener == nullptr) {
+      // nobody listening any more: refuse the client
+      send(item.from.fd, What::reset);
+      release(item.from.fd);
+      return;
+    }
+    listener->backlog.push_back(item.from.fd);
+    raise(item.to.fd, EPOLLIN);
+    return;
+  }
+  auto *s = live(item.to);
+  if (s == nullptr) {
+    // the receiver is gone; a real stack would answer with RST
+    if (item.what == What::data && live(item.from)) {
+      schedule(Scheduled{now_ + latency(), 0, What::reset, item.from, item.to,
+                         {}, {}});
+    }
+    return;
+  }
+  switch (item.what) {
+  case What::data:
+    s->rx += item.bytes;
+    raise(item.to.fd, EPOLLIN);
+    break;
+  case What::eof:
+    s->eof = true;
+    raise(item.to.fd, EPOLLIN);
+    break;
+  case What::reset:
+    s->reset = true;
+    raise(item.to.fd, EPOLLIN | EPOLLERR | EPOLLHUP);
+    break;
+  default:
+    break;
+  }
+  // copied: the callback may close, and so clear, its own socket
+  if (auto fn = s->on_readable) {
+    fn();
+  }
+}
+
+void Network::advance(int epfd, int timeout_ms) {
+  const auto deadline = timeout_ms < 0
+                            ? Clock::time_point::max()
+                            : now_ + std::chrono::milliseconds{timeout_ms};
+  // indexed each time round: callbacks may grow sockets_
+  while (sockets_[epfd].ready.empty() && !queue_.empty() &&
+         queue_.top().when <= deadline) {
+    auto item = std::move(const_cast<Scheduled &>(queue_.top()));
+    queue_.pop();
+    now_ = std::max(now_, item.when);
+    deliver(item);
+  }
+  if (sockets_[epfd].ready.empty() && timeout_ms >= 0) {
+    now_ = std::max(now_, deadline);
+  }
+}
+
+int Network::epoll_create() { return alloc(Kind::epoll); }
+
+int Network::listen() { return alloc(Kind::listener); }
+
+int Network::connect(int listenfd) {
+  const int client = alloc(Kind::stream);
+  const int server = alloc(Kind::stream);
+  sockets_[client].peer = ref(server);
+  sockets_[server].peer = ref(client);
+  // the client's first bytes queue up behind the handshake
+  const auto when = now_ + latency();
+  sockets_[client].last_arrival = when;
+  schedule(Scheduled{when, 0, What::connect, ref(listenfd), ref(server), {},
+                     {}});
+  return client;
+}
+
+void Network::reset(int fd) {
+  if (find(fd, Kind::stream) == nullptr) {
+    return;
+  }
+  send(fd, What::reset);
+  release(fd);
+}
+
+void Network::at(Clock::time_point when, std::function<void()> fn) {
+  schedule(Scheduled{when, 0, What::call, {}, {}, {}, std::move(fn)});
+}
+
+void Network::on_readable(int fd, std::function<void()> fn) {
+  sockets_[fd].on_readable = std::move(fn);
+}
+
+uint64_t Network::trace() const { return trace_; }
+
+auto Network::rng() -> std::mt19937_64 & { return rng_; }
+
+ssize_t Network::read(int fd, void *buf, std::size_t n) {
+  auto *s = find(fd, Kind::stream);
+  if (s == nullptr) {
+    return -1;
+  }
+  if (s->reset) {
+    errno = ECONNRESET;
+    return -1;
+  }
+  const auto avail = s->rx.size() - s->rx_off;
+  if (avail == 0) {
+    if (s->eof) {
+      return 0;
+    }
+    errno = EAGAIN;
+    return -1;
+  }
+  auto k = std::min(n, avail);
+  if (faults_.max_read > 0) {
+    k = std::min(k, std::uniform_int_distribution<std::size_t>(
+                        1, faults_.max_read)(rng_));
+  }
+  std::memcpy(buf, s->rx.data() + s->rx_off, k);
+  s->rx_off += k;
+  if (s->rx_off * 2 >= s->rx.size()) {
+    s->rx.erase(0, s->rx_off);
+    s->rx_off = 0;
+  }
+  // the peer's send buffer just drained a little
+  if (auto *peer = live(s->peer); peer && peer->blocked) {
+    peer->blocked = false;
+    raise(s->peer.fd, EPOLLOUT);
+  }
+  return static_cast<ssize_t>(k);
+}
+
+ssize_t Network::write(int fd, const void *buf, std::size_t n) {
+  auto *s = find(fd, Kind::stream);
+  if (s == nullptr) {
+    return -1;
+  }
+  if (s->reset || s->eof) {
+    // every client hangs up fully, so EOF means the peer is gone
+    errno = EPIPE;
+    return -1;
+  }
+  auto k = std::min(n, space(*s));
+  if (k == 0) {
+    s->blocked = true;
+    errno = EAGAIN;
+    return -1;
+  }
+  if (faults_.max_write > 0) {
+    k = std::min(k, std::uniform_int_distribution<std::size_t>(
+                        1, faults_.max_write)(rng_));
+  }
+  send(fd, What::data, std::string(static_cast<const char *>(buf), k));
+  return static_cast<ssize_t>(k);
+}
+
+int Network::accept(int listenfd) {
+  auto *s = find(listenfd, Kind::listener);
+  if (s == nullptr) {
+    return -1;
+  }
+  if (s->backlog.empty()) {
+    errno = EAGAIN;
+    return -1;
+  }
+  const int fd = s->backlog.front();
+  s->backlog.pop_front();
+  return fd;
+}
+
+int Network::close(int fd) {
+  if (fd < 0 || static_cast<std::size_t>(fd) >= sockets_.size() ||
+      sockets_[fd].kind == Kind::closed) {
+    errno = EBADF;
+    return -1;
+  }
+  auto &s = sockets_[fd];
+  if (s.kind == Kind::stream && !s.reset) {
+    send(fd, What::eof);
+  }
+  if (s.kind == Kind::listener) {
+    for (const int pending : std::deque<int>(s.backlog)) {
+      send(pending, What::reset);
+      release(pending);
+    }
+  }
+  release(fd);
+  return 0;
+}
+
+int Network::epoll_ctl(int epfd, int op, int fd, epoll_event *ev) {
+  if (find(epfd, Kind::epoll) == nullptr) {
+    return -1;
+  }
+  if (fd < 0 || static_cast<std::size_t>(fd) >= sockets_.size() ||
+      sockets_[fd].kind == Kind::closed) {
+    errno = EBADF;
+    return -1;
+  }
+  auto &s = sockets_[fd];
+  switch (op) {
+  case EPOLL_CTL_ADD:
+  case EPOLL_CTL_MOD:
+    s.epoll = ref(epfd);
+    s.interest = ev->events;
+    s.data = ev->data.ptr;
+    // like the kernel, (re-)arming a ready socket reports it straight away
+    raise(fd, readiness(fd));
+    return 0;
+  case EPOLL_CTL_DEL:
+    s.epoll = {};
+    s.pending = 0;
+    s.queued = false;
+    return 0;
+  default:
+    errno = EINVAL;
+    return -1;
+  }
+}
+
+int Network::epoll_wait(int epfd, epoll_event *events, int max_events,
+                        int timeout_ms) {
+  if (find(epfd, Kind::epoll) == nullptr) {
+    return -1;
+  }
+  if (sockets_[epfd].ready.empty()) {
+    advance(epfd, timeout_ms);
+  }
+  auto &ep = sockets_[epfd];
+  int n = 0;
+  while (n < max_events && !ep.ready.empty()) {
+    const auto r = ep.ready.front();
+    ep.ready.pop_front();
+    auto *s = live(r);
+    if (s == nullptr || !s->queued || s->epoll.fd != epfd) {
+      continue;
+    }
+    s->queued = false;
+    if (s->pending == 0) {
+      continue;
+    }
+    events[n].events = std::exchange(s->pending, 0);
+    events[n].data.ptr = s->data;
+    ++n;
+  }
+  return n;
+}
+
+auto Network::now() -> Clock::time_point { return now_; }
+
+uint64_t Network::random() { return secrets_(); }
+
+namespace {
+
+constexpr std::size_t kMaxFrame = 1 << 20;
+constexpr std::chrono::seconds kDrain{30};
+constexpr Chips kBets[] = {0, kBigBlind, 2 * kBigBlind, 5 * kBigBlind};
+
+// Scripted clients: each learns its id from its hole cards, answers its
+// turns after a random think time with a check, call, raise or fold (a
+// rejected bet is followed by a fold), and may join a second table or drop
+// mid-run.
+class Clients {
+public:
+  Clients(const Scenario &sc, Network &net, int listenfd, Report &report)
+      : sc_(sc), net_(net), listenfd_(listenfd), report_(report),
+        clients_(sc.clients) {}
+
+  void start(Clock::time_point end) {
+    auto &rng = net_.rng();
+    const auto start = net_.now();
+    const auto span = (end - start) / 2;
+    std::uniform_real_distribution<double> coin(0, 1);
+    for (std::size_t i = 0; i < clients_.size(); ++i) {
+      const auto arrive = start + pick(rng, span);
+      net_.at(arrive, [this, i] { connect(i); });
+      if (coin(rng) < sc_.join_rate) {
+        net_.at(arrive + pick(rng, end - arrive), [this, i] { join(i); });
+      }
+      if (coin(rng) < sc_.drop_rate) {
+        const bool abort = coin(rng) < 0.5;
+        net_.at(arrive + pick(rng, end - arrive),
+                [this, i, abort] { drop(i, abort); });
+      }
+    }
+  }
+
+  // everybody still connected hangs up
+  void finish() {
+    finished_ = true;
+    for (auto &c : clients_) {
+      if (c.fd >= 0) {
+        net_.close(std::exchange(c.fd, -1));
+      }
+    }
+  }
+
+  auto latencies() -> std::vector<Clock::duration> & { return latencies_; }
+
+private:
+  struct Client {
+    int fd{-1};
+    poker::PlayerId me{0};
+    std::string in;
+    bool awaiting{false};
+    Clock::time_point sent_at{};
+    // table of the bet we are waiting to hear back on; 0 if none
+    uint64_t betting{0};
+  };
+
+  static auto pick(std::mt19937_64 &rng, Clock::duration span)
+      -> Clock::duration {
+    if (span <= Clock::duration::zero()) {
+      return Clock::duration::zero();
+    }
+    return Clock::duration{std::uniform_int_distribution<int64_t>(
+        0, span.count() - 1)(rng)};
+  }
+
+  void connect(std::size_t i) {
+    if (finished_) {
+      return;
+    }
+    auto &c = clients_[i];
+    c.fd = net_.connect(listenfd_);
+    net_.on_readable(c.fd, [this, i] { readable(i); });
+  }
+
+  void join(std::size_t i) {
+    ::poker::v1::Action a;
+    a.mutable_join();
+    send(i, a);
+  }
+
+  void drop(std::size_t i, bool abort) {
+    auto &c = clients_[i];
+    if (c.fd < 0 || finished_) {
+      return;
+    }
+    ++report_.drops;
+    const int fd = std::exchange(c.fd, -1);
+    if (abort) {
+      net_.reset(fd);
+    } else {
+      net_.close(fd);
+    }
+  }
+
+  void send(std::size_t i, const ::poker::v1::Action &a) {
+    auto &c = clients_[i];
+    if (c.fd < 0) {
+      return;
+    }
+    std::string body;
+    a.SerializeToString(&body);
+    const uint32_t len = htonl(static_cast<uint32_t>(body.size()));
+    std::string frame(reinterpret_cast<const char *>(&len), sizeof(len));
+    frame += body;
+    // a client's socket has room for a handful of actions
+    for (std::size_t off = 0; off < frame.size();) {
+      const auto w = net_.write(c.fd, frame.data() + off, frame.size() - off);
+      if (w < 0) {
+        return;
+      }
+      off += static_cast<std::size_t>(w);
+    }
+    ++report_.actions;
+    c.awaiting = true;
+    c.sent_at = net_.now();
+  }
+
+  void act(std::size_t i, uint64_t table) {
+    auto &rng = net_.rng();
+    ::poker::v1::Action a;
+    a.set_table_id(table);
+    if (std::uniform_int_distribution<int>(0, 3)(rng) == 0) {
+      a.mutable_fold();
+    } else {
+      const auto bet = kBets[std::uniform_int_distribution<std::size_t>(
+          0, std::size(kBets) - 1)(rng)];
+      a.mutable_bet()->set_amount(bet);
+      clients_[i].betting = table;
+    }
+    send(i, a);
+  }
+
+  void fail(std::size_t i, const std::string &what) {
+    report_.failures.push_back("client " + std::to_string(i) + ": " + what);
+  }
+
+  void readable(std::size_t i) {
+    auto &c = clients_[i];
+    if (c.fd < 0) {
+      return;
+    }
+    char buf[4096];
+    while (true) {
+      const auto r = net_.read(c.fd, buf, sizeof(buf));
+      if (r > 0) {
+        c.in.append(buf, static_cast<std::size_t>(r));
+        continue;
+      }
+      if (r < 0 && errno == EAGAIN) {
+        break;
+      }
+      // EOF or reset from the server
+      net_.close(std::exchange(c.fd, -1));
+      break;
+    }
+    while (c.in.size() >= sizeof(uint32_t)) {
+      uint32_t len = 0;
+      std::memcpy(&len, c.in.data(), sizeof(len));
+      len = ntohl(len);
+      if (len > kMaxFrame) {
+        fail(i, "oversized frame");
+        c.in.clear();
+        return;
+      }
+      if (c.in.size() < sizeof(len) + len) {
+        break;
+      }
+      ::poker::v1::Response res;
+      if (!res.ParseFromArray(c.in.data() + sizeof(len),
+                              static_cast<int>(len))) {
+        fail(i, "unparsable frame");
+      }
+      c.in.erase(0, sizeof(len) + len);
+      on_frame(i, res);
+    }
+  }
+
+  void on_frame(std::size_t i, const ::poker::v1::Response &res) {
+    auto &c = clients_[i];
+    ++report_.frames;
+    if (c.awaiting) {
+      c.awaiting = false;
+      latencies_.push_back(net_.now() - c.sent_at);
+    }
+    for (const auto &msg : res.messages()) {
+      if (msg.has_error()) {
+        ++report_.errors;
+        // a rejected bet: fold instead, which is always legal on our turn
+        if (c.betting != 0 && msg.table_id() == c.betting) {
+          ::poker::v1::Action fold;
+          fold.set_table_id(std::exchange(c.betting, 0));
+          fold.mutable_fold();
+          send(i, fold);
+        }
+        continue;
+      }
+      const auto &ev = msg.event();
+      if (ev.has_dealt_hole()) {
+        c.me = ev.dealt_hole().who();
+      } else if (ev.has_bet_placed() && ev.bet_placed().who() == c.me) {
+        c.betting = 0;
+      } else if (ev.has_turn_advanced() && c.me != 0 &&
+                 ev.turn_advanced().next() == c.me) {
+        const auto think = std::chrono::milliseconds{
+            std::uniform_int_distribution<int>(5, 500)(net_.rng())};
+        const auto table = msg.table_id();
+        net_.at(net_.now() + think, [this, i, table] {
+          if (!finished_ && clients_[i].fd >= 0) {
+            act(i, table);
+          }
+        });
+      }
+    }
+  }
+
+  const Scenario &sc_;
+  Network &net_;
+  int listenfd_;
+  Report &report_;
+  std::vector<Client> clients_;
+  std::vector<Clock::duration> latencies_;
+  bool finished_{false};
+};
+
+auto percentile(const std::vector<Clock::duration> &sorted, double p)
+    -> Clock::duration {
+  if (sorted.empty()) {
+    return {};
+  }
+  const auto idx = static_cast<std::size_t>(p * (sorted.size() - 1));
+  return sorted[idx];
+}
+
+} // namespace
+
+auto run(const Scenario &sc) -> Report {
+  Report report;
+  Network net(sc.seed, sc.faults);
+  const int epfd = net.epoll_create();
+  const int listenfd = net.listen();
+  const auto level = spdlog::get_level();
+  spdlog::set_level(spdlog::level::warn);
+  {
+    Server state(epfd, listenfd, net);
+    epoll_event ev{};
+    ev.events = EPOLLIN | EPOLLET;
+    ev.data.ptr = nullptr;
+    net.epoll_ctl(epfd, EPOLL_CTL_ADD, listenfd, &ev);
+    reactor::Reactor r(epfd, net);
+    start_server(r, state);
+
+    Clients clients(sc, net, listenfd, report);
+    const auto end = net.now() + sc.duration;
+    clients.start(end);
+    auto run_until = [&](Clock::time_point t, auto done) {
+      while (net.now() < t && !done()) {
+        const auto left =
+            std::chrono::ceil<std::chrono::milliseconds>(t - net.now());
+        r.poll(static_cast<int>(left.count()));
+      }
+    };
+    run_until(end, [] { return false; });
+    clients.finish();
+    run_until(end + kDrain, [&] { return state.connections() == 0; });
+    report.leaked = state.connections();
+    if (report.leaked != 0) {
+      report.failures.push_back(std::to_string(report.leaked) +
+                                " server connections left open");
+    }
+
+    auto &lat = clients.latencies();
+    std::sort(lat.begin(), lat.end());
+    report.p50 = percentile(lat, 0.5);
+    report.p99 = percentile(lat, 0.99);
+    report.max = lat.empty() ? Clock::duration{} : lat.back();
+  }
+  report.trace = net.trace();
+  spdlog::set_level(level);
+  return report;
+}
+
+} // namespace sim
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <queue>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "io.h"
+
+// Deterministic whole-server simulation. Network stands in for the kernel
+// with in-memory stream sockets, an edge-triggered epoll and a virtual clock
+// that jumps straight to the next scheduled delivery whenever nothing is
+// ready. Latency, short reads/writes and disconnects are all drawn from one
+// seeded engine, so a run -- Server, reactor and clients together -- replays
+// exactly from its seed.
+namespace sim {
+
+using reactor::Clock;
+
+struct Faults {
+  // one-way delay of every write, drawn uniformly
+  std::chrono::microseconds min_latency{100};
+  std::chrono::microseconds max_latency{5000};
+  // when non-zero, each read/write moves a random 1..N bytes
+  std::size_t max_read{0};
+  std::size_t max_write{0};
+};
+
+class Network final : public reactor::Io {
+public:
+  explicit Network(uint64_t seed, Faults faults = {});
+  Network(const Network &) = delete;
+  Network &operator=(const Network &) = delete;
+
+  int epoll_create();
+  int listen();
+  // Client end of a new connection; the server end reaches `listenfd`'s
+  // accept queue one latency later.
+  int connect(int listenfd);
+  // Closes `fd` abortively: the peer sees ECONNRESET rather than EOF.
+  void reset(int fd);
+  // Runs `fn` once the clock reaches `when`.
+  void at(Clock::time_point when, std::function<void()> fn);
+  // Runs `fn` whenever data, EOF or a reset lands on `fd`.
+  void on_readable(int fd, std::function<void()> fn);
+
+  // hash of every delivery so far; equal seeds give equal traces
+  uint64_t trace() const;
+  auto rng() -> std::mt19937_64 &;
+
+  ssize_t read(int fd, void *buf, std::size_t n) override;
+  ssize_t write(int fd, const void *buf, std::size_t n) override;
+  int accept(int listenfd) override;
+  int close(int fd) override;
+  int epoll_ctl(int epfd, int op, int fd, epoll_event *ev) override;
+  int epoll_wait(int epfd, epoll_event *events, int max_events,
+                 int timeout_ms) override;
+  auto now() -> Clock::time_point override;
+  uint64_t random() override;
+
+private:
+  enum class Kind : uint8_t { closed, stream, listener, epoll };
+  // A socket number plus the generation it was allocated in, so nothing
+  // in flight reaches a later socket that reused the number.
+  struct Ref {
+    int fd{-1};
+    uint32_t gen{0};
+  };
+  struct Socket {
+    Kind kind{Kind::closed};
+    uint32_t gen{0};
+    // stream
+    Ref peer{};
+    std::string rx;
+    std::size_t rx_off{0};
+    std::size_t in_flight{0}; // written to the peer, not yet delivered
+    Clock::time_point last_arrival{}; // keeps each direction in order
+    bool eof{false};
+    bool reset{false};
+    bool blocked{false}; // a write saw EAGAIN; wake it with EPOLLOUT
+    std::function<void()> on_readable;
+    // listener: established connections waiting for accept()
+    std::deque<int> backlog;
+    // epoll: sockets with pending events
+    std::deque<Ref> ready;
+    // registration with an epoll instance
+    Ref epoll{};
+    uint32_t interest{0};
+    void *data{nullptr};
+    uint32_t pending{0};
+    bool queued{false};
+  };
+  enum class What : uint8_t { data, eof, reset, connect, call };
+  struct Scheduled {
+    Clock::time_point when;
+    uint64_t seq;
+    What what;
+    Ref to;
+    Ref from;
+    std::string bytes;
+    std::function<void()> fn;
+  };
+  struct Later {
+    bool operator()(const Scheduled &a, const Scheduled &b) const {
+      return std::pair(a.when, a.seq) > std::pair(b.when, b.seq);
+    }
+  };
+
+  auto alloc(Kind kind) -> int;
+  void release(int fd);
+  auto live(Ref ref) -> Socket *;
+  auto find(int fd, Kind kind) -> Socket *;
+  auto ref(int fd) const -> Ref;
+  auto latency() -> Clock::duration;
+  auto space(const Socket &s) -> std::size_t;
+  auto readiness(int fd) -> uint32_t;
+  void raise(int fd, uint32_t events);
+  // queues a segment from `from` behind everything it sent before
+  void send(int from, What what, std::string bytes = {});
+  void schedule(Scheduled item);
+  void deliver(Scheduled &item);
+  // delivers scheduled items until `epfd` has events or the timeout passes
+  void advance(int epfd, int timeout_ms);
+
+  Faults faults_;
+  std::mt19937_64 rng_;
+  // apart from rng_ so handing out secrets leaves the faults as they were
+  std::mt19937_64 secrets_;
+  Clock::time_point now_;
+  std::vector<Socket> sockets_;
+  std::priority_queue<int, std::vector<int>, std::greater<>> free_fds_;
+  std::priority_queue<Scheduled, std::vector<Scheduled>, Later> queue_;
+  uint64_t seq_{0};
+  uint64_t trace_;
+};
+
+struct Scenario {
+  uint64_t seed{1};
+  std::size_t clients{100};
+  // clients arrive over the first half and all hang up at the end
+  std::chrono::seconds duration{60};
+  Faults faults{};
+  // fraction of clients that drop mid-run, half with EOF and half with a
+  // reset
+  double drop_rate{0.1};
+  // fraction of clients that take a seat at a second table
+  double join_rate{0.1};
+};
+
+struct Report {
+  uint64_t trace{0};
+  uint64_t frames{0};
+  uint64_t actions{0};
+  uint64_t errors{0};
+  uint64_t drops{0};
+  // server connections still open once every client has hung up
+  std::size_t leaked{0};
+  // virtual time from an action to the next frame for that client
+  Clock::duration p50{};
+  Clock::duration p99{};
+  Clock::duration max{};
+  std::vector<std::string> failures;
+};
+
+// Runs a Server, its reactor loop and `scenario.clients` scripted clients
+// on a Network seeded from `scenario.seed`.
+auto run(const Scenario &scenario) -> Report;
+
+} // namespace sim
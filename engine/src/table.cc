@@ -16,12 +16,57 @@ bool Table::has_open_seat() const {
 
 bool Table::hand_in_progress() const { return hand_state_.has_value(); }
 
+auto Table::seat_view(PlayerId id) const -> std::optional<SeatView> {
+  if (!hand_state_ || !players_.is_sat(id)) {
+    return std::nullopt;
+  }
+  auto hole = hand_state_->player_holes.find(id);
+  if (hole == hand_state_->player_holes.end()) {
+    return std::nullopt;
+  }
+  Chips current = 0;
+  if (auto it = hand_state_->active_bets.find(id);
+      it != hand_state_->active_bets.end()) {
+    current = it->second;
+  }
+  const Chips previous = hand_state_->previous_bet;
+  const Chips to_call = previous > current ? previous - current : 0;
+  return SeatView{hand_state_->phase, to_call, hand_state_->min_raise,
+                  players_.get_chips(id), hole->second};
+}
+
+bool Table::in_hand(PlayerId id) const {
+  if (!hand_state_) {
+    return false;
+  }
+  const auto it = hand_state_->player_state.find(id);
+  return it != hand_state_->player_state.end() &&
+         (it->second == PlayerState::active ||
+          it->second == PlayerState::all_in);
+}
+
+auto Table::on_clock() const -> std::optional<PlayerId> {
+  if (!hand_state_ || hand_state_->turn_queue.empty()) {
+    return std::nullopt;
+  }
+  return hand_state_->turn_queue.front();
+}
+
 bool Table::can_start_hand() const {
   return !hand_in_progress() && players_.num_players() >= 2;
 }
 
-auto Table::add_player(PlayerId id) -> std::expected<Event, PlayerMgmtError> {
-  return players_.add_player(id).transform([&] { return PlayerAdded{id}; });
+auto Table::add_player(PlayerId id, Chips buy_in)
+    -> std::expected<Event, PlayerMgmtError> {
+  return players_.add_player(id, buy_in).transform([&] {
+    return PlayerAdded{id};
+  });
+}
+
+void Table::clear() {
+  hand_state_.reset();
+  players_ = PlayerManager{};
+  button_ = 0;
 }
 
 auto Table::remove_player(PlayerId id)
@@ -57,11 +102,10 @@ auto Table::remove_player(PlayerId id)
       updated.push(cur);
     }
     hand_state_->turn_queue = std::move(updated);
-    if (removed_front) {
-      prune_turn_queue();
-      if (!hand_state_->turn_queue.empty()) {
-        res.push_back(TurnAdvanced{hand_state_->turn_queue.front()});
-      }
+    // the last live player takes the pot, and a player who leaves on the
+    // clock is done acting: the turn, street or hand moves on without them
+    if (removed_front || active_players_in_hand().size() == 1) {
+      end_turn(res);
     }
   }
   return res;
@@ -91,39 +135,42 @@ auto Table::on_action(Action action)
     return std::unexpected(result.error());
   }
   auto response = *result;
+  end_turn(response);
+  return response;
+}
+
+void Table::end_turn(std::vector<Event> &events) {
   prune_turn_queue();
   auto remaining = active_players_in_hand();
   if (remaining.size() == 1) {
-    award_chips(remaining.front(), total_committed(), response);
+    award_chips(remaining.front(), total_committed(), events);
     hand_state_.reset();
-    return response;
-  }
-  // advance the hand phase if that was the last player
-  if (hand_state_->turn_queue.size() == 0) {
-    bool any_active =
-        std::any_of(remaining.begin(), remaining.end(), [&](PlayerId id) {
-          return hand_state_->player_state.at(id) == PlayerState::active;
-        });
-    if (!any_active) {
-      reveal_remaining_board(response);
-      distribute_side_pots(response);
-      hand_state_.reset();
-      return response;
-    }
-    if (hand_state_->phase == Phase::river) {
-      distribute_side_pots(response);
-      hand_state_.reset();
-      return response;
-    }
-    auto advance = handle_new_street();
-    if (!advance) {
-      return std::unexpected(advance.error());
-    }
-    response.insert(response.end(), advance->begin(), advance->end());
-  } else {
-    advance_turn(response);
+    return;
+  }
+  if (!hand_state_->turn_queue.empty()) {
+    advance_turn(events);
+    return;
+  }
+  // that was the last player to act this street
+  bool any_active =
+      std::any_of(remaining.begin(), remaining.end(), [&](PlayerId id) {
+        return hand_state_->player_state.at(id) == PlayerState::active;
+      });
+  if (!any_active) {
+    reveal_remaining_board(events);
+    distribute_side_pots(events);
+    hand_state_.reset();
+    return;
+  }
+  if (hand_state_->phase == Phase::river) {
+    distribute_side_pots(events);
+    hand_state_.reset();
+    return;
+  }
+  // short of the river there is always a next street
+  if (auto advance = handle_new_street()) {
+    events.insert(events.end(), advance->begin(), advance->end());
   }
-  return response;
 }
 
 // assume that all actions will happen serially. any driver needs to ensure
@@ -137,11 +184,13 @@ auto Table::handle_new_hand() -> std::expected<std::vector<Event>, GameError> {
   }
   hand_state_.reset();
   players_.seat_held_players();
-  button_ = button_ == 0 ? *players_.get_first_player()
-                         : *players_.next_player(button_);
+  // the button may have left since the last hand
+  const auto next = players_.next_player(button_);
+  button_ = button_ != 0 && next ? *next : *players_.get_first_player();
   HandState state{};
   state.button = button_;
-  state.participants = players_.active_cycle_from(button_);
+  const auto cycle = players_.active_cycle_from(button_);
+  state.participants.assign(cycle.begin(), cycle.end());
   if (state.participants.size() < 2) {
     return std::unexpected(GameError::not_enough_players);
   }
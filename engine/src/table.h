@@ -84,6 +84,15 @@ using Action = std::variant<Fold, Bet, Timeout>;
 
 enum class PlayerState { active, all_in, folded, broke, left };
 
+// What a seated player can see of the hand in progress.
+struct SeatView {
+  Phase phase;
+  Chips to_call;
+  Chips min_raise;
+  Chips chips;
+  std::array<cards::Card, kHoleSize> hole;
+};
+
 struct HandState {
   Phase phase{Phase::holding};
   PlayerId button{0};
@@ -105,12 +114,21 @@ public:
   bool has_open_seat() const;
   bool can_start_hand() const;
   bool hand_in_progress() const;
-  auto add_player(PlayerId id) -> std::expected<Event, PlayerMgmtError>;
+  auto seat_view(PlayerId id) const -> std::optional<SeatView>;
+  // True while `id` can still win the current hand: not folded, not gone.
+  bool in_hand(PlayerId id) const;
+  // The player the hand is waiting on, if a hand is in progress.
+  auto on_clock() const -> std::optional<PlayerId>;
+  // `buy_in` is what the player sits down with at the next hand.
+  auto add_player(PlayerId id, Chips buy_in = kBuyIn)
+      -> std::expected<Event, PlayerMgmtError>;
   auto remove_player(PlayerId id)
       -> std::expected<std::vector<Event>, PlayerMgmtError>;
   auto on_action(Action action) -> std::expected<std::vector<Event>, GameError>;
   auto handle_new_hand() -> std::expected<std::vector<Event>, GameError>;
   auto handle_new_street() -> std::expected<std::vector<Event>, GameError>;
+  // Empties the table, hand and seats included, for reuse.
+  void clear();
 
 private:
   void deal_cards(HandState &state);
@@ -122,6 +140,9 @@ private:
   auto total_committed() const -> Chips;
   auto hand_rank(PlayerId id) const -> uint64_t;
   void award_chips(PlayerId id, Chips amount, std::vector<Event> &events);
+  // Moves the hand on once the player on the clock is done, by acting or
+  // by leaving: to the next player, the next street or the showdown.
+  void end_turn(std::vector<Event> &events);
   void distribute_side_pots(std::vector<Event> &events);
   void post_blind(PlayerId id, Chips amount, std::vector<Event> &events);
   void reveal_remaining_board(std::vector<Event> &events);
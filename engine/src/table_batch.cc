@@ -0,0 +1,306 @@
+#include "table_batch.h"
+
+#include <bit>
+#include <limits>
+#include <numeric>
+
+namespace poker {
+namespace {
+
+constexpr auto bit(std::size_t seat) -> uint16_t {
+  return static_cast<uint16_t>(1u << seat);
+}
+
+// Cards of the board dealt by `phase`.
+constexpr auto board_cards(Phase phase) -> std::size_t {
+  switch (phase) {
+  case Phase::flop:
+    return kFlopSize;
+  case Phase::turn:
+    return kFlopSize + 1;
+  case Phase::river:
+  case Phase::showdown:
+    return kBoardSize;
+  case Phase::holding:
+  case Phase::preflop:
+    break;
+  }
+  return 0;
+}
+
+} // namespace
+
+TableBatch::TableBatch(std::size_t games, std::size_t seats, Chips stack,
+                       uint64_t seed)
+    : games_(games), seats_(std::clamp<std::size_t>(seats, 2, kMaxPlayers)),
+      stack_(std::max(stack, 2 * kBigBlind)), to_act_(games),
+      phase_(games), button_(games), current_bet_(games), min_raise_(games),
+      pot_(games), rejected_(games), done_(games),
+      board_(games * kBoardSize), live_(games), active_(games),
+      pending_(games), stacks_(games * seats_), bets_(games * seats_),
+      committed_(games * seats_), rewards_(games * seats_),
+      holes_(games * seats_ * kHoleSize), decks_(games) {
+  rngs_.reserve(games);
+  for (std::size_t g = 0; g < games; ++g) {
+    std::iota(decks_[g].begin(), decks_[g].end(), cards::CardId{0});
+    rngs_.emplace_back(seed + g);
+    deal(g);
+  }
+}
+
+void TableBatch::step(std::span<const Move> moves,
+                      std::span<const Chips> amounts) {
+  std::ranges::fill(rejected_, 0);
+  std::ranges::fill(done_, 0);
+  std::ranges::fill(rewards_, 0);
+  showdowns_.clear();
+  for (std::size_t g = 0; g < games_; ++g) {
+    play(g, moves[g], amounts[g]);
+  }
+  rank_showdowns();
+}
+
+void TableBatch::deal(std::size_t g) {
+  auto &deck = decks_[g];
+  std::ranges::shuffle(deck, rngs_[g]);
+  const auto row = g * seats_;
+  std::fill_n(stacks_.begin() + static_cast<std::ptrdiff_t>(row), seats_,
+              stack_);
+  std::fill_n(bets_.begin() + static_cast<std::ptrdiff_t>(row), seats_, 0);
+  std::fill_n(committed_.begin() + static_cast<std::ptrdiff_t>(row), seats_,
+              0);
+  std::fill_n(board_.begin() + static_cast<std::ptrdiff_t>(g * kBoardSize),
+              kBoardSize, kHiddenCard);
+  // two cards each from the button round, then the board
+  const std::size_t button = button_[g];
+  for (std::size_t k = 0; k < seats_; ++k) {
+    const auto seat = (button + k) % seats_;
+    holes_[(row + seat) * kHoleSize] = deck[k * kHoleSize];
+    holes_[(row + seat) * kHoleSize + 1] = deck[k * kHoleSize + 1];
+  }
+  phase_[g] = Phase::preflop;
+  pot_[g] = 0;
+  current_bet_[g] = 0;
+  min_raise_[g] = kBigBlind;
+  live_[g] = active_[g] = static_cast<SeatMask>(bit(seats_) - 1);
+
+  // heads-up the button posts the small blind and acts first preflop
+  const auto sb = seats_ == 2 ? button : (button + 1) % seats_;
+  const auto bb = (sb + 1) % seats_;
+  post_blind(g, sb, kSmallBlind);
+  post_blind(g, bb, kBigBlind);
+  pending_[g] = active_[g];
+  to_act_[g] = static_cast<uint8_t>(seats_ == 2 ? sb : (bb + 1) % seats_);
+}
+
+void TableBatch::post_blind(std::size_t g, std::size_t seat, Chips amount) {
+  const auto at = g * seats_ + seat;
+  const auto blind = std::min(amount, stacks_[at]);
+  if (blind == stacks_[at]) {
+    active_[g] &= static_cast<SeatMask>(~bit(seat));
+  }
+  stacks_[at] -= blind;
+  committed_[at] += blind;
+  bets_[at] += blind;
+  pot_[g] += blind;
+  current_bet_[g] = std::max(current_bet_[g], bets_[at]);
+}
+
+// Table::handle and the tail of Table::on_action, over the masks.
+void TableBatch::play(std::size_t g, Move move, Chips amount) {
+  const std::size_t seat = to_act_[g];
+  const auto at = g * seats_ + seat;
+  const auto me = static_cast<SeatMask>(~bit(seat));
+  if (move == Move::fold) {
+    live_[g] &= me;
+    active_[g] &= me;
+    pending_[g] &= me;
+    bets_[at] = 0;
+  } else {
+    const Chips previous = current_bet_[g];
+    const Chips current = bets_[at];
+    Chips bet = amount;
+    const bool all_in = bet >= stacks_[at] && bet > 0;
+    if (all_in) {
+      bet = stacks_[at];
+    }
+    const Chips total = current + bet;
+    bool raise = false;
+    if (bet == 0 && current < previous) {
+      rejected_[g] = 1;
+      return;
+    }
+    if (bet > 0) {
+      if (total < previous && !all_in) {
+        rejected_[g] = 1;
+        return;
+      }
+      if (total > previous) {
+        if (total - previous < min_raise_[g] && !all_in) {
+          rejected_[g] = 1;
+          return;
+        }
+        raise = total - previous >= min_raise_[g];
+      }
+    }
+    pending_[g] &= me;
+    if (all_in) {
+      active_[g] &= me;
+    }
+    stacks_[at] -= bet;
+    committed_[at] += bet;
+    pot_[g] += bet;
+    current_bet_[g] = std::max(previous, total);
+    bets_[at] = total;
+    if (raise) {
+      min_raise_[g] = total - previous;
+      pending_[g] = active_[g] & me;
+    }
+  }
+
+  if (std::popcount(live_[g]) == 1) {
+    award(g, static_cast<std::size_t>(std::countr_zero(live_[g])), pot_[g]);
+    finish(g);
+    return;
+  }
+  if (pending_[g] != 0) {
+    to_act_[g] = static_cast<uint8_t>(seat_after(pending_[g], seat));
+    return;
+  }
+  if (active_[g] == 0 || phase_[g] == Phase::river) {
+    reveal(g, Phase::river);
+    showdowns_.push_back(static_cast<uint32_t>(g));
+    return;
+  }
+  next_street(g);
+}
+
+void TableBatch::next_street(std::size_t g) {
+  reveal(g, static_cast<Phase>(std::to_underlying(phase_[g]) + 1));
+  std::fill_n(bets_.begin() + static_cast<std::ptrdiff_t>(g * seats_),
+              seats_, 0);
+  current_bet_[g] = 0;
+  min_raise_[g] = kBigBlind;
+  pending_[g] = active_[g];
+  to_act_[g] = static_cast<uint8_t>(seat_after(active_[g], button_[g]));
+}
+
+void TableBatch::reveal(std::size_t g, Phase through) {
+  const auto from = board_cards(phase_[g]);
+  const auto to = board_cards(through);
+  const auto &deck = decks_[g];
+  for (auto i = from; i < to; ++i) {
+    board_[g * kBoardSize + i] = deck[seats_ * kHoleSize + i];
+  }
+  phase_[g] = through;
+}
+
+void TableBatch::finish(std::size_t g) {
+  const auto row = g * seats_;
+  for (std::size_t s = 0; s < seats_; ++s) {
+    rewards_[row + s] =
+        static_cast<int64_t>(stacks_[row + s]) - static_cast<int64_t>(stack_);
+  }
+  done_[g] = 1;
+  ++hands_played_;
+  button_[g] = static_cast<uint8_t>((button_[g] + 1) % seats_);
+  deal(g);
+}
+
+void TableBatch::award(std::size_t g, std::size_t seat, Chips amount) {
+  stacks_[g * seats_ + seat] += amount;
+}
+
+void TableBatch::rank_showdowns() {
+  if (showdowns_.empty()) {
+    return;
+  }
+  // every hand still in, seven cards apiece, then one pass to rank them
+  to_rank_.clear();
+  for (const auto g : showdowns_) {
+    const auto &deck = decks_[g];
+    for (auto live = live_[g]; live != 0; live &= live - 1) {
+      const auto seat = static_cast<std::size_t>(std::countr_zero(live));
+      const auto *hole = &holes_[(g * seats_ + seat) * kHoleSize];
+      auto &hand = to_rank_.emplace_back();
+      hand[0] = cards::from_card_id(hole[0]);
+      hand[1] = cards::from_card_id(hole[1]);
+      for (std::size_t i = 0; i < kBoardSize; ++i) {
+        hand[kHoleSize + i] =
+            cards::from_card_id(deck[seats_ * kHoleSize + i]);
+      }
+    }
+  }
+  ranks_.resize(to_rank_.size());
+  for (std::size_t i = 0; i < to_rank_.size(); ++i) {
+    ranks_[i] = rank_best_of_seven(to_rank_[i]);
+  }
+  const auto *ranks = ranks_.data();
+  for (const auto g : showdowns_) {
+    split_pots(g, ranks);
+    ranks += std::popcount(live_[g]);
+    finish(g);
+  }
+}
+
+// Table::build_side_pots and distribute_side_pots. `ranks` holds the live
+// seats' ranks in seat order.
+void TableBatch::split_pots(std::size_t g, const HandRank *ranks) {
+  const auto row = g * seats_;
+  const auto live = live_[g];
+  SeatMask in = 0; // seats in for the current layer
+  for (std::size_t s = 0; s < seats_; ++s) {
+    if (committed_[row + s] > 0) {
+      in |= bit(s);
+    }
+  }
+  Chips level = 0;
+  while (in != 0) {
+    Chips next = std::numeric_limits<Chips>::max();
+    for (auto m = in; m != 0; m &= m - 1) {
+      next = std::min(next, committed_[row + std::countr_zero(m)]);
+    }
+    const auto layer = (next - level) * static_cast<Chips>(std::popcount(in));
+    const auto eligible = static_cast<SeatMask>(in & live);
+    if (layer > 0 && eligible != 0) {
+      HandRank best = std::numeric_limits<HandRank>::max();
+      SeatMask winners = 0;
+      for (auto m = eligible; m != 0; m &= m - 1) {
+        const auto s = static_cast<std::size_t>(std::countr_zero(m));
+        const auto below = static_cast<SeatMask>(live & (bit(s) - 1));
+        const auto rank = ranks[std::popcount(below)];
+        if (rank < best) {
+          best = rank;
+          winners = bit(s);
+        } else if (rank == best) {
+          winners |= bit(s);
+        }
+      }
+      // odd chips go to the winners nearest the button, button first
+      const auto share = static_cast<Chips>(std::popcount(winners));
+      auto odd = layer % share;
+      for (std::size_t k = 0; k < seats_; ++k) {
+        const auto s = (button_[g] + k) % seats_;
+        if ((winners & bit(s)) != 0) {
+          award(g, s, layer / share + (odd > 0 ? 1 : 0));
+          odd -= odd > 0 ? 1 : 0;
+        }
+      }
+    }
+    level = next;
+    for (auto m = in; m != 0; m &= m - 1) {
+      const auto s = static_cast<std::size_t>(std::countr_zero(m));
+      if (committed_[row + s] == level) {
+        in &= static_cast<SeatMask>(~bit(s));
+      }
+    }
+  }
+}
+
+auto TableBatch::seat_after(SeatMask mask, std::size_t seat) const
+    -> std::size_t {
+  const auto after = static_cast<SeatMask>(mask & ~((2u << seat) - 1));
+  return static_cast<std::size_t>(std::countr_zero(after ? after : mask));
+}
+
+} // namespace poker
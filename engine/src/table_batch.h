@@ -0,0 +1,131 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <span>
+#include <vector>
+
+#include "cards.h"
+#include "hand_evaluator.h"
+#include "poker_rules.h"
+#include "table.h"
+
+// Many games of the same size stepped together, for self-play. Each game
+// plays the rules of a Table, but the state of every game lives in flat
+// per-field arrays rather than in a Table each: step() takes one move per
+// game, plays them all, and leaves what the players can see in buffers
+// the caller reads in place. No events are built, and showdowns are ranked
+// together at the end of the step.
+namespace poker {
+
+enum class Move : uint8_t { fold, bet };
+
+// Cards not dealt yet, in board().
+inline constexpr cards::CardId kHiddenCard = 0xff;
+
+class TableBatch {
+public:
+  // `games` games of `seats` players, 2 to kMaxPlayers. Every hand starts
+  // with each seat holding `stack` chips (at least two big blinds) and the
+  // button one seat on from the hand before, starting at seat 0: what a
+  // Table shows when its players rebuy to `stack` between hands. Game g
+  // shuffles like a Table whose rng is std::mt19937_64(seed + g), so it
+  // deals the same cards.
+  TableBatch(std::size_t games, std::size_t seats, Chips stack = kBuyIn,
+             uint64_t seed = 1);
+
+  // Plays moves[g] for the seat to act in each game g, as Table::on_action
+  // would with a Fold or a Bet of amounts[g] (the chips put in now; 0
+  // checks). A move the Table would refuse as bet_too_low leaves its game
+  // as it was and is flagged in rejected(). A game whose hand ends shows
+  // the result in rewards() and done(), and is dealt its next hand.
+  void step(std::span<const Move> moves, std::span<const Chips> amounts);
+
+  std::size_t games() const { return games_; }
+  std::size_t seats() const { return seats_; }
+  uint64_t hands_played() const { return hands_played_; }
+
+  // By game.
+  std::span<const uint8_t> to_act() const { return to_act_; }
+  std::span<const Phase> phase() const { return phase_; }
+  std::span<const uint8_t> button() const { return button_; }
+  // The bet to match this street, and the least a raise adds to it.
+  std::span<const Chips> current_bet() const { return current_bet_; }
+  std::span<const Chips> min_raise() const { return min_raise_; }
+  std::span<const Chips> pot() const { return pot_; }
+  std::span<const uint8_t> rejected() const { return rejected_; }
+  std::span<const uint8_t> done() const { return done_; }
+  // kBoardSize per game, kHiddenCard past the street.
+  std::span<const cards::CardId> board() const { return board_; }
+
+  // By game * seats() + seat.
+  std::span<const Chips> stacks() const { return stacks_; }
+  // Put in this street.
+  std::span<const Chips> bets() const { return bets_; }
+  // Chips won or lost in the hand that ended this step; 0 if it did not.
+  std::span<const int64_t> rewards() const { return rewards_; }
+  // kHoleSize per seat.
+  std::span<const cards::CardId> holes() const { return holes_; }
+
+  Chips to_call(std::size_t game) const {
+    const auto bet = bets_[game * seats_ + to_act_[game]];
+    return current_bet_[game] - std::min(bet, current_bet_[game]);
+  }
+
+private:
+  // bit s stands for seat s
+  using SeatMask = uint16_t;
+  static_assert(kMaxPlayers <= 16);
+
+  void deal(std::size_t g);
+  void post_blind(std::size_t g, std::size_t seat, Chips amount);
+  void play(std::size_t g, Move move, Chips amount);
+  void next_street(std::size_t g);
+  void reveal(std::size_t g, Phase through);
+  void finish(std::size_t g);
+  void award(std::size_t g, std::size_t seat, Chips amount);
+  void rank_showdowns();
+  void split_pots(std::size_t g, const HandRank *ranks);
+  auto seat_after(SeatMask mask, std::size_t seat) const -> std::size_t;
+
+  std::size_t games_;
+  std::size_t seats_;
+  Chips stack_;
+  uint64_t hands_played_{0};
+
+  std::vector<uint8_t> to_act_;
+  std::vector<Phase> phase_;
+  std::vector<uint8_t> button_;
+  std::vector<Chips> current_bet_;
+  std::vector<Chips> min_raise_;
+  std::vector<Chips> pot_;
+  std::vector<uint8_t> rejected_;
+  std::vector<uint8_t> done_;
+  std::vector<cards::CardId> board_;
+  // Seats still in the hand, those of them with chips behind, and those
+  // still to act this street.
+  std::vector<SeatMask> live_;
+  std::vector<SeatMask> active_;
+  std::vector<SeatMask> pending_;
+
+  std::vector<Chips> stacks_;
+  std::vector<Chips> bets_;
+  std::vector<Chips> committed_;
+  std::vector<int64_t> rewards_;
+  std::vector<cards::CardId> holes_;
+
+  // Each game keeps its deck between hands, as a Table does.
+  std::vector<std::array<cards::CardId, kDeckSize>> decks_;
+  std::vector<std::mt19937_64> rngs_;
+
+  // Games waiting on a showdown this step, and their hands laid out seven
+  // cards to a seat for ranking in one pass.
+  std::vector<uint32_t> showdowns_;
+  std::vector<std::array<cards::Card, kHoleSize + kBoardSize>> to_rank_;
+  std::vector<HandRank> ranks_;
+};
+
+} // namespace poker
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+// Unsigned LEB128, seven bits a byte with the high bit set on all but the
+// last: protobuf's varint, and what the snapshot and capture files use for
+// ids, gaps and lengths.
+namespace varint {
+
+inline void append(std::string &out, uint64_t v) {
+  for (; v >= 0x80; v >>= 7) {
+    out.push_back(static_cast<char>(v | 0x80));
+  }
+  out.push_back(static_cast<char>(v));
+}
+
+// Takes one varint off the front of `in`; nullopt if it runs past the end
+// or past 64 bits.
+inline auto read(std::string_view &in) -> std::optional<uint64_t> {
+  uint64_t v = 0;
+  for (int shift = 0; shift < 64 && !in.empty(); shift += 7) {
+    const auto byte = static_cast<uint8_t>(in.front());
+    in.remove_prefix(1);
+    v |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      return v;
+    }
+  }
+  return std::nullopt;
+}
+
+// how many bytes append() writes for `v`
+constexpr auto size(uint64_t v) -> std::size_t {
+  std::size_t n = 1;
+  for (; v >= 0x80; v >>= 7) {
+    ++n;
+  }
+  return n;
+}
+
+} // namespace varint
@@ -0,0 +1,139 @@
+#include "wire_writer.h"
+
+#include <string_view>
+#include <type_traits>
+#include <variant>
+
+#include "response.pb.h"
+#include "varint.h"
+
+namespace wire {
+namespace {
+
+enum WireType : uint8_t { kVarint = 0, kLen = 2 };
+
+constexpr auto tag(uint32_t field, WireType type) -> char {
+  return static_cast<char>(field << 3 | type);
+}
+
+// An event's payload submessage. The largest, a ShowdownHand, is a player
+// id and two cards, so a small buffer on the stack holds any of them.
+class Body {
+public:
+  // proto3 leaves zero scalars out
+  void uint(uint32_t field, uint64_t v) {
+    if (v != 0) {
+      buf_[n_++] = tag(field, kVarint);
+      for (; v >= 0x80; v >>= 7) {
+        buf_[n_++] = static_cast<char>(v | 0x80);
+      }
+      buf_[n_++] = static_cast<char>(v);
+    }
+  }
+  void card(uint32_t field, cards::Card c) {
+    const auto &body = kCardBodies[cards::to_card_id(c)];
+    buf_[n_++] = tag(field, kLen);
+    buf_[n_++] = static_cast<char>(body.size());
+    for (const char b : body) {
+      buf_[n_++] = b;
+    }
+  }
+  auto view() const -> std::string_view { return {buf_.data(), n_}; }
+
+private:
+  std::array<char, 64> buf_;
+  std::size_t n_{0};
+};
+
+// Event.payload's field number is the alternative's index in poker::Event
+// plus one.
+template <typename T>
+constexpr auto kField =
+    poker::Event(std::in_place_type<T>).index() + 1;
+
+static_assert(::poker::v1::Response::kMessagesFieldNumber == 1);
+static_assert(::poker::v1::ServerMessage::kEventFieldNumber == 1);
+static_assert(::poker::v1::ServerMessage::kTableIdFieldNumber == 3);
+static_assert(::poker::v1::ServerMessage::kHandIdFieldNumber == 8);
+
+using Proto = ::poker::v1::Event;
+static_assert(Proto::kPlayerAddedFieldNumber == kField<poker::PlayerAdded>);
+static_assert(Proto::kPlayerRemovedFieldNumber ==
+              kField<poker::PlayerRemoved>);
+static_assert(Proto::kBetPlacedFieldNumber == kField<poker::BetPlaced>);
+static_assert(Proto::kTurnAdvancedFieldNumber == kField<poker::TurnAdvanced>);
+static_assert(Proto::kPhaseAdvancedFieldNumber ==
+              kField<poker::PhaseAdvanced>);
+static_assert(Proto::kWonPotFieldNumber == kField<poker::WonPot>);
+static_assert(Proto::kPlayerChipsFieldNumber == kField<poker::PlayerChips>);
+static_assert(Proto::kHandStartedFieldNumber == kField<poker::HandStarted>);
+static_assert(Proto::kDealtHoleFieldNumber == kField<poker::DealtHole>);
+static_assert(Proto::kDealtFlopFieldNumber == kField<poker::DealtFlop>);
+static_assert(Proto::kDealtStreetFieldNumber == kField<poker::DealtStreet>);
+static_assert(Proto::kShowdownHandFieldNumber ==
+              kField<poker::ShowdownHand>);
+
+} // namespace
+
+void append_event(std::string &out, const poker::Event &ev,
+                  poker::TableId table, uint64_t hand) {
+  Body body;
+  std::visit(
+      [&](const auto &e) {
+        using T = std::decay_t<decltype(e)>;
+        using namespace poker;
+        if constexpr (std::is_same_v<T, PlayerAdded> ||
+                      std::is_same_v<T, PlayerRemoved>) {
+          body.uint(1, e.who);
+        } else if constexpr (std::is_same_v<T, BetPlaced> ||
+                             std::is_same_v<T, WonPot>) {
+          body.uint(1, e.who);
+          body.uint(2, e.amount);
+        } else if constexpr (std::is_same_v<T, TurnAdvanced>) {
+          body.uint(1, e.next);
+        } else if constexpr (std::is_same_v<T, PhaseAdvanced>) {
+          body.uint(1, std::to_underlying(e.next) + 1); // after UNSPECIFIED
+        } else if constexpr (std::is_same_v<T, PlayerChips>) {
+          body.uint(1, e.who);
+          body.uint(2, e.chips);
+        } else if constexpr (std::is_same_v<T, DealtHole> ||
+                             std::is_same_v<T, ShowdownHand>) {
+          body.uint(1, e.who);
+          for (const auto &c : e.hole) {
+            body.card(2, c);
+          }
+        } else if constexpr (std::is_same_v<T, DealtFlop>) {
+          for (const auto &c : e.flop) {
+            body.card(1, c);
+          }
+        } else if constexpr (std::is_same_v<T, DealtStreet>) {
+          body.card(1, e.street);
+        }
+        // HandStarted has no fields
+      },
+      ev);
+  const auto sub = body.view();
+  // ServerMessage { event = 1 { <payload> { sub } }, table_id = 3,
+  //                 hand_id = 8 }
+  const auto event_size = 1 + varint::size(sub.size()) + sub.size();
+  const auto message_size = 1 + varint::size(event_size) + event_size +
+                            (table != 0 ? 1 + varint::size(table) : 0) +
+                            (hand != 0 ? 1 + varint::size(hand) : 0);
+  out.push_back(tag(1, kLen)); // Response.messages
+  varint::append(out, message_size);
+  out.push_back(tag(1, kLen)); // ServerMessage.event
+  varint::append(out, event_size);
+  out.push_back(tag(static_cast<uint32_t>(ev.index() + 1), kLen));
+  varint::append(out, sub.size());
+  out.append(sub);
+  if (table != 0) {
+    out.push_back(tag(3, kVarint)); // ServerMessage.table_id
+    varint::append(out, table);
+  }
+  if (hand != 0) {
+    out.push_back(tag(8, kVarint)); // ServerMessage.hand_id
+    varint::append(out, hand);
+  }
+}
+
+} // namespace wire
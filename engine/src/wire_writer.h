@@ -0,0 +1,35 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+#include "deck.h"
+#include "table.h"
+
+// Writes outbound Responses straight in protobuf wire format. Events are a
+// handful of fixed shapes over small integers and 52 cards, so rather than
+// building a ::poker::v1::Response and serializing it, the writer appends
+// pre-encoded tags and cards and the few varints that change. The bytes are
+// exactly what SerializeToString produces for the same message.
+namespace wire {
+
+// The body of a poker.v1.Card for every CardId: rank, then suit.
+inline constexpr auto kCardBodies = [] {
+  std::array<std::array<char, 4>, kDeckSize> out{};
+  for (cards::CardId id = 0; id < out.size(); ++id) {
+    const auto card = cards::from_card_id(id);
+    // the proto enums count from 1, after their UNSPECIFIED
+    out[id] = {0x08, static_cast<char>(std::to_underlying(card.rank) + 1),
+               0x10, static_cast<char>(std::to_underlying(card.suit) + 1)};
+  }
+  return out;
+}();
+
+// Appends `ev` as one more `messages` entry of a Response, tagged with
+// `table` and fast-fold `hand` (0 leaves a tag out). Responses concatenate,
+// so a run of calls builds a whole Response.
+void append_event(std::string &out, const poker::Event &ev,
+                  poker::TableId table, uint64_t hand = 0);
+
+} // namespace wire
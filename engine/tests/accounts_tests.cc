@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <string_view>
+
+#include "accounts.h"
+#include "scratch_file.h"
+
+using namespace poker;
+
+TEST(Accounts, VerifiesOnlyTheIssuedToken) {
+  Accounts accounts;
+  accounts.add({7, 0xfeedULL});
+  EXPECT_TRUE(accounts.contains(7));
+  EXPECT_TRUE(accounts.verify({7, 0xfeedULL}));
+  EXPECT_FALSE(accounts.verify({7, 0xbeefULL}));
+  EXPECT_FALSE(accounts.verify({8, 0xfeedULL}));
+
+  accounts.erase(7);
+  EXPECT_FALSE(accounts.verify({7, 0xfeedULL}));
+  // an erased id is still never handed out again
+  EXPECT_EQ(accounts.id_bound(), 8u);
+}
+
+TEST(Accounts, SaveAndLoadRoundTrip) {
+  Accounts accounts;
+  for (PlayerId id = 1; id < 3000; id += 3) {
+    accounts.add({id, id * 0x9e3779b97f4a7c15ULL});
+  }
+  const auto path = scratch_file("_accounts_roundtrip");
+  ASSERT_TRUE(accounts.save(path));
+  // tokens are only for the server's eyes, whatever the umask
+  const auto perms = std::filesystem::status(path).permissions();
+  EXPECT_EQ(perms & std::filesystem::perms::all,
+            std::filesystem::perms::owner_read |
+                std::filesystem::perms::owner_write);
+
+  auto loaded = Accounts::load(path);
+  std::filesystem::remove(path);
+  ASSERT_TRUE(loaded.has_value());
+  EXPECT_EQ(loaded->size(), accounts.size());
+  EXPECT_EQ(loaded->id_bound(), accounts.id_bound());
+  for (const auto &c : accounts.credentials()) {
+    ASSERT_TRUE(loaded->verify(c)) << c.player;
+  }
+}
+
+TEST(Accounts, RejectsMalformedSnapshots) {
+  const auto path = scratch_file("_accounts_malformed");
+  auto load = [&](std::string_view bytes) {
+    {
+      std::ofstream f(path, std::ios::binary | std::ios::trunc);
+      f.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    }
+    return Accounts::load(path);
+  };
+  using namespace std::string_view_literals;
+  EXPECT_TRUE(load("PAC1\x01\x03\x01\x02\x03\x04\x05\x06\x07\x08"sv));
+  EXPECT_FALSE(load("PST1\x00"sv));
+  // id 0 is nobody
+  EXPECT_FALSE(load("PAC1\x01\x00\x01\x02\x03\x04\x05\x06\x07\x08"sv));
+  // a short token, and bytes past the last account
+  EXPECT_FALSE(load("PAC1\x01\x03\x01\x02\x03"sv));
+  EXPECT_FALSE(load("PAC1\x01\x03\x01\x02\x03\x04\x05\x06\x07\x08\x00"sv));
+  std::filesystem::remove(path);
+
+  auto missing = Accounts::load(scratch_file("_accounts_missing"));
+  ASSERT_FALSE(missing);
+  EXPECT_EQ(missing.error(), AccountError::io);
+}
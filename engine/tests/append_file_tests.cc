@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+
+#include "append_file.h"
+#include "scratch_file.h"
+
+using append_file::kFlushBytes;
+using append_file::Writer;
+
+namespace {
+
+auto slurp(const std::filesystem::path &path) -> std::string {
+  std::ifstream in(path, std::ios::binary);
+  return {std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+}
+
+// The writer thread owns the disk, so give it a moment.
+auto wait_for_size(const std::filesystem::path &path, std::size_t size)
+    -> std::size_t {
+  auto got = std::filesystem::file_size(path);
+  for (int i = 0; i < 100 && got < size; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    got = std::filesystem::file_size(path);
+  }
+  return got;
+}
+
+} // namespace
+
+TEST(AppendFile, WritesHeaderThenBuffersInOrder) {
+  const auto path = scratch_file("append_order.bin");
+  {
+    auto writer = Writer::open(path, "HDR\n", "test file");
+    ASSERT_TRUE(writer);
+    writer->buffer() += "one,";
+    writer->flush();
+    writer->buffer() += "two";
+  }
+  EXPECT_EQ(slurp(path), "HDR\none,two");
+  std::filesystem::remove(path);
+}
+
+TEST(AppendFile, OnlyFullBuffersGoWithoutAFlush) {
+  const auto path = scratch_file("append_full.bin");
+  auto writer = Writer::open(path, "H", "test file");
+  ASSERT_TRUE(writer);
+  writer->buffer() += "small";
+  writer->flush_if_full();
+  EXPECT_EQ(writer->buffer(), "small");
+
+  writer->buffer().append(kFlushBytes, 'x');
+  writer->flush_if_full();
+  EXPECT_TRUE(writer->buffer().empty());
+  EXPECT_EQ(wait_for_size(path, 1 + 5 + kFlushBytes), 1 + 5 + kFlushBytes);
+
+  writer->buffer() += "tail";
+  writer->flush();
+  EXPECT_EQ(wait_for_size(path, 1 + 9 + kFlushBytes), 1 + 9 + kFlushBytes);
+  writer.reset();
+  std::filesystem::remove(path);
+}
+
+TEST(AppendFile, UnwritablePathFails) {
+  EXPECT_FALSE(Writer::open("/nonexistent-dir/append.bin", "H", "test file"));
+}
@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <filesystem>
+#include <string>
+
+#include "capture.h"
+#include "scratch_file.h"
+
+using namespace capture;
+using namespace std::chrono_literals;
+
+TEST(Capture, WriterRoundTripsRecords) {
+  const auto path = scratch_file("capture_roundtrip.cap");
+  const auto t0 = Writer::Clock::now();
+  {
+    auto writer = Writer::open(path);
+    ASSERT_TRUE(writer);
+    (*writer)->record(Kind::open, t0, 7);
+    (*writer)->record(Kind::inbound, t0 + 1500us, 7, "action");
+    (*writer)->record(Kind::outbound, t0 + 1500us, 7, std::string(300, 'x'));
+    (*writer)->record(Kind::close, t0 + 2s, 300);
+  }
+
+  auto reader = Reader::open(path);
+  ASSERT_TRUE(reader);
+  auto rec = reader->next();
+  ASSERT_TRUE(rec);
+  EXPECT_EQ(rec->kind, Kind::open);
+  EXPECT_EQ(rec->at, 0us);
+  EXPECT_EQ(rec->conn, 7u);
+
+  rec = reader->next();
+  ASSERT_TRUE(rec);
+  EXPECT_EQ(rec->kind, Kind::inbound);
+  EXPECT_EQ(rec->at, 1500us);
+  EXPECT_EQ(rec->payload, "action");
+
+  rec = reader->next();
+  ASSERT_TRUE(rec);
+  EXPECT_EQ(rec->kind, Kind::outbound);
+  EXPECT_EQ(rec->payload, std::string(300, 'x'));
+
+  rec = reader->next();
+  ASSERT_TRUE(rec);
+  EXPECT_EQ(rec->kind, Kind::close);
+  EXPECT_EQ(rec->at, 2s);
+  EXPECT_EQ(rec->conn, 300u);
+
+  EXPECT_FALSE(reader->next());
+  EXPECT_FALSE(reader->truncated());
+  std::filesystem::remove(path);
+}
+
+TEST(Capture, TruncatedTailEndsTheStream) {
+  std::string bytes(kMagic);
+  encode({Kind::open, 10us, 1, {}}, 0us, bytes);
+  encode({Kind::inbound, 20us, 1, "payload"}, 10us, bytes);
+  bytes.resize(bytes.size() - 3);
+
+  auto reader = Reader::parse(std::move(bytes));
+  ASSERT_TRUE(reader);
+  const auto rec = reader->next();
+  ASSERT_TRUE(rec);
+  EXPECT_EQ(rec->at, 10us);
+  EXPECT_FALSE(reader->next());
+  EXPECT_TRUE(reader->truncated());
+}
+
+TEST(Capture, RejectsForeignFiles) {
+  EXPECT_EQ(Reader::parse("not a capture").error(), CaptureError::bad_format);
+  EXPECT_EQ(Reader::open(scratch_file("capture_missing.cap")).error(),
+            CaptureError::io);
+}
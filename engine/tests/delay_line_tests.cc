@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "delay_line.h"
+
+using broadcast::Clock;
+using broadcast::DelayLine;
+using std::chrono::seconds;
+
+namespace {
+
+auto drain(DelayLine &line, Clock::time_point now) -> std::vector<std::string> {
+  std::vector<std::string> out;
+  line.release(now, [&](std::string_view frame) { out.emplace_back(frame); });
+  return out;
+}
+
+} // namespace
+
+TEST(DelayLine, ReleasesFramesOnceDue) {
+  DelayLine line(1024);
+  const Clock::time_point t0{};
+  line.push(t0 + seconds{1}, "one");
+  line.push(t0 + seconds{2}, "two");
+  line.push(t0 + seconds{3}, "three");
+  EXPECT_TRUE(drain(line, t0).empty());
+  EXPECT_EQ(drain(line, t0 + seconds{2}),
+            (std::vector<std::string>{"one", "two"}));
+  EXPECT_EQ(line.next_due(), t0 + seconds{3});
+  EXPECT_EQ(drain(line, t0 + seconds{9}), std::vector<std::string>{"three"});
+  EXPECT_EQ(line.next_due(), std::nullopt);
+  EXPECT_EQ(line.dropped(), 0u);
+}
+
+TEST(DelayLine, WrapsAroundWithoutLosingFrames) {
+  DelayLine line(256);
+  const Clock::time_point t0{};
+  std::vector<std::string> pushed;
+  std::vector<std::string> released;
+  // about a third of the ring in flight, in frames of awkward sizes
+  for (int i = 0; i < 1000; ++i) {
+    pushed.push_back(std::string(1 + i % 23, static_cast<char>('a' + i % 26)));
+    line.push(t0 + seconds{i}, pushed.back());
+    for (auto &f : drain(line, t0 + seconds{i - 2})) {
+      released.push_back(std::move(f));
+    }
+  }
+  for (auto &f : drain(line, t0 + seconds{1000})) {
+    released.push_back(std::move(f));
+  }
+  EXPECT_EQ(released, pushed);
+  EXPECT_EQ(line.dropped(), 0u);
+}
+
+TEST(DelayLine, FullRingDropsTheOldest) {
+  DelayLine line(128);
+  const Clock::time_point t0{};
+  for (int i = 0; i < 20; ++i) {
+    line.push(t0 + seconds{i}, std::string(20, static_cast<char>('a' + i)));
+  }
+  EXPECT_GT(line.dropped(), 0u);
+  EXPECT_EQ(line.frames() + line.dropped(), 20u);
+  const auto kept = drain(line, t0 + seconds{20});
+  ASSERT_EQ(kept.size(), 20u - line.dropped());
+  EXPECT_EQ(kept.back(), std::string(20, 'a' + 19)); // the newest survive
+  for (std::size_t i = 1; i < kept.size(); ++i) {
+    EXPECT_EQ(kept[i][0], kept[i - 1][0] + 1);
+  }
+  line.push(t0, std::string(200, 'x')); // never fits
+  EXPECT_EQ(line.frames(), 0u);
+}
@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+#include <arpa/inet.h>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "deck.h"
+#include "encoder.h"
+#include "wire_writer.h"
+
+using namespace poker;
+
+namespace {
+
+auto random_batch(std::mt19937_64 &rolls, TableId table) -> encode::Batch {
+  encode::Batch b;
+  b.table = table;
+  const auto n = rolls() % 30;
+  for (std::size_t i = 0; i < n; ++i) {
+    const auto card = [&] {
+      return cards::from_card_id(static_cast<cards::CardId>(rolls() % 52));
+    };
+    switch (rolls() % 4) {
+    case 0:
+      b.events.push_back(DealtHole{1 + rolls() % 6, {card(), card()}});
+      break;
+    case 1:
+      b.events.push_back(BetPlaced{1 + rolls() % 6, rolls() % 1000});
+      break;
+    case 2:
+      b.events.push_back(DealtStreet{card()});
+      break;
+    default:
+      b.events.push_back(TurnAdvanced{1 + rolls() % 6});
+    }
+  }
+  for (PlayerId id = 1; id <= rolls() % 7; ++id) {
+    b.viewers.push_back(id);
+  }
+  if (rolls() % 3 == 0) {
+    b.viewers.push_back(encode::kEveryone);
+  }
+  return b;
+}
+
+} // namespace
+
+TEST(Encoder, RingIsFirstInFirstOutAndBounded) {
+  encode::SpscRing<int, 4> ring;
+  EXPECT_FALSE(ring.pop());
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_TRUE(ring.push(i));
+  }
+  EXPECT_FALSE(ring.push(4));
+  EXPECT_EQ(ring.pop(), 0);
+  EXPECT_TRUE(ring.push(4));
+  for (int i = 1; i <= 4; ++i) {
+    EXPECT_EQ(ring.pop(), i);
+  }
+  EXPECT_FALSE(ring.pop());
+}
+
+TEST(Encoder, HoleCardsGoToTheirOwnerAndWatchersGetAFrame) {
+  encode::Batch b;
+  b.table = 3;
+  const auto ace = cards::from_card_id(12);
+  b.events = {DealtHole{1, {ace, ace}}, DealtHole{2, {ace, ace}},
+              TurnAdvanced{1}};
+  b.viewers = {1, encode::kEveryone};
+  encode::encode(b);
+  std::string own;
+  wire::append_event(own, b.events[0], 3);
+  wire::append_event(own, b.events[2], 3);
+  EXPECT_EQ(b.out[0], own);
+  uint32_t len = 0;
+  std::memcpy(&len, b.out[1].data(), sizeof(len));
+  EXPECT_EQ(ntohl(len), b.out[1].size() - sizeof(len));
+  EXPECT_GT(b.out[1].size(), sizeof(len) + own.size());
+}
+
+// Far more batches than the pool holds, spread over three workers, come
+// back in order and encoded as they would be inline.
+TEST(Encoder, PoolMatchesInlineInOrder) {
+  encode::Pool pool(3);
+  std::mt19937_64 rolls(5);
+  std::vector<encode::Batch> expected;
+  std::size_t seen = 0;
+  auto check = [&](const encode::Batch &got) {
+    ASSERT_LT(seen, expected.size());
+    const auto &want = expected[seen++];
+    EXPECT_EQ(got.table, want.table);
+    EXPECT_EQ(got.out, want.out);
+  };
+  for (TableId t = 1; t <= 3 * encode::Pool::kDepth; ++t) {
+    auto b = random_batch(rolls, t);
+    if (pool.full()) {
+      pool.drain(check);
+    }
+    auto &next = pool.next();
+    next.table = b.table;
+    next.events = b.events;
+    next.viewers = b.viewers;
+    pool.submit();
+    encode::encode(b);
+    expected.push_back(std::move(b));
+  }
+  EXPECT_EQ(pool.in_flight(), encode::Pool::kDepth);
+  pool.drain(check);
+  EXPECT_EQ(seen, expected.size());
+  EXPECT_EQ(pool.in_flight(), 0u);
+}
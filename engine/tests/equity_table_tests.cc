@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "equity_table.h"
+#include "scratch_file.h"
+
+using namespace poker;
+
+namespace {
+
+constexpr auto cls(cards::Rank a, cards::Rank b, bool suited) -> uint8_t {
+  return hand_class({a, cards::Suit::Spades},
+                    {b, suited ? cards::Suit::Spades : cards::Suit::Hearts});
+}
+
+using cards::Rank;
+constexpr uint8_t kAces = cls(Rank::Ace, Rank::Ace, false);
+constexpr uint8_t kKings = cls(Rank::King, Rank::King, false);
+constexpr uint8_t kSevenTwo = cls(Rank::Seven, Rank::Two, false);
+
+} // namespace
+
+TEST(EquityTable, ClassNames) {
+  EXPECT_EQ(class_name(kAces), "AA");
+  EXPECT_EQ(class_name(cls(Rank::Ace, Rank::King, true)), "AKs");
+  EXPECT_EQ(class_name(kSevenTwo), "72o");
+}
+
+TEST(EquityTable, EstimatesMatchKnownEquities) {
+  // AA wins ~85% heads-up and ~82% against KK; 72o is the worst hand
+  EXPECT_NEAR(equity_vs_random(kAces, 2, 4000, 1), 0.85, 0.03);
+  EXPECT_NEAR(equity_vs_class(kAces, kKings, 4000, 1), 0.82, 0.03);
+  EXPECT_LT(equity_vs_random(kSevenTwo, 2, 4000, 1), 0.40);
+  // more opponents, less equity
+  EXPECT_LT(equity_vs_random(kAces, 6, 1000, 1),
+            equity_vs_random(kAces, 3, 1000, 1));
+}
+
+TEST(EquityTable, FileRoundTrips) {
+  const auto path = scratch_file("equity.bin");
+  const EquityOptions opts{.samples = 2, .threads = 3, .seed = 5};
+  ASSERT_TRUE(write_equity_tables(path, opts));
+  auto table = EquityTable::open(path);
+  ASSERT_TRUE(table);
+  EXPECT_EQ(table->samples(), 2u);
+  EXPECT_DOUBLE_EQ(table->vs_class(kAces, kAces), 0.5);
+  EXPECT_DOUBLE_EQ(table->vs_class(kAces, kKings) +
+                       table->vs_class(kKings, kAces),
+                   1.0);
+
+  // the same seed gives the same file on any number of threads
+  const auto serial =
+      build_equity_tables({.samples = 2, .threads = 1, .seed = 5});
+  std::ifstream in(path, std::ios::binary);
+  const std::string bytes{std::istreambuf_iterator<char>(in), {}};
+  EXPECT_EQ(bytes, serial);
+  std::filesystem::remove(path);
+}
+
+TEST(EquityTable, BadFilesAreRejected) {
+  EXPECT_EQ(EquityTable::open("/nonexistent/equity.bin").error(),
+            EquityError::io);
+  const auto path = scratch_file("equity_bad.bin");
+  auto bytes = build_equity_tables({.samples = 1, .threads = 1, .seed = 1});
+  for (const auto corrupt : {std::string_view("short"),
+                             std::string_view("magic"),
+                             std::string_view("skew")}) {
+    auto copy = bytes;
+    if (corrupt == "short") {
+      copy.pop_back();
+    } else if (corrupt == "magic") {
+      copy[0] = 'X';
+    } else {
+      copy[copy.size() - 2] ^= 1; // breaks a heads-up pair's symmetry
+    }
+    std::ofstream(path, std::ios::binary) << copy;
+    EXPECT_EQ(EquityTable::open(path).error(), EquityError::bad_format)
+        << corrupt;
+  }
+  std::filesystem::remove(path);
+}
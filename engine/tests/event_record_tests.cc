@@ -0,0 +1,124 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <random>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "deck.h"
+#include "event_record.h"
+#include "table.h"
+
+using namespace poker;
+
+namespace {
+
+bool same_cards(const cards::Card &a, const cards::Card &b) {
+  return a.rank == b.rank && a.suit == b.suit;
+}
+
+// Events have no operator==, so compare through their records.
+bool same_event(const Event &a, const Event &b) {
+  if (a.index() != b.index()) {
+    return false;
+  }
+  auto ra = to_record(a);
+  auto rb = to_record(b);
+  return std::memcmp(&ra, &rb, sizeof(EventRecord)) == 0;
+}
+
+} // namespace
+
+TEST(CardId, RoundTripsEveryCard) {
+  for (cards::CardId id = 0; id < kDeckSize; ++id) {
+    auto card = cards::from_card_id(id);
+    EXPECT_EQ(cards::to_card_id(card), id);
+    EXPECT_TRUE(same_cards(card, cards::kCardIdMap[id]));
+  }
+}
+
+TEST(EventRecord, RoundTripsEveryAlternative) {
+  const auto ace = cards::Card{cards::Rank::Ace, cards::Suit::Spades};
+  const auto two = cards::Card{cards::Rank::Two, cards::Suit::Clubs};
+  const auto ten = cards::Card{cards::Rank::Ten, cards::Suit::Hearts};
+  std::vector<Event> events{PlayerAdded{1},
+                            PlayerRemoved{2},
+                            BetPlaced{3, 40},
+                            TurnAdvanced{4},
+                            PhaseAdvanced{Phase::turn},
+                            WonPot{5, 900},
+                            PlayerChips{6, 1234},
+                            HandStarted{},
+                            DealtHole{7, {ace, two}},
+                            DealtFlop{{ten, two, ace}},
+                            DealtStreet{ten},
+                            ShowdownHand{8, {two, ten}}};
+  ASSERT_EQ(events.size(), std::variant_size_v<Event>);
+  for (std::size_t i = 0; i < events.size(); ++i) {
+    auto rec = to_record(events[i]);
+    EXPECT_EQ(static_cast<std::size_t>(rec.tag), i);
+    auto back = from_record(rec);
+    ASSERT_TRUE(back);
+    ASSERT_EQ(back->index(), events[i].index());
+  }
+
+  auto hole = std::get<DealtHole>(*from_record(to_record(events[8])));
+  EXPECT_EQ(hole.who, 7u);
+  EXPECT_TRUE(same_cards(hole.hole[0], ace));
+  EXPECT_TRUE(same_cards(hole.hole[1], two));
+
+  auto flop = std::get<DealtFlop>(*from_record(to_record(events[9])));
+  EXPECT_TRUE(same_cards(flop.flop[0], ten));
+  EXPECT_TRUE(same_cards(flop.flop[2], ace));
+
+  auto chips = std::get<PlayerChips>(*from_record(to_record(events[6])));
+  EXPECT_EQ(chips.who, 6u);
+  EXPECT_EQ(chips.chips, 1234u);
+}
+
+TEST(EventRecord, TableHandSurvivesByteCopy) {
+  std::mt19937_64 rng(0);
+  Table table(rng);
+  ASSERT_TRUE(table.add_player(1));
+  ASSERT_TRUE(table.add_player(2));
+  auto start = table.handle_new_hand();
+  ASSERT_TRUE(start.has_value());
+
+  std::vector<EventRecord> records;
+  append_records(*start, records);
+  ASSERT_EQ(records.size(), start->size());
+
+  std::vector<char> bytes(records.size() * sizeof(EventRecord));
+  std::memcpy(bytes.data(), records.data(), bytes.size());
+  std::vector<EventRecord> copied(records.size());
+  std::memcpy(copied.data(), bytes.data(), bytes.size());
+
+  auto events = to_events(copied);
+  ASSERT_TRUE(events);
+  ASSERT_EQ(events->size(), start->size());
+  for (std::size_t i = 0; i < events->size(); ++i) {
+    EXPECT_TRUE(same_event((*events)[i], (*start)[i]));
+  }
+}
+
+TEST(EventRecord, RejectsCardsOutsideTheDeck) {
+  const auto ace = cards::Card{cards::Rank::Ace, cards::Suit::Spades};
+  auto rec = to_record(DealtFlop{{ace, ace, ace}});
+  rec.cards[2] = kDeckSize;
+  EXPECT_EQ(from_record(rec).error(), RecordError::bad_card);
+  // slots the tag does not use are not read
+  rec = to_record(DealtStreet{ace});
+  rec.cards[1] = 0xff;
+  EXPECT_TRUE(from_record(rec));
+  rec.tag = static_cast<EventTag>(std::variant_size_v<Event>);
+  EXPECT_EQ(from_record(rec).error(), RecordError::bad_tag);
+  std::vector<EventRecord> records{to_record(HandStarted{}), rec};
+  EXPECT_FALSE(to_events(records));
+}
+
+TEST(EventRecord, RejectsPhasesPastShowdown) {
+  auto rec = to_record(PhaseAdvanced{Phase::showdown});
+  EXPECT_TRUE(from_record(rec));
+  rec.phase = static_cast<Phase>(std::to_underlying(Phase::showdown) + 1);
+  EXPECT_EQ(from_record(rec).error(), RecordError::bad_phase);
+}
@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+#include <map>
+#include <optional>
+#include <random>
+#include <vector>
+
+#include "fast_fold.h"
+#include "house_bot.h"
+
+using namespace poker;
+
+namespace {
+
+auto next_turn(const std::vector<Event> &events) -> std::optional<PlayerId> {
+  std::optional<PlayerId> turn;
+  for (const auto &ev : events) {
+    if (const auto *t = std::get_if<TurnAdvanced>(&ev)) {
+      turn = t->next;
+    }
+  }
+  return turn;
+}
+
+} // namespace
+
+TEST(FastFold, FoldersAreDealtStraightIntoANewHand) {
+  FastFoldPool pool(3);
+  for (PlayerId id = 1; id <= 7; ++id) {
+    ASSERT_TRUE(pool.join(id));
+  }
+  const auto first = pool.match();
+  ASSERT_EQ(first.size(), 2u);
+  EXPECT_EQ(pool.waiting(), 1u);
+  EXPECT_EQ(pool.live_hands(), 2u);
+
+  std::vector<PlayerId> folders;
+  for (const auto &dealt : first) {
+    const auto actor = next_turn(dealt.events);
+    ASSERT_TRUE(actor);
+    EXPECT_EQ(pool.players(dealt.hand).size(), 3u);
+    ASSERT_TRUE(pool.on_action(dealt.hand, Fold{*actor}));
+    EXPECT_FALSE(pool.hand_of(*actor));
+    EXPECT_EQ(pool.players(dealt.hand).size(), 2u);
+    EXPECT_TRUE(pool.live(dealt.hand));
+    folders.push_back(*actor);
+  }
+  // both hands play on, and the two folders plus the spare fill a third
+  EXPECT_EQ(pool.waiting(), 3u);
+  EXPECT_EQ(pool.live_hands(), 2u);
+  const auto second = pool.match();
+  ASSERT_EQ(second.size(), 1u);
+  EXPECT_EQ(pool.live_hands(), 3u);
+  EXPECT_EQ(pool.tables(), 3u);
+  for (const auto id : folders) {
+    EXPECT_EQ(pool.hand_of(id), second[0].hand);
+  }
+  EXPECT_TRUE(pool.seat_view(second[0].hand, folders[1]));
+}
+
+TEST(FastFold, TablesAreRecycledAndChipsKept) {
+  constexpr PlayerId kPlayers = 30;
+  FastFoldPool pool(6, 7);
+  for (PlayerId id = 1; id <= kPlayers; ++id) {
+    ASSERT_TRUE(pool.join(id));
+  }
+  std::mt19937_64 rolls(8);
+  std::map<HandId, PlayerId> turns; // whose turn it is in each live hand
+  auto track = [&](HandId hand, const std::vector<Event> &events) {
+    if (const auto turn = next_turn(events);
+        turn && pool.seat_view(hand, *turn)) {
+      turns[hand] = *turn;
+    }
+  };
+  std::size_t opened = 0; // tables that dealt their first hand
+  while (pool.hands_dealt() < 300) {
+    for (const auto &dealt : pool.match()) {
+      opened += dealt.opened.has_value();
+      EXPECT_EQ(dealt.stacks.size(), 6u);
+      EXPECT_TRUE(is_pool_table(FastFoldPool::table_of(dealt.hand)));
+      track(dealt.hand, dealt.events);
+    }
+    ASSERT_FALSE(turns.empty()) << "nobody left to deal to";
+    const auto [hand, actor] = *turns.begin();
+    turns.erase(turns.begin());
+    const auto view = pool.seat_view(hand, actor);
+    ASSERT_TRUE(view);
+    auto res = pool.on_action(hand, bot_action(actor, *view, rolls() % 100));
+    if (!res) {
+      res = pool.on_action(hand, Timeout{actor});
+    }
+    ASSERT_TRUE(res);
+    track(hand, *res);
+    for (const auto &d : pool.take_departures()) {
+      EXPECT_EQ(d.stack, 0u); // nobody has left yet
+    }
+  }
+  // a live hand holds at least two players, which bounds the tables built
+  EXPECT_LE(pool.tables(), kPlayers / 2);
+  EXPECT_EQ(opened, pool.tables());
+  EXPECT_EQ(pool.live_hands(), turns.size());
+
+  // finish what is running, then cash everyone out
+  while (!turns.empty()) {
+    const auto [hand, actor] = *turns.begin();
+    turns.erase(turns.begin());
+    auto res = pool.on_action(hand, Timeout{actor});
+    ASSERT_TRUE(res);
+    track(hand, *res);
+  }
+  EXPECT_EQ(pool.live_hands(), 0u);
+  Chips total = 0;
+  for (PlayerId id = 1; id <= kPlayers; ++id) {
+    (void)pool.leave(id);
+  }
+  for (const auto &d : pool.take_departures()) {
+    total += d.stack;
+  }
+  EXPECT_EQ(total, kPlayers * kBuyIn);
+  EXPECT_EQ(pool.waiting(), 0u);
+}
+
+TEST(FastFold, LeaversDepartWhenTheirHandLetsGo) {
+  FastFoldPool pool(2);
+  ASSERT_TRUE(pool.join(1, 500));
+  EXPECT_EQ(pool.join(1).error(), PlayerMgmtError::invalid_id);
+  ASSERT_TRUE(pool.leave(1));
+  EXPECT_EQ(pool.leave(1).error(), PlayerMgmtError::player_not_found);
+  auto gone = pool.take_departures();
+  ASSERT_EQ(gone.size(), 1u);
+  EXPECT_EQ(gone[0].who, 1u);
+  EXPECT_EQ(gone[0].stack, 500u);
+  EXPECT_TRUE(pool.match().empty()); // nobody is waiting
+
+  ASSERT_TRUE(pool.join(2));
+  ASSERT_TRUE(pool.join(3));
+  const auto dealt = pool.match();
+  ASSERT_EQ(dealt.size(), 1u);
+  ASSERT_TRUE(pool.leave(3));
+  EXPECT_TRUE(pool.take_departures().empty()); // still in the hand
+  const auto actor = next_turn(dealt[0].events);
+  ASSERT_TRUE(actor);
+  ASSERT_TRUE(pool.on_action(dealt[0].hand, Fold{*actor}));
+  EXPECT_EQ(pool.live_hands(), 0u);
+  EXPECT_FALSE(pool.live(dealt[0].hand));
+  EXPECT_TRUE(pool.players(dealt[0].hand).empty());
+  gone = pool.take_departures();
+  ASSERT_EQ(gone.size(), 1u);
+  EXPECT_EQ(gone[0].who, 3u);
+  EXPECT_EQ(pool.waiting(), 1u);
+  EXPECT_EQ(pool.on_action(dealt[0].hand, Fold{2}).error(),
+            GameError::invalid_action);
+}
@@ -0,0 +1,143 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "deck.h"
+#include "hand_audit.h"
+#include "scratch_file.h"
+
+using namespace poker;
+
+namespace {
+
+bool flagged(const AuditReport &report, Check check) {
+  return std::any_of(report.findings.begin(), report.findings.end(),
+                     [&](const Finding &f) { return f.check == check; });
+}
+
+auto first_event(TableLog &log, EventTag tag) -> EventRecord & {
+  return *std::find_if(log.events.begin(), log.events.end(),
+                       [&](const EventRecord &r) { return r.tag == tag; });
+}
+
+} // namespace
+
+TEST(HandAudit, SyntheticPlayAuditsClean) {
+  const auto log = play_table(1, 7, 6, 500);
+  const auto report = audit_table(log);
+  EXPECT_GT(report.hands, 400u);
+  for (const auto &f : report.findings) {
+    ADD_FAILURE() << "hand " << f.hand << ": " << to_string(f.check) << ": "
+                  << f.detail;
+  }
+}
+
+TEST(HandAudit, LogFileRoundTrips) {
+  const auto path = scratch_file("hand_audit.hlog");
+  std::vector<TableLog> logs{play_table(3, 1, 4, 50), play_table(4, 2, 9, 50)};
+  {
+    auto writer = HandLogWriter::open(path);
+    ASSERT_TRUE(writer);
+    // interleave the tables the way a server would
+    std::size_t off[2] = {0, 0};
+    for (std::size_t i = 0;
+         i < std::max(logs[0].inputs.size(), logs[1].inputs.size()); ++i) {
+      for (std::size_t t = 0; t < 2; ++t) {
+        if (i >= logs[t].inputs.size()) {
+          continue;
+        }
+        const auto &in = logs[t].inputs[i];
+        const auto events = to_events(
+            std::span(logs[t].events).subspan(off[t], in.events));
+        ASSERT_TRUE(events);
+        off[t] += in.events;
+        (*writer)->append(in, *events);
+      }
+    }
+  }
+
+  auto read = read_hand_log(path);
+  ASSERT_TRUE(read);
+  ASSERT_EQ(read->size(), 2u);
+  for (std::size_t t = 0; t < 2; ++t) {
+    const auto &got = (*read)[t];
+    EXPECT_EQ(got.table, logs[t].table);
+    EXPECT_EQ(got.seed, logs[t].seed);
+    ASSERT_EQ(got.inputs.size(), logs[t].inputs.size());
+    ASSERT_EQ(got.events.size(), logs[t].events.size());
+    EXPECT_TRUE(std::equal(
+        got.events.begin(), got.events.end(), logs[t].events.begin(),
+        [](const EventRecord &a, const EventRecord &b) {
+          return std::memcmp(&a, &b, sizeof(a)) == 0;
+        }));
+  }
+  EXPECT_TRUE(audit(*read, 2).findings.empty());
+  std::filesystem::remove(path);
+}
+
+TEST(HandAudit, FlagsCreatedChips) {
+  auto log = play_table(1, 7, 6, 20);
+  first_event(log, EventTag::won_pot).amount += 1;
+  const auto report = audit_table(log);
+  EXPECT_TRUE(flagged(report, Check::replay));
+  EXPECT_TRUE(flagged(report, Check::conservation));
+  EXPECT_TRUE(flagged(report, Check::settlement));
+  EXPECT_EQ(report.findings.front().hand, 1u);
+}
+
+TEST(HandAudit, FlagsPotPaidToTheWrongPlayer) {
+  auto log = play_table(1, 7, 6, 200);
+  // a showdown hand, paid to someone who is not its winner
+  auto shown = std::find_if(
+      log.events.begin(), log.events.end(),
+      [](const EventRecord &r) { return r.tag == EventTag::showdown_hand; });
+  ASSERT_NE(shown, log.events.end());
+  auto won = std::find_if(shown, log.events.end(), [](const EventRecord &r) {
+    return r.tag == EventTag::won_pot;
+  });
+  auto loser = std::find_if(shown, won, [&](const EventRecord &r) {
+    return r.tag == EventTag::showdown_hand && r.who != won->who;
+  });
+  ASSERT_NE(loser, won);
+  won->who = loser->who;
+  const auto report = audit_table(log);
+  EXPECT_TRUE(flagged(report, Check::settlement));
+  EXPECT_FALSE(flagged(report, Check::conservation));
+}
+
+TEST(HandAudit, ParallelAuditReportsPerTable) {
+  std::vector<TableLog> logs;
+  for (TableId t = 1; t <= 16; ++t) {
+    logs.push_back(play_table(t, t, 6, 30));
+  }
+  first_event(logs[9], EventTag::bet_placed).amount += 5;
+  const auto serial = audit(logs, 1);
+  const auto parallel = audit(logs, 4);
+  EXPECT_EQ(parallel.tables, 16u);
+  EXPECT_EQ(parallel.hands, serial.hands);
+  ASSERT_FALSE(parallel.findings.empty());
+  ASSERT_EQ(parallel.findings.size(), serial.findings.size());
+  for (const auto &f : parallel.findings) {
+    EXPECT_EQ(f.table, 10u);
+  }
+}
+
+TEST(HandAudit, MalformedLogIsRejected) {
+  std::string bytes(kHandLogMagic);
+  bytes += std::string(sizeof(InputRecord) - 1, '\0');
+  EXPECT_EQ(parse_hand_log(bytes).error(), AuditError::bad_format);
+  EXPECT_EQ(parse_hand_log("garbage").error(), AuditError::bad_format);
+
+  // a card id past the deck would index off the end of the card map
+  bytes = kHandLogMagic;
+  const std::vector<Event> dealt{DealtStreet{cards::from_card_id(0)}};
+  append_input(bytes, {.tag = InputTag::new_hand, .events = 1}, dealt);
+  ASSERT_TRUE(parse_hand_log(bytes));
+  bytes[bytes.size() - sizeof(EventRecord) + offsetof(EventRecord, cards)] =
+      static_cast<char>(kDeckSize);
+  EXPECT_EQ(parse_hand_log(bytes).error(), AuditError::bad_format);
+}
@@ -0,0 +1,254 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <random>
+#include <unistd.h>
+#include <vector>
+
+#include "column_store.h"
+#include "hand_history.h"
+#include "table.h"
+
+using namespace poker;
+
+namespace {
+
+// A scratch directory removed with the fixture.
+class StoreTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    root_ = std::filesystem::temp_directory_path() / "hh_tests" /
+            std::to_string(getpid()) /
+            ::testing::UnitTest::GetInstance()->current_test_info()->name();
+    std::filesystem::remove_all(root_);
+    std::filesystem::create_directories(root_);
+  }
+  void TearDown() override {
+    std::filesystem::remove_all(root_.parent_path());
+  }
+
+  std::filesystem::path root_;
+};
+
+auto record(HandRecorder &rec, TableId id,
+            const std::expected<std::vector<Event>, Error> &events) -> void {
+  ASSERT_TRUE(events.has_value());
+  for (const auto &ev : *events) {
+    rec.observe(id, ev);
+  }
+}
+
+auto row_of(const std::vector<HandRow> &rows, PlayerId who) -> HandRow {
+  auto it = std::find_if(rows.begin(), rows.end(),
+                         [&](const HandRow &r) { return r.player == who; });
+  EXPECT_NE(it, rows.end());
+  return it == rows.end() ? HandRow{} : *it;
+}
+
+} // namespace
+
+TEST(HandRecorder, BlindsAreNotVoluntary) {
+  std::mt19937_64 rng(0);
+  Table table(rng);
+  ASSERT_TRUE(table.add_player(1));
+  ASSERT_TRUE(table.add_player(2));
+
+  std::vector<HandRow> rows;
+  HandRecorder rec([&](std::span<const HandRow> r) {
+    rows.assign(r.begin(), r.end());
+  });
+  record(rec, 1, table.handle_new_hand());
+  record(rec, 1, table.on_action(Fold{1}));
+  ASSERT_FALSE(table.hand_in_progress());
+  rec.finish(1);
+
+  ASSERT_EQ(rows.size(), 2u);
+  EXPECT_EQ(rows[0].hand_id, rows[1].hand_id);
+  const auto sb = row_of(rows, 1);
+  const auto bb = row_of(rows, 2);
+  EXPECT_EQ(sb.invested, kSmallBlind);
+  EXPECT_EQ(sb.won, 0u);
+  EXPECT_EQ(sb.flags, 0u);
+  EXPECT_EQ(bb.invested, kBigBlind);
+  EXPECT_EQ(bb.won, kSmallBlind + kBigBlind);
+  EXPECT_EQ(bb.flags, 0u);
+}
+
+TEST(HandRecorder, RaiseAndCallReachShowdown) {
+  std::mt19937_64 rng(0);
+  Table table(rng);
+  ASSERT_TRUE(table.add_player(1));
+  ASSERT_TRUE(table.add_player(2));
+
+  std::vector<HandRow> rows;
+  HandRecorder rec([&](std::span<const HandRow> r) {
+    rows.assign(r.begin(), r.end());
+  });
+  record(rec, 1, table.handle_new_hand());
+  record(rec, 1, table.on_action(Bet{1, kBuyIn}));
+  record(rec, 1, table.on_action(Bet{2, kBuyIn}));
+  ASSERT_FALSE(table.hand_in_progress());
+  rec.finish(1);
+
+  ASSERT_EQ(rows.size(), 2u);
+  const auto shove = row_of(rows, 1);
+  const auto call = row_of(rows, 2);
+  EXPECT_EQ(shove.flags, kVpip | kPfr | kShowdown);
+  EXPECT_EQ(call.flags, kVpip | kShowdown);
+  EXPECT_EQ(shove.aggressive, 1u);
+  EXPECT_EQ(shove.passive, 0u);
+  EXPECT_EQ(call.aggressive, 0u);
+  EXPECT_EQ(call.passive, 1u);
+  EXPECT_EQ(shove.invested, kBuyIn);
+  EXPECT_EQ(call.invested, kBuyIn);
+  EXPECT_EQ(shove.won + call.won, kBuyIn * 2);
+}
+
+TEST(HandRecorder, IgnoresTablesWithoutAnOpenHand) {
+  int calls = 0;
+  HandRecorder rec([&](std::span<const HandRow>) { ++calls; });
+  rec.observe(7, BetPlaced{1, 10});
+  rec.finish(7);
+  EXPECT_EQ(calls, 0);
+}
+
+TEST_F(StoreTest, PartRoundTripsEveryColumn) {
+  // enough rows for a partial last block, with values that need the full
+  // 64 bits, none at all (constant), and widths that straddle words
+  std::mt19937_64 rng(3);
+  std::vector<HandRow> rows;
+  for (uint64_t i = 0; i < 2 * hhstore::kBlockRows + 17; ++i) {
+    rows.push_back(HandRow{i, 1'700'000'000'000 + i * 7, 42, rng() % 1000,
+                           rng() % 5000, i % 3 == 0 ? UINT64_MAX : 0,
+                           static_cast<uint8_t>(i % 8),
+                           static_cast<uint8_t>(i % 5), 0});
+  }
+  const auto path = root_ / "part.hhc";
+  ASSERT_TRUE(hhstore::write_part(path, rows));
+
+  auto part = hhstore::PartFile::open(path);
+  ASSERT_TRUE(part.has_value());
+  EXPECT_EQ(part->rows(), rows.size());
+  EXPECT_EQ(part->blocks(), 3u);
+  EXPECT_EQ(part->min_started_ms(), rows.front().started_ms);
+  EXPECT_EQ(part->max_started_ms(), rows.back().started_ms);
+
+  std::array<uint64_t, hhstore::kBlockRows> out{};
+  for (std::size_t b = 0; b < part->blocks(); ++b) {
+    const auto first = b * hhstore::kBlockRows;
+    auto check = [&](hhstore::Column col, auto field) {
+      const auto n = part->decode(col, b, out);
+      ASSERT_EQ(n, std::min(hhstore::kBlockRows, rows.size() - first));
+      for (std::size_t i = 0; i < n; ++i) {
+        ASSERT_EQ(out[i], field(rows[first + i])) << "row " << first + i;
+      }
+    };
+    check(hhstore::Column::hand_id, [](auto &r) { return r.hand_id; });
+    check(hhstore::Column::started_ms, [](auto &r) { return r.started_ms; });
+    check(hhstore::Column::table, [](auto &r) { return r.table; });
+    check(hhstore::Column::player, [](auto &r) { return r.player; });
+    check(hhstore::Column::invested, [](auto &r) { return r.invested; });
+    check(hhstore::Column::won, [](auto &r) { return r.won; });
+    check(hhstore::Column::flags,
+          [](auto &r) { return static_cast<uint64_t>(r.flags); });
+    check(hhstore::Column::aggressive,
+          [](auto &r) { return static_cast<uint64_t>(r.aggressive); });
+    check(hhstore::Column::passive,
+          [](auto &r) { return static_cast<uint64_t>(r.passive); });
+  }
+}
+
+TEST_F(StoreTest, RejectsTruncatedPart) {
+  std::vector<HandRow> rows(100, HandRow{1, 2, 3, 4, 5, 6, 0, 0, 0});
+  const auto path = root_ / "part.hhc";
+  ASSERT_TRUE(hhstore::write_part(path, rows));
+  std::filesystem::resize_file(path, std::filesystem::file_size(path) - 8);
+
+  auto part = hhstore::PartFile::open(path);
+  ASSERT_FALSE(part.has_value());
+  EXPECT_EQ(part.error(), hhstore::StoreError::bad_format);
+}
+
+TEST_F(StoreTest, PlayerResultsMatchNaiveSum) {
+  std::mt19937_64 rng(9);
+  std::vector<HandRow> rows;
+  for (uint64_t i = 0; i < 20'000; ++i) {
+    rows.push_back(HandRow{i / 6, 1'700'000'000'000, i % 50, 1 + rng() % 300,
+                           rng() % 400, rng() % 800,
+                           static_cast<uint8_t>(rng() % 8), 0, 0});
+  }
+  // several parts so the workers share the scan
+  for (std::size_t p = 0; p < 4; ++p) {
+    const auto n = rows.size() / 4;
+    ASSERT_TRUE(hhstore::write_part(
+        root_ / (std::to_string(p) + ".hhc"),
+        std::span<const HandRow>(rows).subspan(p * n, n)));
+  }
+  std::vector<std::filesystem::path> parts;
+  for (std::size_t p = 0; p < 4; ++p) {
+    parts.push_back(root_ / (std::to_string(p) + ".hhc"));
+  }
+
+  for (const uint8_t req : {uint8_t{0}, uint8_t{kShowdown}}) {
+    std::map<PlayerId, std::pair<uint64_t, int64_t>> want;
+    for (const auto &r : rows) {
+      if ((r.flags & req) == req) {
+        want[r.player].first += 1;
+        want[r.player].second += static_cast<int64_t>(r.won) -
+                                 static_cast<int64_t>(r.invested);
+      }
+    }
+    auto got = hhstore::player_results(parts, req, 4);
+    ASSERT_TRUE(got.has_value());
+    ASSERT_EQ(got->size(), want.size());
+    for (const auto &res : *got) {
+      EXPECT_EQ(res.hands, want[res.player].first);
+      EXPECT_EQ(res.net, want[res.player].second);
+    }
+  }
+}
+
+// A corrupt or hostile part can name any id; it must not size an array.
+TEST_F(StoreTest, PlayerResultsTakeHugeIds) {
+  const uint64_t huge = UINT64_MAX - 1;
+  const std::vector<HandRow> rows{
+      HandRow{1, 2, 3, huge, 10, 0, 0, 0, 0},
+      HandRow{2, 2, 3, 7, 0, 30, 0, 0, 0},
+      HandRow{3, 2, 3, uint64_t{1} << 40, 0, 5, 0, 0, 0},
+      HandRow{4, 2, 3, huge, 0, 4, 0, 0, 0}};
+  const auto path = root_ / "part.hhc";
+  ASSERT_TRUE(hhstore::write_part(path, rows));
+  const auto got = hhstore::player_results(std::span(&path, 1), 0, 2);
+  ASSERT_TRUE(got.has_value());
+  ASSERT_EQ(got->size(), 3u);
+  EXPECT_EQ((*got)[0].player, 7u);
+  EXPECT_EQ((*got)[1].player, uint64_t{1} << 40);
+  EXPECT_EQ((*got)[2].player, huge);
+  EXPECT_EQ((*got)[2].hands, 2u);
+  EXPECT_EQ((*got)[2].net, -6);
+}
+
+TEST_F(StoreTest, WriterPartitionsByHour) {
+  const uint64_t hour = 1'700'000'000'000 / 3'600'000 * 3'600'000;
+  {
+    hhstore::Writer writer(root_, 4);
+    for (uint64_t i = 0; i < 10; ++i) {
+      // alternate between two hours within one batch
+      const HandRow row{i, hour + (i % 2) * 3'600'000 + i, 1, i, 10, 0, 0,
+                        0, 0};
+      writer.append({&row, 1});
+    }
+  }
+  EXPECT_EQ(hhstore::list_parts(root_).size(), 6u);
+
+  auto first = hhstore::list_parts(root_, hour, hour + 3'599'999);
+  auto res = hhstore::player_results(first);
+  ASSERT_TRUE(res.has_value());
+  ASSERT_EQ(res->size(), 5u);
+  for (const auto &r : *res) {
+    EXPECT_EQ(r.player % 2, 0u);
+    EXPECT_EQ(r.net, -10);
+  }
+}
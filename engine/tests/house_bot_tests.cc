@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <set>
+#include <variant>
+#include <vector>
+
+#include "deck.h"
+#include "hand_class.h"
+#include "house_bot.h"
+#include "table.h"
+
+using namespace poker;
+
+namespace {
+
+auto card(cards::Rank r, cards::Suit s) -> cards::Card { return {r, s}; }
+
+auto turn_of(const std::vector<Event> &events) -> std::optional<PlayerId> {
+  std::optional<PlayerId> next;
+  for (const auto &event : events) {
+    if (auto turn = std::get_if<TurnAdvanced>(&event)) {
+      next = turn->next;
+    }
+  }
+  return next;
+}
+
+} // namespace
+
+TEST(HandClass, CoversAllStartingHands) {
+  std::set<uint8_t> classes;
+  for (std::size_t i = 0; i < kDeckSize; ++i) {
+    for (std::size_t j = i + 1; j < kDeckSize; ++j) {
+      auto cls = hand_class(cards::kCardIdMap[i], cards::kCardIdMap[j]);
+      ASSERT_LT(cls, kHandClasses);
+      EXPECT_EQ(cls, hand_class(cards::kCardIdMap[j], cards::kCardIdMap[i]));
+      classes.insert(cls);
+    }
+  }
+  EXPECT_EQ(classes.size(), kHandClasses);
+}
+
+TEST(HouseBot, PreflopScoreOrdering) {
+  using cards::Rank;
+  using cards::Suit;
+  auto score = [](cards::Card a, cards::Card b) {
+    return kPreflopScore[hand_class(a, b)];
+  };
+  auto aces =
+      score(card(Rank::Ace, Suit::Spades), card(Rank::Ace, Suit::Hearts));
+  auto aks =
+      score(card(Rank::Ace, Suit::Spades), card(Rank::King, Suit::Spades));
+  auto ako =
+      score(card(Rank::Ace, Suit::Spades), card(Rank::King, Suit::Hearts));
+  auto seven_deuce =
+      score(card(Rank::Seven, Suit::Spades), card(Rank::Two, Suit::Hearts));
+  EXPECT_EQ(aces, 40);
+  EXPECT_EQ(aks, ako + 4);
+  EXPECT_EQ(seven_deuce, -3);
+  for (auto s : kPreflopScore) {
+    EXPECT_LE(s, aces);
+    EXPECT_GE(s, seven_deuce);
+  }
+}
+
+TEST(HouseBot, ActionFollowsStrengthAndPrice) {
+  using cards::Rank;
+  using cards::Suit;
+  SeatView aces{Phase::preflop, kSmallBlind, kBigBlind, kBuyIn,
+                {card(Rank::Ace, Suit::Spades), card(Rank::Ace, Suit::Hearts)}};
+  auto raise = bot_action(1, aces, 99);
+  ASSERT_TRUE(std::holds_alternative<Bet>(raise));
+  EXPECT_EQ(std::get<Bet>(raise).amount, kSmallBlind + kBigBlind);
+
+  SeatView trash{
+      Phase::preflop, kBigBlind, kBigBlind, kBuyIn,
+      {card(Rank::Seven, Suit::Spades), card(Rank::Two, Suit::Hearts)}};
+  EXPECT_TRUE(std::holds_alternative<Fold>(bot_action(1, trash, 99)));
+
+  trash.to_call = 0;
+  auto check = bot_action(1, trash, 99);
+  ASSERT_TRUE(std::holds_alternative<Bet>(check));
+  EXPECT_EQ(std::get<Bet>(check).amount, 0u);
+}
+
+TEST(HouseBot, BotsPlayLegalHands) {
+  std::mt19937_64 rng(7);
+  Table table(rng);
+  HouseBots bots(7);
+  for (PlayerId id : {1, 2, 3}) {
+    ASSERT_TRUE(table.add_player(id));
+    bots.add(id, 1);
+  }
+  for (int hand = 0; hand < 50 && table.can_start_hand(); ++hand) {
+    auto start = table.handle_new_hand();
+    ASSERT_TRUE(start.has_value());
+    auto next = turn_of(*start);
+    while (table.hand_in_progress() && next) {
+      auto turn = bots.on_turn(1, *next);
+      ASSERT_TRUE(bots.is_current(turn));
+      auto res = table.on_action(bots.decide(turn, table));
+      ASSERT_TRUE(res.has_value()) << to_string(res.error());
+      next = turn_of(*res);
+    }
+    EXPECT_FALSE(table.hand_in_progress());
+  }
+}
+
+TEST(HouseBot, NewTurnMakesOldOneStale) {
+  HouseBots bots(0);
+  bots.add(5, 1);
+  auto first = bots.on_turn(1, 5);
+  auto second = bots.on_turn(1, 5);
+  EXPECT_FALSE(bots.is_current(first));
+  EXPECT_TRUE(bots.is_current(second));
+  EXPECT_GE(second.delay.count(), 600);
+  bots.remove(5);
+  EXPECT_FALSE(bots.is_current(second));
+}
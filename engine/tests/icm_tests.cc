@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+#include "icm.h"
+
+using namespace poker;
+
+namespace {
+
+// Every finishing order, weighted the Malmuth-Harville way.
+auto by_permutation(const std::vector<Chips> &stacks,
+                    const std::vector<double> &payouts) -> std::vector<double> {
+  std::vector<std::size_t> order(stacks.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::vector<double> out(stacks.size(), 0.0);
+  do {
+    double left = static_cast<double>(
+        std::accumulate(stacks.begin(), stacks.end(), Chips{0}));
+    double p = 1.0;
+    for (const auto i : order) {
+      p *= static_cast<double>(stacks[i]) / left;
+      left -= static_cast<double>(stacks[i]);
+    }
+    for (std::size_t place = 0; place < payouts.size(); ++place) {
+      out[order[place]] += p * payouts[place];
+    }
+  } while (std::next_permutation(order.begin(), order.end()));
+  return out;
+}
+
+} // namespace
+
+TEST(Icm, HeadsUpIsLinearInChips) {
+  const std::vector<Chips> stacks{3000, 1000};
+  const std::vector<double> payouts{70, 30};
+  const auto eq = icm_exact(stacks, payouts);
+  ASSERT_TRUE(eq);
+  EXPECT_DOUBLE_EQ((*eq)[0], 30 + 40 * 0.75);
+  EXPECT_DOUBLE_EQ((*eq)[1], 30 + 40 * 0.25);
+}
+
+TEST(Icm, ExactMatchesEveryOrder) {
+  const std::vector<Chips> stacks{5200, 800, 3100, 1500, 2400, 400, 900};
+  for (const auto &payouts : {std::vector<double>{50, 30, 20},
+                              std::vector<double>{40, 25, 15, 10, 6, 4, 0}}) {
+    const auto eq = icm_exact(stacks, payouts);
+    ASSERT_TRUE(eq);
+    const auto want = by_permutation(stacks, payouts);
+    for (std::size_t i = 0; i < stacks.size(); ++i) {
+      EXPECT_NEAR((*eq)[i], want[i], 1e-9) << i;
+    }
+    EXPECT_NEAR(std::accumulate(eq->begin(), eq->end(), 0.0),
+                std::accumulate(payouts.begin(), payouts.end(), 0.0), 1e-9);
+  }
+}
+
+TEST(Icm, ShortPayoutsOverAFullField) {
+  std::vector<Chips> stacks(kIcmExactMax, 1000);
+  stacks[0] = 5000;
+  stacks[1] = 5000;
+  const std::vector<double> payouts{50, 30, 20};
+  const auto eq = icm_exact(stacks, payouts);
+  ASSERT_TRUE(eq);
+  EXPECT_NEAR(std::accumulate(eq->begin(), eq->end(), 0.0), 100, 1e-9);
+  EXPECT_NEAR((*eq)[0], (*eq)[1], 1e-12);
+  EXPECT_GT((*eq)[0], (*eq)[2]);
+  for (std::size_t i = 3; i < stacks.size(); ++i) {
+    EXPECT_NEAR((*eq)[i], (*eq)[2], 1e-12) << i;
+  }
+  const auto mc = icm_monte_carlo(stacks, payouts, 100'000, 5);
+  ASSERT_TRUE(mc);
+  for (std::size_t i = 0; i < stacks.size(); ++i) {
+    EXPECT_NEAR((*mc)[i], (*eq)[i], 0.5) << i;
+  }
+}
+
+TEST(Icm, MonteCarloAgreesWithExact) {
+  const std::vector<Chips> stacks{9000, 7000, 6000, 4000, 3000,
+                                  2500, 2000, 1500, 1000, 500};
+  const std::vector<double> payouts{30, 20, 14, 10, 8, 6, 5, 4, 3};
+  const auto exact = icm_exact(stacks, payouts);
+  const auto mc = icm_monte_carlo(stacks, payouts, 100'000, 7);
+  ASSERT_TRUE(exact && mc);
+  for (std::size_t i = 0; i < stacks.size(); ++i) {
+    // well over four standard errors
+    EXPECT_NEAR((*mc)[i], (*exact)[i], 0.25) << i;
+  }
+}
+
+TEST(Icm, BustedPlayersShareTheBottomPlaces) {
+  const std::vector<Chips> stacks{0, 2000, 0, 2000};
+  const std::vector<double> payouts{50, 30, 12, 8};
+  const auto eq = icm_exact(stacks, payouts);
+  ASSERT_TRUE(eq);
+  EXPECT_DOUBLE_EQ((*eq)[0], 10);
+  EXPECT_DOUBLE_EQ((*eq)[2], 10);
+  EXPECT_DOUBLE_EQ((*eq)[1], 40);
+}
+
+TEST(Icm, BadInputsAreRefused) {
+  const std::vector<double> payouts{60, 40};
+  EXPECT_EQ(icm_exact(std::vector<Chips>{0, 0}, payouts).error(),
+            IcmError::no_chips);
+  EXPECT_EQ(icm_exact(std::vector<Chips>{10, 10}, std::vector{60.0, -1.0})
+                .error(),
+            IcmError::bad_payouts);
+  const std::vector<Chips> big(kIcmExactMax + 1, 100);
+  EXPECT_EQ(icm_exact(big, payouts).error(), IcmError::too_many_players);
+  // icm_equities falls back to sampling
+  const auto eq = icm_equities(big, payouts, {.trials = 20'000, .seed = 3});
+  ASSERT_TRUE(eq);
+  EXPECT_NEAR(std::accumulate(eq->begin(), eq->end(), 0.0), 100, 1e-9);
+}
@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <map>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "leaderboard.h"
+
+using namespace poker;
+
+namespace {
+
+auto row(PlayerId who, Chips invested, Chips won) -> HandRow {
+  return HandRow{1, 0, 1, who, invested, won, 0, 0, 0};
+}
+
+} // namespace
+
+TEST(RankTree, MatchesASortUnderRandomUpdates) {
+  RankTree tree;
+  std::map<PlayerId, int64_t> scores;
+  std::mt19937_64 rolls(11);
+  for (int step = 0; step < 4000; ++step) {
+    const PlayerId id = 1 + rolls() % 300;
+    const auto score = static_cast<int64_t>(rolls() % 200) - 100;
+    tree.set(id, score);
+    scores[id] = score;
+
+    if (step % 500 != 0) {
+      continue;
+    }
+    std::vector<std::pair<int64_t, PlayerId>> order;
+    for (const auto &[who, s] : scores) {
+      order.emplace_back(-s, who);
+    }
+    std::ranges::sort(order);
+    ASSERT_EQ(tree.size(), order.size());
+    for (std::size_t i = 0; i < order.size(); ++i) {
+      const auto [neg, who] = order[i];
+      EXPECT_EQ(tree.rank(who), i + 1);
+      const auto entry = tree.at(i + 1);
+      ASSERT_TRUE(entry);
+      EXPECT_EQ(entry->player, who);
+      EXPECT_EQ(entry->score, -neg);
+    }
+  }
+  EXPECT_FALSE(tree.at(0));
+  EXPECT_FALSE(tree.at(tree.size() + 1));
+  EXPECT_FALSE(tree.rank(301));
+  EXPECT_FALSE(tree.score(100000));
+
+  // ids need not be dense
+  const PlayerId far = PlayerId{1} << 60;
+  tree.set(far, 1000);
+  EXPECT_EQ(tree.rank(far), 1u);
+  EXPECT_EQ(tree.score(far), 1000);
+}
+
+TEST(Leaderboard, RanksAndPagesFollowRecordedHands) {
+  Leaderboard board;
+  EXPECT_FALSE(board.rank(Board::net_winnings, 1));
+  EXPECT_EQ(board.page(Board::hands, 0), nullptr);
+
+  board.record(std::vector{row(1, 100, 0), row(2, 100, 200)});
+  board.record(std::vector{row(1, 50, 0), row(3, 10, 60)});
+  board.sync();
+  EXPECT_EQ(board.score(Board::net_winnings, 1), -150);
+  EXPECT_EQ(board.score(Board::net_winnings, 2), 100);
+  EXPECT_EQ(board.rank(Board::net_winnings, 2), 1u);
+  EXPECT_EQ(board.rank(Board::net_winnings, 3), 2u);
+  EXPECT_EQ(board.rank(Board::net_winnings, 1), 3u);
+  EXPECT_EQ(board.score(Board::hands, 1), 2);
+  EXPECT_EQ(board.rank(Board::hands, 1), 1u);
+  EXPECT_EQ(board.rank(Board::hands, 3), 3u); // ties go to the lower id
+
+  const auto top = board.page(Board::net_winnings, 0);
+  ASSERT_NE(top, nullptr);
+  EXPECT_EQ(top->players, 3u);
+  ASSERT_EQ(top->entries.size(), 3u);
+  EXPECT_EQ(top->entries[0].player, 2u);
+  EXPECT_EQ(top->entries[2].rank, 3u);
+  EXPECT_EQ(top->entries[2].score, -150);
+
+  std::vector<HandRow> many;
+  for (PlayerId id = 10; id < 10 + kLeaderPageSize * 2; ++id) {
+    many.push_back(row(id, 0, id));
+  }
+  board.record(many);
+  board.sync();
+  const auto second = board.page(Board::net_winnings, 1);
+  ASSERT_NE(second, nullptr);
+  EXPECT_EQ(second->players, kLeaderPageSize * 2 + 3);
+  ASSERT_EQ(second->entries.size(), kLeaderPageSize);
+  EXPECT_EQ(second->entries[0].rank, kLeaderPageSize + 1);
+  EXPECT_EQ(board.page(Board::net_winnings, kCachedPages), nullptr);
+}
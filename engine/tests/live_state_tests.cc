@@ -0,0 +1,161 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "house_bot.h"
+#include "live_state.h"
+#include "scratch_file.h"
+#include "server.h"
+
+namespace {
+
+auto seat(const live::TableSummary &s, poker::PlayerId who)
+    -> const live::Seat * {
+  for (std::size_t i = 0; i < s.seated; ++i) {
+    if (s.seats[i].who == who) {
+      return &s.seats[i];
+    }
+  }
+  return nullptr;
+}
+
+} // namespace
+
+TEST(LiveState, SummaryFollowsTable) {
+  std::mt19937_64 rng(3);
+  std::mt19937_64 rolls(4);
+  poker::Table t(rng);
+  live::TableSummary s{.table = 1};
+  auto fold = [&](const std::vector<poker::Event> &events) {
+    for (const auto &ev : events) {
+      live::apply(s, ev);
+    }
+  };
+  for (poker::PlayerId id = 1; id <= 4; ++id) {
+    live::apply(s, *t.add_player(id));
+  }
+  for (int hand = 1; hand <= 200 && t.can_start_hand(); ++hand) {
+    fold(*t.handle_new_hand());
+    EXPECT_EQ(s.hands, static_cast<uint64_t>(hand));
+    while (t.hand_in_progress()) {
+      const auto view = t.seat_view(s.actor);
+      ASSERT_TRUE(view) << "actor " << s.actor << " is not seated";
+      ASSERT_EQ(seat(s, s.actor)->stack, view->chips);
+      auto res =
+          t.on_action(poker::bot_action(s.actor, *view, rolls() % 100));
+      if (!res) {
+        res = t.on_action(poker::Timeout{s.actor});
+      }
+      ASSERT_TRUE(res);
+      fold(*res);
+    }
+    EXPECT_EQ(s.pot, 0u);
+    EXPECT_EQ(s.actor, 0u);
+    EXPECT_EQ(s.phase, poker::Phase::holding);
+    Chips total = 0;
+    for (std::size_t i = 0; i < s.seated; ++i) {
+      total += s.seats[i].stack;
+    }
+    EXPECT_EQ(total, 4 * kBuyIn);
+  }
+  fold(*t.remove_player(2));
+  EXPECT_EQ(s.seated, 3);
+  EXPECT_EQ(seat(s, 2), nullptr);
+  EXPECT_NE(seat(s, 4), nullptr);
+}
+
+TEST(LiveState, ServerPublishesEveryTable) {
+  const auto path = scratch_file("live_server.state");
+  Server server(epoll_create1(0), socket(AF_INET, SOCK_STREAM, 0));
+  ASSERT_TRUE(server.enable_live_state(path));
+  std::vector<int> peers;
+  auto connect = [&] {
+    int sv[2];
+    EXPECT_EQ(socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, sv), 0);
+    peers.push_back(sv[1]);
+    return server.handle_connect(sv[0]);
+  };
+  const auto first = connect();
+  const auto second = connect();
+  ASSERT_TRUE(first.result && second.result);
+  const auto table = first.result->table;
+  ASSERT_TRUE(server.maybe_start_hand(table));
+
+  auto reader = live::Reader::open(path);
+  ASSERT_TRUE(reader);
+  const auto tables = reader->snapshot();
+  ASSERT_EQ(tables.size(), 1u);
+  const auto &s = tables[0];
+  EXPECT_EQ(s.table, table);
+  EXPECT_EQ(s.hands, 1u);
+  EXPECT_EQ(s.phase, poker::Phase::preflop);
+  EXPECT_EQ(s.seated, 2);
+  EXPECT_EQ(s.pot, kSmallBlind + kBigBlind);
+  EXPECT_NE(s.actor, 0u);
+  EXPECT_NE(seat(s, first.conn->player_id), nullptr);
+  EXPECT_NE(seat(s, second.conn->player_id), nullptr);
+  for (int fd : peers) {
+    close(fd);
+  }
+  std::filesystem::remove(path);
+}
+
+TEST(LiveState, ReadsAreNeverTorn) {
+  const auto path = scratch_file("live_torn.state");
+  auto publisher = live::Publisher::open(path, 4);
+  ASSERT_TRUE(publisher);
+  std::vector<poker::Event> seated;
+  for (poker::PlayerId id = 1; id <= kMaxPlayers; ++id) {
+    seated.push_back(poker::PlayerAdded{id});
+  }
+  (*publisher)->apply(7, seated);
+  auto reader = live::Reader::open(path);
+  ASSERT_TRUE(reader);
+
+  // every update moves all ten stacks together; a torn copy would mix them
+  std::atomic<bool> done{false};
+  std::thread writer([&] {
+    std::vector<poker::Event> events;
+    for (Chips round = 1; round <= 20'000; ++round) {
+      events.clear();
+      for (poker::PlayerId id = 1; id <= kMaxPlayers; ++id) {
+        events.push_back(poker::PlayerChips{id, round});
+      }
+      (*publisher)->apply(7, events);
+    }
+    done = true;
+  });
+  uint64_t reads = 0;
+  uint64_t torn = 0;
+  live::TableSummary s;
+  while (!done || reads == 0) {
+    reader->read(0, s);
+    for (std::size_t i = 1; i < s.seated; ++i) {
+      torn += s.seats[i].stack != s.seats[0].stack;
+    }
+    ++reads;
+  }
+  writer.join();
+  EXPECT_EQ(torn, 0u) << "over " << reads << " reads";
+  ASSERT_TRUE(reader->read(0, s));
+  EXPECT_EQ(s.seats[0].stack, 20'000u);
+  EXPECT_FALSE(reader->read(1, s));
+  std::filesystem::remove(path);
+}
+
+TEST(LiveState, ForeignFilesAreRejected) {
+  EXPECT_EQ(live::Reader::open("/nonexistent/live.state").error(),
+            live::LiveError::io);
+  const auto path = scratch_file("live_bad.state");
+  std::ofstream(path) << std::string(4096, 'x');
+  EXPECT_EQ(live::Reader::open(path).error(), live::LiveError::bad_format);
+  std::filesystem::remove(path);
+}
@@ -0,0 +1,63 @@
+#include <gtest/gtest.h>
+#include <chrono>
+
+#include "load_shed.h"
+
+using namespace load;
+using namespace std::chrono_literals;
+
+namespace {
+
+// Feeds `ticks` ticks of `lag`, one millisecond apart, from `now`.
+bool feed(Governor &g, Clock::time_point &now, Clock::duration lag,
+          int ticks) {
+  bool changed = false;
+  for (int i = 0; i < ticks; ++i) {
+    now += 1ms;
+    changed |= g.observe(now, lag);
+  }
+  return changed;
+}
+
+} // namespace
+
+TEST(LoadShed, DegradesWithLagAndRecoversAStepAtATime) {
+  Governor g(Slo{.shed_at = 20ms, .close_at = 50ms, .min_dwell = 100ms});
+  Clock::time_point now{};
+  EXPECT_FALSE(feed(g, now, 5ms, 50));
+  EXPECT_EQ(g.mode(), Mode::normal);
+
+  // one slow tick is smoothed away
+  EXPECT_FALSE(g.observe(now += 1ms, 100ms));
+  EXPECT_EQ(g.mode(), Mode::normal);
+  EXPECT_EQ(g.metrics().max_lag, 100ms);
+
+  EXPECT_TRUE(feed(g, now, 30ms, 50));
+  EXPECT_EQ(g.mode(), Mode::shedding);
+  feed(g, now, 200ms, 50);
+  EXPECT_EQ(g.mode(), Mode::closed);
+
+  // under half the closing threshold, but not for long enough yet
+  feed(g, now, 0ms, 40);
+  EXPECT_EQ(g.mode(), Mode::closed);
+  feed(g, now, 0ms, 100);
+  EXPECT_EQ(g.mode(), Mode::shedding);
+  feed(g, now, 0ms, 100);
+  EXPECT_EQ(g.mode(), Mode::normal);
+
+  const auto &m = g.metrics();
+  EXPECT_EQ(m.entered[1], 2u);
+  EXPECT_EQ(m.entered[2], 1u);
+  EXPECT_GE(m.time_in[2], 100ms);
+}
+
+TEST(LoadShed, HoversBetweenThresholdsWithoutFlapping) {
+  Governor g(Slo{.shed_at = 20ms, .close_at = 50ms, .min_dwell = 0ms});
+  Clock::time_point now{};
+  feed(g, now, 25ms, 100);
+  ASSERT_EQ(g.mode(), Mode::shedding);
+  // back under the threshold, but not under half of it
+  EXPECT_FALSE(feed(g, now, 15ms, 200));
+  EXPECT_EQ(g.mode(), Mode::shedding);
+  EXPECT_EQ(g.metrics().entered[1], 1u);
+}
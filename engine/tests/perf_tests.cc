@@ -0,0 +1,355 @@
+// Performance smoke tests. Each runs a fixed workload and compares what it
+// measured with perf_baseline.txt, failing when a metric is worse than its
+// baseline by more than the metric's tolerance band. They carry the `perf`
+// label: `ctest -L perf` runs only these, `ctest -LE perf` skips them.
+//
+// Allocation counts are checked in every build. Timings are only checked
+// in optimized builds, against numbers taken on the reference machine; set
+// POKER_PERF_RECORD=<file> to write this machine's measurements in baseline
+// format when the baseline needs refreshing.
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <map>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+#include <spdlog/spdlog.h>
+
+#include "actions.pb.h"
+#include "house_bot.h"
+#include "reactor.h"
+#include "response.pb.h"
+#include "server.h"
+#include "server_loop.h"
+#include "table.h"
+
+namespace {
+
+std::atomic<uint64_t> g_allocs{0};
+
+} // namespace
+
+void *operator new(std::size_t n) {
+  g_allocs.fetch_add(1, std::memory_order_relaxed);
+  if (void *p = std::malloc(n == 0 ? 1 : n)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+enum class Better : uint8_t { higher, lower };
+
+struct Band {
+  double value;
+  double tolerance; // fraction of `value`
+};
+
+// "<metric> <value> <tolerance>" per line; '#' starts a comment.
+auto load_baseline() -> std::map<std::string, Band> {
+  std::map<std::string, Band> out;
+  std::ifstream in(POKER_PERF_BASELINE);
+  for (std::string line; std::getline(in, line);) {
+    std::istringstream fields(line.substr(0, line.find('#')));
+    std::string metric;
+    Band band{};
+    if (fields >> metric >> band.value >> band.tolerance) {
+      out[metric] = band;
+    }
+  }
+  return out;
+}
+
+void check(const std::string &metric, double measured, Better better,
+           bool timing) {
+  static const auto baseline = load_baseline();
+  const auto it = baseline.find(metric);
+  if (const char *path = std::getenv("POKER_PERF_RECORD")) {
+    std::ofstream(path, std::ios::app)
+        << metric << ' ' << measured << ' '
+        << (it == baseline.end() ? 0.25 : it->second.tolerance) << '\n';
+  }
+  ::testing::Test::RecordProperty(metric, std::to_string(measured));
+  if (it == baseline.end()) {
+    ADD_FAILURE() << metric << " has no baseline";
+    return;
+  }
+  const auto [value, tolerance] = it->second;
+  const double limit = better == Better::higher ? value * (1 - tolerance)
+                                                : value * (1 + tolerance);
+  std::printf("%-28s %12.2f  baseline %12.2f  limit %12.2f\n",
+              metric.c_str(), measured, value, limit);
+#ifndef NDEBUG
+  if (timing) {
+    return; // unoptimized timings say nothing about a regression
+  }
+#else
+  (void)timing;
+#endif
+  if (better == Better::higher) {
+    EXPECT_GE(measured, limit) << metric << " regressed";
+  } else {
+    EXPECT_LE(measured, limit) << metric << " regressed";
+  }
+}
+
+constexpr std::size_t kEngineHands = 20'000;
+constexpr std::size_t kEngineSeats = 6;
+
+constexpr std::size_t kClients = 12;
+constexpr uint64_t kLoopbackActions = 20'000;
+constexpr std::chrono::seconds kLoopbackLimit{60};
+constexpr Chips kBets[] = {0, kBigBlind, 2 * kBigBlind};
+
+struct Client {
+  int fd{-1};
+  poker::PlayerId me{0};
+  std::string in;
+  bool awaiting{false};
+  Clock::time_point sent_at{};
+  uint64_t betting{0}; // table of a bet waiting on its answer
+};
+
+void send(Client &c, const ::poker::v1::Action &a) {
+  std::string body;
+  a.SerializeToString(&body);
+  const uint32_t len = htonl(static_cast<uint32_t>(body.size()));
+  std::string frame(reinterpret_cast<const char *>(&len), sizeof(len));
+  frame += body;
+  // a few bytes on an idle loopback socket never block
+  for (std::size_t off = 0; off < frame.size();) {
+    const auto w = write(c.fd, frame.data() + off, frame.size() - off);
+    if (w <= 0) {
+      return;
+    }
+    off += static_cast<std::size_t>(w);
+  }
+  c.awaiting = true;
+  c.sent_at = Clock::now();
+}
+
+} // namespace
+
+// Hands of house-bot play at one table, with no server around it.
+TEST(Perf, HeadlessEngine) {
+  std::mt19937_64 rng(1);
+  std::mt19937_64 rolls(2);
+  poker::Table t(rng);
+  poker::PlayerId next_id = 1;
+  std::unordered_map<poker::PlayerId, Chips> chips;
+  auto add = [&] {
+    const auto id = next_id++;
+    if (t.add_player(id)) {
+      chips[id] = kBuyIn;
+    }
+  };
+  auto turn_after = [&](const std::vector<poker::Event> &events) {
+    std::optional<poker::PlayerId> turn;
+    for (const auto &ev : events) {
+      if (const auto *c = std::get_if<poker::PlayerChips>(&ev)) {
+        chips[c->who] = c->chips;
+      } else if (const auto *n = std::get_if<poker::TurnAdvanced>(&ev)) {
+        turn = n->next;
+      }
+    }
+    return t.hand_in_progress() ? turn : std::nullopt;
+  };
+  for (std::size_t i = 0; i < kEngineSeats; ++i) {
+    add();
+  }
+
+  uint64_t hands = 0;
+  uint64_t actions = 0;
+  const auto allocs = g_allocs.load();
+  const auto start = Clock::now();
+  for (; hands < kEngineHands; ++hands) {
+    std::vector<poker::PlayerId> broke;
+    for (const auto &[id, stack] : chips) {
+      if (stack == 0) {
+        broke.push_back(id);
+      }
+    }
+    for (const auto id : broke) {
+      (void)t.remove_player(id);
+      chips.erase(id);
+      add();
+    }
+    auto started = t.handle_new_hand();
+    ASSERT_TRUE(started);
+    for (auto turn = turn_after(*started); turn;) {
+      const auto view = t.seat_view(*turn);
+      auto res = t.on_action(poker::bot_action(*turn, *view, rolls() % 100));
+      if (!res) {
+        res = t.on_action(poker::Timeout{*turn});
+      }
+      ++actions;
+      ASSERT_TRUE(res);
+      turn = turn_after(*res);
+    }
+  }
+  const double secs =
+      std::chrono::duration<double>(Clock::now() - start).count();
+  const auto allocated = g_allocs.load() - allocs;
+
+  check("engine.hands_per_sec", static_cast<double>(hands) / secs,
+        Better::higher, true);
+  check("engine.allocs_per_action",
+        static_cast<double>(allocated) / static_cast<double>(actions),
+        Better::lower, false);
+}
+
+// Scripted clients against a real Server on 127.0.0.1, single-threaded:
+// the reactor and the clients take turns. Latency runs from an action's
+// write to the client's next frame.
+TEST(Perf, LoopbackServer) {
+  const auto level = spdlog::get_level();
+  spdlog::set_level(spdlog::level::warn);
+  const int listenfd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t addr_len = sizeof(addr);
+  ASSERT_EQ(bind(listenfd, reinterpret_cast<sockaddr *>(&addr), addr_len), 0);
+  ASSERT_EQ(listen(listenfd, SOMAXCONN), 0);
+  getsockname(listenfd, reinterpret_cast<sockaddr *>(&addr), &addr_len);
+  const int epfd = epoll_create1(0);
+
+  std::vector<Clock::duration> latencies;
+  uint64_t actions = 0;
+  uint64_t allocated = 0;
+  double secs = 0;
+  {
+    Server server(epfd, listenfd);
+    epoll_event ev{};
+    ev.events = EPOLLIN | EPOLLET;
+    ev.data.ptr = nullptr;
+    epoll_ctl(epfd, EPOLL_CTL_ADD, listenfd, &ev);
+    reactor::Reactor r(epfd);
+    start_server(r, server);
+
+    std::vector<Client> clients(kClients);
+    for (auto &c : clients) {
+      c.fd = socket(AF_INET, SOCK_STREAM, 0);
+      ASSERT_EQ(connect(c.fd, reinterpret_cast<sockaddr *>(&addr), addr_len),
+                0);
+      const int one = 1;
+      setsockopt(c.fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+      fcntl(c.fd, F_SETFL, fcntl(c.fd, F_GETFL, 0) | O_NONBLOCK);
+    }
+
+    auto act = [&](Client &c, uint64_t table) {
+      ::poker::v1::Action a;
+      a.set_table_id(table);
+      if (actions % 4 == 0) {
+        a.mutable_fold();
+      } else {
+        a.mutable_bet()->set_amount(kBets[actions % std::size(kBets)]);
+        c.betting = table;
+      }
+      ++actions;
+      send(c, a);
+    };
+    auto on_frame = [&](Client &c, const ::poker::v1::Response &res) {
+      if (c.awaiting) {
+        c.awaiting = false;
+        latencies.push_back(Clock::now() - c.sent_at);
+      }
+      for (const auto &msg : res.messages()) {
+        if (msg.has_error()) {
+          // a rejected bet: fold instead, which is always legal on our turn
+          if (c.betting != 0 && msg.table_id() == c.betting) {
+            ::poker::v1::Action fold;
+            fold.set_table_id(std::exchange(c.betting, 0));
+            fold.mutable_fold();
+            ++actions;
+            send(c, fold);
+          }
+          continue;
+        }
+        const auto &e = msg.event();
+        if (e.has_dealt_hole()) {
+          c.me = e.dealt_hole().who();
+        } else if (e.has_bet_placed() && e.bet_placed().who() == c.me) {
+          c.betting = 0;
+        } else if (e.has_turn_advanced() && c.me != 0 &&
+                   e.turn_advanced().next() == c.me) {
+          act(c, msg.table_id());
+        }
+      }
+    };
+    auto drain = [&](Client &c) {
+      char buf[4096];
+      for (ssize_t n; (n = read(c.fd, buf, sizeof(buf))) > 0;) {
+        c.in.append(buf, static_cast<std::size_t>(n));
+      }
+      while (c.in.size() >= sizeof(uint32_t)) {
+        uint32_t len = 0;
+        std::memcpy(&len, c.in.data(), sizeof(len));
+        len = ntohl(len);
+        if (c.in.size() < sizeof(len) + len) {
+          break;
+        }
+        ::poker::v1::Response res;
+        res.ParseFromArray(c.in.data() + sizeof(len), static_cast<int>(len));
+        c.in.erase(0, sizeof(len) + len);
+        on_frame(c, res);
+      }
+    };
+
+    const auto start = Clock::now();
+    while (actions < kLoopbackActions &&
+           Clock::now() - start < kLoopbackLimit) {
+      // only the server's side is counted
+      const auto before = g_allocs.load();
+      r.poll(1);
+      allocated += g_allocs.load() - before;
+      for (auto &c : clients) {
+        drain(c);
+      }
+    }
+    secs = std::chrono::duration<double>(Clock::now() - start).count();
+
+    for (auto &c : clients) {
+      close(c.fd);
+    }
+    for (int i = 0; i < 100 && server.connections() != 0; ++i) {
+      r.poll(10);
+    }
+  }
+  close(epfd);
+  spdlog::set_level(level);
+
+  ASSERT_GE(actions, kLoopbackActions) << "the tables stalled";
+  std::sort(latencies.begin(), latencies.end());
+  const auto p99 = latencies[latencies.size() * 99 / 100];
+  check("loopback.actions_per_sec", static_cast<double>(actions) / secs,
+        Better::higher, true);
+  check("loopback.p99_us",
+        std::chrono::duration<double, std::micro>(p99).count(), Better::lower,
+        true);
+  check("loopback.allocs_per_action",
+        static_cast<double>(allocated) / static_cast<double>(actions),
+        Better::lower, false);
+}
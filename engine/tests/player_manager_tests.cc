@@ -116,3 +116,25 @@ TEST(PlayerManager, BettingValidationAndPlacement) {
   pm.place_bet(1, kBuyIn);
   EXPECT_FALSE(pm.has_enough_chips(1, 1));
 }
+
+TEST(PlayerManager, FreedSeatIsReusedInSeatOrder) {
+  PlayerManager pm;
+  for (std::size_t i = 0; i < kMaxPlayers; ++i) {
+    ASSERT_TRUE(pm.add_player(i + 1));
+  }
+  pm.seat_held_players();
+  ASSERT_TRUE(pm.remove_player(4));
+  ASSERT_TRUE(pm.add_player(42));
+  pm.seat_held_players();
+
+  // 42 took seat 3, between players 3 and 5
+  EXPECT_EQ(pm.next_player(3).value(), 42u);
+  EXPECT_EQ(pm.next_player(42).value(), 5u);
+
+  auto cycle = pm.active_cycle_from(kMaxPlayers);
+  ASSERT_EQ(cycle.size(), kMaxPlayers);
+  EXPECT_EQ(cycle[0], kMaxPlayers);
+  EXPECT_EQ(cycle[1], 1u);
+  EXPECT_EQ(cycle[4], 42u);
+  EXPECT_EQ(pm.get_chips(42), kBuyIn);
+}
@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <string_view>
+#include <vector>
+
+#include "player_stats.h"
+#include "scratch_file.h"
+
+using namespace poker;
+
+namespace {
+
+auto row(PlayerId who, uint8_t flags, uint8_t aggressive = 0,
+         uint8_t passive = 0) -> HandRow {
+  return HandRow{1, 0, 1, who, 0, 0, flags, aggressive, passive};
+}
+
+} // namespace
+
+TEST(PlayerStats, UnknownPlayerHasEmptyLine) {
+  PlayerStats stats;
+  const auto line = stats.line(12345);
+  EXPECT_EQ(line.hands, 0u);
+  EXPECT_EQ(line.vpip, 0.0);
+  EXPECT_EQ(line.aggression, 0.0);
+  EXPECT_EQ(stats.players(), 0u);
+}
+
+TEST(PlayerStats, CountsFlagsAndActions) {
+  PlayerStats stats;
+  const std::vector<HandRow> rows{
+      row(3, kVpip | kPfr, 2, 0), row(3, kVpip | kShowdown, 1, 1),
+      row(3, 0), row(3, 0, 0, 1), row(9, kVpip, 0, 1)};
+  stats.record(rows);
+
+  const auto c = stats.counters(3);
+  EXPECT_EQ(c.hands, 4u);
+  EXPECT_EQ(c.vpip, 2u);
+  EXPECT_EQ(c.pfr, 1u);
+  EXPECT_EQ(c.showdowns, 1u);
+  EXPECT_EQ(c.aggressive, 3u);
+  EXPECT_EQ(c.passive, 2u);
+
+  const auto line = stats.line(3);
+  EXPECT_DOUBLE_EQ(line.vpip, 0.5);
+  EXPECT_DOUBLE_EQ(line.pfr, 0.25);
+  EXPECT_DOUBLE_EQ(line.aggression, 1.5);
+  EXPECT_DOUBLE_EQ(line.showdown, 0.25);
+  EXPECT_EQ(stats.players(), 2u);
+}
+
+TEST(PlayerStats, SaveAndLoadRoundTrip) {
+  PlayerStats stats;
+  std::vector<HandRow> rows;
+  for (PlayerId id = 1; id < 5000; id += 7) {
+    for (uint8_t h = 0; h < id % 5 + 1; ++h) {
+      rows.push_back(row(id, static_cast<uint8_t>(h % 8), h, 1));
+    }
+  }
+  stats.record(rows);
+  const auto path = scratch_file("_stats_roundtrip");
+  ASSERT_TRUE(stats.save(path));
+
+  auto loaded = PlayerStats::load(path);
+  std::filesystem::remove(path);
+  ASSERT_TRUE(loaded.has_value());
+  EXPECT_EQ(loaded->players(), stats.players());
+  for (PlayerId id = 0; id < 5000; ++id) {
+    const auto a = stats.counters(id);
+    const auto b = loaded->counters(id);
+    ASSERT_EQ(a.hands, b.hands) << id;
+    ASSERT_EQ(a.vpip, b.vpip) << id;
+    ASSERT_EQ(a.pfr, b.pfr) << id;
+    ASSERT_EQ(a.showdowns, b.showdowns) << id;
+    ASSERT_EQ(a.aggressive, b.aggressive) << id;
+    ASSERT_EQ(a.passive, b.passive) << id;
+  }
+}
+
+TEST(PlayerStats, RejectsTruncatedSnapshot) {
+  PlayerStats stats;
+  const std::vector<HandRow> rows{row(1, kVpip), row(2, 0)};
+  stats.record(rows);
+  const auto path = scratch_file("_stats_truncated");
+  ASSERT_TRUE(stats.save(path));
+  std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1);
+
+  auto loaded = PlayerStats::load(path);
+  std::filesystem::remove(path);
+  ASSERT_FALSE(loaded.has_value());
+  EXPECT_EQ(loaded.error(), StatsError::bad_format);
+}
+
+TEST(PlayerStats, RejectsImpossibleSnapshots) {
+  const auto path = scratch_file("_stats_impossible");
+  auto load = [&](std::string_view bytes) {
+    {
+      std::ofstream f(path, std::ios::binary | std::ios::trunc);
+      f.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    }
+    return PlayerStats::load(path);
+  };
+  // magic, one player, id gap, then hands vpip pfr showdowns agg passive
+  using namespace std::string_view_literals;
+  EXPECT_TRUE(load("PST1\x01\x05\x02\x01\x01\x00\x00\x00"sv));
+  // id 0 is nobody
+  EXPECT_FALSE(load("PST1\x01\x00\x02\x01\x01\x00\x00\x00"sv));
+  // more voluntary hands than hands
+  EXPECT_FALSE(load("PST1\x01\x05\x02\x03\x01\x00\x00\x00"sv));
+  // a counter past 32 bits
+  EXPECT_FALSE(
+      load("PST1\x01\x05\x80\x80\x80\x80\x10\x00\x00\x00\x00\x00"sv));
+  // an id near the top of the range is not worth believing
+  EXPECT_FALSE(load("PST1\x01\xff\xff\xff\xff\xff\xff\xff\xff\x7f"
+                    "\x02\x01\x01\x00\x00\x00"sv));
+  std::filesystem::remove(path);
+}
+
+TEST(PlayerStats, EraseIfDropsPlayers) {
+  PlayerStats stats;
+  const std::vector<HandRow> rows{row(1, kVpip), row(2, 0), row(3, 0)};
+  stats.record(rows);
+  EXPECT_EQ(stats.erase_if([](PlayerId id) { return id != 2; }), 2u);
+  EXPECT_EQ(stats.players(), 1u);
+  EXPECT_EQ(stats.counters(2).hands, 1u);
+  EXPECT_EQ(stats.counters(1).hands, 0u);
+}
@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstdint>
+#include <fcntl.h>
+#include <memory>
+#include <string>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "reactor.h"
+#include "server.h"
+
+namespace {
+
+struct Peer {
+  int client{-1};
+  Conn conn{-1, 0};
+  int frames{0};
+};
+
+reactor::Task count(reactor::Reactor &r, Peer *p) {
+  while (auto frame = co_await r.read_frame(&p->conn)) {
+    ++p->frames;
+  }
+}
+
+// Wakes on a timer, then holds the loop for `busy`.
+reactor::Task stall(reactor::Reactor &r, std::chrono::milliseconds busy) {
+  co_await r.sleep_for(std::chrono::milliseconds{1});
+  std::this_thread::sleep_for(busy);
+}
+
+// Connections on socketpairs registered with a private epoll instance; each
+// counts the frames its coroutine has consumed.
+class ReactorTest : public ::testing::Test {
+protected:
+  ReactorTest() : epfd_(epoll_create1(0)), reactor_(epfd_) {}
+  ~ReactorTest() override {
+    for (auto &p : peers_) {
+      close(p->client);
+      close(p->conn.fd);
+    }
+    close(epfd_);
+  }
+
+  auto add() -> Peer & {
+    auto &p = *peers_.emplace_back(std::make_unique<Peer>());
+    int fds[2];
+    EXPECT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+    p.client = fds[0];
+    p.conn.fd = fds[1];
+    fcntl(p.conn.fd, F_SETFL, fcntl(p.conn.fd, F_GETFL, 0) | O_NONBLOCK);
+    epoll_event ev{};
+    ev.events = EPOLLIN | EPOLLOUT | EPOLLET;
+    ev.data.ptr = &p.conn;
+    epoll_ctl(epfd_, EPOLL_CTL_ADD, p.conn.fd, &ev);
+    count(reactor_, &p);
+    return p;
+  }
+
+  static void send(const Peer &p, int n, std::size_t payload = 16) {
+    std::string batch;
+    for (int i = 0; i < n; ++i) {
+      const uint32_t len = htonl(static_cast<uint32_t>(payload));
+      batch.append(reinterpret_cast<const char *>(&len), sizeof(len));
+      batch.append(payload, 'x');
+    }
+    ASSERT_EQ(write(p.client, batch.data(), batch.size()),
+              static_cast<ssize_t>(batch.size()));
+  }
+
+  int epfd_;
+  reactor::Reactor reactor_;
+  std::vector<std::unique_ptr<Peer>> peers_;
+};
+
+} // namespace
+
+TEST_F(ReactorTest, FloodingConnectionCannotStarveOthers) {
+  auto &flood = add();
+  auto &quiet = add();
+  send(flood, 100);
+  send(quiet, 1);
+
+  reactor_.poll(0);
+  EXPECT_EQ(quiet.frames, 1);
+  EXPECT_EQ(flood.frames, static_cast<int>(reactor::kFrameBudget));
+  EXPECT_TRUE(reactor_.has_ready());
+
+  // the backlog drains a budget per tick without new socket events
+  int ticks = 1;
+  while (reactor_.has_ready()) {
+    reactor_.poll(0);
+    ++ticks;
+    EXPECT_LE(flood.frames, ticks * static_cast<int>(reactor::kFrameBudget));
+  }
+  EXPECT_EQ(flood.frames, 100);
+}
+
+TEST_F(ReactorTest, ByteBudgetBoundsLargeFrames) {
+  auto &p = add();
+  const std::size_t payload = reactor::kByteBudget / 2;
+  send(p, 4, payload);
+
+  reactor_.poll(0);
+  EXPECT_LT(p.frames, 4);
+  while (reactor_.has_ready()) {
+    reactor_.poll(0);
+  }
+  EXPECT_EQ(p.frames, 4);
+}
+
+TEST_F(ReactorTest, LagCoversTheWorkOfTheTick) {
+  stall(reactor_, std::chrono::milliseconds{20});
+  reactor_.poll(); // until the timer
+  EXPECT_GE(reactor_.lag(), std::chrono::milliseconds{20});
+  reactor_.poll(0);
+  EXPECT_LT(reactor_.lag(), std::chrono::milliseconds{20});
+}
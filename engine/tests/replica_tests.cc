@@ -0,0 +1,217 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <arpa/inet.h>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <string>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+#include "actions.pb.h"
+#include "hand_audit.h"
+#include "replica.h"
+#include "response.pb.h"
+#include "server.h"
+
+using namespace poker;
+
+namespace {
+
+// `log` as a primary streams it.
+auto stream(const TableLog &log) -> std::string {
+  std::string out(kHandLogMagic);
+  const auto *events = reinterpret_cast<const char *>(log.events.data());
+  for (const auto &in : log.inputs) {
+    out.append(reinterpret_cast<const char *>(&in), sizeof(in));
+    out.append(events, in.events * sizeof(EventRecord));
+    events += in.events * sizeof(EventRecord);
+  }
+  return out;
+}
+
+// A client on a socketpair; `peer` is the client's end.
+auto client(Server &server, int &peer) -> ConnectResult {
+  int sv[2];
+  EXPECT_EQ(socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, sv), 0);
+  peer = sv[1];
+  return server.handle_connect(sv[0]);
+}
+
+// Every message waiting on the client's end.
+auto messages(int peer) -> std::vector<::poker::v1::ServerMessage> {
+  std::string buf;
+  char chunk[4096];
+  for (ssize_t n; (n = read(peer, chunk, sizeof(chunk))) > 0;) {
+    buf.append(chunk, static_cast<std::size_t>(n));
+  }
+  std::vector<::poker::v1::ServerMessage> out;
+  while (buf.size() >= sizeof(uint32_t)) {
+    uint32_t len = 0;
+    std::memcpy(&len, buf.data(), sizeof(len));
+    len = ntohl(len);
+    ::poker::v1::Response res;
+    res.ParseFromString(buf.substr(sizeof(len), len));
+    out.insert(out.end(), res.messages().begin(), res.messages().end());
+    buf.erase(0, std::min<std::size_t>(buf.size(), sizeof(len) + len));
+  }
+  return out;
+}
+
+auto resume_as(const ::poker::v1::Welcome &w) -> ::poker::v1::Action::Resume {
+  ::poker::v1::Action::Resume req;
+  req.set_player(w.player());
+  req.set_token(w.token());
+  return req;
+}
+
+// A primary with one player in a hand against a house bot and another
+// waiting for the next hand, which dies as soon as the standby and the
+// players have been sent the tick. The players' ends of `fds` outlive it.
+[[noreturn]] void run_primary(const std::filesystem::path &path,
+                              const int (&fds)[2]) {
+  Server server(epoll_create1(0), socket(AF_INET, SOCK_STREAM, 0));
+  while (!server.enable_replication(path)) {
+    usleep(1000); // until the standby listens
+  }
+  const auto first = server.handle_connect(fds[0]);
+  if (!first.result || !server.maybe_start_hand(first.result->table)) {
+    _exit(1);
+  }
+  if (!server.handle_connect(fds[1]).result) {
+    _exit(1);
+  }
+  server.flush_pending();
+  raise(SIGKILL);
+  _exit(1);
+}
+
+} // namespace
+
+TEST(Replica, StandbyReplaysTheStreamInAnyChunking) {
+  const auto log = play_table(3, 11, 6, 40);
+  const auto bytes = stream(log);
+  replica::Standby standby;
+  for (std::size_t off = 0; off < bytes.size(); off += 7) {
+    ASSERT_TRUE(standby.consume(std::string_view(bytes).substr(off, 7)));
+  }
+  EXPECT_EQ(standby.inputs(), log.inputs.size());
+  EXPECT_EQ(standby.diverged(), 0u);
+  EXPECT_EQ(standby.tables(), 1u);
+
+  // an outcome the standby doesn't reproduce is noticed
+  auto bad = log;
+  bad.events.back().amount += 1;
+  replica::Standby other;
+  ASSERT_TRUE(other.consume(stream(bad)));
+  EXPECT_EQ(other.diverged(), 1u);
+
+  replica::Standby garbage;
+  EXPECT_EQ(garbage.consume("NOTALOG!").error(),
+            replica::ReplicaError::bad_format);
+
+  auto off_deck = log;
+  const auto dealt = std::ranges::find(off_deck.events, EventTag::dealt_hole,
+                                       &EventRecord::tag);
+  ASSERT_NE(dealt, off_deck.events.end());
+  dealt->cards[1] = kDeckSize;
+  replica::Standby hostile;
+  EXPECT_EQ(hostile.consume(stream(off_deck)).error(),
+            replica::ReplicaError::bad_format);
+}
+
+TEST(Replica, StandbyTakesOverWhenThePrimaryIsKilled) {
+  const std::filesystem::path path =
+      "/tmp/poker_replica_" + std::to_string(getpid()) + ".sock";
+  int first[2];
+  int second[2];
+  ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, first), 0);
+  ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, second), 0);
+  const pid_t child = fork();
+  ASSERT_GE(child, 0);
+  if (child == 0) {
+    run_primary(path, {first[0], second[0]});
+  }
+  close(first[0]);
+  close(second[0]);
+  const auto fd = replica::Standby::accept_primary(path);
+  ASSERT_TRUE(fd);
+  replica::Standby standby;
+  ASSERT_TRUE(standby.follow(*fd));
+  const auto lost = std::chrono::steady_clock::now();
+  close(*fd);
+  std::filesystem::remove(path);
+  int status = 0;
+  ASSERT_EQ(waitpid(child, &status, 0), child);
+  ASSERT_TRUE(WIFSIGNALED(status));
+  EXPECT_EQ(standby.diverged(), 0u);
+  EXPECT_EQ(standby.tables(), 1u);
+  EXPECT_EQ(standby.hands_in_flight(), 1u);
+
+  const auto player = [](int fd) {
+    for (const auto &msg : messages(fd)) {
+      if (msg.has_welcome()) {
+        return msg.welcome();
+      }
+    }
+    return ::poker::v1::Welcome{};
+  };
+  const auto hero = player(first[1]);
+  const auto gone = player(second[1]);
+  ASSERT_NE(hero.player(), 0u);
+  ASSERT_NE(gone.player(), 0u);
+
+  Server server(epoll_create1(0), socket(AF_INET, SOCK_STREAM, 0));
+  server.adopt(standby.take());
+  const auto took = std::chrono::steady_clock::now() - lost;
+  EXPECT_LT(took, std::chrono::milliseconds{50});
+  EXPECT_TRUE(server.seats_held_for());
+  EXPECT_TRUE(server.take_bot_turns().empty()); // the hero is on the clock
+
+  // newcomers sit at the primary's table under ids it never handed out
+  int peer = -1;
+  const auto back = client(server, peer);
+  ASSERT_TRUE(back.result);
+  EXPECT_EQ(back.result->table, 1u);
+  EXPECT_GT(back.conn->player_id, gone.player());
+
+  // the hero reconnects and takes their seat back mid-hand
+  ASSERT_TRUE(server.resume(back.conn->player_id, resume_as(hero)));
+  EXPECT_EQ(back.conn->player_id, hero.player());
+  EXPECT_EQ(back.conn->tables, std::vector<TableId>{1});
+  server.flush_pending();
+  bool dealt = false;
+  bool to_act = false;
+  for (const auto &msg : messages(peer)) {
+    dealt |= msg.event().has_dealt_hole();
+    to_act |= msg.event().turn_advanced().next() == hero.player();
+  }
+  EXPECT_TRUE(dealt);
+  EXPECT_TRUE(to_act);
+
+  // and plays on: the call puts the adopted house bot on the clock
+  ::poker::v1::Action call;
+  call.set_table_id(1);
+  call.mutable_bet()->set_amount(kBigBlind - kSmallBlind);
+  const auto called = server.apply_action(call, hero.player());
+  ASSERT_TRUE(called);
+  server.settle_table(1, Outbound{called->events});
+  const auto turns = server.take_bot_turns();
+  ASSERT_EQ(turns.size(), 1u);
+  EXPECT_TRUE(server.apply_bot_turn(turns[0]));
+
+  // the other player never came back
+  const auto released = server.release_held_seats();
+  ASSERT_EQ(released.size(), 1u);
+  EXPECT_TRUE(std::ranges::any_of(released[0].events, [&](const Event &ev) {
+    const auto *removed = std::get_if<PlayerRemoved>(&ev);
+    return removed && removed->who == gone.player();
+  }));
+  EXPECT_FALSE(server.seats_held_for());
+  close(first[1]);
+  close(second[1]);
+  close(peer);
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <unistd.h>
+
+// A path in the temp directory for a test's file, tagged with the pid so
+// test binaries running at once never share one.
+inline auto scratch_file(const char *name) -> std::filesystem::path {
+  return std::filesystem::temp_directory_path() /
+         (std::to_string(getpid()) + name);
+}
@@ -0,0 +1,846 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <iterator>
+#include <optional>
+#include <set>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+#include "actions.pb.h"
+#include "capture.h"
+#include "fast_fold.h"
+#include "hand_audit.h"
+#include "live_state.h"
+#include "response.pb.h"
+#include "scratch_file.h"
+#include "server.h"
+
+namespace {
+
+// The kernel, on a clock a test can move forward.
+class SkewedIo : public reactor::Io {
+public:
+  ssize_t read(int fd, void *buf, std::size_t n) override {
+    return sys_.read(fd, buf, n);
+  }
+  ssize_t write(int fd, const void *buf, std::size_t n) override {
+    return sys_.write(fd, buf, n);
+  }
+  int accept(int listenfd) override { return sys_.accept(listenfd); }
+  int close(int fd) override { return sys_.close(fd); }
+  int epoll_ctl(int epfd, int op, int fd, epoll_event *ev) override {
+    return sys_.epoll_ctl(epfd, op, fd, ev);
+  }
+  int epoll_wait(int epfd, epoll_event *events, int max_events,
+                 int timeout_ms) override {
+    return sys_.epoll_wait(epfd, events, max_events, timeout_ms);
+  }
+  auto now() -> reactor::Clock::time_point override {
+    return sys_.now() + ahead;
+  }
+  uint64_t random() override { return sys_.random(); }
+
+  reactor::Clock::duration ahead{};
+
+private:
+  reactor::Io &sys_ = reactor::system_io();
+};
+
+// A Server on a private epoll instance with clients on socketpairs, so
+// frames can be read back without a listening socket.
+class ServerTest : public ::testing::Test {
+protected:
+  ServerTest()
+      : server_(epoll_create1(0), socket(AF_INET, SOCK_STREAM, 0), io_) {}
+  ~ServerTest() override {
+    for (int fd : peers_) {
+      close(fd);
+    }
+  }
+
+  auto connect() -> ConnectResult {
+    int sv[2];
+    EXPECT_EQ(socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, sv), 0);
+    peers_.push_back(sv[1]);
+    return server_.handle_connect(sv[0]);
+  }
+
+  // Every frame waiting on the peer's end.
+  auto frames(int peer) -> std::vector<::poker::v1::Response> {
+    std::string buf;
+    char chunk[4096];
+    for (ssize_t n; (n = read(peer, chunk, sizeof(chunk))) > 0;) {
+      buf.append(chunk, static_cast<std::size_t>(n));
+    }
+    std::vector<::poker::v1::Response> out;
+    while (buf.size() >= sizeof(uint32_t)) {
+      uint32_t len = 0;
+      std::memcpy(&len, buf.data(), sizeof(len));
+      len = ntohl(len);
+      EXPECT_GE(buf.size(), sizeof(len) + len);
+      out.emplace_back().ParseFromString(buf.substr(sizeof(len), len));
+      buf.erase(0, sizeof(len) + len);
+    }
+    return out;
+  }
+
+  SkewedIo io_;
+  Server server_;
+  std::vector<int> peers_;
+};
+
+auto join() -> ::poker::v1::Action {
+  ::poker::v1::Action a;
+  a.mutable_join();
+  return a;
+}
+
+// The player and token of the last Welcome in `got`.
+auto welcome(const std::vector<::poker::v1::Response> &got)
+    -> std::optional<::poker::v1::Welcome> {
+  std::optional<::poker::v1::Welcome> out;
+  for (const auto &res : got) {
+    for (const auto &msg : res.messages()) {
+      if (msg.has_welcome()) {
+        out = msg.welcome();
+      }
+    }
+  }
+  return out;
+}
+
+// The hand and player of the last TurnAdvanced in `got`.
+auto last_turn(const std::vector<::poker::v1::Response> &got)
+    -> std::pair<uint64_t, poker::PlayerId> {
+  std::pair<uint64_t, poker::PlayerId> out{};
+  for (const auto &res : got) {
+    for (const auto &msg : res.messages()) {
+      if (msg.event().has_turn_advanced()) {
+        out = {msg.hand_id(), msg.event().turn_advanced().next()};
+      }
+    }
+  }
+  return out;
+}
+
+auto chat(const std::string &text) -> ::poker::v1::Action {
+  ::poker::v1::Action a;
+  a.mutable_chat()->set_text(text);
+  return a;
+}
+
+} // namespace
+
+TEST_F(ServerTest, JoinSeatsAtAnotherTable) {
+  auto first = connect();
+  ASSERT_TRUE(first.result.has_value());
+  const auto pid = first.conn->player_id;
+
+  auto second = server_.apply_action(join(), pid);
+  ASSERT_TRUE(second.has_value());
+  EXPECT_NE(second->table, first.result->table);
+  EXPECT_EQ(first.conn->tables.size(), 2u);
+}
+
+TEST_F(ServerTest, ActionForUnjoinedTableIsRejected) {
+  auto c = connect();
+  ASSERT_TRUE(c.result.has_value());
+  ::poker::v1::Action fold;
+  fold.mutable_fold();
+  fold.set_table_id(c.result->table + 100);
+
+  auto res = server_.apply_action(fold, c.conn->player_id);
+  ASSERT_FALSE(res.has_value());
+  EXPECT_EQ(res.error(), poker::Error{poker::ServerError::illegal_action});
+}
+
+TEST_F(ServerTest, TableLimitPerConnection) {
+  auto c = connect();
+  ASSERT_TRUE(c.result.has_value());
+  std::expected<TableEvents, poker::Error> res = *c.result;
+  while (res) {
+    res = server_.apply_action(join(), c.conn->player_id);
+  }
+  EXPECT_EQ(res.error(), poker::Error{poker::ServerError::too_many_tables});
+}
+
+TEST_F(ServerTest, BroadcastsFromSeveralTablesShareOneFrame) {
+  auto c = connect();
+  ASSERT_TRUE(c.result.has_value());
+  server_.flush_pending();
+  frames(peers_.back()); // the Welcome
+  const auto pid = c.conn->player_id;
+  std::vector<poker::TableId> tables{c.result->table};
+  for (int i = 0; i < 3; ++i) {
+    auto res = server_.apply_action(join(), pid);
+    ASSERT_TRUE(res.has_value());
+    tables.push_back(res->table);
+  }
+  for (const auto tid : tables) {
+    server_.push_table(tid, Outbound{poker::Event{poker::PlayerAdded{pid}}});
+  }
+  server_.push_one(pid, Outbound{poker::Error{poker::GameError::out_of_turn}},
+                   tables[1]);
+  server_.flush_pending();
+
+  auto got = frames(peers_.back());
+  ASSERT_EQ(got.size(), 1u);
+  ASSERT_EQ(got[0].messages_size(), 5);
+  std::set<uint64_t> seen;
+  for (const auto &msg : got[0].messages()) {
+    seen.insert(msg.table_id());
+  }
+  EXPECT_EQ(seen, std::set<uint64_t>(tables.begin(), tables.end()));
+  EXPECT_TRUE(got[0].messages(4).has_error());
+  EXPECT_EQ(got[0].messages(4).table_id(), tables[1]);
+
+  // nothing left over for the next tick
+  server_.flush_pending();
+  EXPECT_TRUE(frames(peers_.back()).empty());
+}
+
+TEST_F(ServerTest, OutboundCostIsCountedAndHeaviestListed) {
+  auto first = connect();
+  auto second = connect();
+  ASSERT_TRUE(first.result && second.result);
+  server_.push_one(first.conn->player_id,
+                   Outbound{poker::Error{poker::GameError::out_of_turn}});
+  server_.flush_pending();
+  for (std::size_t i = 0; i < peers_.size(); ++i) {
+    const auto *conn = (i == 0 ? first : second).conn;
+    uint64_t bytes = 0;
+    const auto got = frames(peers_[i]);
+    for (const auto &res : got) {
+      bytes += sizeof(uint32_t) + res.ByteSizeLong();
+    }
+    EXPECT_EQ(conn->cost.frames_out, got.size());
+    EXPECT_EQ(conn->cost.bytes_out, bytes);
+  }
+
+  // handler time is counted by the serving loop
+  first.conn->cost.cycles = 100;
+  second.conn->cost.cycles = 500;
+  const auto top = server_.heaviest(1);
+  ASSERT_EQ(top.size(), 1u);
+  EXPECT_EQ(top[0].player, second.conn->player_id);
+  EXPECT_EQ(top[0].cost.cycles, 500u);
+  EXPECT_EQ(server_.heaviest(10).size(), 2u);
+}
+
+TEST_F(ServerTest, OverloadShedsChatAndNewTables) {
+  auto first = connect();
+  auto second = connect();
+  ASSERT_TRUE(first.result && second.result);
+  const auto pid = first.conn->player_id;
+  EXPECT_TRUE(server_.accepting());
+  ASSERT_TRUE(server_.apply_action(chat("hi"), pid).has_value());
+
+  server_.observe_lag(std::chrono::seconds{1});
+  EXPECT_EQ(server_.load().mode, load::Mode::closed);
+  EXPECT_FALSE(server_.accepting());
+  const poker::Error overloaded{poker::ServerError::overloaded};
+  EXPECT_EQ(server_.apply_action(chat("hi"), pid).error(), overloaded);
+  // the only table is already theirs, so joining needs a new one
+  EXPECT_EQ(server_.apply_action(join(), pid).error(), overloaded);
+  EXPECT_EQ(server_.load().shed, 2u);
+  EXPECT_EQ(first.conn->tables.size(), 1u);
+}
+
+TEST_F(ServerTest, LeaveStopsTableTraffic) {
+  auto c = connect();
+  ASSERT_TRUE(c.result.has_value());
+  const auto pid = c.conn->player_id;
+  auto other = server_.apply_action(join(), pid);
+  ASSERT_TRUE(other.has_value());
+  server_.flush_pending();
+  frames(peers_.back());
+
+  ::poker::v1::Action leave;
+  leave.mutable_leave();
+  leave.set_table_id(other->table);
+  ASSERT_TRUE(server_.apply_action(leave, pid).has_value());
+  EXPECT_EQ(c.conn->tables.size(), 1u);
+  server_.flush_pending();
+  frames(peers_.back());
+
+  server_.push_table(other->table,
+                     Outbound{poker::Event{poker::PlayerAdded{99}}});
+  server_.flush_pending();
+  EXPECT_TRUE(frames(peers_.back()).empty());
+}
+
+TEST_F(ServerTest, DisconnectMidHandSettlesTheTable) {
+  auto first = connect();
+  auto second = connect();
+  ASSERT_TRUE(first.result && second.result);
+  const auto table = first.result->table;
+  auto started = server_.maybe_start_hand(table);
+  ASSERT_TRUE(started);
+  server_.push_table(table, Outbound{*started});
+  server_.flush_pending();
+  for (int peer : peers_) {
+    frames(peer);
+  }
+
+  const auto gone = first.conn->player_id;
+  const auto stays = second.conn->player_id;
+  server_.handle_close(gone);
+  server_.flush_pending();
+  bool removed = false, won = false, chips = false, dealt = false;
+  for (const auto &res : frames(peers_[1])) {
+    for (const auto &msg : res.messages()) {
+      const auto &ev = msg.event();
+      removed |= ev.has_player_removed() && ev.player_removed().who() == gone;
+      won |= ev.has_won_pot() && ev.won_pot().who() == stays;
+      chips |= ev.has_player_chips() && ev.player_chips().who() == stays;
+      // the house sits in and the table deals again
+      dealt |= ev.has_hand_started();
+    }
+  }
+  EXPECT_TRUE(removed);
+  EXPECT_TRUE(won);
+  EXPECT_TRUE(chips);
+  EXPECT_TRUE(dealt);
+}
+
+TEST_F(ServerTest, LogsReachTheDiskWithoutMoreTraffic) {
+  const auto path = scratch_file("server_idle.cap");
+  ASSERT_TRUE(server_.enable_capture(path));
+  ASSERT_TRUE(server_.logging());
+  ASSERT_TRUE(connect().result);
+
+  server_.flush_logs();
+  // the writer thread owns the disk
+  auto written = std::filesystem::file_size(path);
+  for (int i = 0; i < 100 && written <= capture::kMagic.size(); ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    written = std::filesystem::file_size(path);
+  }
+  EXPECT_GT(written, capture::kMagic.size());
+  std::filesystem::remove(path);
+}
+
+TEST_F(ServerTest, ResumeTakesBackThePlayer) {
+  auto first = connect();
+  auto second = connect();
+  ASSERT_TRUE(first.result && second.result);
+  const auto table = first.result->table;
+  server_.flush_pending();
+  const auto mine = welcome(frames(peers_[0]));
+  const auto theirs = welcome(frames(peers_[1]));
+  ASSERT_TRUE(mine && theirs);
+  const auto pid = first.conn->player_id;
+  EXPECT_EQ(mine->player(), pid);
+
+  // a hand to come back to
+  auto started = server_.maybe_start_hand(table);
+  ASSERT_TRUE(started);
+  server_.push_table(table, Outbound{*started});
+  poker::PlayerId on_turn = 0;
+  for (const auto &ev : *started) {
+    if (const auto *turn = std::get_if<poker::TurnAdvanced>(&ev)) {
+      on_turn = turn->next;
+    }
+  }
+  ::poker::v1::Action fold;
+  fold.set_table_id(table);
+  fold.mutable_fold();
+  auto folded = server_.apply_action(fold, on_turn);
+  ASSERT_TRUE(folded);
+  server_.push_table(table, Outbound{folded->events});
+  ASSERT_EQ(server_.stats().line(pid).hands, 1u);
+  server_.handle_close(pid);
+
+  auto third = connect();
+  ASSERT_TRUE(third.result);
+  const auto fresh = third.conn->player_id;
+  ::poker::v1::Action resume;
+  resume.mutable_resume()->set_player(pid);
+  resume.mutable_resume()->set_token(mine->token() + 1);
+  const poker::Error refused{poker::ServerError::bad_credential};
+  EXPECT_EQ(server_.resume(fresh, resume.resume()).error(), refused);
+  // still connected
+  resume.mutable_resume()->set_player(theirs->player());
+  resume.mutable_resume()->set_token(theirs->token());
+  EXPECT_EQ(server_.resume(fresh, resume.resume()).error(), refused);
+  server_.flush_pending();
+  frames(peers_[2]);
+
+  resume.mutable_resume()->set_player(pid);
+  resume.mutable_resume()->set_token(mine->token());
+  auto resumed = server_.resume(fresh, resume.resume());
+  ASSERT_TRUE(resumed);
+  EXPECT_EQ(third.conn->player_id, pid);
+  EXPECT_EQ(third.conn->tables.size(), 1u);
+  ::poker::v1::Action stats;
+  stats.mutable_stats()->set_player(pid);
+  ASSERT_TRUE(server_.apply_action(stats, pid));
+  server_.flush_pending();
+  const auto got = frames(peers_[2]);
+  const auto again = welcome(got);
+  ASSERT_TRUE(again);
+  EXPECT_EQ(again->player(), pid);
+  EXPECT_EQ(again->token(), mine->token());
+  bool looked_up = false;
+  for (const auto &res : got) {
+    for (const auto &msg : res.messages()) {
+      if (msg.has_stats()) {
+        looked_up = true;
+        EXPECT_EQ(msg.stats().player(), pid);
+        EXPECT_EQ(msg.stats().hands(), 1u);
+      }
+    }
+  }
+  EXPECT_TRUE(looked_up);
+  // the connection's own id had no hands, so it is nobody's now
+  EXPECT_FALSE(server_.accounts().contains(fresh));
+}
+
+TEST_F(ServerTest, LeavingDuringTheFirstHandKeepsTheAccount) {
+  auto first = connect();
+  auto second = connect();
+  auto third = connect();
+  ASSERT_TRUE(first.result && second.result && third.result);
+  const auto table = first.result->table;
+  ASSERT_EQ(third.result->table, table);
+  auto started = server_.maybe_start_hand(table);
+  ASSERT_TRUE(started);
+  server_.push_table(table, Outbound{*started});
+
+  // two players play on, so the hand is only recorded later
+  const auto gone = first.conn->player_id;
+  server_.handle_close(gone);
+  EXPECT_TRUE(server_.accounts().contains(gone));
+  ::poker::v1::Action fold;
+  fold.set_table_id(table);
+  fold.mutable_fold();
+  for (const auto *conn : {second.conn, third.conn}) {
+    if (auto folded = server_.apply_action(fold, conn->player_id)) {
+      server_.push_table(table, Outbound{folded->events});
+      break;
+    }
+  }
+  EXPECT_EQ(server_.stats().line(gone).hands, 1u);
+  EXPECT_TRUE(server_.accounts().contains(gone));
+}
+
+TEST_F(ServerTest, ChatGoesToTheTableAtFlush) {
+  auto first = connect();
+  auto second = connect();
+  ASSERT_TRUE(first.result && second.result);
+  ASSERT_EQ(first.result->table, second.result->table);
+  server_.flush_pending();
+  for (int peer : peers_) {
+    frames(peer);
+  }
+
+  const auto pid = first.conn->player_id;
+  auto said = server_.apply_action(chat("gl all"), pid);
+  ASSERT_TRUE(said.has_value());
+  EXPECT_TRUE(said->events.empty());
+  EXPECT_TRUE(frames(peers_[1]).empty()); // nothing before the flush
+  server_.flush_pending();
+  for (int peer : peers_) {
+    const auto got = frames(peer);
+    ASSERT_EQ(got.size(), 1u);
+    ASSERT_EQ(got[0].messages_size(), 1);
+    const auto &msg = got[0].messages(0);
+    ASSERT_TRUE(msg.has_chat());
+    EXPECT_EQ(msg.table_id(), first.result->table);
+    EXPECT_EQ(msg.chat().who(), pid);
+    EXPECT_EQ(msg.chat().text(), "gl all");
+  }
+
+  EXPECT_EQ(server_.apply_action(chat(std::string(257, 'x')), pid).error(),
+            poker::Error{poker::ServerError::chat_too_long});
+  // the first line was part of the burst of five
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_TRUE(server_.apply_action(chat("spam"), pid).has_value());
+  }
+  EXPECT_EQ(server_.apply_action(chat("spam"), pid).error(),
+            poker::Error{poker::ServerError::chat_rate_limited});
+}
+
+TEST_F(ServerTest, ChatSkipsConnectionsThatAreBehind) {
+  auto first = connect();
+  auto second = connect();
+  ASSERT_TRUE(first.result && second.result);
+  server_.flush_pending();
+  for (int peer : peers_) {
+    frames(peer);
+  }
+  // as flush leaves a socket that stopped taking bytes
+  second.conn->out = "unwritten";
+  second.conn->io.writable = false;
+
+  ASSERT_TRUE(server_.apply_action(chat("hi"), first.conn->player_id));
+  server_.flush_pending();
+  EXPECT_EQ(frames(peers_[0]).size(), 1u);
+  EXPECT_TRUE(frames(peers_[1]).empty());
+  EXPECT_EQ(second.conn->out, "unwritten");
+  EXPECT_EQ(server_.chat_dropped(), 1u);
+}
+
+TEST_F(ServerTest, WatchersGetTheTableLateWithHoleCards) {
+  server_.enable_broadcast(std::chrono::milliseconds{20}, 64 * 1024);
+  auto first = connect();
+  auto second = connect();
+  auto watcher = connect();
+  ASSERT_TRUE(first.result && second.result && watcher.result);
+  const auto table = first.result->table;
+  ::poker::v1::Action a;
+  a.set_table_id(table);
+  a.mutable_watch();
+  // a seat at the table rules out watching it
+  EXPECT_FALSE(server_.apply_action(a, watcher.conn->player_id));
+  ::poker::v1::Action leave;
+  leave.set_table_id(table);
+  leave.mutable_leave();
+  ASSERT_TRUE(server_.apply_action(leave, watcher.conn->player_id));
+  ASSERT_TRUE(server_.apply_action(a, watcher.conn->player_id));
+  server_.flush_pending();
+  for (int peer : peers_) {
+    frames(peer);
+  }
+
+  auto started = server_.maybe_start_hand(table);
+  ASSERT_TRUE(started);
+  server_.push_table(table, Outbound{*started});
+  server_.release_broadcasts();
+  server_.flush_pending();
+  EXPECT_TRUE(frames(peers_[2]).empty()); // not yet
+  auto holes = [](const std::vector<::poker::v1::Response> &got) {
+    int n = 0;
+    for (const auto &res : got) {
+      for (const auto &msg : res.messages()) {
+        n += msg.has_event() && msg.event().has_dealt_hole();
+      }
+    }
+    return n;
+  };
+  EXPECT_EQ(holes(frames(peers_[0])), 1);
+
+  std::this_thread::sleep_for(std::chrono::milliseconds{30});
+  server_.release_broadcasts();
+  server_.flush_pending();
+  const auto late = frames(peers_[2]);
+  ASSERT_EQ(late.size(), 1u);
+  EXPECT_EQ(late[0].messages(0).table_id(), table);
+  EXPECT_EQ(holes(late), 2);
+}
+
+TEST_F(ServerTest, LeaderboardPagesComeFromTheCache) {
+  auto first = connect();
+  ASSERT_TRUE(first.result);
+  server_.flush_pending();
+  frames(peers_[0]);
+
+  ::poker::v1::Action a;
+  a.mutable_leaderboard()->set_board(
+      ::poker::v1::Action::Leaderboard::BOARD_HANDS);
+  const auto res = server_.apply_action(a, first.conn->player_id);
+  ASSERT_TRUE(res);
+  EXPECT_TRUE(res->events.empty());
+  server_.flush_pending();
+  const auto got = frames(peers_[0]);
+  ASSERT_EQ(got.size(), 1u);
+  ASSERT_EQ(got[0].messages_size(), 1);
+  const auto &page = got[0].messages(0).leaderboard();
+  EXPECT_EQ(page.board(), ::poker::v1::Action::Leaderboard::BOARD_HANDS);
+  EXPECT_EQ(page.players(), 0u); // nobody has finished a hand
+  EXPECT_EQ(page.entries_size(), 0);
+}
+
+TEST_F(ServerTest, LeaderboardLeavesHouseBotsOut) {
+  auto c = connect();
+  ASSERT_TRUE(c.result);
+  const auto pid = c.conn->player_id;
+  const auto table = c.result->table;
+  const auto started = server_.maybe_start_hand(table); // seats a house bot
+  ASSERT_TRUE(started);
+  server_.push_table(table, Outbound{*started});
+  const auto bot = std::ranges::find_if(*started, [&](const auto &ev) {
+    const auto *added = std::get_if<poker::PlayerAdded>(&ev);
+    return added && added->who != pid;
+  });
+  ASSERT_NE(bot, started->end());
+  const auto bot_id = std::get<poker::PlayerAdded>(*bot).who;
+
+  ::poker::v1::Action fold;
+  fold.mutable_fold();
+  fold.set_table_id(table);
+  const auto folded = server_.apply_action(fold, pid);
+  ASSERT_TRUE(folded);
+  server_.push_table(table, Outbound{folded->events});
+
+  // the boards are updated off the game thread
+  const auto &board = server_.leaderboard();
+  for (int i = 0; i < 100 && !board.rank(poker::Board::hands, pid); ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds{10});
+  }
+  EXPECT_EQ(board.rank(poker::Board::hands, pid), 1u);
+  EXPECT_FALSE(board.rank(poker::Board::hands, bot_id));
+}
+
+TEST_F(ServerTest, FastFoldDealsFromThePoolAndTimesOut) {
+  ::poker::v1::Action pool;
+  pool.mutable_join()->set_fast_fold(true);
+  std::vector<poker::PlayerId> players;
+  for (int i = 0; i < 6; ++i) {
+    auto c = connect();
+    ASSERT_TRUE(c.result);
+    players.push_back(c.conn->player_id);
+    const auto joined = server_.apply_action(pool, players.back());
+    ASSERT_TRUE(joined);
+    EXPECT_TRUE(joined->events.empty());
+  }
+  EXPECT_FALSE(server_.apply_action(pool, players[0])); // already in
+
+  // the sixth fills a hand, which each player hears about under its id
+  server_.flush_pending();
+  uint64_t hand = 0;
+  poker::PlayerId actor = 0;
+  for (std::size_t i = 0; i < peers_.size(); ++i) {
+    const auto got = frames(peers_[i]);
+    std::tie(hand, actor) = last_turn(got);
+    int holes = 0;
+    for (const auto &res : got) {
+      for (const auto &msg : res.messages()) {
+        if (msg.hand_id() == hand && msg.event().has_dealt_hole()) {
+          EXPECT_EQ(msg.event().dealt_hole().who(), players[i]);
+          ++holes;
+        }
+      }
+    }
+    EXPECT_EQ(holes, 1) << "player " << players[i];
+  }
+  ASSERT_NE(hand, 0u);
+  const auto peer_of = [&](poker::PlayerId who) {
+    return peers_[static_cast<std::size_t>(std::ranges::find(players, who) -
+                                           players.begin())];
+  };
+
+  // the player on the clock folds and is back in the pool at once
+  ::poker::v1::Action fold;
+  fold.mutable_fold();
+  fold.set_hand_id(hand);
+  ASSERT_TRUE(server_.apply_action(fold, actor));
+  EXPECT_EQ(server_.apply_action(fold, actor).error(),
+            poker::Error{poker::ServerError::illegal_action});
+  const auto watcher = actor == players[0] ? players[1] : players[0];
+  server_.flush_pending();
+  const auto next = last_turn(frames(peer_of(watcher))).second;
+  ASSERT_NE(next, 0u);
+  EXPECT_NE(next, actor);
+
+  // one clock runs for every hand, and does nothing before a turn is due;
+  // the next one never acts, so the clock acts for them
+  ASSERT_TRUE(server_.take_pool_clock());
+  EXPECT_FALSE(server_.take_pool_clock()); // already running
+  EXPECT_TRUE(server_.time_out_pool_turns());
+  server_.flush_pending();
+  EXPECT_TRUE(frames(peer_of(watcher)).empty());
+  io_.ahead += std::chrono::seconds{16};
+  EXPECT_TRUE(server_.time_out_pool_turns()); // the next turn's
+  server_.flush_pending();
+  const auto after = last_turn(frames(peer_of(watcher))).second;
+  ASSERT_NE(after, 0u);
+  EXPECT_NE(after, next);
+
+  // the folder walks away from the pool
+  ::poker::v1::Action leave;
+  leave.mutable_leave()->set_fast_fold(true);
+  ASSERT_TRUE(server_.apply_action(leave, actor));
+  server_.flush_pending();
+  bool removed = false;
+  for (const auto &res : frames(peer_of(actor))) {
+    for (const auto &msg : res.messages()) {
+      removed |= msg.event().player_removed().who() == actor;
+    }
+  }
+  EXPECT_TRUE(removed);
+
+  // a player who goes away on the clock is timed out at once, and so is
+  // one who comes on the clock after going; the hand runs on without the
+  // clock until the one left has to act, or is through
+  std::vector<poker::PlayerId> in_hand;
+  std::ranges::copy_if(players, std::back_inserter(in_hand),
+                       [&](poker::PlayerId p) {
+                         return p != actor && p != next && p != after;
+                       });
+  server_.handle_close(after);
+  server_.flush_pending();
+  const auto now_on = last_turn(frames(peer_of(in_hand[0]))).second;
+  ASSERT_NE(now_on, 0u);
+  EXPECT_NE(now_on, after);
+  // seats go in joining order, so `gone` acts between now_on and stays
+  const auto at = static_cast<std::size_t>(std::ranges::find(in_hand, now_on) -
+                                           in_hand.begin());
+  ASSERT_LT(at, in_hand.size());
+  const auto gone = in_hand[(at + 1) % in_hand.size()];
+  const auto stays = in_hand[(at + 2) % in_hand.size()];
+  frames(peer_of(stays));
+  server_.handle_close(gone);
+  server_.handle_close(now_on);
+  server_.flush_pending();
+  poker::PlayerId waiting = 0;
+  bool won = false;
+  for (const auto &res : frames(peer_of(stays))) {
+    for (const auto &msg : res.messages()) {
+      if (msg.hand_id() != hand) {
+        continue;
+      }
+      if (msg.event().has_turn_advanced()) {
+        waiting = msg.event().turn_advanced().next();
+      }
+      won |= msg.event().has_won_pot();
+    }
+  }
+  EXPECT_TRUE(won || waiting == stays);
+}
+
+TEST_F(ServerTest, FastFoldHandsAreJournaledAndRecorded) {
+  const auto log = scratch_file("fast_fold.hlog");
+  const auto state = scratch_file("fast_fold.state");
+  ASSERT_TRUE(server_.enable_hand_log(log));
+  ASSERT_TRUE(server_.enable_live_state(state));
+  ::poker::v1::Action pool;
+  pool.mutable_join()->set_fast_fold(true);
+  std::vector<poker::PlayerId> players;
+  for (int i = 0; i < 6; ++i) {
+    auto c = connect();
+    ASSERT_TRUE(c.result);
+    players.push_back(c.conn->player_id);
+    ASSERT_TRUE(server_.apply_action(pool, players.back()));
+  }
+
+  // nobody acts, so the clock plays each hand out and the table deals the
+  // next to the same six
+  for (int i = 0; i < 40 && server_.stats().line(players[0]).hands < 2;
+       ++i) {
+    io_.ahead += std::chrono::seconds{16};
+    server_.time_out_pool_turns();
+  }
+  for (const auto p : players) {
+    EXPECT_EQ(server_.stats().line(p).hands, 2u) << "player " << p;
+  }
+
+  // the summary starts over with each hand rather than piling up seats
+  auto reader = live::Reader::open(state);
+  ASSERT_TRUE(reader);
+  const auto summaries = reader->snapshot();
+  const auto summary = std::ranges::find_if(
+      summaries, [](const auto &s) { return poker::is_pool_table(s.table); });
+  ASSERT_NE(summary, summaries.end());
+  EXPECT_EQ(summary->hands, 3u);
+  EXPECT_EQ(summary->seated, 6);
+
+  // the journal replays the pooled table through both hands and clears;
+  // it is written off the game thread, so it may be read mid-write
+  server_.flush_logs();
+  std::vector<poker::TableLog> tables;
+  for (int i = 0; i < 100; ++i) {
+    const auto read = poker::read_hand_log(log);
+    if (read && std::ranges::count_if(*read, [](const poker::TableLog &t) {
+          return std::ranges::count(t.inputs, poker::InputTag::new_hand,
+                                    &poker::InputRecord::tag) == 3;
+        }) == 1) {
+      tables = *read;
+      break;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds{10});
+  }
+  ASSERT_FALSE(tables.empty());
+  const auto report = poker::audit(tables, 1);
+  EXPECT_EQ(report.hands, 3u);
+  for (const auto &t : tables) {
+    EXPECT_EQ(std::ranges::count(t.inputs, poker::InputTag::clear,
+                                 &poker::InputRecord::tag),
+              poker::is_pool_table(t.table) ? 2 : 0);
+  }
+  for (const auto &f : report.findings) {
+    ADD_FAILURE() << "table " << f.table << " hand " << f.hand << ": "
+                  << poker::to_string(f.check) << ": " << f.detail;
+  }
+  std::filesystem::remove(log);
+  std::filesystem::remove(state);
+}
+
+TEST_F(ServerTest, EncodedBroadcastsKeepTheirOrder) {
+  server_.enable_encoders(2);
+  auto first = connect();
+  auto second = connect();
+  ASSERT_TRUE(first.result && second.result);
+  server_.flush_pending();
+  for (int peer : peers_) {
+    frames(peer); // the Welcomes
+  }
+  const auto table = first.result->table;
+  server_.push_table(table, Outbound{second.result->events});
+  auto started = server_.maybe_start_hand(table);
+  ASSERT_TRUE(started);
+  server_.push_table(table, Outbound{*started});
+  // queued behind the broadcasts still with the encoders
+  server_.push_one(first.conn->player_id,
+                   Outbound{poker::Error{poker::GameError::out_of_turn}},
+                   table);
+  server_.flush_pending();
+
+  const auto got = frames(peers_[0]);
+  ASSERT_EQ(got.size(), 1u);
+  const auto &msgs = got[0].messages();
+  ASSERT_GT(msgs.size(), 2);
+  EXPECT_TRUE(msgs[0].event().has_player_added());
+  EXPECT_TRUE(msgs[msgs.size() - 1].has_error());
+  int holes = 0;
+  for (const auto &msg : msgs) {
+    if (msg.event().has_dealt_hole()) {
+      ++holes;
+      EXPECT_EQ(msg.event().dealt_hole().who(), first.conn->player_id);
+    }
+  }
+  EXPECT_EQ(holes, 1);
+  EXPECT_EQ(first.conn->encoding, 0u);
+}
+
+TEST_F(ServerTest, ClosingDrainsTheConnectionsBatches) {
+  server_.enable_encoders(2);
+  auto first = connect();
+  auto second = connect();
+  ASSERT_TRUE(first.result && second.result);
+  server_.flush_pending();
+  const auto mine = welcome(frames(peers_[0]));
+  ASSERT_TRUE(mine);
+  const auto table = first.result->table;
+  auto started = server_.maybe_start_hand(table);
+  ASSERT_TRUE(started);
+  server_.push_table(table, Outbound{*started});
+  const auto gone = first.conn->player_id;
+  ASSERT_NE(first.conn->encoding, 0u);
+  server_.handle_close(gone);
+
+  // the old connection's hole cards must not reach the new one
+  auto third = connect();
+  ASSERT_TRUE(third.result);
+  ::poker::v1::Action resume;
+  resume.mutable_resume()->set_player(gone);
+  resume.mutable_resume()->set_token(mine->token());
+  ASSERT_TRUE(server_.resume(third.conn->player_id, resume.resume()));
+  server_.flush_pending();
+  EXPECT_EQ(third.conn->encoding, 0u);
+  for (const auto &res : frames(peers_[2])) {
+    for (const auto &msg : res.messages()) {
+      EXPECT_FALSE(msg.event().has_hand_started());
+    }
+  }
+}
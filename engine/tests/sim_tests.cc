@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+#include <string>
+
+#include "sim.h"
+
+namespace {
+
+auto small(uint64_t seed) -> sim::Scenario {
+  sim::Scenario sc;
+  sc.seed = seed;
+  sc.clients = 30;
+  sc.duration = std::chrono::seconds{20};
+  return sc;
+}
+
+} // namespace
+
+TEST(Network, DeliversInOrderAfterLatency) {
+  sim::Faults faults;
+  faults.max_write = 3;
+  sim::Network net(1, faults);
+  const int epfd = net.epoll_create();
+  const int lfd = net.listen();
+  epoll_event ev{};
+  ev.events = EPOLLIN | EPOLLET;
+  ASSERT_EQ(net.epoll_ctl(epfd, EPOLL_CTL_ADD, lfd, &ev), 0);
+
+  const int client = net.connect(lfd);
+  EXPECT_EQ(net.accept(lfd), -1);
+  EXPECT_EQ(errno, EAGAIN);
+  epoll_event got[4];
+  const auto before = net.now();
+  ASSERT_EQ(net.epoll_wait(epfd, got, 4, -1), 1);
+  EXPECT_GT(net.now(), before);
+  const int server = net.accept(lfd);
+  ASSERT_GE(server, 0);
+
+  // short writes: the caller loops, the bytes arrive whole and in order
+  const std::string msg = "hello, simulated world";
+  for (std::size_t off = 0; off < msg.size();) {
+    const auto w = net.write(client, msg.data() + off, msg.size() - off);
+    ASSERT_GT(w, 0);
+    ASSERT_LE(w, 3);
+    off += static_cast<std::size_t>(w);
+  }
+  ev.events = EPOLLIN | EPOLLET;
+  ASSERT_EQ(net.epoll_ctl(epfd, EPOLL_CTL_ADD, server, &ev), 0);
+  std::string rx;
+  char buf[64];
+  while (rx.size() < msg.size()) {
+    net.epoll_wait(epfd, got, 4, -1);
+    for (ssize_t r; (r = net.read(server, buf, sizeof(buf))) > 0;) {
+      rx.append(buf, static_cast<std::size_t>(r));
+    }
+  }
+  EXPECT_EQ(rx, msg);
+
+  net.close(client);
+  net.epoll_wait(epfd, got, 4, -1);
+  EXPECT_EQ(net.read(server, buf, sizeof(buf)), 0);
+}
+
+TEST(Network, ResetSurfacesAsError) {
+  sim::Network net(2);
+  const int epfd = net.epoll_create();
+  const int lfd = net.listen();
+  epoll_event ev{};
+  ev.events = EPOLLIN | EPOLLET;
+  net.epoll_ctl(epfd, EPOLL_CTL_ADD, lfd, &ev);
+  const int client = net.connect(lfd);
+  epoll_event got[4];
+  net.epoll_wait(epfd, got, 4, -1);
+  const int server = net.accept(lfd);
+  net.epoll_ctl(epfd, EPOLL_CTL_ADD, server, &ev);
+  net.epoll_wait(epfd, got, 4, 0);
+
+  net.reset(client);
+  ASSERT_EQ(net.epoll_wait(epfd, got, 4, -1), 1);
+  EXPECT_TRUE(got[0].events & EPOLLERR);
+  char buf[8];
+  EXPECT_EQ(net.read(server, buf, sizeof(buf)), -1);
+  EXPECT_EQ(errno, ECONNRESET);
+}
+
+TEST(Simulation, SameSeedReplaysExactly) {
+  const auto a = sim::run(small(7));
+  const auto b = sim::run(small(7));
+  EXPECT_TRUE(a.failures.empty());
+  EXPECT_GT(a.actions, 0u);
+  EXPECT_EQ(a.trace, b.trace);
+  EXPECT_EQ(a.frames, b.frames);
+  EXPECT_EQ(a.p99, b.p99);
+
+  EXPECT_NE(sim::run(small(8)).trace, a.trace);
+}
+
+TEST(Simulation, SurvivesShortIoAndDisconnects) {
+  for (uint64_t seed = 1; seed <= 5; ++seed) {
+    auto sc = small(seed);
+    sc.faults.max_read = 5;
+    sc.faults.max_write = 5;
+    sc.drop_rate = 0.5;
+    sc.join_rate = 0.5;
+    const auto report = sim::run(sc);
+    for (const auto &f : report.failures) {
+      ADD_FAILURE() << "seed " << seed << ": " << f;
+    }
+    EXPECT_EQ(report.leaked, 0u) << "seed " << seed;
+    EXPECT_GT(report.drops, 0u);
+  }
+}
@@ -0,0 +1,177 @@
+#include <gtest/gtest.h>
+#include <deque>
+#include <map>
+#include <random>
+#include <variant>
+#include <vector>
+
+#include "table_batch.h"
+
+using namespace poker;
+
+namespace {
+
+constexpr Chips kStack = 400;
+
+// A Table playing the same game as one slot of a batch: players 1..seats in
+// seats 0.., rebuying to kStack between hands.
+struct Mirror {
+  explicit Mirror(uint64_t seed) : rng(seed), table(rng) {}
+
+  auto start(std::size_t seats) -> std::vector<Event> {
+    for (PlayerId id = 1; id <= seats; ++id) {
+      (void)table.remove_player(id);
+      EXPECT_TRUE(table.add_player(id, kStack));
+      chips[id] = kStack;
+    }
+    board.clear();
+    auto events = table.handle_new_hand();
+    EXPECT_TRUE(events);
+    track(*events);
+    return *events;
+  }
+
+  void track(const std::vector<Event> &events) {
+    for (const auto &ev : events) {
+      if (const auto *c = std::get_if<PlayerChips>(&ev)) {
+        chips[c->who] = c->chips;
+      } else if (const auto *t = std::get_if<TurnAdvanced>(&ev)) {
+        turn = t->next;
+      } else if (const auto *f = std::get_if<DealtFlop>(&ev)) {
+        for (const auto card : f->flop) {
+          board.push_back(cards::to_card_id(card));
+        }
+      } else if (const auto *st = std::get_if<DealtStreet>(&ev)) {
+        board.push_back(cards::to_card_id(st->street));
+      }
+    }
+  }
+
+  std::mt19937_64 rng;
+  Table table;
+  std::map<PlayerId, Chips> chips;
+  PlayerId turn{0};
+  std::vector<cards::CardId> board;
+};
+
+// The batch's view of game `g` against its mirror's.
+void expect_same(const TableBatch &batch, std::size_t g, Mirror &m,
+                 const std::vector<Event> &dealt) {
+  const auto seats = batch.seats();
+  ASSERT_TRUE(m.table.hand_in_progress());
+  EXPECT_EQ(batch.to_act()[g] + 1u, m.turn);
+  for (const auto &ev : dealt) {
+    if (const auto *d = std::get_if<DealtHole>(&ev)) {
+      const auto at = ((g * seats) + d->who - 1) * kHoleSize;
+      EXPECT_EQ(batch.holes()[at], cards::to_card_id(d->hole[0]));
+      EXPECT_EQ(batch.holes()[at + 1], cards::to_card_id(d->hole[1]));
+    }
+  }
+  for (PlayerId id = 1; id <= seats; ++id) {
+    EXPECT_EQ(batch.stacks()[g * seats + id - 1], m.chips[id]);
+  }
+  for (std::size_t i = 0; i < kBoardSize; ++i) {
+    EXPECT_EQ(batch.board()[g * kBoardSize + i],
+              i < m.board.size() ? m.board[i] : kHiddenCard);
+  }
+  const auto view = m.table.seat_view(m.turn);
+  ASSERT_TRUE(view);
+  EXPECT_EQ(batch.phase()[g], view->phase);
+  EXPECT_EQ(batch.to_call(g), view->to_call);
+  EXPECT_EQ(batch.min_raise()[g], view->min_raise);
+}
+
+} // namespace
+
+TEST(TableBatch, FoldPaysTheBlinds) {
+  TableBatch batch(2, 3, kStack);
+  // 3-handed the button is first to act preflop, then the small blind
+  EXPECT_EQ(batch.to_act()[0], 0u);
+  EXPECT_EQ(batch.pot()[1], kSmallBlind + kBigBlind);
+  const std::vector<Move> folds(2, Move::fold);
+  const std::vector<Chips> none(2, 0);
+  batch.step(folds, none);
+  EXPECT_EQ(batch.to_act()[0], 1u);
+  batch.step(folds, none);
+  EXPECT_EQ(batch.done()[0], 1);
+  EXPECT_EQ(batch.rewards()[1], -static_cast<int64_t>(kSmallBlind));
+  EXPECT_EQ(batch.rewards()[2], static_cast<int64_t>(kSmallBlind));
+  EXPECT_EQ(batch.hands_played(), 2u);
+  // the next hand is dealt with the button moved on
+  EXPECT_EQ(batch.button()[0], 1u);
+  EXPECT_EQ(batch.stacks()[1], kStack);
+  EXPECT_EQ(batch.stacks()[2], kStack - kSmallBlind);
+  EXPECT_EQ(batch.board()[0], kHiddenCard);
+
+  const std::vector<Move> bets(2, Move::bet);
+  const std::vector<Chips> short_raise(2, kBigBlind + 1);
+  batch.step(bets, short_raise);
+  EXPECT_EQ(batch.rejected()[0], 1);
+  EXPECT_EQ(batch.to_act()[0], 1u);
+}
+
+// Random play, including refused and all-in bets, against a Table per game.
+TEST(TableBatch, PlaysLikeATable) {
+  constexpr std::size_t kGames = 24;
+  for (const std::size_t seats : {2u, 3u, 6u}) {
+    SCOPED_TRACE(seats);
+    constexpr uint64_t kSeed = 40;
+    TableBatch batch(kGames, seats, kStack, kSeed);
+    std::deque<Mirror> mirrors;
+    for (std::size_t g = 0; g < kGames; ++g) {
+      const auto dealt = mirrors.emplace_back(kSeed + g).start(seats);
+      expect_same(batch, g, mirrors[g], dealt);
+    }
+    std::mt19937_64 rolls(seats);
+    std::vector<Move> moves(kGames);
+    std::vector<Chips> amounts(kGames);
+    uint64_t showdowns = 0;
+    for (int step = 0; step < 1500; ++step) {
+      for (std::size_t g = 0; g < kGames; ++g) {
+        const auto seat = g * seats + batch.to_act()[g];
+        const auto call = batch.to_call(g);
+        const auto roll = rolls() % 10;
+        moves[g] = roll == 0 ? Move::fold : Move::bet;
+        amounts[g] = roll == 1   ? rolls() % (batch.stacks()[seat] + 1)
+                     : roll == 2 ? batch.stacks()[seat]
+                     : roll == 3 ? call + batch.min_raise()[g]
+                     : roll == 4 ? call + 1
+                                 : call;
+      }
+      batch.step(moves, amounts);
+      for (std::size_t g = 0; g < kGames; ++g) {
+        auto &m = mirrors[g];
+        const auto actor = m.turn;
+        const auto res =
+            moves[g] == Move::fold
+                ? m.table.on_action(Fold{actor})
+                : m.table.on_action(Bet{actor, amounts[g]});
+        ASSERT_EQ(batch.rejected()[g] != 0, !res) << "game " << g;
+        if (!res) {
+          EXPECT_EQ(res.error(), GameError::bet_too_low);
+          continue;
+        }
+        m.track(*res);
+        ASSERT_EQ(batch.done()[g] != 0, !m.table.hand_in_progress())
+            << "game " << g;
+        if (!batch.done()[g]) {
+          expect_same(batch, g, m, {});
+          continue;
+        }
+        for (const auto &ev : *res) {
+          showdowns += std::holds_alternative<ShowdownHand>(ev);
+        }
+        for (PlayerId id = 1; id <= seats; ++id) {
+          EXPECT_EQ(batch.rewards()[g * seats + id - 1],
+                    static_cast<int64_t>(m.chips[id]) -
+                        static_cast<int64_t>(kStack));
+        }
+        const auto dealt = m.start(seats);
+        expect_same(batch, g, m, dealt);
+      }
+      ASSERT_FALSE(HasFatalFailure());
+    }
+    EXPECT_GT(batch.hands_played(), 500u);
+    EXPECT_GT(showdowns, 100u);
+  }
+}
@@ -49,6 +49,7 @@ TEST(Table, HeadsUpBlindsAndTurn) {
 
   ASSERT_TRUE(table.add_player(1));
   ASSERT_TRUE(table.add_player(2));
+  EXPECT_FALSE(table.on_clock());
 
   auto start = table.handle_new_hand();
   ASSERT_TRUE(start.has_value());
@@ -63,6 +64,7 @@ TEST(Table, HeadsUpBlindsAndTurn) {
   auto turns = collect<TurnAdvanced>(*start);
   ASSERT_EQ(turns.size(), 1u);
   EXPECT_EQ(turns[0].next, 1u);
+  EXPECT_EQ(table.on_clock(), 1u);
 }
 
 TEST(Table, TimeoutFoldsWhenBehind) {
@@ -199,6 +201,26 @@ TEST(Table, RemovePlayerOnTurnAdvancesGame) {
   EXPECT_TRUE(res.has_value());
 }
 
+TEST(Table, RemovingLastOpponentAwardsPot) {
+  std::mt19937_64 rng(0);
+  Table table(rng);
+
+  ASSERT_TRUE(table.add_player(1));
+  ASSERT_TRUE(table.add_player(2));
+
+  auto start = table.handle_new_hand();
+  ASSERT_TRUE(start.has_value());
+
+  // heads-up: player 1 is the small blind, so player 2 keeps the blinds
+  auto removed = table.remove_player(1);
+  ASSERT_TRUE(removed.has_value());
+  auto wins = collect<WonPot>(*removed);
+  ASSERT_EQ(wins.size(), 1u);
+  EXPECT_EQ(wins[0].who, 2u);
+  EXPECT_EQ(wins[0].amount, kSmallBlind + kBigBlind);
+  EXPECT_FALSE(table.hand_in_progress());
+}
+
 TEST(Table, RemovePlayerOffTurnStillAllowsProgress) {
   std::mt19937_64 rng(0);
   Table table(rng);
@@ -220,3 +242,42 @@ TEST(Table, RemovePlayerOffTurnStillAllowsProgress) {
   ASSERT_EQ(wins.size(), 1u);
   EXPECT_EQ(wins[0].who, 3u);
 }
+
+TEST(Table, LastToActLeavingEndsTheStreet) {
+  std::mt19937_64 rng(0);
+  Table table(rng);
+
+  ASSERT_TRUE(table.add_player(1));
+  ASSERT_TRUE(table.add_player(2));
+  ASSERT_TRUE(table.add_player(3));
+  ASSERT_TRUE(table.handle_new_hand());
+
+  // everyone limps; the big blind leaves with the option
+  ASSERT_TRUE(table.on_action(Bet{1, kBigBlind}));
+  ASSERT_TRUE(table.on_action(Bet{2, kBigBlind - kSmallBlind}));
+  auto removed = table.remove_player(3);
+  ASSERT_TRUE(removed.has_value());
+  EXPECT_EQ(collect<DealtFlop>(*removed).size(), 1u);
+  auto turns = collect<TurnAdvanced>(*removed);
+  ASSERT_EQ(turns.size(), 1u);
+  EXPECT_EQ(turns[0].next, 2u);
+
+  // the rest of the hand plays out and the blind stays in the pot
+  std::vector<WonPot> wins;
+  for (PlayerId next = 2; table.hand_in_progress();) {
+    auto res = table.on_action(Bet{next, 0});
+    ASSERT_TRUE(res.has_value());
+    for (const auto &t : collect<TurnAdvanced>(*res)) {
+      next = t.next;
+    }
+    for (const auto &w : collect<WonPot>(*res)) {
+      wins.push_back(w);
+    }
+  }
+  Chips paid = 0;
+  for (const auto &w : wins) {
+    paid += w.amount;
+  }
+  EXPECT_EQ(paid, 3 * kBigBlind);
+  EXPECT_TRUE(table.handle_new_hand());
+}
@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+#include "deck.h"
+#include "proto_translate.h"
+#include "response.pb.h"
+#include "wire_writer.h"
+
+using namespace poker;
+
+namespace {
+
+// What the protobuf library writes for the same events.
+auto reference(const std::vector<Event> &events, TableId table,
+               uint64_t hand = 0) -> std::string {
+  ::poker::v1::Response res;
+  for (const auto &ev : events) {
+    auto *msg = res.add_messages();
+    *msg->mutable_event() = to_proto_event(ev);
+    msg->set_table_id(table);
+    msg->set_hand_id(hand);
+  }
+  return res.SerializeAsString();
+}
+
+auto written(const std::vector<Event> &events, TableId table,
+             uint64_t hand = 0) -> std::string {
+  std::string out;
+  for (const auto &ev : events) {
+    wire::append_event(out, ev, table, hand);
+  }
+  return out;
+}
+
+auto card(cards::CardId id) -> cards::Card { return cards::from_card_id(id); }
+
+} // namespace
+
+TEST(WireWriter, MatchesSerializeForEveryEvent) {
+  const std::vector<Event> events{
+      PlayerAdded{7},
+      PlayerRemoved{300},
+      BetPlaced{1, 10},
+      TurnAdvanced{2},
+      PhaseAdvanced{Phase::flop},
+      WonPot{3, 1234},
+      PlayerChips{4, 0}, // zero chips leave the field out
+      HandStarted{},
+      DealtHole{5, {card(0), card(51)}},
+      DealtFlop{{card(12), card(13), card(26)}},
+      DealtStreet{card(39)},
+      ShowdownHand{6, {card(1), card(2)}},
+  };
+  for (const TableId table : {TableId{0}, TableId{1}, TableId{1} << 40}) {
+    for (const auto &ev : events) {
+      EXPECT_EQ(written({ev}, table), reference({ev}, table))
+          << "event " << ev.index() << " table " << table;
+    }
+    EXPECT_EQ(written(events, table), reference(events, table));
+  }
+  // fast-fold hands are tagged by hand rather than table
+  for (const uint64_t hand : {uint64_t{1}, (uint64_t{3} << 24) | 5}) {
+    EXPECT_EQ(written(events, 0, hand), reference(events, 0, hand));
+  }
+}
+
+TEST(WireWriter, MatchesSerializeForEveryCardAndLargeValues) {
+  for (cards::CardId id = 0; id < kDeckSize; ++id) {
+    const Event ev = DealtStreet{card(id)};
+    EXPECT_EQ(written({ev}, 9), reference({ev}, 9)) << "card " << id;
+  }
+  for (const uint64_t v : {uint64_t{127}, uint64_t{128}, uint64_t{1} << 35,
+                           ~uint64_t{0}}) {
+    const std::vector<Event> events{BetPlaced{v, v}, PlayerChips{v, v}};
+    EXPECT_EQ(written(events, v), reference(events, v)) << v;
+  }
+}
@@ -0,0 +1,88 @@
+// Builds the preflop equity file that EquityTable maps:
+//
+//   equity_gen [-j threads] <out> [samples per entry]
+//   equity_gen --show <file> [players]
+//
+// Every class is run against 1..9 random hands and heads-up against every
+// other class. The default 20k samples per entry puts the standard error
+// under 0.4%; the output is the same for any thread count. --show prints
+// the 13x13 grid against `players - 1` random hands (default 2).
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+
+#include "equity_table.h"
+
+namespace {
+
+int usage(const char *argv0) {
+  std::fprintf(stderr,
+               "usage: %s [-j threads] <out> [samples per entry]\n"
+               "       %s --show <file> [players]\n",
+               argv0, argv0);
+  return 2;
+}
+
+int show(const char *path, std::size_t players) {
+  auto table = poker::EquityTable::open(path);
+  if (!table) {
+    const auto err = poker::to_string(table.error());
+    std::fprintf(stderr, "cannot open %s: %.*s\n", path,
+                 static_cast<int>(err.size()), err.data());
+    return 2;
+  }
+  if (players < poker::kMinPlayers || players > kMaxPlayers) {
+    std::fprintf(stderr, "players must be %zu..%zu\n", poker::kMinPlayers,
+                 kMaxPlayers);
+    return 2;
+  }
+  // aces first, like a range chart
+  for (std::size_t r = poker::kRanks; r-- > 0;) {
+    for (std::size_t c = poker::kRanks; c-- > 0;) {
+      const auto cls = static_cast<uint8_t>(r * poker::kRanks + c);
+      std::printf("%4s %4.1f ", poker::class_name(cls).c_str(),
+                  100 * table->vs_random(cls, players));
+    }
+    std::printf("\n");
+  }
+  std::printf("%u samples per entry\n", table->samples());
+  return 0;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  if (argc >= 3 && std::string_view(argv[1]) == "--show") {
+    return show(argv[2], argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 2);
+  }
+  poker::EquityOptions opts;
+  int arg = 1;
+  if (arg + 1 < argc && std::string_view(argv[arg]) == "-j") {
+    opts.threads = static_cast<unsigned>(std::atoi(argv[arg + 1]));
+    arg += 2;
+  }
+  if (arg >= argc) {
+    return usage(argv[0]);
+  }
+  const char *out = argv[arg];
+  if (arg + 1 < argc) {
+    opts.samples = static_cast<uint32_t>(std::strtoul(argv[arg + 1], nullptr,
+                                                      10));
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  if (auto written = poker::write_equity_tables(out, opts); !written) {
+    const auto err = poker::to_string(written.error());
+    std::fprintf(stderr, "cannot write %s: %.*s\n", out,
+                 static_cast<int>(err.size()), err.data());
+    return 1;
+  }
+  const double secs = std::chrono::duration<double>(
+                          std::chrono::steady_clock::now() - start)
+                          .count();
+  std::printf("wrote %s: %u samples per entry in %.1fs\n", out, opts.samples,
+              secs);
+  return 0;
+}
@@ -0,0 +1,58 @@
+// Runs the reference query over a hand-history store and reports how long
+// the scan took:
+//
+//   hh_query <root> [showdown] [threads]
+//
+// prints the 20 biggest winners by net chips per 100 hands.
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string_view>
+
+#include "column_store.h"
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    std::fprintf(stderr, "usage: %s <root> [showdown] [threads]\n", argv[0]);
+    return 2;
+  }
+  const uint8_t flags =
+      argc > 2 && std::string_view(argv[2]) == "showdown" ? poker::kShowdown
+                                                           : 0;
+  const unsigned threads =
+      argc > 3 ? static_cast<unsigned>(std::atoi(argv[3])) : 0;
+
+  const auto start = std::chrono::steady_clock::now();
+  const auto parts = hhstore::list_parts(argv[1]);
+  auto results = hhstore::player_results(parts, flags, threads);
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+  if (!results) {
+    std::fprintf(stderr, "query failed: %s\n",
+                 hhstore::to_string(results.error()).data());
+    return 1;
+  }
+
+  uint64_t rows = 0;
+  for (const auto &r : *results) {
+    rows += r.hands;
+  }
+  auto per_100 = [](const hhstore::PlayerResult &r) {
+    return static_cast<double>(r.net) * 100.0 / static_cast<double>(r.hands);
+  };
+  std::sort(results->begin(), results->end(),
+            [&](const auto &a, const auto &b) {
+              return per_100(a) > per_100(b);
+            });
+  for (std::size_t i = 0; i < std::min<std::size_t>(20, results->size()); ++i) {
+    const auto &r = (*results)[i];
+    std::printf("%10llu %12llu hands %12.1f chips/100\n",
+                static_cast<unsigned long long>(r.player),
+                static_cast<unsigned long long>(r.hands), per_100(r));
+  }
+  const double secs = std::chrono::duration<double>(elapsed).count();
+  std::printf("%zu parts, %llu rows, %zu players in %.3f s (%.1f M rows/s)\n",
+              parts.size(), static_cast<unsigned long long>(rows),
+              results->size(), secs, static_cast<double>(rows) / secs / 1e6);
+  return 0;
+}
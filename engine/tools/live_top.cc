@@ -0,0 +1,92 @@
+// Prints the live state of every table on a server started with
+// POKER_LIVE_STATE:
+//
+//   live_top <state file> [refresh ms]
+//
+// One line per table: hand number, street, pot, the player on the clock,
+// the board and each seat as player:stack, with its bet this street in
+// brackets. With a refresh interval it redraws until interrupted. Reading
+// never touches the server.
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+#include "deck.h"
+#include "live_state.h"
+
+namespace {
+
+auto phase_name(poker::Phase p) -> const char * {
+  switch (p) {
+  case poker::Phase::holding:
+    return "-";
+  case poker::Phase::preflop:
+    return "preflop";
+  case poker::Phase::flop:
+    return "flop";
+  case poker::Phase::turn:
+    return "turn";
+  case poker::Phase::river:
+    return "river";
+  case poker::Phase::showdown:
+    return "showdown";
+  }
+  return "?";
+}
+
+void print(const live::TableSummary &t) {
+  std::string board;
+  for (std::size_t i = 0; i < t.board_size; ++i) {
+    board += cards::from_card_id(t.board[i]).to_string();
+  }
+  std::string seats;
+  for (std::size_t i = 0; i < t.seated; ++i) {
+    const auto &s = t.seats[i];
+    seats += ' ' + std::to_string(s.who) + ':' + std::to_string(s.stack);
+    if (s.bet != 0) {
+      seats += '(' + std::to_string(s.bet) + ')';
+    }
+  }
+  std::printf("table %-5llu hand %-6llu %-8s pot %-6llu actor %-6llu "
+              "%-10s|%s\n",
+              static_cast<unsigned long long>(t.table),
+              static_cast<unsigned long long>(t.hands), phase_name(t.phase),
+              static_cast<unsigned long long>(t.pot),
+              static_cast<unsigned long long>(t.actor),
+              board.empty() ? "-" : board.c_str(), seats.c_str());
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    std::fprintf(stderr, "usage: %s <state file> [refresh ms]\n", argv[0]);
+    return 2;
+  }
+  auto reader = live::Reader::open(argv[1]);
+  if (!reader) {
+    const auto err = live::to_string(reader.error());
+    std::fprintf(stderr, "cannot open %s: %.*s\n", argv[1],
+                 static_cast<int>(err.size()), err.data());
+    return 2;
+  }
+  const auto refresh =
+      std::chrono::milliseconds{argc > 2 ? std::atoll(argv[2]) : 0};
+  while (true) {
+    const auto tables = reader->snapshot();
+    if (refresh.count() > 0) {
+      std::printf("\033[H\033[2J");
+    }
+    for (const auto &t : tables) {
+      print(t);
+    }
+    std::printf("%zu tables\n", tables.size());
+    if (refresh.count() <= 0) {
+      return 0;
+    }
+    std::fflush(stdout);
+    std::this_thread::sleep_for(refresh);
+  }
+}
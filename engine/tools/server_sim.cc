@@ -0,0 +1,83 @@
+// Runs the server against simulated clients on a virtual network:
+//
+//   server_sim <seed>[-<last seed>] [clients] [seconds] [faults]
+//
+// `faults` adds 1-7 byte reads and writes on top of the usual latency. Each
+// seed is a separate, exactly reproducible run; a range stops at the first
+// failing seed and prints the command that replays it.
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+
+#include "sim.h"
+
+namespace {
+
+auto ms(sim::Clock::duration d) -> double {
+  return std::chrono::duration<double, std::milli>(d).count();
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    std::fprintf(stderr,
+                 "usage: %s <seed>[-<last seed>] [clients] [seconds] "
+                 "[faults]\n",
+                 argv[0]);
+    return 2;
+  }
+  const std::string_view seeds = argv[1];
+  const auto dash = seeds.find('-');
+  const uint64_t first = std::strtoull(argv[1], nullptr, 10);
+  const uint64_t last =
+      dash == std::string_view::npos
+          ? first
+          : std::strtoull(std::string(seeds.substr(dash + 1)).c_str(),
+                          nullptr, 10);
+
+  sim::Scenario sc;
+  if (argc > 2) {
+    sc.clients = std::strtoull(argv[2], nullptr, 10);
+  }
+  if (argc > 3) {
+    sc.duration = std::chrono::seconds{std::atoi(argv[3])};
+  }
+  if (argc > 4 && std::string_view(argv[4]) == "faults") {
+    sc.faults.max_read = 7;
+    sc.faults.max_write = 7;
+  }
+
+  for (uint64_t seed = first; seed <= last; ++seed) {
+    sc.seed = seed;
+    const auto start = std::chrono::steady_clock::now();
+    const auto report = sim::run(sc);
+    const double wall = std::chrono::duration<double>(
+                            std::chrono::steady_clock::now() - start)
+                            .count();
+    std::printf("seed %llu: %llu frames, %llu actions, %llu errors, "
+                "%llu drops; action->frame p50 %.1f ms p99 %.1f ms max "
+                "%.1f ms; %.2f s wall (%.0fx); trace %016llx\n",
+                static_cast<unsigned long long>(seed),
+                static_cast<unsigned long long>(report.frames),
+                static_cast<unsigned long long>(report.actions),
+                static_cast<unsigned long long>(report.errors),
+                static_cast<unsigned long long>(report.drops), ms(report.p50),
+                ms(report.p99), ms(report.max), wall,
+                static_cast<double>(sc.duration.count()) / wall,
+                static_cast<unsigned long long>(report.trace));
+    if (!report.failures.empty()) {
+      for (const auto &f : report.failures) {
+        std::printf("  FAIL %s\n", f.c_str());
+      }
+      std::printf("replay: %s %llu %zu %lld%s\n", argv[0],
+                  static_cast<unsigned long long>(seed), sc.clients,
+                  static_cast<long long>(sc.duration.count()),
+                  sc.faults.max_read ? " faults" : "");
+      return 1;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,366 @@
+// Replays a traffic capture (POKER_CAPTURE_FILE) against a running
+// poker_server and checks that it broadcasts what the captured server did:
+//
+//   traffic_replay <capture> [speed|max] [host] [port]
+//
+// `speed` scales the captured timing (2 replays twice as fast); `max` sends
+// as fast as the server answers. Either way a client only sends its next
+// frame, or hangs up, once it has received every message the captured
+// client had by then, so pacing never reorders what a player saw before
+// acting. Messages are compared per connection and table, in order and
+// independent of how the server coalesced them into frames.
+//
+// The comparison assumes the server starts as the captured one did (same
+// build flags, no restored POKER_ACCOUNTS_FILE) so player and table ids line
+// up. Welcome tokens are random, so they are left out of the comparison and
+// a captured Resume is sent with the token this server issued instead.
+// House bots act on timers, so replays much faster than 1x can legitimately
+// diverge once a bot and a human race for the same turn.
+#include <algorithm>
+#include <arpa/inet.h>
+#include <chrono>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <netinet/in.h>
+#include <optional>
+#include <poll.h>
+#include <string>
+#include <string_view>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+#include "actions.pb.h"
+#include "capture.h"
+#include "response.pb.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int kDefaultPort = 65432;
+// how long a client waits for a message the capture says is coming
+constexpr std::chrono::seconds kCatchUp{2};
+
+struct Message {
+  uint64_t table;
+  std::string bytes;
+  bool operator==(const Message &) const = default;
+};
+
+struct Client {
+  int fd{-1};
+  std::string rx;
+  // ServerMessages, as captured and as received
+  std::vector<Message> expected;
+  std::vector<Message> got;
+  // expected messages the captured client had before its next record
+  std::size_t due{0};
+  std::optional<Clock::time_point> sent;
+};
+
+struct Step {
+  capture::Kind kind;
+  std::chrono::microseconds at;
+  uint64_t conn;
+  std::string payload;
+  // the client's expected message count at this point of the capture
+  std::size_t seen;
+};
+
+// Welcome tokens are noted in `tokens` when given and blanked either way.
+void split_messages(std::string_view bytes, std::vector<Message> &out,
+                    std::map<uint64_t, uint64_t> *tokens = nullptr) {
+  ::poker::v1::Response res;
+  if (!res.ParseFromArray(bytes.data(), static_cast<int>(bytes.size()))) {
+    return;
+  }
+  for (auto &msg : *res.mutable_messages()) {
+    if (msg.has_welcome()) {
+      if (tokens) {
+        (*tokens)[msg.welcome().player()] = msg.welcome().token();
+      }
+      msg.mutable_welcome()->clear_token();
+    }
+    out.push_back({msg.table_id(), msg.SerializeAsString()});
+  }
+}
+
+// Tables run independently -- their hands start and their bots act on
+// separate timers -- so only the order within each table is compared.
+auto by_table(const std::vector<Message> &msgs)
+    -> std::vector<Message> {
+  auto sorted = msgs;
+  std::stable_sort(sorted.begin(), sorted.end(),
+                   [](const Message &a, const Message &b) {
+                     return a.table < b.table;
+                   });
+  return sorted;
+}
+
+auto describe(const std::string &bytes) -> std::string {
+  ::poker::v1::ServerMessage msg;
+  msg.ParseFromString(bytes);
+  return msg.ShortDebugString();
+}
+
+class Replay {
+public:
+  Replay(sockaddr_in addr, double speed) : addr_(addr), speed_(speed) {}
+
+  bool load(capture::Reader &reader) {
+    while (auto rec = reader.next()) {
+      auto &c = clients_[rec->conn];
+      if (rec->kind == capture::Kind::outbound) {
+        split_messages(rec->payload, c.expected);
+        continue;
+      }
+      steps_.push_back({rec->kind, rec->at, rec->conn,
+                        std::string(rec->payload), c.expected.size()});
+    }
+    if (reader.truncated()) {
+      std::fprintf(stderr, "capture is truncated; replaying what was read\n");
+    }
+    return !steps_.empty();
+  }
+
+  void run() {
+    start_ = Clock::now();
+    for (const auto &step : steps_) {
+      if (speed_ > 0) {
+        pump_until(start_ + std::chrono::duration_cast<Clock::duration>(
+                                step.at / speed_));
+      }
+      auto &c = clients_[step.conn];
+      c.due = step.seen;
+      if (step.kind != capture::Kind::open) {
+        catch_up(c);
+      }
+      switch (step.kind) {
+      case capture::Kind::open:
+        open(c);
+        break;
+      case capture::Kind::inbound:
+        send(c, step.payload);
+        break;
+      case capture::Kind::close:
+        if (c.fd >= 0) {
+          ::close(c.fd);
+          c.fd = -1;
+        }
+        break;
+      case capture::Kind::outbound:
+        break;
+      }
+    }
+    elapsed_ = Clock::now() - start_;
+    for (auto &[id, c] : clients_) {
+      c.due = c.expected.size();
+      catch_up(c);
+    }
+  }
+
+  // prints the comparison and returns the number of diverged connections
+  std::size_t report() {
+    std::size_t sent = 0;
+    std::size_t received = 0;
+    std::size_t diverged = 0;
+    for (const auto &step : steps_) {
+      sent += step.kind == capture::Kind::inbound;
+    }
+    for (const auto &[id, c] : clients_) {
+      received += c.got.size();
+      const auto expected = by_table(c.expected);
+      const auto got = by_table(c.got);
+      const auto [e, g] = std::mismatch(expected.begin(), expected.end(),
+                                        got.begin(), got.end());
+      if (e == expected.end() && g == got.end()) {
+        continue;
+      }
+      if (diverged++ == 0) {
+        std::printf("conn %llu diverges after %td of %zu messages\n",
+                    static_cast<unsigned long long>(id),
+                    e - expected.begin(), expected.size());
+        std::printf("  expected: %s\n", e == expected.end()
+                                            ? "(nothing)"
+                                            : describe(e->bytes).c_str());
+        std::printf("  got:      %s\n", g == got.end()
+                                            ? "(nothing)"
+                                            : describe(g->bytes).c_str());
+      }
+    }
+    const double secs = std::chrono::duration<double>(elapsed_).count();
+    std::printf("%zu connections, %zu frames sent in %.2fs (%.0f/s), %zu "
+                "messages received\n",
+                clients_.size(), sent, secs, secs > 0 ? sent / secs : 0.0,
+                received);
+    if (!latencies_.empty()) {
+      std::sort(latencies_.begin(), latencies_.end());
+      const auto pct = [&](double p) {
+        return std::chrono::duration<double, std::milli>(
+                   latencies_[static_cast<std::size_t>(
+                       p * static_cast<double>(latencies_.size() - 1))])
+            .count();
+      };
+      std::printf("frame to reply: p50 %.3fms p99 %.3fms max %.3fms\n",
+                  pct(0.5), pct(0.99), pct(1.0));
+    }
+    std::printf("%zu of %zu connections diverged\n", diverged,
+                clients_.size());
+    return diverged;
+  }
+
+private:
+  void open(Client &c) {
+    c.fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (c.fd < 0 ||
+        connect(c.fd, reinterpret_cast<const sockaddr *>(&addr_),
+                sizeof(addr_)) < 0) {
+      std::perror("connect");
+      std::exit(2);
+    }
+  }
+
+  void send(Client &c, std::string_view payload) {
+    if (c.fd < 0) {
+      return;
+    }
+    std::string body(payload);
+    ::poker::v1::Action action;
+    if (action.ParseFromString(body) && action.has_resume()) {
+      const auto it = tokens_.find(action.resume().player());
+      if (it != tokens_.end()) {
+        action.mutable_resume()->set_token(it->second);
+        body = action.SerializeAsString();
+      }
+    }
+    const uint32_t len = htonl(static_cast<uint32_t>(body.size()));
+    std::string frame(reinterpret_cast<const char *>(&len), sizeof(len));
+    frame += body;
+    std::size_t off = 0;
+    while (off < frame.size()) {
+      const auto n = ::send(c.fd, frame.data() + off, frame.size() - off,
+                            MSG_NOSIGNAL);
+      if (n <= 0) {
+        return;
+      }
+      off += static_cast<std::size_t>(n);
+    }
+    c.sent = Clock::now();
+  }
+
+  // reads until `c` has what it is due, or gives up after kCatchUp
+  void catch_up(Client &c) {
+    if (c.fd >= 0 && c.got.size() < c.due) {
+      pump_until(Clock::now() + kCatchUp, &c);
+    }
+  }
+
+  // services every socket until `until`, or until `waiter` is caught up
+  void pump_until(Clock::time_point until, const Client *waiter = nullptr) {
+    std::vector<pollfd> fds;
+    std::vector<Client *> owners;
+    for (auto &[id, c] : clients_) {
+      if (c.fd >= 0) {
+        fds.push_back({c.fd, POLLIN, 0});
+        owners.push_back(&c);
+      }
+    }
+    while (Clock::now() < until) {
+      const auto left =
+          std::chrono::ceil<std::chrono::milliseconds>(until - Clock::now());
+      if (poll(fds.data(), fds.size(), static_cast<int>(left.count())) <= 0) {
+        continue;
+      }
+      for (std::size_t i = 0; i < fds.size(); ++i) {
+        if (fds[i].revents && !receive(*owners[i])) {
+          fds[i].fd = -1;
+        }
+      }
+      if (waiter && waiter->got.size() >= waiter->due) {
+        return;
+      }
+    }
+  }
+
+  // false once the server has hung up
+  bool receive(Client &c) {
+    char buf[16 * 1024];
+    const auto n = recv(c.fd, buf, sizeof(buf), MSG_DONTWAIT);
+    if (n < 0 && errno == EAGAIN) {
+      return true;
+    }
+    if (n <= 0) {
+      ::close(c.fd);
+      c.fd = -1;
+      return false;
+    }
+    c.rx.append(buf, static_cast<std::size_t>(n));
+    while (c.rx.size() >= sizeof(uint32_t)) {
+      uint32_t len;
+      std::memcpy(&len, c.rx.data(), sizeof(len));
+      len = ntohl(len);
+      if (c.rx.size() < sizeof(len) + len) {
+        break;
+      }
+      split_messages(std::string_view(c.rx).substr(sizeof(len), len), c.got,
+                     &tokens_);
+      c.rx.erase(0, sizeof(len) + len);
+      if (c.sent) {
+        latencies_.push_back(Clock::now() - *c.sent);
+        c.sent.reset();
+      }
+    }
+    return true;
+  }
+
+  sockaddr_in addr_;
+  double speed_;
+  std::map<uint64_t, Client> clients_;
+  // player id to the token this server welcomed it with
+  std::map<uint64_t, uint64_t> tokens_;
+  std::vector<Step> steps_;
+  std::vector<Clock::duration> latencies_;
+  Clock::time_point start_;
+  Clock::duration elapsed_{};
+};
+
+} // namespace
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    std::fprintf(stderr, "usage: %s <capture> [speed|max] [host] [port]\n",
+                 argv[0]);
+    return 2;
+  }
+  double speed = 1.0;
+  if (argc > 2) {
+    speed = std::string_view(argv[2]) == "max" ? 0.0 : std::atof(argv[2]);
+  }
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(argc > 4 ? std::atoi(argv[4]) : kDefaultPort);
+  if (inet_pton(AF_INET, argc > 3 ? argv[3] : "127.0.0.1", &addr.sin_addr) !=
+      1) {
+    std::fprintf(stderr, "bad host\n");
+    return 2;
+  }
+
+  auto reader = capture::Reader::open(argv[1]);
+  if (!reader) {
+    std::fprintf(stderr, "cannot read %s: %.*s\n", argv[1],
+                 static_cast<int>(capture::to_string(reader.error()).size()),
+                 capture::to_string(reader.error()).data());
+    return 2;
+  }
+  Replay replay(addr, speed);
+  if (!replay.load(*reader)) {
+    std::fprintf(stderr, "%s holds no traffic\n", argv[1]);
+    return 2;
+  }
+  replay.run();
+  return replay.report() == 0 ? 0 : 1;
+}